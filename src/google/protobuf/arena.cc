@@ -57,6 +57,7 @@ void Arena::Init(const ArenaOptions& options) {
   hint_ = 0;
   owns_first_block_ = true;
   cleanup_list_ = 0;
+  slab_allocate_repeated_messages_ = options.slab_allocate_repeated_messages;
 
   if (options.initial_block != NULL && options.initial_block_size > 0) {
     // Add first unowned block to list.
@@ -95,13 +95,22 @@ struct ArenaOptions {
   // calls free.
   void (*block_dealloc)(void*, size_t);
 
+  // If true, repeated message fields on the arena create new elements in
+  // batches carved out of a single allocation, each batch sized to the growth
+  // of the field's pointer array, so that iterating over the field walks
+  // memory sequentially.  Elements created ahead of need are held as cleared
+  // objects until Add() hands them out, so this trades some arena space for
+  // locality.
+  bool slab_allocate_repeated_messages;
+
   ArenaOptions()
       : start_block_size(kDefaultStartBlockSize),
         max_block_size(kDefaultMaxBlockSize),
         initial_block(NULL),
         initial_block_size(0),
         block_alloc(&malloc),
-        block_dealloc(&internal::arena_free) {}
+        block_dealloc(&internal::arena_free),
+        slab_allocate_repeated_messages(false) {}
 
  private:
   // Constants define default starting block size and max block size for
@@ -352,6 +361,32 @@ class LIBPROTOBUF_EXPORT Arena {
     return Create<T>(arena);
   }
 
+  // Creates |n| messages of type Msg with one allocation on |arena| and stores
+  // pointers to them in |elements|, if |arena| was asked to slab-allocate
+  // repeated messages.  Returns false, creating nothing, otherwise or if Msg
+  // does not support arenas.  Used by repeated fields, like the above.
+  template<typename Msg>
+  static bool CreateMaybeMessageArray(
+      Arena* arena, int n, Msg** elements,
+      typename Msg::InternalArenaConstructable_*) {
+    if (arena == NULL || !arena->slab_allocate_repeated_messages_) {
+      return false;
+    }
+    char* slab = static_cast<char*>(arena->AllocateAligned(n * sizeof(Msg)));
+    for (int i = 0; i < n; i++) {
+      elements[i] = new (slab + i * sizeof(Msg)) Msg(arena);
+      if (!SkipDeleteList<Msg>(static_cast<Msg*>(0))) {
+        arena->AddListNode(elements[i], &internal::arena_destruct_object<Msg>);
+      }
+    }
+    return true;
+  }
+
+  template<typename T>
+  static bool CreateMaybeMessageArray(Arena* arena, int n, T** elements, ...) {
+    return false;
+  }
+
   template <typename T> GOOGLE_ATTRIBUTE_ALWAYS_INLINE
   inline T* CreateInternal(
       bool skip_explicit_ownership) {
@@ -462,6 +497,7 @@ class LIBPROTOBUF_EXPORT Arena {
                              // ptrs and cleanup methods.
 
   bool owns_first_block_;    // Indicates that arena owns the first block
+  bool slab_allocate_repeated_messages_;
   Mutex blocks_lock_;
 
   void AddBlock(Block* b);
@@ -37,6 +37,7 @@
 #include <google/protobuf/stubs/shared_ptr.h>
 #endif
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <google/protobuf/stubs/common.h>
@@ -333,6 +334,84 @@ TEST(ArenaTest, UnsafeArenaSwap) {
   TestUtil::ExpectAllFieldsSet(*message2);
 }
 
+#if LANG_CXX11
+TEST(ArenaTest, MoveAssignWithinArena) {
+  Arena shared_arena;
+  TestAllTypes* message1 = Arena::CreateMessage<TestAllTypes>(&shared_arena);
+  TestAllTypes* message2 = Arena::CreateMessage<TestAllTypes>(&shared_arena);
+  TestUtil::SetAllFields(message1);
+  const TestAllTypes::NestedMessage* nested =
+      &message1->optional_nested_message();
+
+  *message2 = std::move(*message1);
+
+  // Same arena: the fields are stolen rather than copied.
+  TestUtil::ExpectAllFieldsSet(*message2);
+  EXPECT_EQ(nested, &message2->optional_nested_message());
+  EXPECT_EQ(&shared_arena, message2->GetArena());
+  TestUtil::ExpectClear(*message1);
+}
+
+TEST(ArenaTest, MoveAssignBetweenArenas) {
+  Arena arena1;
+  Arena arena2;
+  TestAllTypes* message1 = Arena::CreateMessage<TestAllTypes>(&arena1);
+  TestAllTypes* message2 = Arena::CreateMessage<TestAllTypes>(&arena2);
+  TestUtil::SetAllFields(message1);
+
+  *message2 = std::move(*message1);
+
+  // Different arenas: the move degrades to a copy.
+  TestUtil::ExpectAllFieldsSet(*message2);
+  EXPECT_NE(&message1->optional_nested_message(),
+            &message2->optional_nested_message());
+  EXPECT_EQ(&arena2, message2->GetArena());
+  EXPECT_EQ(&arena2, message2->optional_nested_message().GetArena());
+}
+
+TEST(ArenaTest, MoveConstructFromArenaMessage) {
+  Arena arena;
+  TestAllTypes* arena_message = Arena::CreateMessage<TestAllTypes>(&arena);
+  TestUtil::SetAllFields(arena_message);
+
+  TestAllTypes heap_message(std::move(*arena_message));
+
+  TestUtil::ExpectAllFieldsSet(heap_message);
+  EXPECT_TRUE(heap_message.GetArena() == NULL);
+  EXPECT_TRUE(heap_message.optional_nested_message().GetArena() == NULL);
+}
+
+TEST(ArenaTest, MoveMessageWithoutArenaSupport) {
+  protobuf_unittest_no_arena::TestAllTypes message1;
+  message1.set_optional_int32(123);
+  message1.mutable_optional_nested_message()->set_bb(7);
+  const protobuf_unittest_no_arena::TestAllTypes::NestedMessage* nested =
+      &message1.optional_nested_message();
+
+  protobuf_unittest_no_arena::TestAllTypes message2(std::move(message1));
+  EXPECT_EQ(123, message2.optional_int32());
+  EXPECT_EQ(nested, &message2.optional_nested_message());
+
+  protobuf_unittest_no_arena::TestAllTypes message3;
+  message3 = std::move(message2);
+  EXPECT_EQ(123, message3.optional_int32());
+  EXPECT_EQ(nested, &message3.optional_nested_message());
+}
+#endif  // LANG_CXX11
+
+TEST(ArenaTest, SpaceUsedLongOfArenaMessage) {
+  // Everything reachable from an arena message lives on the arena, so
+  // SpaceUsedLong() attributes nothing to the message itself.
+  Arena arena;
+  TestAllTypes* arena_message = Arena::CreateMessage<TestAllTypes>(&arena);
+  TestUtil::SetAllFields(arena_message);
+  EXPECT_EQ(0, arena_message->SpaceUsedLong());
+
+  TestAllTypes heap_message;
+  heap_message.CopyFrom(*arena_message);
+  EXPECT_LT(sizeof(heap_message), heap_message.SpaceUsedLong());
+}
+
 TEST(ArenaTest, SwapBetweenArenasUsingReflection) {
   Arena arena1;
   TestAllTypes* arena1_message = Arena::CreateMessage<TestAllTypes>(&arena1);
@@ -845,6 +924,83 @@ TEST(ArenaTest, RepeatedFieldOnArena) {
   arena.Reset();
 }
 
+// Returns true if elements [begin, end) of |field| sit next to each other in
+// memory, in order.
+bool ElementsAreContiguous(const RepeatedPtrField<TestAllTypes>& field,
+                           int begin, int end) {
+  for (int i = begin + 1; i < end; i++) {
+    if (&field.Get(i) != &field.Get(i - 1) + 1) return false;
+  }
+  return true;
+}
+
+TEST(ArenaTest, SlabAllocatedRepeatedMessages) {
+  ArenaOptions options;
+  options.slab_allocate_repeated_messages = true;
+  Arena arena(options);
+  TestAllTypes* message = Arena::CreateMessage<TestAllTypes>(&arena);
+  RepeatedPtrField<TestAllTypes::NestedMessage>* field =
+      message->mutable_repeated_nested_message();
+
+  // The first Add() fills the whole pointer array; later elements come from
+  // the same slab.
+  field->Add()->set_bb(0);
+  const int capacity = field->Capacity();
+  EXPECT_EQ(capacity - 1, field->ClearedCount());
+  for (int i = 1; i < capacity; i++) {
+    field->Add()->set_bb(i);
+    EXPECT_EQ(&field->Get(i - 1) + 1, &field->Get(i));
+  }
+  EXPECT_EQ(0, field->ClearedCount());
+  for (int i = 0; i < capacity; i++) {
+    EXPECT_EQ(&arena, field->Get(i).GetArena());
+    EXPECT_EQ(i, field->Get(i).bb());
+  }
+
+  // Clear() keeps the slabs, and the elements are reused in the same order.
+  const TestAllTypes::NestedMessage* first = &field->Get(0);
+  field->Clear();
+  EXPECT_EQ(capacity, field->ClearedCount());
+  EXPECT_EQ(first, field->Add());
+  EXPECT_FALSE(field->Get(0).has_bb());
+}
+
+TEST(ArenaTest, SlabAllocatedMergeAndParse) {
+  TestAllTypes source;
+  for (int i = 0; i < 10; i++) {
+    source.add_repeated_foreign_message()->set_c(i);
+  }
+
+  ArenaOptions options;
+  options.slab_allocate_repeated_messages = true;
+  Arena arena(options);
+
+  RepeatedPtrField<TestAllTypes>* merged =
+      Arena::CreateMessage<RepeatedPtrField<TestAllTypes> >(&arena);
+  RepeatedPtrField<TestAllTypes> heap_field;
+  for (int i = 0; i < 10; i++) {
+    heap_field.Add()->set_optional_int32(i);
+  }
+  merged->MergeFrom(heap_field);
+  ASSERT_EQ(10, merged->size());
+  EXPECT_TRUE(ElementsAreContiguous(*merged, 0, 10));
+  EXPECT_EQ(9, merged->Get(9).optional_int32());
+
+  TestAllTypes* parsed = Arena::CreateMessage<TestAllTypes>(&arena);
+  ASSERT_TRUE(parsed->ParseFromString(source.SerializeAsString()));
+  ASSERT_EQ(10, parsed->repeated_foreign_message_size());
+  EXPECT_EQ(&parsed->repeated_foreign_message(0) + 1,
+            &parsed->repeated_foreign_message(1));
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(i, parsed->repeated_foreign_message(i).c());
+  }
+
+  // Without the option, elements are created one at a time.
+  Arena plain_arena;
+  TestAllTypes* plain = Arena::CreateMessage<TestAllTypes>(&plain_arena);
+  plain->add_repeated_nested_message();
+  EXPECT_EQ(0, plain->repeated_nested_message().ClearedCount());
+}
 
 TEST(ArenaTest, MutableMessageReflection) {
   Arena arena;
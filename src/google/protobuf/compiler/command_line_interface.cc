@@ -65,6 +65,8 @@
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/dynamic_message.h>
 #include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/delimited_message_stream.h>
+#include <google/protobuf/io/dictionary_trainer.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 #include <google/protobuf/io/printer.h>
 #include <google/protobuf/stubs/strutil.h>
@@ -108,6 +110,9 @@ static const char* kPathSeparator = ";";
 static const char* kPathSeparator = ":";
 #endif
 
+// Default for --dictionary_size.
+static const int kDefaultDictionarySize = 16 * 1024;
+
 // Returns true if the text looks like a Windows-style absolute path, starting
 // with a drive letter.  Example:  "C:\foo".  TODO(kenton):  Share this with
 // copy in importer.cc?
@@ -587,6 +592,7 @@ CommandLineInterface::CommandLineInterface()
   : mode_(MODE_COMPILE),
     print_mode_(PRINT_NONE),
     error_format_(ERROR_FORMAT_GCC),
+    dictionary_size_(kDefaultDictionarySize),
     imports_in_descriptor_set_(false),
     source_info_in_descriptor_set_(false),
     disallow_services_(false),
@@ -744,6 +750,12 @@ int CommandLineInterface::Run(int argc, const char* const argv[]) {
     }
   }
 
+  if (mode_ == MODE_TRAIN_DICTIONARY) {
+    if (!TrainDictionary(importer.pool())) {
+      return 1;
+    }
+  }
+
   if (mode_ == MODE_PRINT) {
     switch (print_mode_) {
       case PRINT_FREE_FIELDS:
@@ -774,6 +786,7 @@ void CommandLineInterface::Clear() {
   input_files_.clear();
   output_directives_.clear();
   codec_type_.clear();
+  dictionary_size_ = kDefaultDictionarySize;
   descriptor_set_name_.clear();
 
   mode_ = MODE_COMPILE;
@@ -1069,6 +1082,30 @@ CommandLineInterface::InterpretArgument(const string& name,
 
     codec_type_ = value;
 
+  } else if (name == "--train_dictionary") {
+    if (mode_ != MODE_COMPILE) {
+      cerr << "Cannot use " << name << " and use --encode, --decode or print "
+           << "other info at the same time." << endl;
+      return PARSE_ARGUMENT_FAIL;
+    }
+    if (!output_directives_.empty() || !descriptor_set_name_.empty()) {
+      cerr << "Cannot use " << name
+           << " and generate code or descriptors at the same time." << endl;
+      return PARSE_ARGUMENT_FAIL;
+    }
+    if (value.empty()) {
+      cerr << "Type name for " << name << " cannot be blank." << endl;
+      return PARSE_ARGUMENT_FAIL;
+    }
+    mode_ = MODE_TRAIN_DICTIONARY;
+    codec_type_ = value;
+
+  } else if (name == "--dictionary_size") {
+    if (!safe_strto32(value, &dictionary_size_) || dictionary_size_ <= 0) {
+      cerr << "Invalid dictionary size: " << value << endl;
+      return PARSE_ARGUMENT_FAIL;
+    }
+
   } else if (name == "--error_format") {
     if (value == "gcc") {
       error_format_ = ERROR_FORMAT_GCC;
@@ -1139,8 +1176,8 @@ CommandLineInterface::InterpretArgument(const string& name,
     } else {
       // It's an output flag.  Add it to the output directives.
       if (mode_ != MODE_COMPILE) {
-        cerr << "Cannot use --encode, --decode or print .proto info and "
-                "generate code at the same time." << endl;
+        cerr << "Cannot use --encode, --decode, --train_dictionary or print "
+                ".proto info and generate code at the same time." << endl;
         return PARSE_ARGUMENT_FAIL;
       }
 
@@ -1194,6 +1231,17 @@ void CommandLineInterface::PrintHelpText() {
 "                              pairs in text format to standard output.  No\n"
 "                              PROTO_FILES should be given when using this\n"
 "                              flag.\n"
+"  --train_dictionary=MESSAGE_TYPE\n"
+"                              Read binary messages of the given type, each\n"
+"                              preceded by its size as a varint, from\n"
+"                              standard input and write a preset dictionary\n"
+"                              for compressing such messages individually\n"
+"                              with zlib to standard output.  The message\n"
+"                              type must be defined in PROTO_FILES or their\n"
+"                              imports.\n"
+"  --dictionary_size=BYTES     Maximum size of the dictionary written by\n"
+"                              --train_dictionary.  Defaults to 16384;\n"
+"                              zlib uses at most 32768.\n"
 "  -oFILE,                     Writes a FileDescriptorSet (a protocol buffer,\n"
 "    --descriptor_set_out=FILE defined in descriptor.proto) containing all of\n"
 "                              the input files to FILE.\n"
@@ -1424,6 +1472,57 @@ bool CommandLineInterface::EncodeOrDecode(const DescriptorPool* pool) {
   return true;
 }
 
+bool CommandLineInterface::TrainDictionary(const DescriptorPool* pool) {
+  // Look up the type.
+  const Descriptor* type = pool->FindMessageTypeByName(codec_type_);
+  if (type == NULL) {
+    cerr << "Type not defined: " << codec_type_ << endl;
+    return false;
+  }
+
+  DynamicMessageFactory dynamic_factory(pool);
+  google::protobuf::scoped_ptr<Message> message(dynamic_factory.GetPrototype(type)->New());
+
+  SetFdToBinaryMode(STDIN_FILENO);
+  SetFdToBinaryMode(STDOUT_FILENO);
+
+  io::FileInputStream in(STDIN_FILENO);
+  io::DelimitedMessageReader reader(&in);
+  io::DictionaryTrainer trainer;
+  // Samples are re-serialized, so that they have the canonical field order
+  // regardless of what wrote them.
+  while (reader.ReadPartialMessage(message.get())) {
+    trainer.AddSample(message->SerializePartialAsString());
+  }
+  if (reader.HadError()) {
+    cerr << "Failed to parse input message " << trainer.sample_count() + 1
+         << "." << endl;
+    return false;
+  }
+  if (trainer.sample_count() == 0) {
+    cerr << "No input messages." << endl;
+    return false;
+  }
+
+  string dictionary = trainer.Train(dictionary_size_);
+  io::FileOutputStream out(STDOUT_FILENO);
+  void* buffer;
+  int size;
+  int written = 0;
+  while (written < dictionary.size()) {
+    if (!out.Next(&buffer, &size)) break;
+    int n = min<int>(size, dictionary.size() - written);
+    memcpy(buffer, dictionary.data() + written, n);
+    if (n < size) out.BackUp(size - n);
+    written += n;
+  }
+  if (written < dictionary.size() || !out.Flush()) {
+    cerr << "output: I/O error." << endl;
+    return false;
+  }
+  return true;
+}
+
 bool CommandLineInterface::WriteDescriptorSet(
     const vector<const FileDescriptor*> parsed_files) {
   FileDescriptorSet file_set;
@@ -244,6 +244,9 @@ class LIBPROTOC_EXPORT CommandLineInterface {
   // Implements --encode and --decode.
   bool EncodeOrDecode(const DescriptorPool* pool);
 
+  // Implements --train_dictionary.
+  bool TrainDictionary(const DescriptorPool* pool);
+
   // Implements the --descriptor_set_out option.
   bool WriteDescriptorSet(const vector<const FileDescriptor*> parsed_files);
 
@@ -314,6 +317,9 @@ class LIBPROTOC_EXPORT CommandLineInterface {
     MODE_ENCODE,   // --encode:  read text from stdin, write binary to stdout.
     MODE_DECODE,   // --decode:  read binary from stdin, write text to stdout.
     MODE_PRINT,    // Print mode: print info of the given .proto files and exit.
+    MODE_TRAIN_DICTIONARY,  // --train_dictionary:  read delimited binary
+                            // messages from stdin, write a compression
+                            // dictionary to stdout.
   };
 
   Mode mode_;
@@ -346,9 +352,13 @@ class LIBPROTOC_EXPORT CommandLineInterface {
   vector<OutputDirective> output_directives_;
 
   // When using --encode or --decode, this names the type we are encoding or
-  // decoding.  (Empty string indicates --decode_raw.)
+  // decoding.  (Empty string indicates --decode_raw.)  With
+  // --train_dictionary, it names the type of the sample messages.
   string codec_type_;
 
+  // Maximum dictionary size for --train_dictionary (--dictionary_size).
+  int dictionary_size_;
+
   // If --descriptor_set_out was given, this is the filename to which the
   // FileDescriptorSet should be written.  Otherwise, empty.
   string descriptor_set_name_;
@@ -48,7 +48,10 @@
 
 #include <google/protobuf/descriptor.pb.h>
 #include <google/protobuf/descriptor.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/dictionary_trainer.h>
 #include <google/protobuf/io/zero_copy_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 #include <google/protobuf/compiler/command_line_interface.h>
 #include <google/protobuf/compiler/code_generator.h>
 #include <google/protobuf/testing/file.h>
@@ -1578,6 +1581,12 @@ class EncodeDecodeTest : public testing::Test {
     EXPECT_TRUE(captured_stdout_ == expected_output);
   }
 
+  void ExpectStdoutMatchesBinary(const string& expected_output) {
+    // Don't use EXPECT_EQ because we don't want to print raw binary data to
+    // stdout on failure.
+    EXPECT_TRUE(captured_stdout_ == expected_output);
+  }
+
   void ExpectStdoutMatchesTextFile(const string& filename) {
     string expected_output;
     GOOGLE_CHECK_OK(File::GetContents(filename, &expected_output, true));
@@ -1658,6 +1667,42 @@ TEST_F(EncodeDecodeTest, ProtoParseError) {
     "google/protobuf/no_such_file.proto: File not found.\n");
 }
 
+TEST_F(EncodeDecodeTest, TrainDictionary) {
+  string input;
+  io::DictionaryTrainer trainer;
+  {
+    io::StringOutputStream output(&input);
+    io::CodedOutputStream coded_output(&output);
+    for (int i = 0; i < 100; i++) {
+      protobuf_unittest::TestAllTypes message;
+      message.set_optional_int32(i);
+      message.set_optional_string("request from client " + SimpleItoa(i % 7));
+      message.add_repeated_string("common repeated value");
+      string serialized = message.SerializeAsString();
+      coded_output.WriteVarint32(serialized.size());
+      coded_output.WriteString(serialized);
+      trainer.AddSample(serialized);
+    }
+  }
+
+  RedirectStdinFromText(input);
+  EXPECT_TRUE(Run("google/protobuf/unittest.proto "
+                  "--train_dictionary=protobuf_unittest.TestAllTypes "
+                  "--dictionary_size=1024"));
+  string expected = trainer.Train(1024);
+  EXPECT_FALSE(expected.empty());
+  ExpectStdoutMatchesBinary(expected);
+  ExpectStderrMatchesText("");
+}
+
+TEST_F(EncodeDecodeTest, TrainDictionaryBadInput) {
+  RedirectStdinFromText("\x05abc");
+  EXPECT_FALSE(Run("google/protobuf/unittest.proto "
+                   "--train_dictionary=protobuf_unittest.TestAllTypes"));
+  ExpectStdoutMatchesText("");
+  ExpectStderrMatchesText("Failed to parse input message 1.\n");
+}
+
 }  // anonymous namespace
 
 }  // namespace compiler
@@ -35,6 +35,7 @@
 #include <google/protobuf/compiler/cpp/cpp_enum_field.h>
 #include <google/protobuf/compiler/cpp/cpp_helpers.h>
 #include <google/protobuf/io/printer.h>
+#include <google/protobuf/wire_format_lite.h>
 #include <google/protobuf/descriptor.pb.h>
 #include <google/protobuf/stubs/strutil.h>
 
@@ -169,6 +170,19 @@ GenerateByteSize(io::Printer* printer) const {
     "  ::google::protobuf::internal::WireFormatLite::EnumSize(this->$name$());\n");
 }
 
+void EnumFieldGenerator::
+GenerateStructuralHash(io::Printer* printer) const {
+  printer->Print(variables_,
+    "hash += ::google::protobuf::internal::HashCombine(\n"
+    "    $number$, ::google::protobuf::internal::HashValue(this->$name$()));\n");
+}
+
+void EnumFieldGenerator::
+GenerateStructuralEquals(io::Printer* printer) const {
+  printer->Print(variables_,
+    "if (this->$name$() != other.$name$()) return false;\n");
+}
+
 // ===================================================================
 
 EnumOneofFieldGenerator::
@@ -228,6 +242,13 @@ RepeatedEnumFieldGenerator(const FieldDescriptor* descriptor,
                            const Options& options)
   : descriptor_(descriptor) {
   SetEnumVariables(descriptor, &variables_, options);
+  if (options.inline_repeated > 0) {
+    variables_["storage_type"] = StrCat(
+        "::google::protobuf::internal::InlinedRepeatedField<int, ",
+        SimpleItoa(options.inline_repeated), ">");
+  } else {
+    variables_["storage_type"] = "::google::protobuf::RepeatedField<int>";
+  }
 }
 
 RepeatedEnumFieldGenerator::~RepeatedEnumFieldGenerator() {}
@@ -235,7 +256,7 @@ RepeatedEnumFieldGenerator::~RepeatedEnumFieldGenerator() {}
 void RepeatedEnumFieldGenerator::
 GeneratePrivateMembers(io::Printer* printer) const {
   printer->Print(variables_,
-    "::google::protobuf::RepeatedField<int> $name$_;\n");
+    "$storage_type$ $name$_;\n");
   if (descriptor_->options().packed()
       && HasGeneratedMethods(descriptor_->file())) {
     printer->Print(variables_,
@@ -469,6 +490,60 @@ GenerateByteSize(io::Printer* printer) const {
   printer->Print("}\n");
 }
 
+void RepeatedEnumFieldGenerator::
+GenerateSpaceUsed(io::Printer* printer) const {
+  printer->Print(variables_,
+    "total_size += $name$_.SpaceUsedExcludingSelfLong();\n");
+}
+
+void RepeatedEnumFieldGenerator::
+GenerateStructuralHash(io::Printer* printer) const {
+  printer->Print(variables_,
+    "if (this->$name$_size() > 0) {\n"
+    "  hash += ::google::protobuf::internal::HashCombine(\n"
+    "      $number$,\n"
+    "      ::google::protobuf::internal::HashRepeatedValues(this->$name$()));\n"
+    "}\n");
+}
+
+void RepeatedEnumFieldGenerator::
+GenerateStructuralEquals(io::Printer* printer) const {
+  printer->Print(variables_,
+    "if (!::google::protobuf::internal::RepeatedPrimitivesEqual(\n"
+    "        this->$name$(), other.$name$())) {\n"
+    "  return false;\n"
+    "}\n");
+}
+
+void RepeatedEnumFieldGenerator::
+GenerateSerializeReverse(io::Printer* printer) const {
+  if (!descriptor_->options().packed()) {
+    FieldGenerator::GenerateSerializeReverse(printer);
+    return;
+  }
+  // The ByteSize() code would store _$name$_cached_byte_size_, so size the
+  // packed data locally instead.
+  map<string, string> vars(variables_);
+  vars["packed_tag"] = SimpleItoa(internal::WireFormatLite::MakeTag(
+      descriptor_->number(),
+      internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED));
+  printer->Print(vars,
+    "if (this->$name$_size() > 0) {\n"
+    "  int data_size = 0;\n"
+    "  for (int i = 0; i < this->$name$_size(); i++) {\n"
+    "    data_size += ::google::protobuf::internal::WireFormatLite::EnumSize(\n"
+    "      this->$name$(i));\n"
+    "  }\n"
+    "  ::google::protobuf::uint8* target = output->Reserve(data_size);\n"
+    "  for (int i = 0; i < this->$name$_size(); i++) {\n"
+    "    target = ::google::protobuf::internal::WireFormatLite::\n"
+    "      WriteEnumNoTagToArray(this->$name$(i), target);\n"
+    "  }\n"
+    "  output->WriteVarint32(data_size);\n"
+    "  output->WriteTag($packed_tag$);\n"
+    "}\n");
+}
+
 }  // namespace cpp
 }  // namespace compiler
 }  // namespace protobuf
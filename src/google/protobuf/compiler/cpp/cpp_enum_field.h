@@ -62,6 +62,8 @@ class EnumFieldGenerator : public FieldGenerator {
   void GenerateSerializeWithCachedSizes(io::Printer* printer) const;
   void GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const;
   void GenerateByteSize(io::Printer* printer) const;
+  void GenerateStructuralHash(io::Printer* printer) const;
+  void GenerateStructuralEquals(io::Printer* printer) const;
 
  protected:
   const FieldDescriptor* descriptor_;
@@ -106,6 +108,10 @@ class RepeatedEnumFieldGenerator : public FieldGenerator {
   void GenerateSerializeWithCachedSizes(io::Printer* printer) const;
   void GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const;
   void GenerateByteSize(io::Printer* printer) const;
+  void GenerateSpaceUsed(io::Printer* printer) const;
+  void GenerateStructuralHash(io::Printer* printer) const;
+  void GenerateStructuralEquals(io::Printer* printer) const;
+  void GenerateSerializeReverse(io::Printer* printer) const;
 
  private:
   const FieldDescriptor* descriptor_;
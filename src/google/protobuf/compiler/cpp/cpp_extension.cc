@@ -187,6 +187,17 @@ void ExtensionGenerator::GenerateRegistration(io::Printer* printer) {
         "type", ClassName(descriptor_->enum_type(), true));
       break;
     case FieldDescriptor::CPPTYPE_MESSAGE:
+      if (descriptor_->options().lazy() && !descriptor_->is_repeated() &&
+          descriptor_->type() == FieldDescriptor::TYPE_MESSAGE) {
+        printer->Print(vars,
+          "::google::protobuf::internal::ExtensionSet::RegisterLazyMessageExtension(\n"
+          "  &$extendee$::default_instance(),\n"
+          "  $number$, $field_type$,\n");
+        printer->Print(
+          "  &$type$::default_instance());\n",
+          "type", ClassName(descriptor_->message_type(), true));
+        break;
+      }
       printer->Print(vars,
         "::google::protobuf::internal::ExtensionSet::RegisterMessageExtension(\n"
         "  &$extendee$::default_instance(),\n"
@@ -117,6 +117,20 @@ GenerateMergeFromCodedStreamWithPacking(io::Printer* printer) const {
 
 }
 
+void FieldGenerator::
+GenerateSerializeReverse(io::Printer* printer) const {
+  printer->Print(
+    "{\n"
+    "  int total_size = 0;\n");
+  printer->Indent();
+  GenerateByteSize(printer);
+  printer->Print(
+    "::google::protobuf::uint8* target = output->Reserve(total_size);\n");
+  GenerateSerializeWithCachedSizesToArray(printer);
+  printer->Outdent();
+  printer->Print("}\n");
+}
+
 FieldGeneratorMap::FieldGeneratorMap(const Descriptor* descriptor,
                                      const Options& options)
     : descriptor_(descriptor),
@@ -168,6 +168,31 @@ class FieldGenerator {
   // are placed in the message's ByteSize() method.
   virtual void GenerateByteSize(io::Printer* printer) const = 0;
 
+  // Generate lines to add the memory this field uses outside of the message
+  // object to "total_size", which are placed in the message's SpaceUsedLong()
+  // method.  Fields stored inline in the message need nothing, so the default
+  // implementation is empty.
+  virtual void GenerateSpaceUsed(io::Printer* /*printer*/) const {}
+
+  // Generate lines to add this field's term to "hash", which are placed in
+  // the message's StructuralHash() method.  For singular fields, these are
+  // only run if the field is present.
+  virtual void GenerateStructuralHash(io::Printer* printer) const = 0;
+
+  // Generate lines that return false if this field differs from the same
+  // field in "other", which are placed in the message's StructurallyEquals()
+  // method.  For singular fields, these are only run if the field is present
+  // in both messages.
+  virtual void GenerateStructuralEquals(io::Printer* printer) const = 0;
+
+  // Generate lines to prepend this field to the io::ReverseCodedBuffer
+  // "output", which are placed within the message's
+  // InternalSerializeReverse() method.  The default implementation sizes the
+  // field with the GenerateByteSize() code and then writes it with the
+  // GenerateSerializeWithCachedSizesToArray() code; fields whose size depends
+  // on cached sizes must override it.
+  virtual void GenerateSerializeReverse(io::Printer* printer) const;
+
  private:
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(FieldGenerator);
 };
@@ -33,6 +33,7 @@
 //  Sanjay Ghemawat, Jeff Dean, and others.
 
 #include <google/protobuf/compiler/cpp/cpp_file.h>
+#include <algorithm>
 #include <memory>
 #ifndef _SHARED_PTR_H
 #include <google/protobuf/stubs/shared_ptr.h>
@@ -54,6 +55,18 @@ namespace protobuf {
 namespace compiler {
 namespace cpp {
 
+namespace {
+
+// Returns the number of fields in the message, including nested types.
+int CountFields(const Descriptor* descriptor) {
+  int count = descriptor->field_count();
+  for (int i = 0; i < descriptor->nested_type_count(); i++) {
+    count += CountFields(descriptor->nested_type(i));
+  }
+  return count;
+}
+
+}  // namespace
 // ===================================================================
 
 FileGenerator::FileGenerator(const FileDescriptor* file, const Options& options)
@@ -322,12 +335,8 @@ void FileGenerator::GenerateHeader(io::Printer* printer) {
     "filename_identifier", filename_identifier);
 }
 
-void FileGenerator::GenerateSource(io::Printer* printer) {
+void FileGenerator::GenerateSourceIncludes(io::Printer* printer) {
   printer->Print(
-    "// Generated by the protocol buffer compiler.  DO NOT EDIT!\n"
-    "// source: $filename$\n"
-    "\n"
-
     // The generated code calls accessors that might be deprecated. We don't
     // want the compiler to warn in generated code.
     "#define INTERNAL_SUPPRESS_PROTOBUF_FIELD_DEPRECATION\n"
@@ -339,7 +348,6 @@ void FileGenerator::GenerateSource(io::Printer* printer) {
     "#include <google/protobuf/stubs/once.h>\n"
     "#include <google/protobuf/io/coded_stream.h>\n"
     "#include <google/protobuf/wire_format_lite_inl.h>\n",
-    "filename", file_->name(),
     "basename", StripProto(file_->name()));
 
   // Unknown fields implementation in lite mode uses StringOutputStream
@@ -358,16 +366,28 @@ void FileGenerator::GenerateSource(io::Printer* printer) {
 
   printer->Print(
     "// @@protoc_insertion_point(includes)\n");
+}
 
+void FileGenerator::GenerateSource(io::Printer* printer) {
+  printer->Print(
+    "// Generated by the protocol buffer compiler.  DO NOT EDIT!\n"
+    "// source: $filename$\n"
+    "\n",
+    "filename", file_->name());
+
+  GenerateSourceIncludes(printer);
   GenerateNamespaceOpeners(printer);
 
   if (HasDescriptorMethods(file_)) {
+    // With split_into, the other parts of the file refer to the descriptor
+    // pointers, so they can't be in an anonymous namespace.
     printer->Print(
       "\n"
-      "namespace {\n"
-      "\n");
+      "$namespace$"
+      "\n",
+      "namespace", options_.split_into > 0 ? "" : "namespace {\n");
     for (int i = 0; i < file_->message_type_count(); i++) {
-      message_generators_[i]->GenerateDescriptorDeclarations(printer);
+      message_generators_[i]->GenerateDescriptorDeclarations(printer, false);
     }
     for (int i = 0; i < file_->enum_type_count(); i++) {
       printer->Print(
@@ -385,8 +405,9 @@ void FileGenerator::GenerateSource(io::Printer* printer) {
 
     printer->Print(
       "\n"
-      "}  // namespace\n"
-      "\n");
+      "$namespace$"
+      "\n",
+      "namespace", options_.split_into > 0 ? "" : "}  // namespace\n");
   }
 
   // Define our externally-visible BuildDescriptors() function.  (For the lite
@@ -399,24 +420,8 @@ void FileGenerator::GenerateSource(io::Printer* printer) {
   }
 
   // Generate classes.
-  for (int i = 0; i < file_->message_type_count(); i++) {
-    if (i == 0 && HasGeneratedMethods(file_)) {
-      printer->Print(
-          "\n"
-          "namespace {\n"
-          "\n"
-          "static void MergeFromFail(int line) GOOGLE_ATTRIBUTE_COLD;\n"
-          "static void MergeFromFail(int line) {\n"
-          "  GOOGLE_CHECK(false) << __FILE__ << \":\" << line;\n"
-          "}\n"
-          "\n"
-          "}  // namespace\n"
-          "\n");
-    }
-    printer->Print("\n");
-    printer->Print(kThickSeparator);
-    printer->Print("\n");
-    message_generators_[i]->GenerateClassMethods(printer);
+  if (options_.split_into == 0) {
+    GenerateClasses(printer, 0, file_->message_type_count());
   }
 
   if (HasGenericServices(file_)) {
@@ -445,6 +450,97 @@ void FileGenerator::GenerateSource(io::Printer* printer) {
     "// @@protoc_insertion_point(global_scope)\n");
 }
 
+void FileGenerator::GenerateSourcePart(io::Printer* printer, int part) {
+  int begin, end;
+  GetPartRange(part, &begin, &end);
+
+  printer->Print(
+    "// Generated by the protocol buffer compiler.  DO NOT EDIT!\n"
+    "// source: $filename$\n"
+    "// Part $part$ of $count$ of the message implementations.\n"
+    "\n",
+    "filename", file_->name(),
+    "part", SimpleItoa(part),
+    "count", SimpleItoa(options_.split_into));
+
+  GenerateSourceIncludes(printer);
+  GenerateNamespaceOpeners(printer);
+
+  if (HasDescriptorMethods(file_)) {
+    // The descriptor pointers are defined, and assigned, by the main part.
+    printer->Print(
+      "\n"
+      "void $assigndescriptorsname$_once();\n"
+      "\n"
+      "namespace {\n"
+      "\n"
+      "inline void protobuf_AssignDescriptorsOnce() {\n"
+      "  $assigndescriptorsname$_once();\n"
+      "}\n"
+      "\n"
+      "}  // namespace\n"
+      "\n",
+      "assigndescriptorsname", GlobalAssignDescriptorsName(file_->name()));
+    for (int i = 0; i < file_->message_type_count(); i++) {
+      message_generators_[i]->GenerateDescriptorDeclarations(printer, true);
+    }
+  }
+
+  GenerateClasses(printer, begin, end);
+
+  GenerateNamespaceClosers(printer);
+}
+
+void FileGenerator::GenerateClasses(io::Printer* printer, int begin, int end) {
+  for (int i = begin; i < end; i++) {
+    if (i == begin && HasGeneratedMethods(file_)) {
+      printer->Print(
+          "\n"
+          "namespace {\n"
+          "\n"
+          "static void MergeFromFail(int line) GOOGLE_ATTRIBUTE_COLD;\n"
+          "static void MergeFromFail(int line) {\n"
+          "  GOOGLE_CHECK(false) << __FILE__ << \":\" << line;\n"
+          "}\n"
+          "\n"
+          "}  // namespace\n"
+          "\n");
+    }
+    printer->Print("\n");
+    printer->Print(kThickSeparator);
+    printer->Print("\n");
+    message_generators_[i]->GenerateClassMethods(printer);
+  }
+}
+
+void FileGenerator::GetPartRange(int part, int* begin, int* end) {
+  // Top-level messages are split into contiguous runs, in declaration order,
+  // weighted by the number of fields they contain (including those of
+  // nested types), so that the parts take about as long to compile.  The
+  // result only depends on the .proto file, so the file names and contents
+  // are stable from one run to the next.
+  vector<int> weights(file_->message_type_count());
+  int total = 0;
+  for (int i = 0; i < file_->message_type_count(); i++) {
+    weights[i] = 1 + CountFields(file_->message_type(i));
+    total += weights[i];
+  }
+
+  *begin = file_->message_type_count();
+  *end = 0;
+  int64 offset = 0;
+  for (int i = 0; i < file_->message_type_count(); i++) {
+    // Part (1-based) that the message's first field falls into.
+    int message_part = 1 + offset * options_.split_into / total;
+    if (message_part == part) {
+      *begin = min(*begin, i);
+      *end = i + 1;
+    }
+    offset += weights[i];
+  }
+  if (*begin > *end) *begin = *end;
+}
+
 void FileGenerator::GenerateBuildDescriptors(io::Printer* printer) {
   // AddDescriptors() is a file-level procedure which adds the encoded
   // FileDescriptorProto for this .proto file to the global DescriptorPool for
@@ -539,6 +635,16 @@ void FileGenerator::GenerateBuildDescriptors(io::Printer* printer) {
       "}\n"
       "\n"
       "}  // namespace\n");
+
+    // Lets the other parts of a split file use protobuf_AssignDescriptorsOnce.
+    if (options_.split_into > 0) {
+      printer->Print(
+        "\n"
+        "void $assigndescriptorsname$_once() {\n"
+        "  protobuf_AssignDescriptorsOnce();\n"
+        "}\n",
+        "assigndescriptorsname", GlobalAssignDescriptorsName(file_->name()));
+    }
   }
 
   // -----------------------------------------------------------------
@@ -560,9 +666,14 @@ void FileGenerator::GenerateBuildDescriptors(io::Printer* printer) {
 
   // -----------------------------------------------------------------
 
+  if (LazyInitialization(file_, options_)) {
+    GenerateLazyAddDescriptors(printer);
+    return;
+  }
+
   // Now generate the AddDescriptors() function.
   PrintHandlingOptionalStaticInitializers(
-    file_, printer,
+    file_, options_, printer,
     // With static initializers.
     // Note that we don't need any special synchronization in the following code
     // because it is called at static init time before any threads exist.
@@ -595,34 +706,7 @@ void FileGenerator::GenerateBuildDescriptors(io::Printer* printer) {
   }
 
   if (HasDescriptorMethods(file_)) {
-    // Embed the descriptor.  We simply serialize the entire FileDescriptorProto
-    // and embed it as a string literal, which is parsed and built into real
-    // descriptors at initialization time.
-    FileDescriptorProto file_proto;
-    file_->CopyTo(&file_proto);
-    string file_data;
-    file_proto.SerializeToString(&file_data);
-
-    printer->Print(
-      "::google::protobuf::DescriptorPool::InternalAddGeneratedFile(");
-
-    // Only write 40 bytes per line.
-    static const int kBytesPerLine = 40;
-    for (int i = 0; i < file_data.size(); i += kBytesPerLine) {
-      printer->Print("\n  \"$data$\"",
-                     "data",
-                     EscapeTrigraphs(
-                         CEscape(file_data.substr(i, kBytesPerLine))));
-    }
-    printer->Print(
-        ", $size$);\n",
-      "size", SimpleItoa(file_data.size()));
-
-    // Call MessageFactory::InternalRegisterGeneratedFile().
-    printer->Print(
-      "::google::protobuf::MessageFactory::InternalRegisterGeneratedFile(\n"
-      "  \"$filename$\", &protobuf_RegisterTypes);\n",
-      "filename", file_->name());
+    GenerateEmbeddedDescriptor(printer, "InternalAddGeneratedFile");
   }
 
   // Allocate and initialize default instances.  This can't be done lazily
@@ -648,7 +732,7 @@ void FileGenerator::GenerateBuildDescriptors(io::Printer* printer) {
     "\n");
 
   PrintHandlingOptionalStaticInitializers(
-    file_, printer,
+    file_, options_, printer,
     // With static initializers.
     "// Force AddDescriptors() to be called at static initialization time.\n"
     "struct StaticDescriptorInitializer_$filename$ {\n"
@@ -667,6 +751,116 @@ void FileGenerator::GenerateBuildDescriptors(io::Printer* printer) {
     "filename", FilenameIdentifier(file_->name()));
 }
 
+void FileGenerator::GenerateLazyAddDescriptors(io::Printer* printer) {
+  // AddDescriptors_register() is all that runs at static initialization
+  // time.  It hands the encoded descriptor to the generated pool, which only
+  // parses and indexes it once the pool is first searched, and registers the
+  // file with the generated MessageFactory.  Constructors of the file's
+  // messages depend on the static default values of fields, so those are
+  // allocated here as well.
+  printer->Print(
+    "void $adddescriptorsname$_register() {\n"
+    "  static bool already_here = false;\n"
+    "  if (already_here) return;\n"
+    "  already_here = true;\n"
+    "  GOOGLE_PROTOBUF_VERIFY_VERSION;\n"
+    "\n",
+    "adddescriptorsname", GlobalAddDescriptorsName(file_->name()));
+  printer->Indent();
+
+  if (HasDescriptorMethods(file_)) {
+    GenerateEmbeddedDescriptor(printer, "InternalAddGeneratedFileDeferred");
+  }
+  for (int i = 0; i < file_->message_type_count(); i++) {
+    message_generators_[i]->GenerateFieldDefaultsAllocator(printer);
+  }
+  printer->Print(
+    "::google::protobuf::internal::OnShutdown(&$shutdownfilename$);\n",
+    "shutdownfilename", GlobalShutdownFileName(file_->name()));
+
+  printer->Outdent();
+  printer->Print(
+    "}\n"
+    "\n");
+
+  // AddDescriptors() builds the default instances the first time it is
+  // called, typically from default_instance() or AssignDescriptors().  Since
+  // lazy files define no extensions, nothing else needs to happen before
+  // then.
+  printer->Print(
+    "void $adddescriptorsname$_impl() {\n"
+    "  $adddescriptorsname$_register();\n"
+    "\n",
+    "adddescriptorsname", GlobalAddDescriptorsName(file_->name()));
+  printer->Indent();
+
+  for (int i = 0; i < file_->dependency_count(); i++) {
+    const FileDescriptor* dependency = file_->dependency(i);
+    printer->Print(
+      "$name$();\n",
+      "name", QualifiedFileLevelSymbol(
+          dependency->package(), GlobalAddDescriptorsName(dependency->name())));
+  }
+  for (int i = 0; i < file_->message_type_count(); i++) {
+    message_generators_[i]->GenerateDefaultInstanceAllocator(printer);
+  }
+  for (int i = 0; i < file_->message_type_count(); i++) {
+    message_generators_[i]->GenerateDefaultInstanceInitializer(printer);
+  }
+
+  printer->Outdent();
+  printer->Print(
+    "}\n"
+    "\n"
+    "GOOGLE_PROTOBUF_DECLARE_ONCE($adddescriptorsname$_once_);\n"
+    "void $adddescriptorsname$() {\n"
+    "  ::google::protobuf::GoogleOnceInit(&$adddescriptorsname$_once_,\n"
+    "                 &$adddescriptorsname$_impl);\n"
+    "}\n"
+    "\n"
+    "// Register the file at static initialization time.\n"
+    "struct StaticDescriptorInitializer_$filename$ {\n"
+    "  StaticDescriptorInitializer_$filename$() {\n"
+    "    $adddescriptorsname$_register();\n"
+    "  }\n"
+    "} static_descriptor_initializer_$filename$_;\n",
+    "adddescriptorsname", GlobalAddDescriptorsName(file_->name()),
+    "filename", FilenameIdentifier(file_->name()));
+}
+
+void FileGenerator::GenerateEmbeddedDescriptor(io::Printer* printer,
+                                               const string& add_function) {
+  // Embed the descriptor.  We simply serialize the entire FileDescriptorProto
+  // and embed it as a string literal, which is parsed and built into real
+  // descriptors at initialization time.
+  FileDescriptorProto file_proto;
+  file_->CopyTo(&file_proto);
+  string file_data;
+  file_proto.SerializeToString(&file_data);
+
+  printer->Print(
+    "::google::protobuf::DescriptorPool::$function$(",
+    "function", add_function);
+
+  // Only write 40 bytes per line.
+  static const int kBytesPerLine = 40;
+  for (int i = 0; i < file_data.size(); i += kBytesPerLine) {
+    printer->Print("\n  \"$data$\"",
+                   "data",
+                   EscapeTrigraphs(
+                       CEscape(file_data.substr(i, kBytesPerLine))));
+  }
+  printer->Print(
+      ", $size$);\n",
+    "size", SimpleItoa(file_data.size()));
+
+  // Call MessageFactory::InternalRegisterGeneratedFile().
+  printer->Print(
+    "::google::protobuf::MessageFactory::InternalRegisterGeneratedFile(\n"
+    "  \"$filename$\", &protobuf_RegisterTypes);\n",
+    "filename", file_->name());
+}
+
 void FileGenerator::GenerateNamespaceOpeners(io::Printer* printer) {
   if (package_parts_.size() > 0) printer->Print("\n");
 
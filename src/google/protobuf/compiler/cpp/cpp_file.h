@@ -72,11 +72,37 @@ class FileGenerator {
   void GenerateHeader(io::Printer* printer);
   void GenerateSource(io::Printer* printer);
 
+  // With the split_into option, generates part number 'part' (1-based) of the
+  // message implementations.  The descriptors, registration code, enums,
+  // services and extensions stay in the file written by GenerateSource().
+  void GenerateSourcePart(io::Printer* printer, int part);
+
  private:
+  // Generate the top of a .pb.cc file, up to and including the includes.
+  void GenerateSourceIncludes(io::Printer* printer);
+
+  // Generate the implementations of top-level messages [begin, end).
+  void GenerateClasses(io::Printer* printer, int begin, int end);
+
+  // Returns the range of top-level messages [*begin, *end) which goes into
+  // the given part with split_into.
+  void GetPartRange(int part, int* begin, int* end);
+
   // Generate the BuildDescriptors() procedure, which builds all descriptors
   // for types defined in the file.
   void GenerateBuildDescriptors(io::Printer* printer);
 
+  // Generate the AddDescriptors() procedure and its static initializer for
+  // files compiled with lazy_init.  Only the descriptor registration runs at
+  // static init time; default instances are built on first use.
+  void GenerateLazyAddDescriptors(io::Printer* printer);
+
+  // Generate a call to the given DescriptorPool method which adds the
+  // encoded FileDescriptorProto to the generated pool, followed by the
+  // MessageFactory registration.
+  void GenerateEmbeddedDescriptor(io::Printer* printer,
+                                  const string& add_function);
+
   void GenerateNamespaceOpeners(io::Printer* printer);
   void GenerateNamespaceClosers(io::Printer* printer);
 
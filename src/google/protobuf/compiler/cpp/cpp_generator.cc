@@ -46,6 +46,7 @@
 #include <google/protobuf/io/printer.h>
 #include <google/protobuf/io/zero_copy_stream.h>
 #include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/stubs/strutil.h>
 
 namespace google {
 namespace protobuf {
@@ -89,6 +90,25 @@ bool CppGenerator::Generate(const FileDescriptor* file,
       file_options.dllexport_decl = options[i].second;
     } else if (options[i].first == "safe_boundary_check") {
       file_options.safe_boundary_check = true;
+    } else if (options[i].first == "single_pass_serialization") {
+      file_options.single_pass_serialization = true;
+    } else if (options[i].first == "lazy_init") {
+      file_options.lazy_init = true;
+    } else if (options[i].first == "split_into") {
+      int32 split_into;
+      if (!safe_strto32(options[i].second, &split_into) || split_into < 1) {
+        *error = "Invalid value for split_into: " + options[i].second;
+        return false;
+      }
+      file_options.split_into = split_into;
+    } else if (options[i].first == "inline_repeated") {
+      int32 inline_repeated;
+      if (!safe_strto32(options[i].second, &inline_repeated) ||
+          inline_repeated < 1) {
+        *error = "Invalid value for inline_repeated: " + options[i].second;
+        return false;
+      }
+      file_options.inline_repeated = inline_repeated;
     } else {
       *error = "Unknown generator option: " + options[i].first;
       return false;
@@ -119,6 +139,15 @@ bool CppGenerator::Generate(const FileDescriptor* file,
     file_generator.GenerateSource(&printer);
   }
 
+  // With split_into=N, the message implementations go into foo.pb.1.cc
+  // through foo.pb.N.cc instead, so that they can be compiled in parallel.
+  for (int i = 1; i <= file_options.split_into; i++) {
+    google::protobuf::scoped_ptr<io::ZeroCopyOutputStream> output(
+        generator_context->Open(basename + "." + SimpleItoa(i) + ".cc"));
+    io::Printer printer(output.get(), '$');
+    file_generator.GenerateSourcePart(&printer, i);
+  }
+
   return true;
 }
 
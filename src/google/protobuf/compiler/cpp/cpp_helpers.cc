@@ -420,8 +420,20 @@ bool StaticInitializersForced(const FileDescriptor* file) {
   return false;
 }
 
+bool LazyInitialization(const FileDescriptor* file, const Options& options) {
+  if (!options.lazy_init || file->extension_count() > 0) {
+    return false;
+  }
+  for (int i = 0; i < file->message_type_count(); ++i) {
+    if (HasExtension(file->message_type(i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void PrintHandlingOptionalStaticInitializers(
-    const FileDescriptor* file, io::Printer* printer,
+    const FileDescriptor* file, const Options& options, io::Printer* printer,
     const char* with_static_init, const char* without_static_init,
     const char* var1, const string& val1,
     const char* var2, const string& val2) {
@@ -433,14 +445,16 @@ void PrintHandlingOptionalStaticInitializers(
     vars[var2] = val2;
   }
   PrintHandlingOptionalStaticInitializers(
-      vars, file, printer, with_static_init, without_static_init);
+      vars, file, options, printer, with_static_init, without_static_init);
 }
 
 void PrintHandlingOptionalStaticInitializers(
     const map<string, string>& vars, const FileDescriptor* file,
-    io::Printer* printer, const char* with_static_init,
-    const char* without_static_init) {
-  if (StaticInitializersForced(file)) {
+    const Options& options, io::Printer* printer,
+    const char* with_static_init, const char* without_static_init) {
+  if (LazyInitialization(file, options)) {
+    printer->Print(vars, without_static_init);
+  } else if (StaticInitializersForced(file)) {
     printer->Print(vars, with_static_init);
   } else {
     printer->Print(vars, (string(
@@ -37,6 +37,7 @@
 
 #include <map>
 #include <string>
+#include <google/protobuf/compiler/cpp/cpp_options.h>
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/descriptor.pb.h>
 
@@ -189,19 +190,26 @@ inline bool HasFastArraySerialization(const FileDescriptor* file) {
 // Returns whether we have to generate code with static initializers.
 bool StaticInitializersForced(const FileDescriptor* file);
 
-// Prints 'with_static_init' if static initializers have to be used for the
-// provided file. Otherwise emits both 'with_static_init' and
-// 'without_static_init' using #ifdef.
+// Returns whether default instances of the file's messages are built on
+// first use (the lazy_init generator option).  Files that define extensions
+// are always initialized at static init time, because the extensions have to
+// be registered before anything can parse them.
+bool LazyInitialization(const FileDescriptor* file, const Options& options);
+
+// Prints 'without_static_init' if the file is initialized lazily, and
+// 'with_static_init' if static initializers have to be used for the provided
+// file. Otherwise emits both 'with_static_init' and 'without_static_init'
+// using #ifdef.
 void PrintHandlingOptionalStaticInitializers(
-    const FileDescriptor* file, io::Printer* printer,
+    const FileDescriptor* file, const Options& options, io::Printer* printer,
     const char* with_static_init, const char* without_static_init,
     const char* var1 = NULL, const string& val1 = "",
     const char* var2 = NULL, const string& val2 = "");
 
 void PrintHandlingOptionalStaticInitializers(
     const map<string, string>& vars, const FileDescriptor* file,
-    io::Printer* printer, const char* with_static_init,
-    const char* without_static_init);
+    const Options& options, io::Printer* printer,
+    const char* with_static_init, const char* without_static_init);
 
 
 inline bool IsMapEntryMessage(const Descriptor* descriptor) {
@@ -0,0 +1,205 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Tests for the "inline_repeated" option, which stores the first few elements
+// of repeated fields (or, for strings and messages, their pointers) inside the
+// message object.
+
+#include <string>
+
+#include <google/protobuf/arena.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/unittest_inline_repeated.pb.h>
+
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace compiler {
+namespace cpp {
+
+namespace {
+
+using protobuf_unittest::TestInlineRepeated;
+
+void SetFields(TestInlineRepeated* message, int count) {
+  for (int i = 0; i < count; i++) {
+    message->add_repeated_int32(i);
+    message->add_repeated_double(i + 0.5);
+    message->add_repeated_bool(i % 2 == 0);
+    message->add_repeated_nested_enum(
+        i % 2 == 0 ? TestInlineRepeated::FOO : TestInlineRepeated::BAR);
+    message->add_packed_int64(-i);
+  }
+}
+
+void ExpectFields(const TestInlineRepeated& message, int count) {
+  ASSERT_EQ(count, message.repeated_int32_size());
+  ASSERT_EQ(count, message.repeated_double_size());
+  ASSERT_EQ(count, message.repeated_bool_size());
+  ASSERT_EQ(count, message.repeated_nested_enum_size());
+  ASSERT_EQ(count, message.packed_int64_size());
+  for (int i = 0; i < count; i++) {
+    EXPECT_EQ(i, message.repeated_int32(i));
+    EXPECT_EQ(i + 0.5, message.repeated_double(i));
+    EXPECT_EQ(i % 2 == 0, message.repeated_bool(i));
+    EXPECT_EQ(i % 2 == 0 ? TestInlineRepeated::FOO : TestInlineRepeated::BAR,
+              message.repeated_nested_enum(i));
+    EXPECT_EQ(-i, message.packed_int64(i));
+  }
+}
+
+TEST(InlineRepeatedTest, SmallFieldsNeedNoAllocation) {
+  TestInlineRepeated message;
+  EXPECT_EQ(2, message.repeated_int32().Capacity());
+  SetFields(&message, 2);
+  ExpectFields(message, 2);
+  // The elements live inside the message, so nothing is counted beyond it.
+  EXPECT_EQ(sizeof(message), message.SpaceUsedLong());
+  EXPECT_EQ(message.SpaceUsed(), message.SpaceUsedLong());
+}
+
+TEST(InlineRepeatedTest, GrowsOutOfLine) {
+  TestInlineRepeated message;
+  SetFields(&message, 10);
+  ExpectFields(message, 10);
+  EXPECT_LT(sizeof(message), message.SpaceUsedLong());
+  EXPECT_EQ(message.SpaceUsed(), message.SpaceUsedLong());
+}
+
+TEST(InlineRepeatedTest, SerializeAndParse) {
+  for (int count = 0; count < 5; count++) {
+    TestInlineRepeated message;
+    SetFields(&message, count);
+    message.mutable_child()->add_repeated_int32(42);
+
+    TestInlineRepeated parsed;
+    ASSERT_TRUE(parsed.ParseFromString(message.SerializeAsString()));
+    ExpectFields(parsed, count);
+    ASSERT_EQ(1, parsed.child().repeated_int32_size());
+    EXPECT_EQ(42, parsed.child().repeated_int32(0));
+  }
+}
+
+TEST(InlineRepeatedTest, CopyAndSwap) {
+  TestInlineRepeated small;
+  SetFields(&small, 1);
+  TestInlineRepeated large;
+  SetFields(&large, 6);
+
+  TestInlineRepeated copy(small);
+  ExpectFields(copy, 1);
+  copy = large;
+  ExpectFields(copy, 6);
+
+  // Inline elements cannot change hands, so these swap element by element.
+  small.Swap(&large);
+  ExpectFields(small, 6);
+  ExpectFields(large, 1);
+  large.mutable_repeated_int32()->Swap(small.mutable_repeated_int32());
+  EXPECT_EQ(6, large.repeated_int32_size());
+  EXPECT_EQ(1, small.repeated_int32_size());
+}
+
+TEST(InlineRepeatedTest, OnArena) {
+  Arena arena;
+  TestInlineRepeated* message =
+      Arena::CreateMessage<TestInlineRepeated>(&arena);
+  EXPECT_EQ(&arena, message->repeated_int32().GetArena());
+  SetFields(message, 2);
+  ExpectFields(*message, 2);
+  SetFields(message, 3);
+  EXPECT_EQ(&arena, message->repeated_int32().GetArena());
+  EXPECT_EQ(5, message->repeated_int32_size());
+
+  TestInlineRepeated heap_message;
+  heap_message.Swap(message);
+  EXPECT_EQ(5, heap_message.repeated_int32_size());
+  EXPECT_EQ(0, message->repeated_int32_size());
+}
+
+TEST(InlineRepeatedTest, StringsAndMessages) {
+  TestInlineRepeated message;
+  EXPECT_EQ(2, message.repeated_string().Capacity());
+  EXPECT_EQ(2, message.repeated_child().Capacity());
+  message.add_repeated_string("foo");
+  message.add_repeated_string("bar");
+  message.add_repeated_child()->add_repeated_int32(1);
+  message.add_repeated_child()->add_repeated_string("baz");
+  // Only the elements themselves are counted; their pointers are inline.
+  EXPECT_EQ(sizeof(message) + 2 * sizeof(string) +
+                message.repeated_child(0).SpaceUsedLong() +
+                message.repeated_child(1).SpaceUsedLong(),
+            message.SpaceUsedLong());
+
+  TestInlineRepeated parsed;
+  ASSERT_TRUE(parsed.ParseFromString(message.SerializeAsString()));
+  ASSERT_EQ(2, parsed.repeated_string_size());
+  EXPECT_EQ("bar", parsed.repeated_string(1));
+  ASSERT_EQ(2, parsed.repeated_child_size());
+  EXPECT_EQ(1, parsed.repeated_child(0).repeated_int32(0));
+  EXPECT_EQ("baz", parsed.repeated_child(1).repeated_string(0));
+
+  TestInlineRepeated large;
+  for (int i = 0; i < 5; i++) {
+    large.add_repeated_string("x");
+    large.add_repeated_child();
+  }
+  parsed.Swap(&large);
+  EXPECT_EQ(5, parsed.repeated_string_size());
+  EXPECT_EQ(5, parsed.repeated_child_size());
+  EXPECT_EQ("bar", large.repeated_string(1));
+  EXPECT_EQ("baz", large.repeated_child(1).repeated_string(0));
+}
+
+TEST(InlineRepeatedTest, Reflection) {
+  TestInlineRepeated message;
+  const Reflection* reflection = message.GetReflection();
+  const FieldDescriptor* field =
+      message.GetDescriptor()->FindFieldByName("repeated_int32");
+  reflection->AddInt32(&message, field, 7);
+  reflection->AddInt32(&message, field, 8);
+  reflection->AddInt32(&message, field, 9);
+  ASSERT_EQ(3, message.repeated_int32_size());
+  EXPECT_EQ(9, reflection->GetRepeatedInt32(message, field, 2));
+  reflection->SwapElements(&message, field, 0, 2);
+  EXPECT_EQ(9, message.repeated_int32(0));
+  reflection->RemoveLast(&message, field);
+  EXPECT_EQ(2, message.repeated_int32_size());
+}
+
+}  // namespace
+
+}  // namespace cpp
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
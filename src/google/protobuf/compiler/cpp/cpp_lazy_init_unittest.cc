@@ -0,0 +1,154 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Tests for the code generated with the "lazy_init" option: default instances
+// are built on first use, and descriptors are only parsed once looked up.
+
+#include <string>
+
+#include <google/protobuf/unittest.pb.h>
+#include <google/protobuf/unittest_lazy_init.pb.h>
+#include <google/protobuf/unittest_lazy_init_lite.pb.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace compiler {
+namespace cpp {
+
+namespace {
+
+typedef protobuf_unittest::TestLazyInit TestLazyInit;
+typedef protobuf_unittest::TestLazyInitChild TestLazyInitChild;
+typedef protobuf_unittest::TestLazyInitLite TestLazyInitLite;
+
+// Nothing else in the test binary uses these files, so their default
+// instances must not exist until this test asks for them.
+TEST(LazyInitTest, DefaultInstanceBuiltOnFirstUse) {
+  EXPECT_TRUE(TestLazyInit::internal_default_instance() == NULL);
+  EXPECT_TRUE(TestLazyInitLite::internal_default_instance() == NULL);
+
+  // Constructors only depend on what was set up at static init time.
+  TestLazyInit message;
+  EXPECT_EQ(41, message.optional_int32());
+  EXPECT_EQ("hello", message.optional_string());
+  EXPECT_EQ("world", message.optional_bytes());
+  EXPECT_EQ(TestLazyInit::BAR, message.optional_nested_enum());
+  TestLazyInitLite lite_message;
+  EXPECT_EQ("hello", lite_message.optional_string());
+  EXPECT_TRUE(TestLazyInit::internal_default_instance() == NULL);
+
+  const TestLazyInit& default_instance = TestLazyInit::default_instance();
+  EXPECT_EQ(&default_instance, TestLazyInit::internal_default_instance());
+  EXPECT_EQ("hello", default_instance.optional_string());
+  const TestLazyInitLite& lite_default_instance =
+      TestLazyInitLite::default_instance();
+  EXPECT_EQ(&lite_default_instance,
+            TestLazyInitLite::internal_default_instance());
+}
+
+TEST(LazyInitTest, DefaultInstancesAreCrossLinked) {
+  const TestLazyInit& message = TestLazyInit::default_instance();
+  EXPECT_EQ(&TestLazyInit::NestedMessage::default_instance(),
+            &message.optional_nested_message());
+  EXPECT_EQ("nested", message.optional_nested_message().name());
+  EXPECT_EQ(&protobuf_unittest::ForeignMessage::default_instance(),
+            &message.optional_foreign_message());
+  EXPECT_EQ(&TestLazyInitChild::default_instance(), &message.optional_child());
+  EXPECT_EQ("child", message.optional_child().name());
+  EXPECT_EQ(&message, &message.optional_child().parent());
+  EXPECT_EQ(&TestLazyInit::NestedMessage::default_instance(),
+            &message.oneof_nested_message());
+  EXPECT_EQ("oneof", message.oneof_string());
+  EXPECT_EQ(&TestLazyInitLite::NestedMessage::default_instance(),
+            &TestLazyInitLite::default_instance().optional_nested_message());
+}
+
+TEST(LazyInitTest, DescriptorsFoundInGeneratedPool) {
+  const FileDescriptor* file = DescriptorPool::generated_pool()->FindFileByName(
+      "google/protobuf/unittest_lazy_init.proto");
+  ASSERT_TRUE(file != NULL);
+  EXPECT_EQ(TestLazyInit::descriptor()->file(), file);
+
+  const Descriptor* descriptor =
+      DescriptorPool::generated_pool()->FindMessageTypeByName(
+          "protobuf_unittest.TestLazyInit.NestedMessage");
+  ASSERT_TRUE(descriptor != NULL);
+  EXPECT_EQ(TestLazyInit::NestedMessage::descriptor(), descriptor);
+  EXPECT_EQ(&TestLazyInit::NestedMessage::default_instance(),
+            MessageFactory::generated_factory()->GetPrototype(descriptor));
+}
+
+TEST(LazyInitTest, SerializeAndParse) {
+  TestLazyInit message;
+  message.set_optional_int32(1);
+  message.set_optional_string("foo");
+  message.mutable_optional_nested_message()->set_bb(2);
+  message.mutable_optional_foreign_message()->set_c(3);
+  message.mutable_optional_child()->mutable_parent()->set_optional_int32(4);
+  message.add_repeated_nested_message()->set_name("bar");
+  (*message.mutable_map_string_message())["baz"].set_bb(5);
+  message.mutable_oneof_nested_message()->set_bb(6);
+
+  string data;
+  ASSERT_TRUE(message.SerializeToString(&data));
+  TestLazyInit parsed;
+  ASSERT_TRUE(parsed.ParseFromString(data));
+  EXPECT_EQ(message.DebugString(), parsed.DebugString());
+  EXPECT_EQ(4, parsed.optional_child().parent().optional_int32());
+  EXPECT_EQ(5, parsed.map_string_message().at("baz").bb());
+  EXPECT_EQ(6, parsed.oneof_nested_message().bb());
+
+  // Reflection works the same as for eagerly initialized files.
+  const Reflection* reflection = parsed.GetReflection();
+  const FieldDescriptor* field =
+      TestLazyInit::descriptor()->FindFieldByName("optional_string");
+  EXPECT_EQ("foo", reflection->GetString(parsed, field));
+  reflection->ClearField(&parsed, field);
+  EXPECT_EQ("hello", reflection->GetString(parsed, field));
+
+  TestLazyInitLite lite_message;
+  lite_message.mutable_optional_nested_message()->set_bb(7);
+  TestLazyInitLite lite_parsed;
+  ASSERT_TRUE(lite_parsed.ParseFromString(lite_message.SerializeAsString()));
+  EXPECT_EQ(7, lite_parsed.optional_nested_message().bb());
+  EXPECT_EQ(41, lite_parsed.optional_int32());
+}
+
+}  // namespace
+
+}  // namespace cpp
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
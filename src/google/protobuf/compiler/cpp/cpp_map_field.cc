@@ -165,33 +165,16 @@ void MapFieldGenerator::
 GenerateMergeFromCodedStream(io::Printer* printer) const {
   const FieldDescriptor* value_field =
       descriptor_->message_type()->FindFieldByName("value");
-  printer->Print(variables_,
-      "::google::protobuf::scoped_ptr<$map_classname$> entry($name$_.NewEntry());\n");
-
   if (IsProto3Field(descriptor_) ||
       value_field->type() != FieldDescriptor::TYPE_ENUM) {
     printer->Print(variables_,
-        "DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(\n"
-        "    input, entry.get()));\n");
-    switch (value_field->cpp_type()) {
-      case FieldDescriptor::CPPTYPE_MESSAGE:
-        printer->Print(variables_,
-            "(*mutable_$name$())[entry->key()].Swap("
-            "entry->mutable_value());\n");
-        break;
-      case FieldDescriptor::CPPTYPE_ENUM:
-        printer->Print(variables_,
-            "(*mutable_$name$())[entry->key()] =\n"
-            "    static_cast<$val_cpp$>(*entry->mutable_value());\n");
-        break;
-      default:
-        printer->Print(variables_,
-            "(*mutable_$name$())[entry->key()] = *entry->mutable_value();\n");
-        break;
-    }
+        "DO_($name$_.MergeEntryFromCodedStream(input));\n");
   } else {
+    // Entries with unknown enum values are kept as unknown fields, which
+    // needs the raw bytes of the entry, so these still go through MapEntry.
     printer->Print(variables_,
         "{\n"
+        "  ::google::protobuf::scoped_ptr<$map_classname$> entry($name$_.NewEntry());\n"
         "  ::std::string data;\n"
         "  DO_(::google::protobuf::internal::WireFormatLite::ReadString(input, &data));\n"
         "  DO_(entry->ParseFromString(data));\n"
@@ -208,13 +191,13 @@ GenerateMergeFromCodedStream(io::Printer* printer) const {
 void MapFieldGenerator::
 GenerateSerializeWithCachedSizes(io::Printer* printer) const {
   printer->Print(variables_,
-      "{\n"
-      "  ::google::protobuf::scoped_ptr<$map_classname$> entry;\n"
+      "if (output->IsSerializationDeterministic() &&\n"
+      "    this->$name$().size() > 1) {\n"
+      "  $name$_.SerializeSortedEntries($number$, this->$name$(), output);\n"
+      "} else {\n"
       "  for (::google::protobuf::Map< $key_cpp$, $val_cpp$ >::const_iterator\n"
       "      it = $name$().begin(); it != $name$().end(); ++it) {\n"
-      "    entry.reset($name$_.New$wrapper$(it->first, it->second));\n"
-      "    ::google::protobuf::internal::WireFormatLite::Write$stream_writer$(\n"
-      "        $number$, *entry, output);\n"
+      "    $name$_.SerializeEntry($number$, it->first, it->second, output);\n"
       "  }\n"
       "}\n");
 }
@@ -222,15 +205,10 @@ GenerateSerializeWithCachedSizes(io::Printer* printer) const {
 void MapFieldGenerator::
 GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const {
   printer->Print(variables_,
-      "{\n"
-      "  ::google::protobuf::scoped_ptr<$map_classname$> entry;\n"
-      "  for (::google::protobuf::Map< $key_cpp$, $val_cpp$ >::const_iterator\n"
-      "      it = $name$().begin(); it != $name$().end(); ++it) {\n"
-      "    entry.reset($name$_.New$wrapper$(it->first, it->second));\n"
-      "    target = ::google::protobuf::internal::WireFormatLite::\n"
-      "        Write$declared_type$NoVirtualToArray(\n"
-      "            $number$, *entry, target);\n"
-      "  }\n"
+      "for (::google::protobuf::Map< $key_cpp$, $val_cpp$ >::const_iterator\n"
+      "    it = $name$().begin(); it != $name$().end(); ++it) {\n"
+      "  target = $name$_.SerializeEntryToArray(\n"
+      "      $number$, it->first, it->second, target);\n"
       "}\n");
 }
 
@@ -238,14 +216,62 @@ void MapFieldGenerator::
 GenerateByteSize(io::Printer* printer) const {
   printer->Print(variables_,
       "total_size += $tag_size$ * this->$name$_size();\n"
-      "{\n"
-      "  ::google::protobuf::scoped_ptr<$map_classname$> entry;\n"
-      "  for (::google::protobuf::Map< $key_cpp$, $val_cpp$ >::const_iterator\n"
-      "      it = $name$().begin(); it != $name$().end(); ++it) {\n"
-      "    entry.reset($name$_.New$wrapper$(it->first, it->second));\n"
-      "    total_size += ::google::protobuf::internal::WireFormatLite::\n"
-      "        $declared_type$SizeNoVirtual(*entry);\n"
-      "  }\n"
+      "for (::google::protobuf::Map< $key_cpp$, $val_cpp$ >::const_iterator\n"
+      "    it = $name$().begin(); it != $name$().end(); ++it) {\n"
+      "  total_size += ::google::protobuf::internal::WireFormatLite::LengthDelimitedSize(\n"
+      "      $name$_.EntryByteSize(it->first, it->second));\n"
+      "}\n");
+}
+
+void MapFieldGenerator::
+GenerateSpaceUsed(io::Printer* printer) const {
+  printer->Print(variables_,
+    "total_size += $name$_.SpaceUsedExcludingSelf();\n");
+}
+
+void MapFieldGenerator::
+GenerateStructuralHash(io::Printer* printer) const {
+  const FieldDescriptor* value_field =
+      descriptor_->message_type()->FindFieldByName("value");
+  map<string, string> vars(variables_);
+  if (value_field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
+    vars["hash_function"] = "HashMapMessages";
+  } else {
+    vars["hash_function"] = "HashMapValues";
+  }
+  printer->Print(vars,
+    "if (this->$name$().size() > 0) {\n"
+    "  hash += ::google::protobuf::internal::HashCombine(\n"
+    "      $number$,\n"
+    "      ::google::protobuf::internal::$hash_function$(this->$name$()));\n"
+    "}\n");
+}
+
+void MapFieldGenerator::
+GenerateStructuralEquals(io::Printer* printer) const {
+  const FieldDescriptor* value_field =
+      descriptor_->message_type()->FindFieldByName("value");
+  map<string, string> vars(variables_);
+  if (value_field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
+    vars["equals_function"] = "MapMessagesEqual";
+  } else {
+    vars["equals_function"] = "MapValuesEqual";
+  }
+  printer->Print(vars,
+    "if (!::google::protobuf::internal::$equals_function$(\n"
+    "        this->$name$(), other.$name$())) {\n"
+    "  return false;\n"
+    "}\n");
+}
+
+void MapFieldGenerator::
+GenerateSerializeReverse(io::Printer* printer) const {
+  // Entries come out in reverse iteration order, which is just as arbitrary.
+  printer->Print(variables_,
+      "for (::google::protobuf::Map< $key_cpp$, $val_cpp$ >::const_iterator\n"
+      "    it = $name$().begin(); it != $name$().end(); ++it) {\n"
+      "  $name$_.SerializeEntryReverse(\n"
+      "      $number$, it->first, it->second, output);\n"
       "}\n");
 }
 
@@ -59,6 +59,10 @@ class MapFieldGenerator : public FieldGenerator {
   void GenerateSerializeWithCachedSizes(io::Printer* printer) const;
   void GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const;
   void GenerateByteSize(io::Printer* printer) const;
+  void GenerateSpaceUsed(io::Printer* printer) const;
+  void GenerateStructuralHash(io::Printer* printer) const;
+  void GenerateStructuralEquals(io::Printer* printer) const;
+  void GenerateSerializeReverse(io::Printer* printer) const;
 
  private:
   const FieldDescriptor* descriptor_;
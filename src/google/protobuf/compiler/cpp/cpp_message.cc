@@ -100,6 +100,36 @@ struct ExtensionRangeSorter {
   }
 };
 
+// Returns the largest number of bytes a singular, non-oneof field can take
+// on the wire, including its tag, or -1 if the size is unbounded.
+int MaxSerializedFieldSize(const FieldDescriptor* field) {
+  if (field->is_repeated() || field->containing_oneof() != NULL) return -1;
+  int tag_size = WireFormat::TagSize(field->number(), field->type());
+  switch (field->type()) {
+    case FieldDescriptor::TYPE_BOOL:
+      return tag_size + 1;
+    case FieldDescriptor::TYPE_FIXED32:
+    case FieldDescriptor::TYPE_SFIXED32:
+    case FieldDescriptor::TYPE_FLOAT:
+      return tag_size + 4;
+    case FieldDescriptor::TYPE_FIXED64:
+    case FieldDescriptor::TYPE_SFIXED64:
+    case FieldDescriptor::TYPE_DOUBLE:
+      return tag_size + 8;
+    case FieldDescriptor::TYPE_UINT32:
+    case FieldDescriptor::TYPE_SINT32:
+      return tag_size + 5;
+    case FieldDescriptor::TYPE_INT32:    // Negative values are sign-extended.
+    case FieldDescriptor::TYPE_INT64:
+    case FieldDescriptor::TYPE_UINT64:
+    case FieldDescriptor::TYPE_SINT64:
+    case FieldDescriptor::TYPE_ENUM:
+      return tag_size + 10;
+    default:
+      return -1;
+  }
+}
+
 // Returns true if the "required" restriction check should be ignored for the
 // given field.
 inline static bool ShouldIgnoreRequiredFieldCheck(
@@ -689,6 +719,34 @@ GenerateClassDefinition(io::Printer* printer) {
     "}\n"
     "\n");
 
+  // Moves steal the other message's fields with InternalSwap() when both
+  // messages live on the same arena (or both on the heap), and fall back to a
+  // deep copy otherwise.
+  printer->Print(vars,
+    "#if LANG_CXX11\n"
+    "$classname$($classname$&& from) noexcept\n"
+    "  : $classname$() {\n"
+    "  *this = ::std::move(from);\n"
+    "}\n"
+    "\n"
+    "inline $classname$& operator=($classname$&& from) noexcept {\n");
+  if (SupportsArenas(descriptor_)) {
+    printer->Print(
+      "  if (GetArenaNoVirtual() == from.GetArenaNoVirtual()) {\n"
+      "    if (this != &from) InternalSwap(&from);\n"
+      "  } else {\n"
+      "    CopyFrom(from);\n"
+      "  }\n");
+  } else {
+    printer->Print(
+      "  if (this != &from) InternalSwap(&from);\n");
+  }
+  printer->Print(
+    "  return *this;\n"
+    "}\n"
+    "#endif\n"
+    "\n");
+
   if (PreserveUnknownFields(descriptor_)) {
     if (UseUnknownFieldSet(descriptor_->file())) {
       printer->Print(
@@ -764,18 +822,21 @@ GenerateClassDefinition(io::Printer* printer) {
         "\n");
   }
 
-  if (!StaticInitializersForced(descriptor_->file())) {
-    printer->Print(vars,
-      "#ifdef GOOGLE_PROTOBUF_NO_STATIC_INITIALIZER\n"
+  // With lazy_init the accessor is always needed, since InitAsDefaultInstance()
+  // must not go through default_instance() of types in the same file.
+  const bool lazy = LazyInitialization(descriptor_->file(), options_);
+  if (lazy || !StaticInitializersForced(descriptor_->file())) {
+    printer->Print(vars, StrCat(
+      lazy ? "" : "#ifdef GOOGLE_PROTOBUF_NO_STATIC_INITIALIZER\n",
       "// Returns the internal default instance pointer. This function can\n"
       "// return NULL thus should not be used by the user. This is intended\n"
       "// for Protobuf internal code. Please use default_instance() declared\n"
       "// above instead.\n"
       "static inline const $classname$* internal_default_instance() {\n"
       "  return default_instance_;\n"
-      "}\n"
-      "#endif\n"
-      "\n");
+      "}\n",
+      lazy ? "" : "#endif\n",
+      "\n").c_str());
   }
 
 
@@ -809,10 +870,18 @@ GenerateClassDefinition(io::Printer* printer) {
       "bool IsInitialized() const;\n"
       "\n"
       "int ByteSize() const;\n"
+      "size_t ByteSizeLong() const;\n"
+      "size_t SpaceUsedLong() const;\n"
       "bool MergePartialFromCodedStream(\n"
       "    ::google::protobuf::io::CodedInputStream* input);\n"
       "void SerializeWithCachedSizes(\n"
       "    ::google::protobuf::io::CodedOutputStream* output) const;\n");
+    if (HasDescriptorMethods(descriptor_->file())) {
+      printer->Print(vars,
+        "::google::protobuf::uint64 StructuralHash() const;\n"
+        "bool StructurallyEquals(const ::google::protobuf::Message& other) const;\n"
+        "bool StructurallyEquals(const $classname$& other) const;\n");
+    }
     // DiscardUnknownFields() is implemented in message.cc using reflections. We
     // need to implement this function in generated code for messages.
     if (!UseUnknownFieldSet(descriptor_->file())) {
@@ -823,6 +892,11 @@ GenerateClassDefinition(io::Printer* printer) {
       printer->Print(
         "::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;\n");
     }
+    if (HasSinglePassSerialization()) {
+      printer->Print(
+        "void InternalSerializeReverse(\n"
+        "    ::google::protobuf::io::ReverseCodedBuffer* output) const;\n");
+    }
   }
 
   // Check all FieldDescriptors including those in oneofs to estimate
@@ -985,8 +1059,8 @@ GenerateClassDefinition(io::Printer* printer) {
       !descriptor_->options().message_set_wire_format() &&
       num_required_fields_ > 1) {
     printer->Print(
-        "// helper for ByteSize()\n"
-        "int RequiredFieldsByteSizeFallback() const;\n\n");
+        "// helper for ByteSizeLong()\n"
+        "size_t RequiredFieldsByteSizeFallback() const;\n\n");
   }
 
   // Prepare decls for _cached_size_ and _has_bits_.  Their position in the
@@ -1144,7 +1218,7 @@ GenerateClassDefinition(io::Printer* printer) {
   // friends so that they can access private static variables like
   // default_instance_ and reflection_.
   PrintHandlingOptionalStaticInitializers(
-    descriptor_->file(), printer,
+    descriptor_->file(), options_, printer,
     // With static initializers.
     "friend void $dllexport_decl$ $adddescriptorsname$();\n",
     // Without.
@@ -1153,6 +1227,12 @@ GenerateClassDefinition(io::Printer* printer) {
     "dllexport_decl", options_.dllexport_decl,
     "adddescriptorsname",
     GlobalAddDescriptorsName(descriptor_->file()->name()));
+  if (LazyInitialization(descriptor_->file(), options_)) {
+    printer->Print(
+      "friend void $adddescriptorsname$_register();\n",
+      "adddescriptorsname",
+      GlobalAddDescriptorsName(descriptor_->file()->name()));
+  }
 
   printer->Print(
     "friend void $assigndescriptorsname$();\n"
@@ -1205,8 +1285,18 @@ GenerateInlineMethods(io::Printer* printer) {
 }
 
 void MessageGenerator::
-GenerateDescriptorDeclarations(io::Printer* printer) {
-  if (!IsMapEntryMessage(descriptor_)) {
+GenerateDescriptorDeclarations(io::Printer* printer, bool is_extern) {
+  if (is_extern) {
+    printer->Print(
+      "extern const ::google::protobuf::Descriptor* $name$_descriptor_;\n",
+      "name", classname_);
+    if (!IsMapEntryMessage(descriptor_)) {
+      printer->Print(
+        "extern const ::google::protobuf::internal::GeneratedMessageReflection*\n"
+        "  $name$_reflection_;\n",
+        "name", classname_);
+    }
+  } else if (!IsMapEntryMessage(descriptor_)) {
     printer->Print(
       "const ::google::protobuf::Descriptor* $name$_descriptor_ = NULL;\n"
       "const ::google::protobuf::internal::GeneratedMessageReflection*\n"
@@ -1233,16 +1323,26 @@ GenerateDescriptorDeclarations(io::Printer* printer) {
       }
     }
 
-    printer->Print("}* $name$_default_oneof_instance_ = NULL;\n",
-                   "name", classname_);
+    if (is_extern) {
+      // The struct is defined identically in every part of the file.
+      printer->Print(
+        "};\n"
+        "extern $name$OneofInstance* $name$_default_oneof_instance_;\n",
+        "name", classname_);
+    } else {
+      printer->Print("}* $name$_default_oneof_instance_ = NULL;\n",
+                     "name", classname_);
+    }
   }
 
   for (int i = 0; i < descriptor_->nested_type_count(); i++) {
-    nested_generators_[i]->GenerateDescriptorDeclarations(printer);
+    nested_generators_[i]->GenerateDescriptorDeclarations(printer, is_extern);
   }
 
   for (int i = 0; i < descriptor_->enum_type_count(); i++) {
     printer->Print(
+      is_extern ?
+      "extern const ::google::protobuf::EnumDescriptor* $name$_descriptor_;\n" :
       "const ::google::protobuf::EnumDescriptor* $name$_descriptor_ = NULL;\n",
       "name", ClassName(descriptor_->enum_type(i), false));
   }
@@ -1411,9 +1511,11 @@ void MessageGenerator::
 GenerateDefaultInstanceAllocator(io::Printer* printer) {
   // Construct the default instances of all fields, as they will be used
   // when creating the default instance of the entire message.
-  for (int i = 0; i < descriptor_->field_count(); i++) {
-    field_generators_.get(descriptor_->field(i))
-                     .GenerateDefaultInstanceAllocator(printer);
+  if (!LazyInitialization(descriptor_->file(), options_)) {
+    for (int i = 0; i < descriptor_->field_count(); i++) {
+      field_generators_.get(descriptor_->field(i))
+                       .GenerateDefaultInstanceAllocator(printer);
+    }
   }
 
   if (IsMapEntryMessage(descriptor_)) return;
@@ -1439,6 +1541,18 @@ GenerateDefaultInstanceAllocator(io::Printer* printer) {
 
 }
 
+void MessageGenerator::
+GenerateFieldDefaultsAllocator(io::Printer* printer) {
+  for (int i = 0; i < descriptor_->field_count(); i++) {
+    field_generators_.get(descriptor_->field(i))
+                     .GenerateDefaultInstanceAllocator(printer);
+  }
+
+  for (int i = 0; i < descriptor_->nested_type_count(); i++) {
+    nested_generators_[i]->GenerateFieldDefaultsAllocator(printer);
+  }
+}
+
 void MessageGenerator::
 GenerateDefaultInstanceInitializer(io::Printer* printer) {
   printer->Print(
@@ -1554,9 +1668,25 @@ GenerateClassMethods(io::Printer* printer) {
       printer->Print("\n");
     }
 
+    if (HasSinglePassSerialization()) {
+      GenerateSerializeReverse(printer);
+      printer->Print("\n");
+    }
+
     GenerateByteSize(printer);
     printer->Print("\n");
 
+    GenerateSpaceUsed(printer);
+    printer->Print("\n");
+
+    if (HasDescriptorMethods(descriptor_->file())) {
+      GenerateStructuralHash(printer);
+      printer->Print("\n");
+
+      GenerateStructuralEquals(printer);
+      printer->Print("\n");
+    }
+
     GenerateMergeFrom(printer);
     printer->Print("\n");
 
@@ -1701,7 +1831,7 @@ GenerateSharedDestructorCode(io::Printer* printer) {
   }
 
   PrintHandlingOptionalStaticInitializers(
-    descriptor_->file(), printer,
+    descriptor_->file(), options_, printer,
     // With static initializers.
     "if (this != default_instance_) {\n",
     // Without.
@@ -1863,16 +1993,26 @@ GenerateStructors(io::Printer* printer) {
         name = classname_ + "_default_oneof_instance_->";
       }
       name += FieldName(field);
-      PrintHandlingOptionalStaticInitializers(
-        descriptor_->file(), printer,
-        // With static initializers.
-        "  $name$_ = const_cast< $type$*>(&$type$::default_instance());\n",
-        // Without.
-        "  $name$_ = const_cast< $type$*>(\n"
-        "      $type$::internal_default_instance());\n",
-        // Vars.
-        "name", name,
-        "type", FieldMessageTypeName(field));
+      if (LazyInitialization(descriptor_->file(), options_) &&
+          field->message_type()->file() != descriptor_->file()) {
+        // Other files were initialized before this one, and may not declare
+        // internal_default_instance().
+        printer->Print(
+          "  $name$_ = const_cast< $type$*>(&$type$::default_instance());\n",
+          "name", name,
+          "type", FieldMessageTypeName(field));
+      } else {
+        PrintHandlingOptionalStaticInitializers(
+          descriptor_->file(), options_, printer,
+          // With static initializers.
+          "  $name$_ = const_cast< $type$*>(&$type$::default_instance());\n",
+          // Without.
+          "  $name$_ = const_cast< $type$*>(\n"
+          "      $type$::internal_default_instance());\n",
+          // Vars.
+          "name", name,
+          "type", FieldMessageTypeName(field));
+      }
     } else if (field->containing_oneof() &&
                HasDescriptorMethods(descriptor_->file())) {
       field_generators_.get(descriptor_->field(i))
@@ -1955,7 +2095,7 @@ GenerateStructors(io::Printer* printer) {
     "classname", classname_);
 
   PrintHandlingOptionalStaticInitializers(
-    descriptor_->file(), printer,
+    descriptor_->file(), options_, printer,
     // With static initializers.
     "  if (default_instance_ == NULL) $adddescriptorsname$();\n",
     // Without.
@@ -2519,7 +2659,7 @@ GenerateMergeFromCodedStream(io::Printer* printer) {
       "classname", classname_);
 
     PrintHandlingOptionalStaticInitializers(
-      descriptor_->file(), printer,
+      descriptor_->file(), options_, printer,
       // With static initializers.
       "  return _extensions_.ParseMessageSet(input, default_instance_,\n"
       "                                      mutable_unknown_fields());\n",
@@ -2716,7 +2856,7 @@ GenerateMergeFromCodedStream(io::Printer* printer) {
     if (PreserveUnknownFields(descriptor_)) {
       if (UseUnknownFieldSet(descriptor_->file())) {
         PrintHandlingOptionalStaticInitializers(
-          descriptor_->file(), printer,
+          descriptor_->file(), options_, printer,
           // With static initializers.
           "  DO_(_extensions_.ParseField(tag, input, default_instance_,\n"
           "                              mutable_unknown_fields()));\n",
@@ -2725,7 +2865,7 @@ GenerateMergeFromCodedStream(io::Printer* printer) {
           "                              mutable_unknown_fields()));\n");
       } else {
         PrintHandlingOptionalStaticInitializers(
-          descriptor_->file(), printer,
+          descriptor_->file(), options_, printer,
           // With static initializers.
           "  DO_(_extensions_.ParseField(tag, input, default_instance_,\n"
           "                              &unknown_fields_stream));\n",
@@ -2735,7 +2875,7 @@ GenerateMergeFromCodedStream(io::Printer* printer) {
       }
     } else {
       PrintHandlingOptionalStaticInitializers(
-        descriptor_->file(), printer,
+        descriptor_->file(), options_, printer,
         // With static initializers.
         "  DO_(_extensions_.ParseField(tag, input, default_instance_);\n",
         // Without.
@@ -2813,6 +2953,46 @@ void MessageGenerator::GenerateSerializeOneField(
   printer->Print("\n");
 }
 
+int MessageGenerator::GenerateSerializeFields(
+    io::Printer* printer, const FieldDescriptor** fields, int count,
+    bool to_array) {
+  // SerializeWithCachedSizes() is only used when the message does not fit
+  // into the stream's current buffer.  Runs of small fields are still
+  // written through CodedOutputStream::BeginFastWrite() with the same code
+  // as SerializeWithCachedSizesToArray(), checking the bounds once per run
+  // rather than once per value.
+  int run_size = 0;
+  int run_length = 0;
+  if (!to_array && HasFastArraySerialization(descriptor_->file())) {
+    while (run_length < count) {
+      int size = MaxSerializedFieldSize(fields[run_length]);
+      if (size < 0 || run_size + size > io::CodedOutputStream::kSlopBytes) {
+        break;
+      }
+      run_size += size;
+      ++run_length;
+    }
+  }
+
+  if (run_length < 2) {
+    GenerateSerializeOneField(printer, fields[0], to_array);
+    return 1;
+  }
+
+  printer->Print(
+    "{\n"
+    "  ::google::protobuf::uint8* target = output->BeginFastWrite();\n"
+    "\n");
+  printer->Indent();
+  for (int i = 0; i < run_length; i++) {
+    GenerateSerializeOneField(printer, fields[i], true);
+  }
+  printer->Print("output->EndFastWrite(target);\n");
+  printer->Outdent();
+  printer->Print("}\n\n");
+  return run_length;
+}
+
 void MessageGenerator::GenerateSerializeOneExtensionRange(
     io::Printer* printer, const Descriptor::ExtensionRange* range,
     bool to_array) {
@@ -2936,9 +3116,18 @@ GenerateSerializeWithCachedSizesBody(io::Printer* printer, bool to_array) {
                                          sorted_extensions[j++],
                                          to_array);
     } else if (j == sorted_extensions.size()) {
-      GenerateSerializeOneField(printer, ordered_fields[i++], to_array);
+      i += GenerateSerializeFields(printer, ordered_fields.get() + i,
+                                   descriptor_->field_count() - i, to_array);
     } else if (ordered_fields[i]->number() < sorted_extensions[j]->start) {
-      GenerateSerializeOneField(printer, ordered_fields[i++], to_array);
+      // Fields written together must not straddle the extension range.
+      int count = 1;
+      while (i + count < descriptor_->field_count() &&
+             ordered_fields[i + count]->number() <
+                 sorted_extensions[j]->start) {
+        ++count;
+      }
+      i += GenerateSerializeFields(printer, ordered_fields.get() + i, count,
+                                   to_array);
     } else {
       GenerateSerializeOneExtensionRange(printer,
                                          sorted_extensions[j++],
@@ -2972,6 +3161,106 @@ GenerateSerializeWithCachedSizesBody(io::Printer* printer, bool to_array) {
   }
 }
 
+bool MessageGenerator::HasSinglePassSerialization() const {
+  // The per-field fallback reuses the SerializeWithCachedSizesToArray() code,
+  // and MessageSets keep the default implementation.
+  return options_.single_pass_serialization &&
+         HasFastArraySerialization(descriptor_->file()) &&
+         !descriptor_->options().message_set_wire_format();
+}
+
+void MessageGenerator::GenerateSerializeOneFieldReverse(
+    io::Printer* printer, const FieldDescriptor* field) {
+  PrintFieldComment(printer, field);
+
+  bool have_enclosing_if = false;
+  if (!field->is_repeated() && HasFieldPresence(descriptor_->file())) {
+    printer->Print(
+      "if (has_$name$()) {\n",
+      "name", FieldName(field));
+    printer->Indent();
+    have_enclosing_if = true;
+  } else if (!HasFieldPresence(descriptor_->file())) {
+    have_enclosing_if = EmitFieldNonDefaultCondition(printer, "this->", field);
+  }
+
+  field_generators_.get(field).GenerateSerializeReverse(printer);
+
+  if (have_enclosing_if) {
+    printer->Outdent();
+    printer->Print("}\n");
+  }
+  printer->Print("\n");
+}
+
+void MessageGenerator::
+GenerateSerializeReverse(io::Printer* printer) {
+  printer->Print(
+    "void $classname$::InternalSerializeReverse(\n"
+    "    ::google::protobuf::io::ReverseCodedBuffer* output) const {\n",
+    "classname", classname_);
+  printer->Indent();
+
+  printer->Print(
+    "// @@protoc_insertion_point(serialize_reverse_start:$full_name$)\n",
+    "full_name", descriptor_->full_name());
+
+  // Everything is prepended, so emit the unknown fields first and then the
+  // fields and extension ranges in descending order of field number.
+  if (PreserveUnknownFields(descriptor_)) {
+    if (UseUnknownFieldSet(descriptor_->file())) {
+      printer->Print(
+        "if (_internal_metadata_.have_unknown_fields()) {\n"
+        "  ::google::protobuf::uint8* target = output->Reserve(\n"
+        "      ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(\n"
+        "          unknown_fields()));\n"
+        "  ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(\n"
+        "      unknown_fields(), target);\n"
+        "}\n");
+    } else {
+      printer->Print(
+        "output->WriteString(unknown_fields());\n");
+    }
+    printer->Print("\n");
+  }
+
+  google::protobuf::scoped_array<const FieldDescriptor * > ordered_fields(
+      SortFieldsByNumber(descriptor_));
+
+  vector<const Descriptor::ExtensionRange*> sorted_extensions;
+  for (int i = 0; i < descriptor_->extension_range_count(); ++i) {
+    sorted_extensions.push_back(descriptor_->extension_range(i));
+  }
+  sort(sorted_extensions.begin(), sorted_extensions.end(),
+       ExtensionRangeSorter());
+
+  // Merge the fields and the extension ranges, walking both backwards.
+  int i = descriptor_->field_count() - 1;
+  int j = sorted_extensions.size() - 1;
+  while (i >= 0 || j >= 0) {
+    if (j < 0 ||
+        (i >= 0 && ordered_fields[i]->number() >= sorted_extensions[j]->end)) {
+      GenerateSerializeOneFieldReverse(printer, ordered_fields[i--]);
+    } else {
+      map<string, string> vars;
+      vars["start"] = SimpleItoa(sorted_extensions[j]->start);
+      vars["end"] = SimpleItoa(sorted_extensions[j]->end);
+      printer->Print(vars,
+        "// Extension range [$start$, $end$)\n"
+        "_extensions_.InternalSerializeReverse($start$, $end$, output);\n\n");
+      j--;
+    }
+  }
+
+  printer->Print(
+    "// @@protoc_insertion_point(serialize_reverse_end:$full_name$)\n",
+    "full_name", descriptor_->full_name());
+
+  printer->Outdent();
+  printer->Print(
+    "}\n");
+}
+
 static vector<uint32> RequiredFieldsBitMask(const Descriptor* desc) {
   vector<uint32> result;
   uint32 mask = 0;
@@ -3011,13 +3300,24 @@ static string ConditionalToCheckBitmasks(const vector<uint32>& masks) {
   return result + " == 0";
 }
 
+void MessageGenerator::
+GenerateByteSizeWrapper(io::Printer* printer) {
+  printer->Print(
+    "int $classname$::ByteSize() const {\n"
+    "  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());\n"
+    "}\n"
+    "\n",
+    "classname", classname_);
+}
+
 void MessageGenerator::
 GenerateByteSize(io::Printer* printer) {
   if (descriptor_->options().message_set_wire_format()) {
     // Special-case MessageSet.
+    GenerateByteSizeWrapper(printer);
     printer->Print(
-      "int $classname$::ByteSize() const {\n"
-      "  int total_size = _extensions_.MessageSetByteSize();\n",
+      "size_t $classname$::ByteSizeLong() const {\n"
+      "  size_t total_size = _extensions_.MessageSetByteSize();\n",
       "classname", classname_);
     GOOGLE_CHECK(UseUnknownFieldSet(descriptor_->file()));
     printer->Print(
@@ -3026,8 +3326,9 @@ GenerateByteSize(io::Printer* printer) {
       "      ComputeUnknownMessageSetItemsSize(unknown_fields());\n"
       "}\n");
     printer->Print(
+      "  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);\n"
       "  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();\n"
-      "  _cached_size_ = total_size;\n"
+      "  _cached_size_ = cached_size;\n"
       "  GOOGLE_SAFE_CONCURRENT_WRITES_END();\n"
       "  return total_size;\n"
       "}\n");
@@ -3038,10 +3339,10 @@ GenerateByteSize(io::Printer* printer) {
     // Emit a function (rarely used, we hope) that handles the required fields
     // by checking for each one individually.
     printer->Print(
-        "int $classname$::RequiredFieldsByteSizeFallback() const {\n",
+        "size_t $classname$::RequiredFieldsByteSizeFallback() const {\n",
         "classname", classname_);
     printer->Indent();
-    printer->Print("int total_size = 0;\n");
+    printer->Print("size_t total_size = 0;\n");
     for (int i = 0; i < descriptor_->field_count(); i++) {
       const FieldDescriptor* field = descriptor_->field(i);
       if (field->is_required()) {
@@ -3061,12 +3362,13 @@ GenerateByteSize(io::Printer* printer) {
     printer->Print("}\n");
   }
 
+  GenerateByteSizeWrapper(printer);
   printer->Print(
-    "int $classname$::ByteSize() const {\n",
+    "size_t $classname$::ByteSizeLong() const {\n",
     "classname", classname_);
   printer->Indent();
   printer->Print(
-    "int total_size = 0;\n"
+    "size_t total_size = 0;\n"
     "\n");
 
   // Handle required fields (if any).  We expect all of them to be
@@ -3257,10 +3559,13 @@ GenerateByteSize(io::Printer* printer) {
   // this is not thread-compatible, because concurrent writes have undefined
   // results.  In practice, since any concurrent writes will be writing the
   // exact same value, it works on all common processors.  In a future version
-  // of C++, _cached_size_ should be made into an atomic<int>.
+  // of C++, _cached_size_ should be made into an atomic<int>.  Sizes above
+  // 2GB are only possible for the outermost message, whose cached size is
+  // never used to serialize it.
   printer->Print(
+    "int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);\n"
     "GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();\n"
-    "_cached_size_ = total_size;\n"
+    "_cached_size_ = cached_size;\n"
     "GOOGLE_SAFE_CONCURRENT_WRITES_END();\n"
     "return total_size;\n");
 
@@ -3268,6 +3573,274 @@ GenerateByteSize(io::Printer* printer) {
   printer->Print("}\n");
 }
 
+void MessageGenerator::
+GenerateSpaceUsed(io::Printer* printer) {
+  printer->Print(
+    "size_t $classname$::SpaceUsedLong() const {\n",
+    "classname", classname_);
+  printer->Indent();
+
+  if (SupportsArenas(descriptor_)) {
+    // Everything reachable from a message on an arena is owned by the arena,
+    // including unknown fields and extensions.
+    printer->Print(
+      "if (GetArenaNoVirtual() != NULL) return 0;\n");
+  }
+  // The default instance's sub-message pointers refer to other default
+  // instances, which it does not own.
+  PrintHandlingOptionalStaticInitializers(
+    descriptor_->file(), options_, printer,
+    // With static initializers.
+    "if (this == default_instance_) return sizeof(*this);\n",
+    // Without.
+    "if (this == &default_instance()) return sizeof(*this);\n");
+  printer->Print(
+    "size_t total_size = sizeof(*this);\n"
+    "\n");
+
+  for (int i = 0; i < descriptor_->field_count(); i++) {
+    const FieldDescriptor* field = descriptor_->field(i);
+    if (!field->containing_oneof()) {
+      field_generators_.get(field).GenerateSpaceUsed(printer);
+    }
+  }
+
+  // Only the active member of a oneof may own memory.
+  for (int i = 0; i < descriptor_->oneof_decl_count(); i++) {
+    printer->Print(
+        "switch ($oneofname$_case()) {\n",
+        "oneofname", descriptor_->oneof_decl(i)->name());
+    printer->Indent();
+    for (int j = 0; j < descriptor_->oneof_decl(i)->field_count(); j++) {
+      const FieldDescriptor* field = descriptor_->oneof_decl(i)->field(j);
+      printer->Print(
+          "case k$field_name$: {\n",
+          "field_name", UnderscoresToCamelCase(field->name(), true));
+      printer->Indent();
+      field_generators_.get(field).GenerateSpaceUsed(printer);
+      printer->Print(
+          "break;\n");
+      printer->Outdent();
+      printer->Print(
+          "}\n");
+    }
+    printer->Print(
+        "case $cap_oneof_name$_NOT_SET: {\n"
+        "  break;\n"
+        "}\n",
+        "cap_oneof_name",
+        ToUpper(descriptor_->oneof_decl(i)->name()));
+    printer->Outdent();
+    printer->Print(
+        "}\n");
+  }
+
+  if (descriptor_->extension_range_count() > 0) {
+    printer->Print(
+      "total_size += _extensions_.SpaceUsedExcludingSelfLong();\n");
+  }
+
+  if (UseUnknownFieldSet(descriptor_->file())) {
+    printer->Print(
+      "if (_internal_metadata_.have_unknown_fields()) {\n"
+      "  total_size += _internal_metadata_.unknown_fields().SpaceUsed();\n"
+      "}\n");
+  } else {
+    printer->Print(
+      "total_size +=\n"
+      "    ::google::protobuf::internal::StringSpaceUsedExcludingSelf(_unknown_fields_);\n");
+  }
+
+  printer->Print(
+    "return total_size;\n");
+
+  printer->Outdent();
+  printer->Print("}\n");
+}
+
+void MessageGenerator::
+GenerateStructuralHash(io::Printer* printer) {
+  printer->Print(
+    "::google::protobuf::uint64 $classname$::StructuralHash() const {\n"
+    "  ::google::protobuf::uint64 hash = 0;\n"
+    "\n",
+    "classname", classname_);
+  printer->Indent();
+
+  // Each term is mixed with its field number and the terms are added up, so
+  // this must agree with ReflectionOps::Hash() for the same contents.
+  for (int i = 0; i < descriptor_->field_count(); i++) {
+    const FieldDescriptor* field = descriptor_->field(i);
+    if (field->containing_oneof()) continue;
+    const FieldGenerator& generator = field_generators_.get(field);
+    if (field->is_repeated()) {
+      generator.GenerateStructuralHash(printer);
+      continue;
+    }
+    if (HasFieldPresence(descriptor_->file())) {
+      printer->Print(
+        "if (has_$name$()) {\n",
+        "name", FieldName(field));
+      printer->Indent();
+    } else {
+      EmitFieldNonDefaultCondition(printer, "this->", field);
+    }
+    generator.GenerateStructuralHash(printer);
+    printer->Outdent();
+    printer->Print("}\n");
+  }
+
+  for (int i = 0; i < descriptor_->oneof_decl_count(); i++) {
+    printer->Print(
+        "switch ($oneofname$_case()) {\n",
+        "oneofname", descriptor_->oneof_decl(i)->name());
+    printer->Indent();
+    for (int j = 0; j < descriptor_->oneof_decl(i)->field_count(); j++) {
+      const FieldDescriptor* field = descriptor_->oneof_decl(i)->field(j);
+      printer->Print(
+          "case k$field_name$: {\n",
+          "field_name", UnderscoresToCamelCase(field->name(), true));
+      printer->Indent();
+      field_generators_.get(field).GenerateStructuralHash(printer);
+      printer->Print(
+          "break;\n");
+      printer->Outdent();
+      printer->Print(
+          "}\n");
+    }
+    printer->Print(
+        "case $cap_oneof_name$_NOT_SET: {\n"
+        "  break;\n"
+        "}\n",
+        "cap_oneof_name",
+        ToUpper(descriptor_->oneof_decl(i)->name()));
+    printer->Outdent();
+    printer->Print(
+        "}\n");
+  }
+
+  if (descriptor_->extension_range_count() > 0) {
+    printer->Print(
+      "hash += _extensions_.StructuralHash(descriptor());\n");
+  }
+
+  printer->Print(
+    "if (_internal_metadata_.have_unknown_fields()) {\n"
+    "  hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(\n"
+    "      _internal_metadata_.unknown_fields());\n"
+    "}\n"
+    "return hash;\n");
+
+  printer->Outdent();
+  printer->Print("}\n");
+}
+
+void MessageGenerator::
+GenerateStructuralEquals(io::Printer* printer) {
+  // Like MergeFrom(const Message&), fall back to reflection if the other
+  // message is not of the generated type (e.g. it is a DynamicMessage).
+  printer->Print(
+    "bool $classname$::StructurallyEquals(\n"
+    "    const ::google::protobuf::Message& other) const {\n"
+    "  const $classname$* source =\n"
+    "    ::google::protobuf::internal::dynamic_cast_if_available<const $classname$*>(\n"
+    "      &other);\n"
+    "  if (source == NULL) {\n"
+    "    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);\n"
+    "  }\n"
+    "  return StructurallyEquals(*source);\n"
+    "}\n"
+    "\n"
+    "bool $classname$::StructurallyEquals(const $classname$& other) const {\n"
+    "  if (&other == this) return true;\n"
+    "\n",
+    "classname", classname_);
+  printer->Indent();
+
+  for (int i = 0; i < descriptor_->field_count(); i++) {
+    const FieldDescriptor* field = descriptor_->field(i);
+    if (field->containing_oneof()) continue;
+    const FieldGenerator& generator = field_generators_.get(field);
+    if (field->is_repeated()) {
+      generator.GenerateStructuralEquals(printer);
+      continue;
+    }
+    if (HasFieldPresence(descriptor_->file()) ||
+        field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
+      printer->Print(
+        "if (has_$name$() != other.has_$name$()) return false;\n"
+        "if (has_$name$()) {\n",
+        "name", FieldName(field));
+      printer->Indent();
+      generator.GenerateStructuralEquals(printer);
+      printer->Outdent();
+      printer->Print("}\n");
+    } else if (field->cpp_type() == FieldDescriptor::CPPTYPE_FLOAT ||
+               field->cpp_type() == FieldDescriptor::CPPTYPE_DOUBLE) {
+      // Values are compared bitwise, but -0.0 counts as unset like 0.0.
+      printer->Print(
+        "if (this->$name$() != 0 || other.$name$() != 0) {\n",
+        "name", FieldName(field));
+      printer->Indent();
+      generator.GenerateStructuralEquals(printer);
+      printer->Outdent();
+      printer->Print("}\n");
+    } else {
+      // Without field presence, an unset field is equal to its default.
+      generator.GenerateStructuralEquals(printer);
+    }
+  }
+
+  for (int i = 0; i < descriptor_->oneof_decl_count(); i++) {
+    printer->Print(
+        "if ($oneofname$_case() != other.$oneofname$_case()) return false;\n"
+        "switch ($oneofname$_case()) {\n",
+        "oneofname", descriptor_->oneof_decl(i)->name());
+    printer->Indent();
+    for (int j = 0; j < descriptor_->oneof_decl(i)->field_count(); j++) {
+      const FieldDescriptor* field = descriptor_->oneof_decl(i)->field(j);
+      printer->Print(
+          "case k$field_name$: {\n",
+          "field_name", UnderscoresToCamelCase(field->name(), true));
+      printer->Indent();
+      field_generators_.get(field).GenerateStructuralEquals(printer);
+      printer->Print(
+          "break;\n");
+      printer->Outdent();
+      printer->Print(
+          "}\n");
+    }
+    printer->Print(
+        "case $cap_oneof_name$_NOT_SET: {\n"
+        "  break;\n"
+        "}\n",
+        "cap_oneof_name",
+        ToUpper(descriptor_->oneof_decl(i)->name()));
+    printer->Outdent();
+    printer->Print(
+        "}\n");
+  }
+
+  if (descriptor_->extension_range_count() > 0) {
+    printer->Print(
+      "if (!_extensions_.StructurallyEquals(descriptor(), other._extensions_)) {\n"
+      "  return false;\n"
+      "}\n");
+  }
+
+  printer->Print(
+    "if (_internal_metadata_.have_unknown_fields() ||\n"
+    "    other._internal_metadata_.have_unknown_fields()) {\n"
+    "  return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(\n"
+    "      _internal_metadata_.unknown_fields(),\n"
+    "      other._internal_metadata_.unknown_fields());\n"
+    "}\n"
+    "return true;\n");
+
+  printer->Outdent();
+  printer->Print("}\n");
+}
+
 void MessageGenerator::
 GenerateIsInitialized(io::Printer* printer) {
   printer->Print(
@@ -87,8 +87,10 @@ class MessageGenerator {
   // Source file stuff.
 
   // Generate code which declares all the global descriptor pointers which
-  // will be initialized by the methods below.
-  void GenerateDescriptorDeclarations(io::Printer* printer);
+  // will be initialized by the methods below.  If is_extern is true, the
+  // pointers are only declared extern, for the parts of a file generated
+  // with split_into which use the pointers defined by the main part.
+  void GenerateDescriptorDeclarations(io::Printer* printer, bool is_extern);
 
   // Generate code that initializes the global variable storing the message's
   // descriptor.
@@ -98,9 +100,17 @@ class MessageGenerator {
   // for all types.
   void GenerateTypeRegistrations(io::Printer* printer);
 
-  // Generates code that allocates the message's default instance.
+  // Generates code that allocates the message's default instance.  With
+  // lazy_init the default values of fields are not included; see
+  // GenerateFieldDefaultsAllocator().
   void GenerateDefaultInstanceAllocator(io::Printer* printer);
 
+  // Generates code that allocates the static default values of fields, such
+  // as non-empty default strings, for this message and its nested types.
+  // Constructors depend on these, so with lazy_init they are still allocated
+  // at static init time.
+  void GenerateFieldDefaultsAllocator(io::Printer* printer);
+
   // Generates code that initializes the message's default instance.  This
   // is separate from allocating because all default instances must be
   // allocated before any can be initialized.
@@ -143,7 +153,12 @@ class MessageGenerator {
   void GenerateSerializeWithCachedSizesToArray(io::Printer* printer);
   void GenerateSerializeWithCachedSizesBody(io::Printer* printer,
                                             bool to_array);
+  void GenerateSerializeReverse(io::Printer* printer);
+  void GenerateByteSizeWrapper(io::Printer* printer);
   void GenerateByteSize(io::Printer* printer);
+  void GenerateSpaceUsed(io::Printer* printer);
+  void GenerateStructuralHash(io::Printer* printer);
+  void GenerateStructuralEquals(io::Printer* printer);
   void GenerateMergeFrom(io::Printer* printer);
   void GenerateCopyFrom(io::Printer* printer);
   void GenerateSwap(io::Printer* printer);
@@ -153,10 +168,22 @@ class MessageGenerator {
   void GenerateSerializeOneField(io::Printer* printer,
                                  const FieldDescriptor* field,
                                  bool unbounded);
+  // Serializes fields[0], or a run of fields starting with it that fits
+  // into the output's slop region.  Returns the number of fields written.
+  int GenerateSerializeFields(io::Printer* printer,
+                              const FieldDescriptor** fields, int count,
+                              bool to_array);
   void GenerateSerializeOneExtensionRange(
       io::Printer* printer, const Descriptor::ExtensionRange* range,
       bool unbounded);
 
+  // Helper for GenerateSerializeReverse().
+  void GenerateSerializeOneFieldReverse(io::Printer* printer,
+                                        const FieldDescriptor* field);
+
+  // Whether to generate InternalSerializeReverse() for this message.
+  bool HasSinglePassSerialization() const;
+
 
   const Descriptor* descriptor_;
   string classname_;
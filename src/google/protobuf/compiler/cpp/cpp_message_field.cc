@@ -72,7 +72,8 @@ void SetMessageVariables(const FieldDescriptor* descriptor,
 MessageFieldGenerator::
 MessageFieldGenerator(const FieldDescriptor* descriptor,
                       const Options& options)
-  : descriptor_(descriptor) {
+  : descriptor_(descriptor),
+    options_(options) {
   SetMessageVariables(descriptor, &variables_, options);
 }
 
@@ -105,7 +106,7 @@ GenerateInlineAccessorDefinitions(io::Printer* printer) const {
     "  // @@protoc_insertion_point(field_get:$full_name$)\n");
 
   PrintHandlingOptionalStaticInitializers(
-    variables_, descriptor_->file(), printer,
+    variables_, descriptor_->file(), options_, printer,
     // With static initializers.
     "  return $name$_ != NULL ? *$name$_ : *default_instance_->$name$_;\n",
     // Without.
@@ -316,6 +317,35 @@ GenerateByteSize(io::Printer* printer) const {
     "    *$non_null_ptr_to_name$);\n");
 }
 
+void MessageFieldGenerator::
+GenerateSpaceUsed(io::Printer* printer) const {
+  printer->Print(variables_,
+    "if ($non_null_ptr_to_name$ != NULL) {\n"
+    "  total_size += $non_null_ptr_to_name$->SpaceUsedLong();\n"
+    "}\n");
+}
+
+void MessageFieldGenerator::
+GenerateStructuralHash(io::Printer* printer) const {
+  printer->Print(variables_,
+    "hash += ::google::protobuf::internal::HashCombine(\n"
+    "    $number$, this->$name$().StructuralHash());\n");
+}
+
+void MessageFieldGenerator::
+GenerateStructuralEquals(io::Printer* printer) const {
+  printer->Print(variables_,
+    "if (!this->$name$().StructurallyEquals(other.$name$())) return false;\n");
+}
+
+void MessageFieldGenerator::
+GenerateSerializeReverse(io::Printer* printer) const {
+  printer->Print(variables_,
+    "::google::protobuf::internal::WireFormatLite::\n"
+    "  Write$declared_type$NoVirtualReverse(\n"
+    "    $number$, *$non_null_ptr_to_name$, output);\n");
+}
+
 // ===================================================================
 
 MessageOneofFieldGenerator::
@@ -508,6 +538,14 @@ RepeatedMessageFieldGenerator(const FieldDescriptor* descriptor,
                               const Options& options)
   : descriptor_(descriptor) {
   SetMessageVariables(descriptor, &variables_, options);
+  if (options.inline_repeated > 0) {
+    variables_["storage_type"] = StrCat(
+        "::google::protobuf::internal::InlinedRepeatedPtrField< ",
+        variables_["type"], ", ", SimpleItoa(options.inline_repeated), " >");
+  } else {
+    variables_["storage_type"] =
+        "::google::protobuf::RepeatedPtrField< " + variables_["type"] + " >";
+  }
 }
 
 RepeatedMessageFieldGenerator::~RepeatedMessageFieldGenerator() {}
@@ -515,7 +553,7 @@ RepeatedMessageFieldGenerator::~RepeatedMessageFieldGenerator() {}
 void RepeatedMessageFieldGenerator::
 GeneratePrivateMembers(io::Printer* printer) const {
   printer->Print(variables_,
-    "::google::protobuf::RepeatedPtrField< $type$ > $name$_;\n");
+    "$storage_type$ $name$_;\n");
 }
 
 void RepeatedMessageFieldGenerator::
@@ -622,6 +660,41 @@ GenerateByteSize(io::Printer* printer) const {
     "}\n");
 }
 
+void RepeatedMessageFieldGenerator::
+GenerateSpaceUsed(io::Printer* printer) const {
+  printer->Print(variables_,
+    "total_size += $name$_.SpaceUsedExcludingSelfLong();\n");
+}
+
+void RepeatedMessageFieldGenerator::
+GenerateStructuralHash(io::Printer* printer) const {
+  printer->Print(variables_,
+    "if (this->$name$_size() > 0) {\n"
+    "  hash += ::google::protobuf::internal::HashCombine(\n"
+    "      $number$,\n"
+    "      ::google::protobuf::internal::HashRepeatedMessages(this->$name$()));\n"
+    "}\n");
+}
+
+void RepeatedMessageFieldGenerator::
+GenerateStructuralEquals(io::Printer* printer) const {
+  printer->Print(variables_,
+    "if (!::google::protobuf::internal::RepeatedMessagesEqual(\n"
+    "        this->$name$(), other.$name$())) {\n"
+    "  return false;\n"
+    "}\n");
+}
+
+void RepeatedMessageFieldGenerator::
+GenerateSerializeReverse(io::Printer* printer) const {
+  printer->Print(variables_,
+    "for (int i = this->$name$_size() - 1; i >= 0; i--) {\n"
+    "  ::google::protobuf::internal::WireFormatLite::\n"
+    "    Write$declared_type$NoVirtualReverse(\n"
+    "      $number$, this->$name$(i), output);\n"
+    "}\n");
+}
+
 }  // namespace cpp
 }  // namespace compiler
 }  // namespace protobuf
@@ -62,10 +62,15 @@ class MessageFieldGenerator : public FieldGenerator {
   void GenerateSerializeWithCachedSizes(io::Printer* printer) const;
   void GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const;
   void GenerateByteSize(io::Printer* printer) const;
+  void GenerateSpaceUsed(io::Printer* printer) const;
+  void GenerateStructuralHash(io::Printer* printer) const;
+  void GenerateStructuralEquals(io::Printer* printer) const;
+  void GenerateSerializeReverse(io::Printer* printer) const;
 
  protected:
   const FieldDescriptor* descriptor_;
   map<string, string> variables_;
+  const Options options_;
 
  private:
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(MessageFieldGenerator);
@@ -105,6 +110,10 @@ class RepeatedMessageFieldGenerator : public FieldGenerator {
   void GenerateSerializeWithCachedSizes(io::Printer* printer) const;
   void GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const;
   void GenerateByteSize(io::Printer* printer) const;
+  void GenerateSpaceUsed(io::Printer* printer) const;
+  void GenerateStructuralHash(io::Printer* printer) const;
+  void GenerateStructuralEquals(io::Printer* printer) const;
+  void GenerateSerializeReverse(io::Printer* printer) const;
 
  private:
   const FieldDescriptor* descriptor_;
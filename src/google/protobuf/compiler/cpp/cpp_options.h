@@ -43,10 +43,20 @@ namespace cpp {
 
 // Generator options:
 struct Options {
-  Options() : safe_boundary_check(false) {
+  Options() : safe_boundary_check(false), single_pass_serialization(false),
+              lazy_init(false), split_into(0), inline_repeated(0) {
   }
   string dllexport_decl;
   bool safe_boundary_check;
+  bool single_pass_serialization;
+  bool lazy_init;
+  // If positive, message implementations are spread over this many extra
+  // source files; see FileGenerator::GenerateSourcePart().
+  int split_into;
+  // If positive, repeated fields keep up to this many elements (or, for
+  // string and message fields, element pointers) inside the message; see
+  // internal::InlinedRepeatedField and internal::InlinedRepeatedPtrField.
+  int inline_repeated;
 };
 
 }  // namespace cpp
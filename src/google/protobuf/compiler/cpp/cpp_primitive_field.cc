@@ -192,6 +192,22 @@ GenerateByteSize(io::Printer* printer) const {
   }
 }
 
+void PrimitiveFieldGenerator::
+GenerateStructuralHash(io::Printer* printer) const {
+  printer->Print(variables_,
+    "hash += ::google::protobuf::internal::HashCombine(\n"
+    "    $number$, ::google::protobuf::internal::HashValue(this->$name$()));\n");
+}
+
+void PrimitiveFieldGenerator::
+GenerateStructuralEquals(io::Printer* printer) const {
+  printer->Print(variables_,
+    "if (!::google::protobuf::internal::ValuesEqual(\n"
+    "        this->$name$(), other.$name$())) {\n"
+    "  return false;\n"
+    "}\n");
+}
+
 // ===================================================================
 
 PrimitiveOneofFieldGenerator::
@@ -257,6 +273,14 @@ RepeatedPrimitiveFieldGenerator(const FieldDescriptor* descriptor,
                                 const Options& options)
   : descriptor_(descriptor) {
   SetPrimitiveVariables(descriptor, &variables_, options);
+  if (options.inline_repeated > 0) {
+    variables_["storage_type"] = StrCat(
+        "::google::protobuf::internal::InlinedRepeatedField< ",
+        variables_["type"], ", ", SimpleItoa(options.inline_repeated), " >");
+  } else {
+    variables_["storage_type"] =
+        "::google::protobuf::RepeatedField< " + variables_["type"] + " >";
+  }
 
   if (descriptor->options().packed()) {
     variables_["packed_reader"] = "ReadPackedPrimitive";
@@ -272,7 +296,7 @@ RepeatedPrimitiveFieldGenerator::~RepeatedPrimitiveFieldGenerator() {}
 void RepeatedPrimitiveFieldGenerator::
 GeneratePrivateMembers(io::Printer* printer) const {
   printer->Print(variables_,
-    "::google::protobuf::RepeatedField< $type$ > $name$_;\n");
+    "$storage_type$ $name$_;\n");
   if (descriptor_->options().packed() && HasGeneratedMethods(descriptor_->file())) {
     printer->Print(variables_,
       "mutable int _$name$_cached_byte_size_;\n");
@@ -447,6 +471,65 @@ GenerateByteSize(io::Printer* printer) const {
   printer->Print("}\n");
 }
 
+void RepeatedPrimitiveFieldGenerator::
+GenerateSpaceUsed(io::Printer* printer) const {
+  printer->Print(variables_,
+    "total_size += $name$_.SpaceUsedExcludingSelfLong();\n");
+}
+
+void RepeatedPrimitiveFieldGenerator::
+GenerateStructuralHash(io::Printer* printer) const {
+  printer->Print(variables_,
+    "if (this->$name$_size() > 0) {\n"
+    "  hash += ::google::protobuf::internal::HashCombine(\n"
+    "      $number$,\n"
+    "      ::google::protobuf::internal::HashRepeatedValues(this->$name$()));\n"
+    "}\n");
+}
+
+void RepeatedPrimitiveFieldGenerator::
+GenerateStructuralEquals(io::Printer* printer) const {
+  printer->Print(variables_,
+    "if (!::google::protobuf::internal::RepeatedPrimitivesEqual(\n"
+    "        this->$name$(), other.$name$())) {\n"
+    "  return false;\n"
+    "}\n");
+}
+
+void RepeatedPrimitiveFieldGenerator::
+GenerateSerializeReverse(io::Printer* printer) const {
+  if (!descriptor_->options().packed()) {
+    FieldGenerator::GenerateSerializeReverse(printer);
+    return;
+  }
+  // The ByteSize() code would store _$name$_cached_byte_size_, so size the
+  // packed data locally instead.
+  printer->Print(variables_,
+    "if (this->$name$_size() > 0) {\n");
+  printer->Indent();
+  if (FixedSize(descriptor_->type()) == -1) {
+    printer->Print(variables_,
+      "int data_size = 0;\n"
+      "for (int i = 0; i < this->$name$_size(); i++) {\n"
+      "  data_size += ::google::protobuf::internal::WireFormatLite::\n"
+      "    $declared_type$Size(this->$name$(i));\n"
+      "}\n");
+  } else {
+    printer->Print(variables_,
+      "int data_size = $fixed_size$ * this->$name$_size();\n");
+  }
+  printer->Print(variables_,
+    "::google::protobuf::uint8* target = output->Reserve(data_size);\n"
+    "for (int i = 0; i < this->$name$_size(); i++) {\n"
+    "  target = ::google::protobuf::internal::WireFormatLite::\n"
+    "    Write$declared_type$NoTagToArray(this->$name$(i), target);\n"
+    "}\n"
+    "output->WriteVarint32(data_size);\n"
+    "output->WriteTag($tag$);\n");
+  printer->Outdent();
+  printer->Print("}\n");
+}
+
 }  // namespace cpp
 }  // namespace compiler
 }  // namespace protobuf
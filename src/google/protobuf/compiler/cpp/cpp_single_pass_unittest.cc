@@ -0,0 +1,233 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Tests for the code generated with the "single_pass_serialization" option:
+// SerializeToStringSinglePass() must produce the same bytes as
+// SerializeToString() without touching any cached size.
+
+#include <map>
+#include <string>
+
+#include <google/protobuf/unittest.pb.h>
+#include <google/protobuf/unittest_single_pass.pb.h>
+#include <google/protobuf/test_util.h>
+#include <google/protobuf/unknown_field_set.h>
+#include <google/protobuf/stubs/strutil.h>
+
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace compiler {
+namespace cpp {
+
+namespace {
+
+typedef protobuf_unittest::TestSinglePass TestSinglePass;
+
+void SetFields(TestSinglePass* message) {
+  message->set_optional_int32(-101);
+  message->set_optional_sint64(-102);
+  message->set_optional_fixed32(103);
+  message->set_optional_double(104.5);
+  message->set_optional_bool(true);
+  message->set_optional_string("105");
+  message->set_optional_bytes(string(1000, 'x'));
+  message->set_optional_nested_enum(TestSinglePass::BAZ);
+  message->mutable_optional_nested_message()->set_bb(109);
+  message->mutable_optional_nested_message()->add_children()
+      ->mutable_optional_nested_message()->set_bb(1109);
+  message->mutable_optionalgroup()->set_a(111);
+  TestUtil::SetAllFields(message->mutable_optional_foreign_message());
+
+  for (int i = 0; i < 3; i++) {
+    message->add_repeated_int32(201 + i);
+    message->add_repeated_string("202");
+    message->add_repeated_nested_enum(TestSinglePass::BAR);
+    message->add_repeated_nested_message()->set_bb(204 + i);
+    message->add_repeatedgroup()->set_a(226 + i);
+
+    message->add_packed_int32(-301 - i);
+    message->add_packed_sint64(302 + i);
+    message->add_packed_fixed64(303 + i);
+    message->add_packed_float(304.5 + i);
+    message->add_packed_nested_enum(TestSinglePass::BAZ);
+  }
+
+  message->mutable_oneof_nested_message()->set_bb(402);
+
+  // One entry each, so that the entry order is the same either way.
+  (*message->mutable_map_int32_string())[501] = "501";
+  (*message->mutable_map_string_message())["502"].set_bb(502);
+
+  message->set_field_after_extensions(600);
+  message->SetExtension(protobuf_unittest::single_pass_int32_extension, 700);
+  message->MutableExtension(
+      protobuf_unittest::single_pass_message_extension)->set_bb(701);
+  message->AddExtension(
+      protobuf_unittest::single_pass_repeated_message_extension)->set_bb(702);
+  message->AddExtension(
+      protobuf_unittest::single_pass_repeated_message_extension)->set_bb(703);
+  message->AddExtension(
+      protobuf_unittest::single_pass_packed_int32_extension, 704);
+  message->AddExtension(
+      protobuf_unittest::single_pass_packed_int32_extension, -705);
+  message->MutableExtension(
+      protobuf_unittest::singlepassgroupextension)->set_a(706);
+
+  message->mutable_unknown_fields()->AddVarint(300, 800);
+  message->mutable_unknown_fields()->AddLengthDelimited(301, "801");
+}
+
+TEST(SinglePassSerializationTest, Empty) {
+  TestSinglePass message;
+  string data = "garbage";
+  EXPECT_TRUE(message.SerializeToStringSinglePass(&data));
+  EXPECT_EQ("", data);
+}
+
+TEST(SinglePassSerializationTest, MatchesSerializeToString) {
+  TestSinglePass message;
+  SetFields(&message);
+
+  string single_pass;
+  ASSERT_TRUE(message.SerializeToStringSinglePass(&single_pass));
+  EXPECT_EQ(message.SerializeAsString(), single_pass);
+
+  TestSinglePass parsed;
+  ASSERT_TRUE(parsed.ParseFromString(single_pass));
+  EXPECT_EQ(message.DebugString(), parsed.DebugString());
+}
+
+TEST(SinglePassSerializationTest, OneofAndDefaultValues) {
+  TestSinglePass message;
+  message.set_oneof_string("");
+  message.set_optional_int32(0);
+
+  string single_pass;
+  ASSERT_TRUE(message.SerializeToStringSinglePass(&single_pass));
+  EXPECT_EQ(message.SerializeAsString(), single_pass);
+}
+
+TEST(SinglePassSerializationTest, DoesNotWriteCachedSizes) {
+  TestSinglePass message;
+  SetFields(&message);
+
+  string single_pass;
+  ASSERT_TRUE(message.SerializeToStringSinglePass(&single_pass));
+  EXPECT_EQ(0, message.GetCachedSize());
+  EXPECT_EQ(0, message.optional_nested_message().GetCachedSize());
+  EXPECT_EQ(0, message.optional_nested_message().children(0).GetCachedSize());
+  EXPECT_EQ(0, message.repeated_nested_message(1).GetCachedSize());
+  EXPECT_EQ(0, message.oneof_nested_message().GetCachedSize());
+  EXPECT_EQ(0, message.GetExtension(
+      protobuf_unittest::single_pass_message_extension).GetCachedSize());
+  EXPECT_EQ(0, message.map_string_message().at("502").GetCachedSize());
+
+  // SerializeToString() does fill them in.
+  message.SerializeAsString();
+  EXPECT_EQ(single_pass.size(), message.GetCachedSize());
+  EXPECT_NE(0, message.optional_nested_message().GetCachedSize());
+  EXPECT_NE(0, message.map_string_message().at("502").GetCachedSize());
+}
+
+TEST(SinglePassSerializationTest, LazyExtensionDoesNotWriteCachedSizes) {
+  TestSinglePass source;
+  source.MutableExtension(
+      protobuf_unittest::single_pass_lazy_message_extension)->set_bb(900);
+  TestSinglePass message;
+  ASSERT_TRUE(message.ParseFromString(source.SerializeAsString()));
+  // Modifying the lazily parsed extension means it can no longer be written
+  // from its serialized bytes.
+  message.MutableExtension(
+      protobuf_unittest::single_pass_lazy_message_extension)->set_bb(901);
+
+  string single_pass;
+  ASSERT_TRUE(message.SerializeToStringSinglePass(&single_pass));
+  EXPECT_EQ(0, message.GetExtension(
+      protobuf_unittest::single_pass_lazy_message_extension).GetCachedSize());
+  EXPECT_EQ(message.SerializeAsString(), single_pass);
+}
+
+TEST(SinglePassSerializationTest, Maps) {
+  TestSinglePass message;
+  for (int i = 0; i < 100; i++) {
+    (*message.mutable_map_int32_string())[i] = SimpleItoa(i);
+    (*message.mutable_map_string_message())[SimpleItoa(i)].set_bb(i);
+  }
+
+  // Entries may come out in a different order, so compare the maps.
+  string single_pass;
+  ASSERT_TRUE(message.SerializeToStringSinglePass(&single_pass));
+  EXPECT_EQ(message.ByteSize(), single_pass.size());
+  TestSinglePass parsed;
+  ASSERT_TRUE(parsed.ParseFromString(single_pass));
+  ASSERT_EQ(100, parsed.map_int32_string().size());
+  ASSERT_EQ(100, parsed.map_string_message().size());
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(SimpleItoa(i), parsed.map_int32_string().at(i));
+    EXPECT_EQ(i, parsed.map_string_message().at(SimpleItoa(i)).bb());
+  }
+}
+
+TEST(SinglePassSerializationTest, DeepNesting) {
+  TestSinglePass message;
+  TestSinglePass* current = &message;
+  for (int i = 0; i < 50; i++) {
+    TestSinglePass::NestedMessage* nested =
+        current->mutable_optional_nested_message();
+    nested->set_bb(i);
+    current->set_optional_string(string(i * 10, 'a' + i % 26));
+    current = nested->add_children();
+  }
+
+  string single_pass;
+  ASSERT_TRUE(message.SerializeToStringSinglePass(&single_pass));
+  EXPECT_EQ(message.SerializeAsString(), single_pass);
+}
+
+TEST(SinglePassSerializationTest, WithoutOptionFallsBack) {
+  // Messages generated without the option use MessageLite's default, which
+  // goes through ByteSize().
+  protobuf_unittest::TestAllTypes message;
+  TestUtil::SetAllFields(&message);
+
+  string single_pass;
+  ASSERT_TRUE(message.SerializeToStringSinglePass(&single_pass));
+  EXPECT_EQ(message.SerializeAsString(), single_pass);
+}
+
+}  // namespace
+
+}  // namespace cpp
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
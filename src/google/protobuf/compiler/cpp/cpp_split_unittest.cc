@@ -0,0 +1,218 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Tests for the "split_into" option, which spreads the message
+// implementations of a file over several .pb.cc files.
+
+#include <map>
+#include <string>
+
+#include <google/protobuf/compiler/cpp/cpp_generator.h>
+#include <google/protobuf/compiler/code_generator.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/unittest.pb.h>
+#include <google/protobuf/unittest_split.pb.h>
+#include <google/protobuf/stubs/strutil.h>
+
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace compiler {
+namespace cpp {
+
+namespace {
+
+using protobuf_unittest::TestSplitA;
+using protobuf_unittest::TestSplitB;
+using protobuf_unittest::TestSplitC;
+
+class InMemoryGeneratorContext : public GeneratorContext {
+ public:
+  map<string, string> files_;
+
+  // implements GeneratorContext --------------------------------------
+  virtual io::ZeroCopyOutputStream* Open(const string& filename) {
+    string* contents = &files_[filename];
+    contents->clear();
+    return new io::StringOutputStream(contents);
+  }
+};
+
+// Returns the name of the generated file which defines the constructor of
+// the given class, or "" if there is not exactly one.
+string FileDefiningClass(const map<string, string>& files,
+                         const string& classname) {
+  const string constructor = classname + "::" + classname + "()";
+  string result;
+  for (map<string, string>::const_iterator it = files.begin();
+       it != files.end(); ++it) {
+    if (it->second.find(constructor) != string::npos) {
+      if (!result.empty()) return "";
+      result = it->first;
+    }
+  }
+  return result;
+}
+
+TEST(SplitIntoTest, GeneratesParts) {
+  const FileDescriptor* file = TestSplitA::descriptor()->file();
+  CppGenerator generator;
+  InMemoryGeneratorContext context;
+  string error;
+  ASSERT_TRUE(generator.Generate(file, "split_into=3", &context, &error));
+
+  const string basename = "google/protobuf/unittest_split.pb";
+  ASSERT_EQ(5, context.files_.size());
+  EXPECT_EQ(1, context.files_.count(basename + ".h"));
+  EXPECT_EQ(1, context.files_.count(basename + ".cc"));
+  EXPECT_EQ(1, context.files_.count(basename + ".1.cc"));
+  EXPECT_EQ(1, context.files_.count(basename + ".2.cc"));
+  EXPECT_EQ(1, context.files_.count(basename + ".3.cc"));
+
+  // Messages are split in declaration order, and the main part only has the
+  // registration code.
+  EXPECT_EQ(basename + ".1.cc",
+            FileDefiningClass(context.files_, "TestSplitA"));
+  EXPECT_EQ(basename + ".1.cc",
+            FileDefiningClass(context.files_, "TestSplitA_NestedMessage"));
+  EXPECT_EQ(basename + ".2.cc",
+            FileDefiningClass(context.files_, "TestSplitB"));
+  EXPECT_EQ(basename + ".3.cc",
+            FileDefiningClass(context.files_, "TestSplitC"));
+  const string& main_part = context.files_[basename + ".cc"];
+  EXPECT_NE(string::npos, main_part.find("protobuf_AddDesc_"));
+  EXPECT_NE(string::npos, main_part.find("TestSplitEnum_descriptor()"));
+
+  // The output is the same every time.
+  InMemoryGeneratorContext context2;
+  ASSERT_TRUE(generator.Generate(file, "split_into=3", &context2, &error));
+  EXPECT_TRUE(context.files_ == context2.files_);
+}
+
+TEST(SplitIntoTest, MorePartsThanMessages) {
+  const FileDescriptor* file = TestSplitA::descriptor()->file();
+  CppGenerator generator;
+  InMemoryGeneratorContext context;
+  string error;
+  ASSERT_TRUE(generator.Generate(file, "split_into=8", &context, &error));
+
+  // Every part is written, so that build rules can list them up front.
+  const string basename = "google/protobuf/unittest_split.pb";
+  ASSERT_EQ(10, context.files_.size());
+  for (int i = 1; i <= 8; i++) {
+    EXPECT_EQ(1, context.files_.count(basename + "." + SimpleItoa(i) + ".cc"));
+  }
+  EXPECT_NE("", FileDefiningClass(context.files_, "TestSplitA"));
+  EXPECT_NE("", FileDefiningClass(context.files_, "TestSplitB"));
+  EXPECT_NE("", FileDefiningClass(context.files_, "TestSplitC"));
+}
+
+TEST(SplitIntoTest, InvalidValues) {
+  const FileDescriptor* file = TestSplitA::descriptor()->file();
+  CppGenerator generator;
+  InMemoryGeneratorContext context;
+  string error;
+  EXPECT_FALSE(generator.Generate(file, "split_into=0", &context, &error));
+  EXPECT_EQ("Invalid value for split_into: 0", error);
+  EXPECT_FALSE(generator.Generate(file, "split_into=two", &context, &error));
+  EXPECT_EQ("Invalid value for split_into: two", error);
+}
+
+// The rest of the tests use unittest_split.proto, which is compiled with
+// split_into=3.
+
+TEST(SplitIntoTest, DefaultInstances) {
+  const TestSplitA& a = TestSplitA::default_instance();
+  EXPECT_EQ("a", a.optional_string());
+  EXPECT_EQ(TestSplitA::BAR, a.optional_nested_enum());
+  EXPECT_EQ(&TestSplitC::default_instance(), &a.optional_split_c());
+  EXPECT_EQ(&a, &TestSplitC::default_instance().optional_split_a());
+  EXPECT_EQ(protobuf_unittest::FOREIGN_BAZ,
+            TestSplitC::default_instance().optional_foreign_enum());
+  EXPECT_EQ(&TestSplitA::default_instance(),
+            &TestSplitB::default_instance().oneof_split_a());
+}
+
+TEST(SplitIntoTest, SerializeAndParse) {
+  TestSplitB message;
+  (*message.mutable_map_int32_message())[1].set_bb(2);
+  (*message.mutable_map_string_enum())["foo"] = TestSplitA::FOO;
+  TestSplitA* a = message.mutable_oneof_split_a();
+  a->set_optional_int32(3);
+  a->mutable_optional_split_c()->mutable_optional_foreign_message()->set_c(4);
+  a->add_repeated_nested_message()->set_bb(5);
+  a->SetExtension(protobuf_unittest::split_extension, 6);
+  a->MutableExtension(TestSplitB::nested_extension)->set_oneof_uint32(7);
+
+  string data;
+  ASSERT_TRUE(message.SerializeToString(&data));
+  TestSplitB parsed;
+  ASSERT_TRUE(parsed.ParseFromString(data));
+  EXPECT_EQ(message.DebugString(), parsed.DebugString());
+  EXPECT_EQ(2, parsed.map_int32_message().at(1).bb());
+  EXPECT_EQ(6, parsed.oneof_split_a().GetExtension(
+      protobuf_unittest::split_extension));
+  EXPECT_EQ(7, parsed.oneof_split_a().GetExtension(
+      TestSplitB::nested_extension).oneof_uint32());
+}
+
+TEST(SplitIntoTest, Reflection) {
+  TestSplitA message;
+  const Descriptor* descriptor = message.GetDescriptor();
+  EXPECT_EQ(TestSplitA::descriptor(), descriptor);
+  EXPECT_EQ("protobuf_unittest.TestSplitA", descriptor->full_name());
+  EXPECT_EQ(TestSplitA::NestedEnum_descriptor(),
+            descriptor->FindEnumTypeByName("NestedEnum"));
+  EXPECT_EQ(&TestSplitA::default_instance(),
+            MessageFactory::generated_factory()->GetPrototype(descriptor));
+
+  const Reflection* reflection = message.GetReflection();
+  reflection->SetInt32(&message, descriptor->FindFieldByName("optional_int32"),
+                       10);
+  EXPECT_EQ(10, message.optional_int32());
+
+  TestSplitB b;
+  b.set_oneof_string("foo");
+  const FieldDescriptor* field =
+      TestSplitB::descriptor()->FindFieldByName("oneof_string");
+  EXPECT_EQ("foo", b.GetReflection()->GetString(b, field));
+  b.clear_oneof_string();
+  EXPECT_EQ("", b.GetReflection()->GetString(b, field));
+}
+
+}  // namespace
+
+}  // namespace cpp
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
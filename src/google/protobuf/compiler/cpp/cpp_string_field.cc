@@ -410,6 +410,30 @@ GenerateByteSize(io::Printer* printer) const {
     "    this->$name$());\n");
 }
 
+void StringFieldGenerator::
+GenerateSpaceUsed(io::Printer* printer) const {
+  // The field points at the default value until it is first set; only a
+  // string of its own costs extra memory.
+  printer->Print(variables_,
+    "if (&this->$name$() != $default_variable$) {\n"
+    "  total_size += sizeof(::std::string) +\n"
+    "    ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->$name$());\n"
+    "}\n");
+}
+
+void StringFieldGenerator::
+GenerateStructuralHash(io::Printer* printer) const {
+  printer->Print(variables_,
+    "hash += ::google::protobuf::internal::HashCombine(\n"
+    "    $number$, ::google::protobuf::internal::HashValue(this->$name$()));\n");
+}
+
+void StringFieldGenerator::
+GenerateStructuralEquals(io::Printer* printer) const {
+  printer->Print(variables_,
+    "if (this->$name$() != other.$name$()) return false;\n");
+}
+
 // ===================================================================
 
 StringOneofFieldGenerator::
@@ -657,6 +681,14 @@ RepeatedStringFieldGenerator(const FieldDescriptor* descriptor,
                              const Options& options)
   : descriptor_(descriptor) {
   SetStringVariables(descriptor, &variables_, options);
+  if (options.inline_repeated > 0) {
+    variables_["storage_type"] = StrCat(
+        "::google::protobuf::internal::InlinedRepeatedPtrField< ::std::string, ",
+        SimpleItoa(options.inline_repeated), ">");
+  } else {
+    variables_["storage_type"] =
+        "::google::protobuf::RepeatedPtrField< ::std::string>";
+  }
 }
 
 RepeatedStringFieldGenerator::~RepeatedStringFieldGenerator() {}
@@ -664,7 +696,7 @@ RepeatedStringFieldGenerator::~RepeatedStringFieldGenerator() {}
 void RepeatedStringFieldGenerator::
 GeneratePrivateMembers(io::Printer* printer) const {
   printer->Print(variables_,
-    "::google::protobuf::RepeatedPtrField< ::std::string> $name$_;\n");
+    "$storage_type$ $name$_;\n");
 }
 
 void RepeatedStringFieldGenerator::
@@ -842,6 +874,31 @@ GenerateByteSize(io::Printer* printer) const {
     "}\n");
 }
 
+void RepeatedStringFieldGenerator::
+GenerateSpaceUsed(io::Printer* printer) const {
+  printer->Print(variables_,
+    "total_size += $name$_.SpaceUsedExcludingSelfLong();\n");
+}
+
+void RepeatedStringFieldGenerator::
+GenerateStructuralHash(io::Printer* printer) const {
+  printer->Print(variables_,
+    "if (this->$name$_size() > 0) {\n"
+    "  hash += ::google::protobuf::internal::HashCombine(\n"
+    "      $number$,\n"
+    "      ::google::protobuf::internal::HashRepeatedValues(this->$name$()));\n"
+    "}\n");
+}
+
+void RepeatedStringFieldGenerator::
+GenerateStructuralEquals(io::Printer* printer) const {
+  printer->Print(variables_,
+    "if (!::google::protobuf::internal::RepeatedStringsEqual(\n"
+    "        this->$name$(), other.$name$())) {\n"
+    "  return false;\n"
+    "}\n");
+}
+
 }  // namespace cpp
 }  // namespace compiler
 }  // namespace protobuf
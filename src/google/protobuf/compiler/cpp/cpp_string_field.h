@@ -67,6 +67,9 @@ class StringFieldGenerator : public FieldGenerator {
   void GenerateSerializeWithCachedSizes(io::Printer* printer) const;
   void GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const;
   void GenerateByteSize(io::Printer* printer) const;
+  void GenerateSpaceUsed(io::Printer* printer) const;
+  void GenerateStructuralHash(io::Printer* printer) const;
+  void GenerateStructuralEquals(io::Printer* printer) const;
 
  protected:
   const FieldDescriptor* descriptor_;
@@ -112,6 +115,9 @@ class RepeatedStringFieldGenerator : public FieldGenerator {
   void GenerateSerializeWithCachedSizes(io::Printer* printer) const;
   void GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const;
   void GenerateByteSize(io::Printer* printer) const;
+  void GenerateSpaceUsed(io::Printer* printer) const;
+  void GenerateStructuralHash(io::Printer* printer) const;
+  void GenerateStructuralEquals(io::Printer* printer) const;
 
  private:
   const FieldDescriptor* descriptor_;
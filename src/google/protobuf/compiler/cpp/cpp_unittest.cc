@@ -50,6 +50,7 @@
 #ifndef _SHARED_PTR_H
 #include <google/protobuf/stubs/shared_ptr.h>
 #endif
+#include <utility>
 #include <vector>
 
 #include <google/protobuf/unittest.pb.h>
@@ -511,6 +512,52 @@ TEST(GeneratedMessageTest, CopyAssignmentOperator) {
   TestUtil::ExpectAllFieldsSet(message2);
 }
 
+#if LANG_CXX11
+TEST(GeneratedMessageTest, MoveConstructor) {
+  unittest::TestAllTypes message1;
+  TestUtil::SetAllFields(&message1);
+  const unittest::TestAllTypes::NestedMessage* nested =
+      &message1.optional_nested_message();
+
+  unittest::TestAllTypes message2(std::move(message1));
+  TestUtil::ExpectAllFieldsSet(message2);
+  TestUtil::ExpectClear(message1);
+
+  // The sub-message was taken over, not copied.
+  EXPECT_EQ(nested, &message2.optional_nested_message());
+}
+
+TEST(GeneratedMessageTest, MoveAssignmentOperator) {
+  unittest::TestAllTypes message1;
+  TestUtil::SetAllFields(&message1);
+  const unittest::TestAllTypes::NestedMessage* nested =
+      &message1.optional_nested_message();
+
+  unittest::TestAllTypes message2;
+  message2.set_optional_int32(1);
+  message2 = std::move(message1);
+  TestUtil::ExpectAllFieldsSet(message2);
+  EXPECT_EQ(nested, &message2.optional_nested_message());
+
+  // Make sure that self-move-assignment does something sane.
+  message2.operator=(std::move(message2));
+  TestUtil::ExpectAllFieldsSet(message2);
+}
+
+TEST(GeneratedMessageTest, VectorOfMessagesMovesOnGrowth) {
+  // The move constructor is noexcept, so std::vector moves rather than copies
+  // its elements when it reallocates.
+  std::vector<unittest::TestAllTypes> messages(1);
+  TestUtil::SetAllFields(&messages[0]);
+  const unittest::TestAllTypes::NestedMessage* nested =
+      &messages[0].optional_nested_message();
+
+  messages.reserve(messages.capacity() + 1);
+  TestUtil::ExpectAllFieldsSet(messages[0]);
+  EXPECT_EQ(nested, &messages[0].optional_nested_message());
+}
+#endif  // LANG_CXX11
+
 #if !defined(PROTOBUF_TEST_NO_DESCRIPTORS) || \
     !defined(GOOGLE_PROTOBUF_NO_RTTI)
 TEST(GeneratedMessageTest, UpcastCopyFrom) {
@@ -619,6 +666,16 @@ TEST(GeneratedMessageTest, PackedFieldsSerializationToArray) {
   TestUtil::ExpectPackedFieldsSet(packed_message2);
 }
 
+TEST(GeneratedMessageTest, ByteSizeLong) {
+  unittest::TestAllTypes message;
+  TestUtil::SetAllFields(&message);
+  const MessageLite& lite = message;
+  size_t size = lite.ByteSizeLong();
+  EXPECT_EQ(static_cast<int>(size), message.ByteSize());
+  EXPECT_EQ(static_cast<int>(size), message.GetCachedSize());
+  EXPECT_EQ(size, message.SerializeAsString().size());
+}
+
 // Test the generated SerializeWithCachedSizes() by forcing the buffer to write
 // one byte at a time.
 TEST(GeneratedMessageTest, SerializationToStream) {
@@ -897,6 +954,133 @@ TEST(GeneratedMessageTest, TestOneofSpaceUsed) {
             message1.SpaceUsed());
 }
 
+TEST(GeneratedMessageTest, SpaceUsedLongMatchesReflection) {
+  // The generated SpaceUsedLong() walks the same memory that the reflection
+  // based SpaceUsed() does, so the two agree on messages without unknown
+  // fields.
+  unittest::TestAllTypes message;
+  EXPECT_EQ(sizeof(message), message.SpaceUsedLong());
+  EXPECT_EQ(message.SpaceUsed(), message.SpaceUsedLong());
+
+  TestUtil::SetAllFields(&message);
+  EXPECT_LT(sizeof(message), message.SpaceUsedLong());
+  EXPECT_EQ(message.SpaceUsed(), message.SpaceUsedLong());
+
+  unittest::TestAllExtensions extensions;
+  TestUtil::SetAllExtensions(&extensions);
+  EXPECT_LT(sizeof(extensions), extensions.SpaceUsedLong());
+  EXPECT_EQ(extensions.SpaceUsed(), extensions.SpaceUsedLong());
+
+  unittest::TestOneof2 oneof;
+  oneof.set_foo_string(string(sizeof(string) + 1, 'x'));
+  EXPECT_EQ(oneof.SpaceUsed(), oneof.SpaceUsedLong());
+  oneof.mutable_foo_message()->add_corge_int(1);
+  EXPECT_EQ(oneof.SpaceUsed(), oneof.SpaceUsedLong());
+}
+
+TEST(GeneratedMessageTest, SpaceUsedLongCountsUnknownFields) {
+  unittest::TestAllTypes message;
+  TestUtil::SetAllFields(&message);
+  unittest::TestEmptyMessage empty_message;
+  ASSERT_TRUE(empty_message.ParseFromString(message.SerializeAsString()));
+  EXPECT_EQ(sizeof(empty_message) + empty_message.unknown_fields().SpaceUsed(),
+            empty_message.SpaceUsedLong());
+}
+
+TEST(GeneratedMessageTest, SpaceUsedLongOfDefaultInstance) {
+  // The default instance does not own its sub-messages.
+  EXPECT_EQ(sizeof(unittest::TestAllTypes),
+            unittest::TestAllTypes::default_instance().SpaceUsedLong());
+}
+
+TEST(GeneratedMessageTest, StructuralHashMatchesReflection) {
+  unittest::TestAllTypes message;
+  EXPECT_EQ(0u, MessageHash(message));
+  TestUtil::SetAllFields(&message);
+
+  DynamicMessageFactory factory;
+  google::protobuf::scoped_ptr<Message> dynamic_message(
+      factory.GetPrototype(message.GetDescriptor())->New());
+  dynamic_message->CopyFrom(message);
+  EXPECT_EQ(MessageHash(message), MessageHash(*dynamic_message));
+  EXPECT_TRUE(MessageEquals(message, *dynamic_message));
+  EXPECT_TRUE(MessageEquals(*dynamic_message, message));
+
+  unittest::TestAllExtensions extensions;
+  TestUtil::SetAllExtensions(&extensions);
+  EXPECT_EQ(extensions.Message::StructuralHash(), MessageHash(extensions));
+
+  unittest::TestOneof2 oneof;
+  oneof.mutable_foo_message()->add_corge_int(1);
+  EXPECT_EQ(oneof.Message::StructuralHash(), MessageHash(oneof));
+}
+
+TEST(GeneratedMessageTest, StructurallyEquals) {
+  unittest::TestAllTypes message1, message2;
+  EXPECT_TRUE(MessageEquals(message1, message2));
+  TestUtil::SetAllFields(&message1);
+  EXPECT_FALSE(MessageEquals(message1, message2));
+  TestUtil::SetAllFields(&message2);
+  EXPECT_TRUE(MessageEquals(message1, message2));
+  EXPECT_EQ(MessageHash(message1), MessageHash(message2));
+
+  message2.mutable_optional_nested_message()->set_bb(1000);
+  EXPECT_FALSE(MessageEquals(message1, message2));
+  EXPECT_NE(MessageHash(message1), MessageHash(message2));
+
+  // Setting a field to its default value still makes it present.
+  message1.Clear();
+  message2.Clear();
+  message2.set_optional_int32(0);
+  EXPECT_FALSE(MessageEquals(message1, message2));
+
+  // Floating-point values compare bitwise.
+  message1.set_optional_double(-0.0);
+  message2.Clear();
+  message2.set_optional_double(0.0);
+  EXPECT_FALSE(MessageEquals(message1, message2));
+
+  // Messages of different types are never equal.
+  unittest::TestAllExtensions extensions;
+  EXPECT_FALSE(MessageEquals(unittest::TestEmptyMessage(), extensions));
+}
+
+TEST(GeneratedMessageTest, StructurallyEqualsExtensions) {
+  unittest::TestAllExtensions message1, message2;
+  TestUtil::SetAllExtensions(&message1);
+  TestUtil::SetAllExtensions(&message2);
+  EXPECT_TRUE(MessageEquals(message1, message2));
+  EXPECT_EQ(MessageHash(message1), MessageHash(message2));
+
+  message2.ClearExtension(unittest::optional_int32_extension);
+  EXPECT_FALSE(MessageEquals(message1, message2));
+  EXPECT_NE(MessageHash(message1), MessageHash(message2));
+  message2.SetExtension(unittest::optional_int32_extension,
+                        message1.GetExtension(
+                            unittest::optional_int32_extension));
+  EXPECT_TRUE(MessageEquals(message1, message2));
+}
+
+TEST(GeneratedMessageTest, StructurallyEqualsIgnoresUnknownFieldOrder) {
+  // Two unknown fields with different numbers, written in either order.
+  unittest::TestEmptyMessage message1, message2;
+  message1.mutable_unknown_fields()->AddVarint(1, 2);
+  message1.mutable_unknown_fields()->AddLengthDelimited(2, "foo");
+  message1.mutable_unknown_fields()->AddVarint(1, 3);
+  message2.mutable_unknown_fields()->AddLengthDelimited(2, "foo");
+  message2.mutable_unknown_fields()->AddVarint(1, 2);
+  message2.mutable_unknown_fields()->AddVarint(1, 3);
+  EXPECT_TRUE(MessageEquals(message1, message2));
+  EXPECT_EQ(MessageHash(message1), MessageHash(message2));
+
+  // But repeated occurrences of one number keep their order.
+  message2.Clear();
+  message2.mutable_unknown_fields()->AddVarint(1, 3);
+  message2.mutable_unknown_fields()->AddLengthDelimited(2, "foo");
+  message2.mutable_unknown_fields()->AddVarint(1, 2);
+  EXPECT_FALSE(MessageEquals(message1, message2));
+}
+
 #endif  // !PROTOBUF_TEST_NO_DESCRIPTORS
 
 
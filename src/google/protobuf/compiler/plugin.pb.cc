@@ -408,7 +408,11 @@ void CodeGeneratorRequest::SerializeWithCachedSizes(
 }
 
 int CodeGeneratorRequest::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t CodeGeneratorRequest::ByteSizeLong() const {
+  size_t total_size = 0;
 
   // optional string parameter = 2;
   if (has_parameter()) {
@@ -437,12 +441,88 @@ int CodeGeneratorRequest::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
+size_t CodeGeneratorRequest::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  total_size += file_to_generate_.SpaceUsedExcludingSelfLong();
+  if (&this->parameter() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->parameter());
+  }
+  total_size += proto_file_.SpaceUsedExcludingSelfLong();
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 CodeGeneratorRequest::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (this->file_to_generate_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        1,
+        ::google::protobuf::internal::HashRepeatedValues(this->file_to_generate()));
+  }
+  if (has_parameter()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        2, ::google::protobuf::internal::HashValue(this->parameter()));
+  }
+  if (this->proto_file_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        15,
+        ::google::protobuf::internal::HashRepeatedMessages(this->proto_file()));
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool CodeGeneratorRequest::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const CodeGeneratorRequest* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const CodeGeneratorRequest*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool CodeGeneratorRequest::StructurallyEquals(const CodeGeneratorRequest& other) const {
+  if (&other == this) return true;
+
+  if (!::google::protobuf::internal::RepeatedStringsEqual(
+          this->file_to_generate(), other.file_to_generate())) {
+    return false;
+  }
+  if (has_parameter() != other.has_parameter()) return false;
+  if (has_parameter()) {
+    if (this->parameter() != other.parameter()) return false;
+  }
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->proto_file(), other.proto_file())) {
+    return false;
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
 void CodeGeneratorRequest::MergeFrom(const ::google::protobuf::Message& from) {
   if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
   const CodeGeneratorRequest* source =
@@ -767,7 +847,11 @@ void CodeGeneratorResponse_File::SerializeWithCachedSizes(
 }
 
 int CodeGeneratorResponse_File::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t CodeGeneratorResponse_File::ByteSizeLong() const {
+  size_t total_size = 0;
 
   if (_has_bits_[0 / 32] & 7) {
     // optional string name = 1;
@@ -797,12 +881,92 @@ int CodeGeneratorResponse_File::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
+size_t CodeGeneratorResponse_File::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  if (&this->name() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->name());
+  }
+  if (&this->insertion_point() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->insertion_point());
+  }
+  if (&this->content() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->content());
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 CodeGeneratorResponse_File::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (has_name()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        1, ::google::protobuf::internal::HashValue(this->name()));
+  }
+  if (has_insertion_point()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        2, ::google::protobuf::internal::HashValue(this->insertion_point()));
+  }
+  if (has_content()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        15, ::google::protobuf::internal::HashValue(this->content()));
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool CodeGeneratorResponse_File::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const CodeGeneratorResponse_File* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const CodeGeneratorResponse_File*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool CodeGeneratorResponse_File::StructurallyEquals(const CodeGeneratorResponse_File& other) const {
+  if (&other == this) return true;
+
+  if (has_name() != other.has_name()) return false;
+  if (has_name()) {
+    if (this->name() != other.name()) return false;
+  }
+  if (has_insertion_point() != other.has_insertion_point()) return false;
+  if (has_insertion_point()) {
+    if (this->insertion_point() != other.insertion_point()) return false;
+  }
+  if (has_content() != other.has_content()) return false;
+  if (has_content()) {
+    if (this->content() != other.content()) return false;
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
 void CodeGeneratorResponse_File::MergeFrom(const ::google::protobuf::Message& from) {
   if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
   const CodeGeneratorResponse_File* source =
@@ -1071,7 +1235,11 @@ void CodeGeneratorResponse::SerializeWithCachedSizes(
 }
 
 int CodeGeneratorResponse::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t CodeGeneratorResponse::ByteSizeLong() const {
+  size_t total_size = 0;
 
   // optional string error = 1;
   if (has_error()) {
@@ -1093,12 +1261,78 @@ int CodeGeneratorResponse::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
+size_t CodeGeneratorResponse::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  if (&this->error() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->error());
+  }
+  total_size += file_.SpaceUsedExcludingSelfLong();
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 CodeGeneratorResponse::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (has_error()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        1, ::google::protobuf::internal::HashValue(this->error()));
+  }
+  if (this->file_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        15,
+        ::google::protobuf::internal::HashRepeatedMessages(this->file()));
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool CodeGeneratorResponse::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const CodeGeneratorResponse* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const CodeGeneratorResponse*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool CodeGeneratorResponse::StructurallyEquals(const CodeGeneratorResponse& other) const {
+  if (&other == this) return true;
+
+  if (has_error() != other.has_error()) return false;
+  if (has_error()) {
+    if (this->error() != other.error()) return false;
+  }
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->file(), other.file())) {
+    return false;
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
 void CodeGeneratorResponse::MergeFrom(const ::google::protobuf::Message& from) {
   if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
   const CodeGeneratorResponse* source =
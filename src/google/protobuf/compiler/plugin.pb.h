@@ -57,6 +57,18 @@ class LIBPROTOC_EXPORT CodeGeneratorRequest : public ::google::protobuf::Message
     return *this;
   }
 
+  #if LANG_CXX11
+  CodeGeneratorRequest(CodeGeneratorRequest&& from) noexcept
+    : CodeGeneratorRequest() {
+    *this = ::std::move(from);
+  }
+
+  inline CodeGeneratorRequest& operator=(CodeGeneratorRequest&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -83,10 +95,15 @@ class LIBPROTOC_EXPORT CodeGeneratorRequest : public ::google::protobuf::Message
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const CodeGeneratorRequest& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -181,6 +198,18 @@ class LIBPROTOC_EXPORT CodeGeneratorResponse_File : public ::google::protobuf::M
     return *this;
   }
 
+  #if LANG_CXX11
+  CodeGeneratorResponse_File(CodeGeneratorResponse_File&& from) noexcept
+    : CodeGeneratorResponse_File() {
+    *this = ::std::move(from);
+  }
+
+  inline CodeGeneratorResponse_File& operator=(CodeGeneratorResponse_File&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -207,10 +236,15 @@ class LIBPROTOC_EXPORT CodeGeneratorResponse_File : public ::google::protobuf::M
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const CodeGeneratorResponse_File& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -305,6 +339,18 @@ class LIBPROTOC_EXPORT CodeGeneratorResponse : public ::google::protobuf::Messag
     return *this;
   }
 
+  #if LANG_CXX11
+  CodeGeneratorResponse(CodeGeneratorResponse&& from) noexcept
+    : CodeGeneratorResponse() {
+    *this = ::std::move(from);
+  }
+
+  inline CodeGeneratorResponse& operator=(CodeGeneratorResponse&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -331,10 +377,15 @@ class LIBPROTOC_EXPORT CodeGeneratorResponse : public ::google::protobuf::Messag
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const CodeGeneratorResponse& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -1126,6 +1126,12 @@ void DescriptorPool::InternalAddGeneratedFile(
   GOOGLE_CHECK(generated_database_->Add(encoded_file_descriptor, size));
 }
 
+void DescriptorPool::InternalAddGeneratedFileDeferred(
+    const void* encoded_file_descriptor, int size) {
+  InitGeneratedPoolOnce();
+  generated_database_->AddDeferred(encoded_file_descriptor, size);
+}
+
 
 // Find*By* methods ==================================================
 
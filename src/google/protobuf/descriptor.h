@@ -1446,6 +1446,12 @@ class LIBPROTOBUF_EXPORT DescriptorPool {
   static void InternalAddGeneratedFile(
       const void* encoded_file_descriptor, int size);
 
+  // Like InternalAddGeneratedFile(), but the bytes are not parsed until
+  // generated_pool is first searched.  Used by code generated with the
+  // lazy_init option, to keep static initialization cheap.
+  static void InternalAddGeneratedFileDeferred(
+      const void* encoded_file_descriptor, int size);
+
 
   // For internal use only:  Gets a non-const pointer to the generated pool.
   // This is called at static-initialization time only, so thread-safety is
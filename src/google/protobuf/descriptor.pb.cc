@@ -931,7 +931,11 @@ void FileDescriptorSet::SerializeWithCachedSizes(
 }
 
 int FileDescriptorSet::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t FileDescriptorSet::ByteSizeLong() const {
+  size_t total_size = 0;
 
   // repeated .google.protobuf.FileDescriptorProto file = 1;
   total_size += 1 * this->file_size();
@@ -946,12 +950,66 @@ int FileDescriptorSet::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
+size_t FileDescriptorSet::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  total_size += file_.SpaceUsedExcludingSelfLong();
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 FileDescriptorSet::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (this->file_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        1,
+        ::google::protobuf::internal::HashRepeatedMessages(this->file()));
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool FileDescriptorSet::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const FileDescriptorSet* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const FileDescriptorSet*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool FileDescriptorSet::StructurallyEquals(const FileDescriptorSet& other) const {
+  if (&other == this) return true;
+
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->file(), other.file())) {
+    return false;
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
 void FileDescriptorSet::MergeFrom(const ::google::protobuf::Message& from) {
   if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
   const FileDescriptorSet* source =
@@ -1558,7 +1616,11 @@ void FileDescriptorProto::SerializeWithCachedSizes(
 }
 
 int FileDescriptorProto::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t FileDescriptorProto::ByteSizeLong() const {
+  size_t total_size = 0;
 
   if (_has_bits_[0 / 32] & 3) {
     // optional string name = 1;
@@ -1663,12 +1725,184 @@ int FileDescriptorProto::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
+size_t FileDescriptorProto::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  if (&this->name() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->name());
+  }
+  if (&this->package() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->package());
+  }
+  total_size += dependency_.SpaceUsedExcludingSelfLong();
+  total_size += public_dependency_.SpaceUsedExcludingSelfLong();
+  total_size += weak_dependency_.SpaceUsedExcludingSelfLong();
+  total_size += message_type_.SpaceUsedExcludingSelfLong();
+  total_size += enum_type_.SpaceUsedExcludingSelfLong();
+  total_size += service_.SpaceUsedExcludingSelfLong();
+  total_size += extension_.SpaceUsedExcludingSelfLong();
+  if (this->options_ != NULL) {
+    total_size += this->options_->SpaceUsedLong();
+  }
+  if (this->source_code_info_ != NULL) {
+    total_size += this->source_code_info_->SpaceUsedLong();
+  }
+  if (&this->syntax() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->syntax());
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 FileDescriptorProto::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (has_name()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        1, ::google::protobuf::internal::HashValue(this->name()));
+  }
+  if (has_package()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        2, ::google::protobuf::internal::HashValue(this->package()));
+  }
+  if (this->dependency_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        3,
+        ::google::protobuf::internal::HashRepeatedValues(this->dependency()));
+  }
+  if (this->public_dependency_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        10,
+        ::google::protobuf::internal::HashRepeatedValues(this->public_dependency()));
+  }
+  if (this->weak_dependency_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        11,
+        ::google::protobuf::internal::HashRepeatedValues(this->weak_dependency()));
+  }
+  if (this->message_type_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        4,
+        ::google::protobuf::internal::HashRepeatedMessages(this->message_type()));
+  }
+  if (this->enum_type_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        5,
+        ::google::protobuf::internal::HashRepeatedMessages(this->enum_type()));
+  }
+  if (this->service_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        6,
+        ::google::protobuf::internal::HashRepeatedMessages(this->service()));
+  }
+  if (this->extension_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        7,
+        ::google::protobuf::internal::HashRepeatedMessages(this->extension()));
+  }
+  if (has_options()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        8, this->options().StructuralHash());
+  }
+  if (has_source_code_info()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        9, this->source_code_info().StructuralHash());
+  }
+  if (has_syntax()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        12, ::google::protobuf::internal::HashValue(this->syntax()));
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool FileDescriptorProto::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const FileDescriptorProto* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const FileDescriptorProto*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool FileDescriptorProto::StructurallyEquals(const FileDescriptorProto& other) const {
+  if (&other == this) return true;
+
+  if (has_name() != other.has_name()) return false;
+  if (has_name()) {
+    if (this->name() != other.name()) return false;
+  }
+  if (has_package() != other.has_package()) return false;
+  if (has_package()) {
+    if (this->package() != other.package()) return false;
+  }
+  if (!::google::protobuf::internal::RepeatedStringsEqual(
+          this->dependency(), other.dependency())) {
+    return false;
+  }
+  if (!::google::protobuf::internal::RepeatedPrimitivesEqual(
+          this->public_dependency(), other.public_dependency())) {
+    return false;
+  }
+  if (!::google::protobuf::internal::RepeatedPrimitivesEqual(
+          this->weak_dependency(), other.weak_dependency())) {
+    return false;
+  }
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->message_type(), other.message_type())) {
+    return false;
+  }
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->enum_type(), other.enum_type())) {
+    return false;
+  }
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->service(), other.service())) {
+    return false;
+  }
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->extension(), other.extension())) {
+    return false;
+  }
+  if (has_options() != other.has_options()) return false;
+  if (has_options()) {
+    if (!this->options().StructurallyEquals(other.options())) return false;
+  }
+  if (has_source_code_info() != other.has_source_code_info()) return false;
+  if (has_source_code_info()) {
+    if (!this->source_code_info().StructurallyEquals(other.source_code_info())) return false;
+  }
+  if (has_syntax() != other.has_syntax()) return false;
+  if (has_syntax()) {
+    if (this->syntax() != other.syntax()) return false;
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
 void FileDescriptorProto::MergeFrom(const ::google::protobuf::Message& from) {
   if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
   const FileDescriptorProto* source =
@@ -1924,14 +2158,20 @@ failure:
 void DescriptorProto_ExtensionRange::SerializeWithCachedSizes(
     ::google::protobuf::io::CodedOutputStream* output) const {
   // @@protoc_insertion_point(serialize_start:google.protobuf.DescriptorProto.ExtensionRange)
-  // optional int32 start = 1;
-  if (has_start()) {
-    ::google::protobuf::internal::WireFormatLite::WriteInt32(1, this->start(), output);
-  }
+  {
+    ::google::protobuf::uint8* target = output->BeginFastWrite();
 
-  // optional int32 end = 2;
-  if (has_end()) {
-    ::google::protobuf::internal::WireFormatLite::WriteInt32(2, this->end(), output);
+    // optional int32 start = 1;
+    if (has_start()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(1, this->start(), target);
+    }
+
+    // optional int32 end = 2;
+    if (has_end()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(2, this->end(), target);
+    }
+
+    output->EndFastWrite(target);
   }
 
   if (_internal_metadata_.have_unknown_fields()) {
@@ -1963,7 +2203,11 @@ void DescriptorProto_ExtensionRange::SerializeWithCachedSizes(
 }
 
 int DescriptorProto_ExtensionRange::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t DescriptorProto_ExtensionRange::ByteSizeLong() const {
+  size_t total_size = 0;
 
   if (_has_bits_[0 / 32] & 3) {
     // optional int32 start = 1;
@@ -1986,12 +2230,78 @@ int DescriptorProto_ExtensionRange::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
+size_t DescriptorProto_ExtensionRange::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 DescriptorProto_ExtensionRange::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (has_start()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        1, ::google::protobuf::internal::HashValue(this->start()));
+  }
+  if (has_end()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        2, ::google::protobuf::internal::HashValue(this->end()));
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool DescriptorProto_ExtensionRange::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const DescriptorProto_ExtensionRange* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const DescriptorProto_ExtensionRange*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool DescriptorProto_ExtensionRange::StructurallyEquals(const DescriptorProto_ExtensionRange& other) const {
+  if (&other == this) return true;
+
+  if (has_start() != other.has_start()) return false;
+  if (has_start()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->start(), other.start())) {
+      return false;
+    }
+  }
+  if (has_end() != other.has_end()) return false;
+  if (has_end()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->end(), other.end())) {
+      return false;
+    }
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
 void DescriptorProto_ExtensionRange::MergeFrom(const ::google::protobuf::Message& from) {
   if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
   const DescriptorProto_ExtensionRange* source =
@@ -2433,7 +2743,11 @@ void DescriptorProto::SerializeWithCachedSizes(
 }
 
 int DescriptorProto::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t DescriptorProto::ByteSizeLong() const {
+  size_t total_size = 0;
 
   if (_has_bits_[0 / 32] & 129) {
     // optional string name = 1;
@@ -2504,12 +2818,139 @@ int DescriptorProto::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
+size_t DescriptorProto::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  if (&this->name() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->name());
+  }
+  total_size += field_.SpaceUsedExcludingSelfLong();
+  total_size += extension_.SpaceUsedExcludingSelfLong();
+  total_size += nested_type_.SpaceUsedExcludingSelfLong();
+  total_size += enum_type_.SpaceUsedExcludingSelfLong();
+  total_size += extension_range_.SpaceUsedExcludingSelfLong();
+  total_size += oneof_decl_.SpaceUsedExcludingSelfLong();
+  if (this->options_ != NULL) {
+    total_size += this->options_->SpaceUsedLong();
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 DescriptorProto::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (has_name()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        1, ::google::protobuf::internal::HashValue(this->name()));
+  }
+  if (this->field_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        2,
+        ::google::protobuf::internal::HashRepeatedMessages(this->field()));
+  }
+  if (this->extension_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        6,
+        ::google::protobuf::internal::HashRepeatedMessages(this->extension()));
+  }
+  if (this->nested_type_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        3,
+        ::google::protobuf::internal::HashRepeatedMessages(this->nested_type()));
+  }
+  if (this->enum_type_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        4,
+        ::google::protobuf::internal::HashRepeatedMessages(this->enum_type()));
+  }
+  if (this->extension_range_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        5,
+        ::google::protobuf::internal::HashRepeatedMessages(this->extension_range()));
+  }
+  if (this->oneof_decl_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        8,
+        ::google::protobuf::internal::HashRepeatedMessages(this->oneof_decl()));
+  }
+  if (has_options()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        7, this->options().StructuralHash());
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool DescriptorProto::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const DescriptorProto* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const DescriptorProto*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool DescriptorProto::StructurallyEquals(const DescriptorProto& other) const {
+  if (&other == this) return true;
+
+  if (has_name() != other.has_name()) return false;
+  if (has_name()) {
+    if (this->name() != other.name()) return false;
+  }
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->field(), other.field())) {
+    return false;
+  }
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->extension(), other.extension())) {
+    return false;
+  }
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->nested_type(), other.nested_type())) {
+    return false;
+  }
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->enum_type(), other.enum_type())) {
+    return false;
+  }
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->extension_range(), other.extension_range())) {
+    return false;
+  }
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->oneof_decl(), other.oneof_decl())) {
+    return false;
+  }
+  if (has_options() != other.has_options()) return false;
+  if (has_options()) {
+    if (!this->options().StructurallyEquals(other.options())) return false;
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
 void DescriptorProto::MergeFrom(const ::google::protobuf::Message& from) {
   if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
   const DescriptorProto* source =
@@ -2991,21 +3432,27 @@ void FieldDescriptorProto::SerializeWithCachedSizes(
       2, this->extendee(), output);
   }
 
-  // optional int32 number = 3;
-  if (has_number()) {
-    ::google::protobuf::internal::WireFormatLite::WriteInt32(3, this->number(), output);
-  }
+  {
+    ::google::protobuf::uint8* target = output->BeginFastWrite();
 
-  // optional .google.protobuf.FieldDescriptorProto.Label label = 4;
-  if (has_label()) {
-    ::google::protobuf::internal::WireFormatLite::WriteEnum(
-      4, this->label(), output);
-  }
+    // optional int32 number = 3;
+    if (has_number()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(3, this->number(), target);
+    }
 
-  // optional .google.protobuf.FieldDescriptorProto.Type type = 5;
-  if (has_type()) {
-    ::google::protobuf::internal::WireFormatLite::WriteEnum(
-      5, this->type(), output);
+    // optional .google.protobuf.FieldDescriptorProto.Label label = 4;
+    if (has_label()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteEnumToArray(
+        4, this->label(), target);
+    }
+
+    // optional .google.protobuf.FieldDescriptorProto.Type type = 5;
+    if (has_type()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteEnumToArray(
+        5, this->type(), target);
+    }
+
+    output->EndFastWrite(target);
   }
 
   // optional string type_name = 6;
@@ -3131,7 +3578,11 @@ void FieldDescriptorProto::SerializeWithCachedSizes(
 }
 
 int FieldDescriptorProto::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t FieldDescriptorProto::ByteSizeLong() const {
+  size_t total_size = 0;
 
   if (_has_bits_[0 / 32] & 255) {
     // optional string name = 1;
@@ -3201,76 +3652,217 @@ int FieldDescriptorProto::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
-void FieldDescriptorProto::MergeFrom(const ::google::protobuf::Message& from) {
-  if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
-  const FieldDescriptorProto* source =
-    ::google::protobuf::internal::dynamic_cast_if_available<const FieldDescriptorProto*>(
-      &from);
-  if (source == NULL) {
-    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
-  } else {
-    MergeFrom(*source);
-  }
-}
+size_t FieldDescriptorProto::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
 
-void FieldDescriptorProto::MergeFrom(const FieldDescriptorProto& from) {
-  if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
-  if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
-    if (from.has_name()) {
-      set_has_name();
-      name_.AssignWithDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), from.name_);
-    }
-    if (from.has_number()) {
-      set_number(from.number());
-    }
-    if (from.has_label()) {
-      set_label(from.label());
-    }
-    if (from.has_type()) {
-      set_type(from.type());
-    }
-    if (from.has_type_name()) {
-      set_has_type_name();
-      type_name_.AssignWithDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), from.type_name_);
-    }
-    if (from.has_extendee()) {
-      set_has_extendee();
-      extendee_.AssignWithDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), from.extendee_);
-    }
-    if (from.has_default_value()) {
-      set_has_default_value();
-      default_value_.AssignWithDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), from.default_value_);
-    }
-    if (from.has_oneof_index()) {
-      set_oneof_index(from.oneof_index());
-    }
+  if (&this->name() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->name());
   }
-  if (from._has_bits_[8 / 32] & (0xffu << (8 % 32))) {
-    if (from.has_options()) {
-      mutable_options()->::google::protobuf::FieldOptions::MergeFrom(from.options());
-    }
+  if (&this->type_name() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->type_name());
   }
-  if (from._internal_metadata_.have_unknown_fields()) {
-    mutable_unknown_fields()->MergeFrom(from.unknown_fields());
+  if (&this->extendee() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->extendee());
+  }
+  if (&this->default_value() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->default_value());
+  }
+  if (this->options_ != NULL) {
+    total_size += this->options_->SpaceUsedLong();
   }
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
 }
 
-void FieldDescriptorProto::CopyFrom(const ::google::protobuf::Message& from) {
-  if (&from == this) return;
-  Clear();
-  MergeFrom(from);
-}
+::google::protobuf::uint64 FieldDescriptorProto::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
 
-void FieldDescriptorProto::CopyFrom(const FieldDescriptorProto& from) {
-  if (&from == this) return;
-  Clear();
-  MergeFrom(from);
+  if (has_name()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        1, ::google::protobuf::internal::HashValue(this->name()));
+  }
+  if (has_number()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        3, ::google::protobuf::internal::HashValue(this->number()));
+  }
+  if (has_label()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        4, ::google::protobuf::internal::HashValue(this->label()));
+  }
+  if (has_type()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        5, ::google::protobuf::internal::HashValue(this->type()));
+  }
+  if (has_type_name()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        6, ::google::protobuf::internal::HashValue(this->type_name()));
+  }
+  if (has_extendee()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        2, ::google::protobuf::internal::HashValue(this->extendee()));
+  }
+  if (has_default_value()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        7, ::google::protobuf::internal::HashValue(this->default_value()));
+  }
+  if (has_oneof_index()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        9, ::google::protobuf::internal::HashValue(this->oneof_index()));
+  }
+  if (has_options()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        8, this->options().StructuralHash());
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool FieldDescriptorProto::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const FieldDescriptorProto* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const FieldDescriptorProto*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool FieldDescriptorProto::StructurallyEquals(const FieldDescriptorProto& other) const {
+  if (&other == this) return true;
+
+  if (has_name() != other.has_name()) return false;
+  if (has_name()) {
+    if (this->name() != other.name()) return false;
+  }
+  if (has_number() != other.has_number()) return false;
+  if (has_number()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->number(), other.number())) {
+      return false;
+    }
+  }
+  if (has_label() != other.has_label()) return false;
+  if (has_label()) {
+    if (this->label() != other.label()) return false;
+  }
+  if (has_type() != other.has_type()) return false;
+  if (has_type()) {
+    if (this->type() != other.type()) return false;
+  }
+  if (has_type_name() != other.has_type_name()) return false;
+  if (has_type_name()) {
+    if (this->type_name() != other.type_name()) return false;
+  }
+  if (has_extendee() != other.has_extendee()) return false;
+  if (has_extendee()) {
+    if (this->extendee() != other.extendee()) return false;
+  }
+  if (has_default_value() != other.has_default_value()) return false;
+  if (has_default_value()) {
+    if (this->default_value() != other.default_value()) return false;
+  }
+  if (has_oneof_index() != other.has_oneof_index()) return false;
+  if (has_oneof_index()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->oneof_index(), other.oneof_index())) {
+      return false;
+    }
+  }
+  if (has_options() != other.has_options()) return false;
+  if (has_options()) {
+    if (!this->options().StructurallyEquals(other.options())) return false;
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
+void FieldDescriptorProto::MergeFrom(const ::google::protobuf::Message& from) {
+  if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
+  const FieldDescriptorProto* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const FieldDescriptorProto*>(
+      &from);
+  if (source == NULL) {
+    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
+  } else {
+    MergeFrom(*source);
+  }
+}
+
+void FieldDescriptorProto::MergeFrom(const FieldDescriptorProto& from) {
+  if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
+  if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    if (from.has_name()) {
+      set_has_name();
+      name_.AssignWithDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), from.name_);
+    }
+    if (from.has_number()) {
+      set_number(from.number());
+    }
+    if (from.has_label()) {
+      set_label(from.label());
+    }
+    if (from.has_type()) {
+      set_type(from.type());
+    }
+    if (from.has_type_name()) {
+      set_has_type_name();
+      type_name_.AssignWithDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), from.type_name_);
+    }
+    if (from.has_extendee()) {
+      set_has_extendee();
+      extendee_.AssignWithDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), from.extendee_);
+    }
+    if (from.has_default_value()) {
+      set_has_default_value();
+      default_value_.AssignWithDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), from.default_value_);
+    }
+    if (from.has_oneof_index()) {
+      set_oneof_index(from.oneof_index());
+    }
+  }
+  if (from._has_bits_[8 / 32] & (0xffu << (8 % 32))) {
+    if (from.has_options()) {
+      mutable_options()->::google::protobuf::FieldOptions::MergeFrom(from.options());
+    }
+  }
+  if (from._internal_metadata_.have_unknown_fields()) {
+    mutable_unknown_fields()->MergeFrom(from.unknown_fields());
+  }
+}
+
+void FieldDescriptorProto::CopyFrom(const ::google::protobuf::Message& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+void FieldDescriptorProto::CopyFrom(const FieldDescriptorProto& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
 }
 
 bool FieldDescriptorProto::IsInitialized() const {
@@ -3476,7 +4068,11 @@ void OneofDescriptorProto::SerializeWithCachedSizes(
 }
 
 int OneofDescriptorProto::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t OneofDescriptorProto::ByteSizeLong() const {
+  size_t total_size = 0;
 
   // optional string name = 1;
   if (has_name()) {
@@ -3490,12 +4086,68 @@ int OneofDescriptorProto::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
+size_t OneofDescriptorProto::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  if (&this->name() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->name());
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 OneofDescriptorProto::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (has_name()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        1, ::google::protobuf::internal::HashValue(this->name()));
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool OneofDescriptorProto::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const OneofDescriptorProto* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const OneofDescriptorProto*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool OneofDescriptorProto::StructurallyEquals(const OneofDescriptorProto& other) const {
+  if (&other == this) return true;
+
+  if (has_name() != other.has_name()) return false;
+  if (has_name()) {
+    if (this->name() != other.name()) return false;
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
 void OneofDescriptorProto::MergeFrom(const ::google::protobuf::Message& from) {
   if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
   const OneofDescriptorProto* source =
@@ -3789,7 +4441,11 @@ void EnumDescriptorProto::SerializeWithCachedSizes(
 }
 
 int EnumDescriptorProto::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t EnumDescriptorProto::ByteSizeLong() const {
+  size_t total_size = 0;
 
   if (_has_bits_[0 / 32] & 5) {
     // optional string name = 1;
@@ -3820,12 +4476,89 @@ int EnumDescriptorProto::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
+size_t EnumDescriptorProto::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  if (&this->name() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->name());
+  }
+  total_size += value_.SpaceUsedExcludingSelfLong();
+  if (this->options_ != NULL) {
+    total_size += this->options_->SpaceUsedLong();
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 EnumDescriptorProto::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (has_name()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        1, ::google::protobuf::internal::HashValue(this->name()));
+  }
+  if (this->value_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        2,
+        ::google::protobuf::internal::HashRepeatedMessages(this->value()));
+  }
+  if (has_options()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        3, this->options().StructuralHash());
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool EnumDescriptorProto::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const EnumDescriptorProto* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const EnumDescriptorProto*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool EnumDescriptorProto::StructurallyEquals(const EnumDescriptorProto& other) const {
+  if (&other == this) return true;
+
+  if (has_name() != other.has_name()) return false;
+  if (has_name()) {
+    if (this->name() != other.name()) return false;
+  }
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->value(), other.value())) {
+    return false;
+  }
+  if (has_options() != other.has_options()) return false;
+  if (has_options()) {
+    if (!this->options().StructurallyEquals(other.options())) return false;
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
 void EnumDescriptorProto::MergeFrom(const ::google::protobuf::Message& from) {
   if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
   const EnumDescriptorProto* source =
@@ -4128,7 +4861,11 @@ void EnumValueDescriptorProto::SerializeWithCachedSizes(
 }
 
 int EnumValueDescriptorProto::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t EnumValueDescriptorProto::ByteSizeLong() const {
+  size_t total_size = 0;
 
   if (_has_bits_[0 / 32] & 7) {
     // optional string name = 1;
@@ -4158,12 +4895,90 @@ int EnumValueDescriptorProto::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
+size_t EnumValueDescriptorProto::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  if (&this->name() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->name());
+  }
+  if (this->options_ != NULL) {
+    total_size += this->options_->SpaceUsedLong();
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 EnumValueDescriptorProto::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (has_name()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        1, ::google::protobuf::internal::HashValue(this->name()));
+  }
+  if (has_number()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        2, ::google::protobuf::internal::HashValue(this->number()));
+  }
+  if (has_options()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        3, this->options().StructuralHash());
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool EnumValueDescriptorProto::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const EnumValueDescriptorProto* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const EnumValueDescriptorProto*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool EnumValueDescriptorProto::StructurallyEquals(const EnumValueDescriptorProto& other) const {
+  if (&other == this) return true;
+
+  if (has_name() != other.has_name()) return false;
+  if (has_name()) {
+    if (this->name() != other.name()) return false;
+  }
+  if (has_number() != other.has_number()) return false;
+  if (has_number()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->number(), other.number())) {
+      return false;
+    }
+  }
+  if (has_options() != other.has_options()) return false;
+  if (has_options()) {
+    if (!this->options().StructurallyEquals(other.options())) return false;
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
 void EnumValueDescriptorProto::MergeFrom(const ::google::protobuf::Message& from) {
   if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
   const EnumValueDescriptorProto* source =
@@ -4468,7 +5283,11 @@ void ServiceDescriptorProto::SerializeWithCachedSizes(
 }
 
 int ServiceDescriptorProto::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t ServiceDescriptorProto::ByteSizeLong() const {
+  size_t total_size = 0;
 
   if (_has_bits_[0 / 32] & 5) {
     // optional string name = 1;
@@ -4499,12 +5318,89 @@ int ServiceDescriptorProto::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
+size_t ServiceDescriptorProto::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  if (&this->name() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->name());
+  }
+  total_size += method_.SpaceUsedExcludingSelfLong();
+  if (this->options_ != NULL) {
+    total_size += this->options_->SpaceUsedLong();
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 ServiceDescriptorProto::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (has_name()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        1, ::google::protobuf::internal::HashValue(this->name()));
+  }
+  if (this->method_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        2,
+        ::google::protobuf::internal::HashRepeatedMessages(this->method()));
+  }
+  if (has_options()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        3, this->options().StructuralHash());
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool ServiceDescriptorProto::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const ServiceDescriptorProto* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const ServiceDescriptorProto*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool ServiceDescriptorProto::StructurallyEquals(const ServiceDescriptorProto& other) const {
+  if (&other == this) return true;
+
+  if (has_name() != other.has_name()) return false;
+  if (has_name()) {
+    if (this->name() != other.name()) return false;
+  }
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->method(), other.method())) {
+    return false;
+  }
+  if (has_options() != other.has_options()) return false;
+  if (has_options()) {
+    if (!this->options().StructurallyEquals(other.options())) return false;
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
 void ServiceDescriptorProto::MergeFrom(const ::google::protobuf::Message& from) {
   if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
   const ServiceDescriptorProto* source =
@@ -4857,14 +5753,20 @@ void MethodDescriptorProto::SerializeWithCachedSizes(
       4, *this->options_, output);
   }
 
-  // optional bool client_streaming = 5 [default = false];
-  if (has_client_streaming()) {
-    ::google::protobuf::internal::WireFormatLite::WriteBool(5, this->client_streaming(), output);
-  }
+  {
+    ::google::protobuf::uint8* target = output->BeginFastWrite();
 
-  // optional bool server_streaming = 6 [default = false];
-  if (has_server_streaming()) {
-    ::google::protobuf::internal::WireFormatLite::WriteBool(6, this->server_streaming(), output);
+    // optional bool client_streaming = 5 [default = false];
+    if (has_client_streaming()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(5, this->client_streaming(), target);
+    }
+
+    // optional bool server_streaming = 6 [default = false];
+    if (has_server_streaming()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(6, this->server_streaming(), target);
+    }
+
+    output->EndFastWrite(target);
   }
 
   if (_internal_metadata_.have_unknown_fields()) {
@@ -4936,7 +5838,11 @@ void MethodDescriptorProto::SerializeWithCachedSizes(
 }
 
 int MethodDescriptorProto::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t MethodDescriptorProto::ByteSizeLong() const {
+  size_t total_size = 0;
 
   if (_has_bits_[0 / 32] & 63) {
     // optional string name = 1;
@@ -4983,12 +5889,125 @@ int MethodDescriptorProto::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
+size_t MethodDescriptorProto::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  if (&this->name() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->name());
+  }
+  if (&this->input_type() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->input_type());
+  }
+  if (&this->output_type() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->output_type());
+  }
+  if (this->options_ != NULL) {
+    total_size += this->options_->SpaceUsedLong();
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 MethodDescriptorProto::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (has_name()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        1, ::google::protobuf::internal::HashValue(this->name()));
+  }
+  if (has_input_type()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        2, ::google::protobuf::internal::HashValue(this->input_type()));
+  }
+  if (has_output_type()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        3, ::google::protobuf::internal::HashValue(this->output_type()));
+  }
+  if (has_options()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        4, this->options().StructuralHash());
+  }
+  if (has_client_streaming()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        5, ::google::protobuf::internal::HashValue(this->client_streaming()));
+  }
+  if (has_server_streaming()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        6, ::google::protobuf::internal::HashValue(this->server_streaming()));
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool MethodDescriptorProto::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const MethodDescriptorProto* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const MethodDescriptorProto*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool MethodDescriptorProto::StructurallyEquals(const MethodDescriptorProto& other) const {
+  if (&other == this) return true;
+
+  if (has_name() != other.has_name()) return false;
+  if (has_name()) {
+    if (this->name() != other.name()) return false;
+  }
+  if (has_input_type() != other.has_input_type()) return false;
+  if (has_input_type()) {
+    if (this->input_type() != other.input_type()) return false;
+  }
+  if (has_output_type() != other.has_output_type()) return false;
+  if (has_output_type()) {
+    if (this->output_type() != other.output_type()) return false;
+  }
+  if (has_options() != other.has_options()) return false;
+  if (has_options()) {
+    if (!this->options().StructurallyEquals(other.options())) return false;
+  }
+  if (has_client_streaming() != other.has_client_streaming()) return false;
+  if (has_client_streaming()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->client_streaming(), other.client_streaming())) {
+      return false;
+    }
+  }
+  if (has_server_streaming() != other.has_server_streaming()) return false;
+  if (has_server_streaming()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->server_streaming(), other.server_streaming())) {
+      return false;
+    }
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
 void MethodDescriptorProto::MergeFrom(const ::google::protobuf::Message& from) {
   if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
   const MethodDescriptorProto* source =
@@ -5491,15 +6510,21 @@ void FileOptions::SerializeWithCachedSizes(
       8, this->java_outer_classname(), output);
   }
 
-  // optional .google.protobuf.FileOptions.OptimizeMode optimize_for = 9 [default = SPEED];
-  if (has_optimize_for()) {
-    ::google::protobuf::internal::WireFormatLite::WriteEnum(
-      9, this->optimize_for(), output);
-  }
+  {
+    ::google::protobuf::uint8* target = output->BeginFastWrite();
 
-  // optional bool java_multiple_files = 10 [default = false];
-  if (has_java_multiple_files()) {
-    ::google::protobuf::internal::WireFormatLite::WriteBool(10, this->java_multiple_files(), output);
+    // optional .google.protobuf.FileOptions.OptimizeMode optimize_for = 9 [default = SPEED];
+    if (has_optimize_for()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteEnumToArray(
+        9, this->optimize_for(), target);
+    }
+
+    // optional bool java_multiple_files = 10 [default = false];
+    if (has_java_multiple_files()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(10, this->java_multiple_files(), target);
+    }
+
+    output->EndFastWrite(target);
   }
 
   // optional string go_package = 11;
@@ -5512,39 +6537,45 @@ void FileOptions::SerializeWithCachedSizes(
       11, this->go_package(), output);
   }
 
-  // optional bool cc_generic_services = 16 [default = false];
-  if (has_cc_generic_services()) {
-    ::google::protobuf::internal::WireFormatLite::WriteBool(16, this->cc_generic_services(), output);
-  }
+  {
+    ::google::protobuf::uint8* target = output->BeginFastWrite();
 
-  // optional bool java_generic_services = 17 [default = false];
-  if (has_java_generic_services()) {
-    ::google::protobuf::internal::WireFormatLite::WriteBool(17, this->java_generic_services(), output);
-  }
+    // optional bool cc_generic_services = 16 [default = false];
+    if (has_cc_generic_services()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(16, this->cc_generic_services(), target);
+    }
 
-  // optional bool py_generic_services = 18 [default = false];
-  if (has_py_generic_services()) {
-    ::google::protobuf::internal::WireFormatLite::WriteBool(18, this->py_generic_services(), output);
-  }
+    // optional bool java_generic_services = 17 [default = false];
+    if (has_java_generic_services()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(17, this->java_generic_services(), target);
+    }
 
-  // optional bool java_generate_equals_and_hash = 20 [default = false];
-  if (has_java_generate_equals_and_hash()) {
-    ::google::protobuf::internal::WireFormatLite::WriteBool(20, this->java_generate_equals_and_hash(), output);
-  }
+    // optional bool py_generic_services = 18 [default = false];
+    if (has_py_generic_services()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(18, this->py_generic_services(), target);
+    }
 
-  // optional bool deprecated = 23 [default = false];
-  if (has_deprecated()) {
-    ::google::protobuf::internal::WireFormatLite::WriteBool(23, this->deprecated(), output);
-  }
+    // optional bool java_generate_equals_and_hash = 20 [default = false];
+    if (has_java_generate_equals_and_hash()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(20, this->java_generate_equals_and_hash(), target);
+    }
 
-  // optional bool java_string_check_utf8 = 27 [default = false];
-  if (has_java_string_check_utf8()) {
-    ::google::protobuf::internal::WireFormatLite::WriteBool(27, this->java_string_check_utf8(), output);
-  }
+    // optional bool deprecated = 23 [default = false];
+    if (has_deprecated()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(23, this->deprecated(), target);
+    }
 
-  // optional bool cc_enable_arenas = 31 [default = false];
-  if (has_cc_enable_arenas()) {
-    ::google::protobuf::internal::WireFormatLite::WriteBool(31, this->cc_enable_arenas(), output);
+    // optional bool java_string_check_utf8 = 27 [default = false];
+    if (has_java_string_check_utf8()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(27, this->java_string_check_utf8(), target);
+    }
+
+    // optional bool cc_enable_arenas = 31 [default = false];
+    if (has_cc_enable_arenas()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(31, this->cc_enable_arenas(), target);
+    }
+
+    output->EndFastWrite(target);
   }
 
   // repeated .google.protobuf.UninterpretedOption uninterpreted_option = 999;
@@ -5666,7 +6697,11 @@ void FileOptions::SerializeWithCachedSizes(
 }
 
 int FileOptions::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t FileOptions::ByteSizeLong() const {
+  size_t total_size = 0;
 
   if (_has_bits_[0 / 32] & 255) {
     // optional string java_package = 1;
@@ -5754,10 +6789,201 @@ int FileOptions::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
-  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
-  GOOGLE_SAFE_CONCURRENT_WRITES_END();
-  return total_size;
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = cached_size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+  return total_size;
+}
+
+size_t FileOptions::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  if (&this->java_package() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->java_package());
+  }
+  if (&this->java_outer_classname() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->java_outer_classname());
+  }
+  if (&this->go_package() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->go_package());
+  }
+  total_size += uninterpreted_option_.SpaceUsedExcludingSelfLong();
+  total_size += _extensions_.SpaceUsedExcludingSelfLong();
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 FileOptions::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (has_java_package()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        1, ::google::protobuf::internal::HashValue(this->java_package()));
+  }
+  if (has_java_outer_classname()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        8, ::google::protobuf::internal::HashValue(this->java_outer_classname()));
+  }
+  if (has_java_multiple_files()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        10, ::google::protobuf::internal::HashValue(this->java_multiple_files()));
+  }
+  if (has_java_generate_equals_and_hash()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        20, ::google::protobuf::internal::HashValue(this->java_generate_equals_and_hash()));
+  }
+  if (has_java_string_check_utf8()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        27, ::google::protobuf::internal::HashValue(this->java_string_check_utf8()));
+  }
+  if (has_optimize_for()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        9, ::google::protobuf::internal::HashValue(this->optimize_for()));
+  }
+  if (has_go_package()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        11, ::google::protobuf::internal::HashValue(this->go_package()));
+  }
+  if (has_cc_generic_services()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        16, ::google::protobuf::internal::HashValue(this->cc_generic_services()));
+  }
+  if (has_java_generic_services()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        17, ::google::protobuf::internal::HashValue(this->java_generic_services()));
+  }
+  if (has_py_generic_services()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        18, ::google::protobuf::internal::HashValue(this->py_generic_services()));
+  }
+  if (has_deprecated()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        23, ::google::protobuf::internal::HashValue(this->deprecated()));
+  }
+  if (has_cc_enable_arenas()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        31, ::google::protobuf::internal::HashValue(this->cc_enable_arenas()));
+  }
+  if (this->uninterpreted_option_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        999,
+        ::google::protobuf::internal::HashRepeatedMessages(this->uninterpreted_option()));
+  }
+  hash += _extensions_.StructuralHash(descriptor());
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool FileOptions::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const FileOptions* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const FileOptions*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool FileOptions::StructurallyEquals(const FileOptions& other) const {
+  if (&other == this) return true;
+
+  if (has_java_package() != other.has_java_package()) return false;
+  if (has_java_package()) {
+    if (this->java_package() != other.java_package()) return false;
+  }
+  if (has_java_outer_classname() != other.has_java_outer_classname()) return false;
+  if (has_java_outer_classname()) {
+    if (this->java_outer_classname() != other.java_outer_classname()) return false;
+  }
+  if (has_java_multiple_files() != other.has_java_multiple_files()) return false;
+  if (has_java_multiple_files()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->java_multiple_files(), other.java_multiple_files())) {
+      return false;
+    }
+  }
+  if (has_java_generate_equals_and_hash() != other.has_java_generate_equals_and_hash()) return false;
+  if (has_java_generate_equals_and_hash()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->java_generate_equals_and_hash(), other.java_generate_equals_and_hash())) {
+      return false;
+    }
+  }
+  if (has_java_string_check_utf8() != other.has_java_string_check_utf8()) return false;
+  if (has_java_string_check_utf8()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->java_string_check_utf8(), other.java_string_check_utf8())) {
+      return false;
+    }
+  }
+  if (has_optimize_for() != other.has_optimize_for()) return false;
+  if (has_optimize_for()) {
+    if (this->optimize_for() != other.optimize_for()) return false;
+  }
+  if (has_go_package() != other.has_go_package()) return false;
+  if (has_go_package()) {
+    if (this->go_package() != other.go_package()) return false;
+  }
+  if (has_cc_generic_services() != other.has_cc_generic_services()) return false;
+  if (has_cc_generic_services()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->cc_generic_services(), other.cc_generic_services())) {
+      return false;
+    }
+  }
+  if (has_java_generic_services() != other.has_java_generic_services()) return false;
+  if (has_java_generic_services()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->java_generic_services(), other.java_generic_services())) {
+      return false;
+    }
+  }
+  if (has_py_generic_services() != other.has_py_generic_services()) return false;
+  if (has_py_generic_services()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->py_generic_services(), other.py_generic_services())) {
+      return false;
+    }
+  }
+  if (has_deprecated() != other.has_deprecated()) return false;
+  if (has_deprecated()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->deprecated(), other.deprecated())) {
+      return false;
+    }
+  }
+  if (has_cc_enable_arenas() != other.has_cc_enable_arenas()) return false;
+  if (has_cc_enable_arenas()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->cc_enable_arenas(), other.cc_enable_arenas())) {
+      return false;
+    }
+  }
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->uninterpreted_option(), other.uninterpreted_option())) {
+    return false;
+  }
+  if (!_extensions_.StructurallyEquals(descriptor(), other._extensions_)) {
+    return false;
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
 }
 
 void FileOptions::MergeFrom(const ::google::protobuf::Message& from) {
@@ -6084,24 +7310,30 @@ failure:
 void MessageOptions::SerializeWithCachedSizes(
     ::google::protobuf::io::CodedOutputStream* output) const {
   // @@protoc_insertion_point(serialize_start:google.protobuf.MessageOptions)
-  // optional bool message_set_wire_format = 1 [default = false];
-  if (has_message_set_wire_format()) {
-    ::google::protobuf::internal::WireFormatLite::WriteBool(1, this->message_set_wire_format(), output);
-  }
+  {
+    ::google::protobuf::uint8* target = output->BeginFastWrite();
 
-  // optional bool no_standard_descriptor_accessor = 2 [default = false];
-  if (has_no_standard_descriptor_accessor()) {
-    ::google::protobuf::internal::WireFormatLite::WriteBool(2, this->no_standard_descriptor_accessor(), output);
-  }
+    // optional bool message_set_wire_format = 1 [default = false];
+    if (has_message_set_wire_format()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(1, this->message_set_wire_format(), target);
+    }
 
-  // optional bool deprecated = 3 [default = false];
-  if (has_deprecated()) {
-    ::google::protobuf::internal::WireFormatLite::WriteBool(3, this->deprecated(), output);
-  }
+    // optional bool no_standard_descriptor_accessor = 2 [default = false];
+    if (has_no_standard_descriptor_accessor()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(2, this->no_standard_descriptor_accessor(), target);
+    }
 
-  // optional bool map_entry = 7;
-  if (has_map_entry()) {
-    ::google::protobuf::internal::WireFormatLite::WriteBool(7, this->map_entry(), output);
+    // optional bool deprecated = 3 [default = false];
+    if (has_deprecated()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(3, this->deprecated(), target);
+    }
+
+    // optional bool map_entry = 7;
+    if (has_map_entry()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(7, this->map_entry(), target);
+    }
+
+    output->EndFastWrite(target);
   }
 
   // repeated .google.protobuf.UninterpretedOption uninterpreted_option = 999;
@@ -6164,7 +7396,11 @@ void MessageOptions::SerializeWithCachedSizes(
 }
 
 int MessageOptions::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t MessageOptions::ByteSizeLong() const {
+  size_t total_size = 0;
 
   if (_has_bits_[0 / 32] & 15) {
     // optional bool message_set_wire_format = 1 [default = false];
@@ -6203,12 +7439,115 @@ int MessageOptions::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
+size_t MessageOptions::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  total_size += uninterpreted_option_.SpaceUsedExcludingSelfLong();
+  total_size += _extensions_.SpaceUsedExcludingSelfLong();
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 MessageOptions::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (has_message_set_wire_format()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        1, ::google::protobuf::internal::HashValue(this->message_set_wire_format()));
+  }
+  if (has_no_standard_descriptor_accessor()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        2, ::google::protobuf::internal::HashValue(this->no_standard_descriptor_accessor()));
+  }
+  if (has_deprecated()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        3, ::google::protobuf::internal::HashValue(this->deprecated()));
+  }
+  if (has_map_entry()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        7, ::google::protobuf::internal::HashValue(this->map_entry()));
+  }
+  if (this->uninterpreted_option_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        999,
+        ::google::protobuf::internal::HashRepeatedMessages(this->uninterpreted_option()));
+  }
+  hash += _extensions_.StructuralHash(descriptor());
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool MessageOptions::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const MessageOptions* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const MessageOptions*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool MessageOptions::StructurallyEquals(const MessageOptions& other) const {
+  if (&other == this) return true;
+
+  if (has_message_set_wire_format() != other.has_message_set_wire_format()) return false;
+  if (has_message_set_wire_format()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->message_set_wire_format(), other.message_set_wire_format())) {
+      return false;
+    }
+  }
+  if (has_no_standard_descriptor_accessor() != other.has_no_standard_descriptor_accessor()) return false;
+  if (has_no_standard_descriptor_accessor()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->no_standard_descriptor_accessor(), other.no_standard_descriptor_accessor())) {
+      return false;
+    }
+  }
+  if (has_deprecated() != other.has_deprecated()) return false;
+  if (has_deprecated()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->deprecated(), other.deprecated())) {
+      return false;
+    }
+  }
+  if (has_map_entry() != other.has_map_entry()) return false;
+  if (has_map_entry()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->map_entry(), other.map_entry())) {
+      return false;
+    }
+  }
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->uninterpreted_option(), other.uninterpreted_option())) {
+    return false;
+  }
+  if (!_extensions_.StructurallyEquals(descriptor(), other._extensions_)) {
+    return false;
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
 void MessageOptions::MergeFrom(const ::google::protobuf::Message& from) {
   if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
   const MessageOptions* source =
@@ -6543,30 +7882,36 @@ failure:
 void FieldOptions::SerializeWithCachedSizes(
     ::google::protobuf::io::CodedOutputStream* output) const {
   // @@protoc_insertion_point(serialize_start:google.protobuf.FieldOptions)
-  // optional .google.protobuf.FieldOptions.CType ctype = 1 [default = STRING];
-  if (has_ctype()) {
-    ::google::protobuf::internal::WireFormatLite::WriteEnum(
-      1, this->ctype(), output);
-  }
+  {
+    ::google::protobuf::uint8* target = output->BeginFastWrite();
 
-  // optional bool packed = 2;
-  if (has_packed()) {
-    ::google::protobuf::internal::WireFormatLite::WriteBool(2, this->packed(), output);
-  }
+    // optional .google.protobuf.FieldOptions.CType ctype = 1 [default = STRING];
+    if (has_ctype()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteEnumToArray(
+        1, this->ctype(), target);
+    }
 
-  // optional bool deprecated = 3 [default = false];
-  if (has_deprecated()) {
-    ::google::protobuf::internal::WireFormatLite::WriteBool(3, this->deprecated(), output);
-  }
+    // optional bool packed = 2;
+    if (has_packed()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(2, this->packed(), target);
+    }
 
-  // optional bool lazy = 5 [default = false];
-  if (has_lazy()) {
-    ::google::protobuf::internal::WireFormatLite::WriteBool(5, this->lazy(), output);
-  }
+    // optional bool deprecated = 3 [default = false];
+    if (has_deprecated()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(3, this->deprecated(), target);
+    }
 
-  // optional bool weak = 10 [default = false];
-  if (has_weak()) {
-    ::google::protobuf::internal::WireFormatLite::WriteBool(10, this->weak(), output);
+    // optional bool lazy = 5 [default = false];
+    if (has_lazy()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(5, this->lazy(), target);
+    }
+
+    // optional bool weak = 10 [default = false];
+    if (has_weak()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(10, this->weak(), target);
+    }
+
+    output->EndFastWrite(target);
   }
 
   // repeated .google.protobuf.UninterpretedOption uninterpreted_option = 999;
@@ -6635,7 +7980,11 @@ void FieldOptions::SerializeWithCachedSizes(
 }
 
 int FieldOptions::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t FieldOptions::ByteSizeLong() const {
+  size_t total_size = 0;
 
   if (_has_bits_[0 / 32] & 31) {
     // optional .google.protobuf.FieldOptions.CType ctype = 1 [default = STRING];
@@ -6680,12 +8029,123 @@ int FieldOptions::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
+size_t FieldOptions::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  total_size += uninterpreted_option_.SpaceUsedExcludingSelfLong();
+  total_size += _extensions_.SpaceUsedExcludingSelfLong();
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 FieldOptions::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (has_ctype()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        1, ::google::protobuf::internal::HashValue(this->ctype()));
+  }
+  if (has_packed()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        2, ::google::protobuf::internal::HashValue(this->packed()));
+  }
+  if (has_lazy()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        5, ::google::protobuf::internal::HashValue(this->lazy()));
+  }
+  if (has_deprecated()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        3, ::google::protobuf::internal::HashValue(this->deprecated()));
+  }
+  if (has_weak()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        10, ::google::protobuf::internal::HashValue(this->weak()));
+  }
+  if (this->uninterpreted_option_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        999,
+        ::google::protobuf::internal::HashRepeatedMessages(this->uninterpreted_option()));
+  }
+  hash += _extensions_.StructuralHash(descriptor());
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool FieldOptions::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const FieldOptions* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const FieldOptions*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool FieldOptions::StructurallyEquals(const FieldOptions& other) const {
+  if (&other == this) return true;
+
+  if (has_ctype() != other.has_ctype()) return false;
+  if (has_ctype()) {
+    if (this->ctype() != other.ctype()) return false;
+  }
+  if (has_packed() != other.has_packed()) return false;
+  if (has_packed()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->packed(), other.packed())) {
+      return false;
+    }
+  }
+  if (has_lazy() != other.has_lazy()) return false;
+  if (has_lazy()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->lazy(), other.lazy())) {
+      return false;
+    }
+  }
+  if (has_deprecated() != other.has_deprecated()) return false;
+  if (has_deprecated()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->deprecated(), other.deprecated())) {
+      return false;
+    }
+  }
+  if (has_weak() != other.has_weak()) return false;
+  if (has_weak()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->weak(), other.weak())) {
+      return false;
+    }
+  }
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->uninterpreted_option(), other.uninterpreted_option())) {
+    return false;
+  }
+  if (!_extensions_.StructurallyEquals(descriptor(), other._extensions_)) {
+    return false;
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
 void FieldOptions::MergeFrom(const ::google::protobuf::Message& from) {
   if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
   const FieldOptions* source =
@@ -6943,14 +8403,20 @@ failure:
 void EnumOptions::SerializeWithCachedSizes(
     ::google::protobuf::io::CodedOutputStream* output) const {
   // @@protoc_insertion_point(serialize_start:google.protobuf.EnumOptions)
-  // optional bool allow_alias = 2;
-  if (has_allow_alias()) {
-    ::google::protobuf::internal::WireFormatLite::WriteBool(2, this->allow_alias(), output);
-  }
+  {
+    ::google::protobuf::uint8* target = output->BeginFastWrite();
 
-  // optional bool deprecated = 3 [default = false];
-  if (has_deprecated()) {
-    ::google::protobuf::internal::WireFormatLite::WriteBool(3, this->deprecated(), output);
+    // optional bool allow_alias = 2;
+    if (has_allow_alias()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(2, this->allow_alias(), target);
+    }
+
+    // optional bool deprecated = 3 [default = false];
+    if (has_deprecated()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(3, this->deprecated(), target);
+    }
+
+    output->EndFastWrite(target);
   }
 
   // repeated .google.protobuf.UninterpretedOption uninterpreted_option = 999;
@@ -7003,7 +8469,11 @@ void EnumOptions::SerializeWithCachedSizes(
 }
 
 int EnumOptions::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t EnumOptions::ByteSizeLong() const {
+  size_t total_size = 0;
 
   if (_has_bits_[0 / 32] & 3) {
     // optional bool allow_alias = 2;
@@ -7032,12 +8502,93 @@ int EnumOptions::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
+size_t EnumOptions::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  total_size += uninterpreted_option_.SpaceUsedExcludingSelfLong();
+  total_size += _extensions_.SpaceUsedExcludingSelfLong();
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 EnumOptions::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (has_allow_alias()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        2, ::google::protobuf::internal::HashValue(this->allow_alias()));
+  }
+  if (has_deprecated()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        3, ::google::protobuf::internal::HashValue(this->deprecated()));
+  }
+  if (this->uninterpreted_option_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        999,
+        ::google::protobuf::internal::HashRepeatedMessages(this->uninterpreted_option()));
+  }
+  hash += _extensions_.StructuralHash(descriptor());
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool EnumOptions::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const EnumOptions* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const EnumOptions*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool EnumOptions::StructurallyEquals(const EnumOptions& other) const {
+  if (&other == this) return true;
+
+  if (has_allow_alias() != other.has_allow_alias()) return false;
+  if (has_allow_alias()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->allow_alias(), other.allow_alias())) {
+      return false;
+    }
+  }
+  if (has_deprecated() != other.has_deprecated()) return false;
+  if (has_deprecated()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->deprecated(), other.deprecated())) {
+      return false;
+    }
+  }
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->uninterpreted_option(), other.uninterpreted_option())) {
+    return false;
+  }
+  if (!_extensions_.StructurallyEquals(descriptor(), other._extensions_)) {
+    return false;
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
 void EnumOptions::MergeFrom(const ::google::protobuf::Message& from) {
   if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
   const EnumOptions* source =
@@ -7302,7 +8853,11 @@ void EnumValueOptions::SerializeWithCachedSizes(
 }
 
 int EnumValueOptions::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t EnumValueOptions::ByteSizeLong() const {
+  size_t total_size = 0;
 
   // optional bool deprecated = 1 [default = false];
   if (has_deprecated()) {
@@ -7324,10 +8879,80 @@ int EnumValueOptions::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
-  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
-  GOOGLE_SAFE_CONCURRENT_WRITES_END();
-  return total_size;
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = cached_size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+  return total_size;
+}
+
+size_t EnumValueOptions::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  total_size += uninterpreted_option_.SpaceUsedExcludingSelfLong();
+  total_size += _extensions_.SpaceUsedExcludingSelfLong();
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 EnumValueOptions::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (has_deprecated()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        1, ::google::protobuf::internal::HashValue(this->deprecated()));
+  }
+  if (this->uninterpreted_option_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        999,
+        ::google::protobuf::internal::HashRepeatedMessages(this->uninterpreted_option()));
+  }
+  hash += _extensions_.StructuralHash(descriptor());
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool EnumValueOptions::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const EnumValueOptions* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const EnumValueOptions*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool EnumValueOptions::StructurallyEquals(const EnumValueOptions& other) const {
+  if (&other == this) return true;
+
+  if (has_deprecated() != other.has_deprecated()) return false;
+  if (has_deprecated()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->deprecated(), other.deprecated())) {
+      return false;
+    }
+  }
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->uninterpreted_option(), other.uninterpreted_option())) {
+    return false;
+  }
+  if (!_extensions_.StructurallyEquals(descriptor(), other._extensions_)) {
+    return false;
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
 }
 
 void EnumValueOptions::MergeFrom(const ::google::protobuf::Message& from) {
@@ -7590,7 +9215,11 @@ void ServiceOptions::SerializeWithCachedSizes(
 }
 
 int ServiceOptions::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t ServiceOptions::ByteSizeLong() const {
+  size_t total_size = 0;
 
   // optional bool deprecated = 33 [default = false];
   if (has_deprecated()) {
@@ -7612,12 +9241,82 @@ int ServiceOptions::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
+size_t ServiceOptions::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  total_size += uninterpreted_option_.SpaceUsedExcludingSelfLong();
+  total_size += _extensions_.SpaceUsedExcludingSelfLong();
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 ServiceOptions::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (has_deprecated()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        33, ::google::protobuf::internal::HashValue(this->deprecated()));
+  }
+  if (this->uninterpreted_option_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        999,
+        ::google::protobuf::internal::HashRepeatedMessages(this->uninterpreted_option()));
+  }
+  hash += _extensions_.StructuralHash(descriptor());
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool ServiceOptions::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const ServiceOptions* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const ServiceOptions*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool ServiceOptions::StructurallyEquals(const ServiceOptions& other) const {
+  if (&other == this) return true;
+
+  if (has_deprecated() != other.has_deprecated()) return false;
+  if (has_deprecated()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->deprecated(), other.deprecated())) {
+      return false;
+    }
+  }
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->uninterpreted_option(), other.uninterpreted_option())) {
+    return false;
+  }
+  if (!_extensions_.StructurallyEquals(descriptor(), other._extensions_)) {
+    return false;
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
 void ServiceOptions::MergeFrom(const ::google::protobuf::Message& from) {
   if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
   const ServiceOptions* source =
@@ -7878,7 +9577,11 @@ void MethodOptions::SerializeWithCachedSizes(
 }
 
 int MethodOptions::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t MethodOptions::ByteSizeLong() const {
+  size_t total_size = 0;
 
   // optional bool deprecated = 33 [default = false];
   if (has_deprecated()) {
@@ -7900,12 +9603,82 @@ int MethodOptions::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
+size_t MethodOptions::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  total_size += uninterpreted_option_.SpaceUsedExcludingSelfLong();
+  total_size += _extensions_.SpaceUsedExcludingSelfLong();
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 MethodOptions::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (has_deprecated()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        33, ::google::protobuf::internal::HashValue(this->deprecated()));
+  }
+  if (this->uninterpreted_option_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        999,
+        ::google::protobuf::internal::HashRepeatedMessages(this->uninterpreted_option()));
+  }
+  hash += _extensions_.StructuralHash(descriptor());
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool MethodOptions::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const MethodOptions* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const MethodOptions*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool MethodOptions::StructurallyEquals(const MethodOptions& other) const {
+  if (&other == this) return true;
+
+  if (has_deprecated() != other.has_deprecated()) return false;
+  if (has_deprecated()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->deprecated(), other.deprecated())) {
+      return false;
+    }
+  }
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->uninterpreted_option(), other.uninterpreted_option())) {
+    return false;
+  }
+  if (!_extensions_.StructurallyEquals(descriptor(), other._extensions_)) {
+    return false;
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
 void MethodOptions::MergeFrom(const ::google::protobuf::Message& from) {
   if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
   const MethodOptions* source =
@@ -8169,8 +9942,8 @@ void UninterpretedOption_NamePart::SerializeWithCachedSizes(
   return target;
 }
 
-int UninterpretedOption_NamePart::RequiredFieldsByteSizeFallback() const {
-  int total_size = 0;
+size_t UninterpretedOption_NamePart::RequiredFieldsByteSizeFallback() const {
+  size_t total_size = 0;
 
   if (has_name_part()) {
     // required string name_part = 1;
@@ -8187,7 +9960,11 @@ int UninterpretedOption_NamePart::RequiredFieldsByteSizeFallback() const {
   return total_size;
 }
 int UninterpretedOption_NamePart::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t UninterpretedOption_NamePart::ByteSizeLong() const {
+  size_t total_size = 0;
 
   if (((_has_bits_[0] & 0x00000003) ^ 0x00000003) == 0) {  // All required fields are present.
     // required string name_part = 1;
@@ -8206,12 +9983,79 @@ int UninterpretedOption_NamePart::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
+size_t UninterpretedOption_NamePart::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  if (&this->name_part() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->name_part());
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 UninterpretedOption_NamePart::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (has_name_part()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        1, ::google::protobuf::internal::HashValue(this->name_part()));
+  }
+  if (has_is_extension()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        2, ::google::protobuf::internal::HashValue(this->is_extension()));
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool UninterpretedOption_NamePart::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const UninterpretedOption_NamePart* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const UninterpretedOption_NamePart*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool UninterpretedOption_NamePart::StructurallyEquals(const UninterpretedOption_NamePart& other) const {
+  if (&other == this) return true;
+
+  if (has_name_part() != other.has_name_part()) return false;
+  if (has_name_part()) {
+    if (this->name_part() != other.name_part()) return false;
+  }
+  if (has_is_extension() != other.has_is_extension()) return false;
+  if (has_is_extension()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->is_extension(), other.is_extension())) {
+      return false;
+    }
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
 void UninterpretedOption_NamePart::MergeFrom(const ::google::protobuf::Message& from) {
   if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
   const UninterpretedOption_NamePart* source =
@@ -8549,19 +10393,25 @@ void UninterpretedOption::SerializeWithCachedSizes(
       3, this->identifier_value(), output);
   }
 
-  // optional uint64 positive_int_value = 4;
-  if (has_positive_int_value()) {
-    ::google::protobuf::internal::WireFormatLite::WriteUInt64(4, this->positive_int_value(), output);
-  }
+  {
+    ::google::protobuf::uint8* target = output->BeginFastWrite();
 
-  // optional int64 negative_int_value = 5;
-  if (has_negative_int_value()) {
-    ::google::protobuf::internal::WireFormatLite::WriteInt64(5, this->negative_int_value(), output);
-  }
+    // optional uint64 positive_int_value = 4;
+    if (has_positive_int_value()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteUInt64ToArray(4, this->positive_int_value(), target);
+    }
 
-  // optional double double_value = 6;
-  if (has_double_value()) {
-    ::google::protobuf::internal::WireFormatLite::WriteDouble(6, this->double_value(), output);
+    // optional int64 negative_int_value = 5;
+    if (has_negative_int_value()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArray(5, this->negative_int_value(), target);
+    }
+
+    // optional double double_value = 6;
+    if (has_double_value()) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteDoubleToArray(6, this->double_value(), target);
+    }
+
+    output->EndFastWrite(target);
   }
 
   // optional bytes string_value = 7;
@@ -8650,7 +10500,11 @@ void UninterpretedOption::SerializeWithCachedSizes(
 }
 
 int UninterpretedOption::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t UninterpretedOption::ByteSizeLong() const {
+  size_t total_size = 0;
 
   if (_has_bits_[1 / 32] & 126) {
     // optional string identifier_value = 3;
@@ -8707,12 +10561,135 @@ int UninterpretedOption::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
+size_t UninterpretedOption::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  total_size += name_.SpaceUsedExcludingSelfLong();
+  if (&this->identifier_value() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->identifier_value());
+  }
+  if (&this->string_value() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->string_value());
+  }
+  if (&this->aggregate_value() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->aggregate_value());
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 UninterpretedOption::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (this->name_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        2,
+        ::google::protobuf::internal::HashRepeatedMessages(this->name()));
+  }
+  if (has_identifier_value()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        3, ::google::protobuf::internal::HashValue(this->identifier_value()));
+  }
+  if (has_positive_int_value()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        4, ::google::protobuf::internal::HashValue(this->positive_int_value()));
+  }
+  if (has_negative_int_value()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        5, ::google::protobuf::internal::HashValue(this->negative_int_value()));
+  }
+  if (has_double_value()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        6, ::google::protobuf::internal::HashValue(this->double_value()));
+  }
+  if (has_string_value()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        7, ::google::protobuf::internal::HashValue(this->string_value()));
+  }
+  if (has_aggregate_value()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        8, ::google::protobuf::internal::HashValue(this->aggregate_value()));
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool UninterpretedOption::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const UninterpretedOption* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const UninterpretedOption*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool UninterpretedOption::StructurallyEquals(const UninterpretedOption& other) const {
+  if (&other == this) return true;
+
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->name(), other.name())) {
+    return false;
+  }
+  if (has_identifier_value() != other.has_identifier_value()) return false;
+  if (has_identifier_value()) {
+    if (this->identifier_value() != other.identifier_value()) return false;
+  }
+  if (has_positive_int_value() != other.has_positive_int_value()) return false;
+  if (has_positive_int_value()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->positive_int_value(), other.positive_int_value())) {
+      return false;
+    }
+  }
+  if (has_negative_int_value() != other.has_negative_int_value()) return false;
+  if (has_negative_int_value()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->negative_int_value(), other.negative_int_value())) {
+      return false;
+    }
+  }
+  if (has_double_value() != other.has_double_value()) return false;
+  if (has_double_value()) {
+    if (!::google::protobuf::internal::ValuesEqual(
+            this->double_value(), other.double_value())) {
+      return false;
+    }
+  }
+  if (has_string_value() != other.has_string_value()) return false;
+  if (has_string_value()) {
+    if (this->string_value() != other.string_value()) return false;
+  }
+  if (has_aggregate_value() != other.has_aggregate_value()) return false;
+  if (has_aggregate_value()) {
+    if (this->aggregate_value() != other.aggregate_value()) return false;
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
 void UninterpretedOption::MergeFrom(const ::google::protobuf::Message& from) {
   if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
   const UninterpretedOption* source =
@@ -9101,7 +11078,11 @@ void SourceCodeInfo_Location::SerializeWithCachedSizes(
 }
 
 int SourceCodeInfo_Location::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t SourceCodeInfo_Location::ByteSizeLong() const {
+  size_t total_size = 0;
 
   if (_has_bits_[2 / 32] & 12) {
     // optional string leading_comments = 3;
@@ -9158,12 +11139,100 @@ int SourceCodeInfo_Location::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
+size_t SourceCodeInfo_Location::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  total_size += path_.SpaceUsedExcludingSelfLong();
+  total_size += span_.SpaceUsedExcludingSelfLong();
+  if (&this->leading_comments() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->leading_comments());
+  }
+  if (&this->trailing_comments() != &::google::protobuf::internal::GetEmptyStringAlreadyInited()) {
+    total_size += sizeof(::std::string) +
+      ::google::protobuf::internal::StringSpaceUsedExcludingSelf(this->trailing_comments());
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 SourceCodeInfo_Location::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (this->path_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        1,
+        ::google::protobuf::internal::HashRepeatedValues(this->path()));
+  }
+  if (this->span_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        2,
+        ::google::protobuf::internal::HashRepeatedValues(this->span()));
+  }
+  if (has_leading_comments()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        3, ::google::protobuf::internal::HashValue(this->leading_comments()));
+  }
+  if (has_trailing_comments()) {
+    hash += ::google::protobuf::internal::HashCombine(
+        4, ::google::protobuf::internal::HashValue(this->trailing_comments()));
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool SourceCodeInfo_Location::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const SourceCodeInfo_Location* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const SourceCodeInfo_Location*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool SourceCodeInfo_Location::StructurallyEquals(const SourceCodeInfo_Location& other) const {
+  if (&other == this) return true;
+
+  if (!::google::protobuf::internal::RepeatedPrimitivesEqual(
+          this->path(), other.path())) {
+    return false;
+  }
+  if (!::google::protobuf::internal::RepeatedPrimitivesEqual(
+          this->span(), other.span())) {
+    return false;
+  }
+  if (has_leading_comments() != other.has_leading_comments()) return false;
+  if (has_leading_comments()) {
+    if (this->leading_comments() != other.leading_comments()) return false;
+  }
+  if (has_trailing_comments() != other.has_trailing_comments()) return false;
+  if (has_trailing_comments()) {
+    if (this->trailing_comments() != other.trailing_comments()) return false;
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
 void SourceCodeInfo_Location::MergeFrom(const ::google::protobuf::Message& from) {
   if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
   const SourceCodeInfo_Location* source =
@@ -9387,7 +11456,11 @@ void SourceCodeInfo::SerializeWithCachedSizes(
 }
 
 int SourceCodeInfo::ByteSize() const {
-  int total_size = 0;
+  return ::google::protobuf::internal::ToIntSize(ByteSizeLong());
+}
+
+size_t SourceCodeInfo::ByteSizeLong() const {
+  size_t total_size = 0;
 
   // repeated .google.protobuf.SourceCodeInfo.Location location = 1;
   total_size += 1 * this->location_size();
@@ -9402,12 +11475,66 @@ int SourceCodeInfo::ByteSize() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         unknown_fields());
   }
+  int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
-  _cached_size_ = total_size;
+  _cached_size_ = cached_size;
   GOOGLE_SAFE_CONCURRENT_WRITES_END();
   return total_size;
 }
 
+size_t SourceCodeInfo::SpaceUsedLong() const {
+  if (this == default_instance_) return sizeof(*this);
+  size_t total_size = sizeof(*this);
+
+  total_size += location_.SpaceUsedExcludingSelfLong();
+  if (_internal_metadata_.have_unknown_fields()) {
+    total_size += _internal_metadata_.unknown_fields().SpaceUsed();
+  }
+  return total_size;
+}
+
+::google::protobuf::uint64 SourceCodeInfo::StructuralHash() const {
+  ::google::protobuf::uint64 hash = 0;
+
+  if (this->location_size() > 0) {
+    hash += ::google::protobuf::internal::HashCombine(
+        1,
+        ::google::protobuf::internal::HashRepeatedMessages(this->location()));
+  }
+  if (_internal_metadata_.have_unknown_fields()) {
+    hash += ::google::protobuf::internal::ReflectionOps::HashUnknownFields(
+        _internal_metadata_.unknown_fields());
+  }
+  return hash;
+}
+
+bool SourceCodeInfo::StructurallyEquals(
+    const ::google::protobuf::Message& other) const {
+  const SourceCodeInfo* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const SourceCodeInfo*>(
+      &other);
+  if (source == NULL) {
+    return ::google::protobuf::internal::ReflectionOps::Equals(*this, other);
+  }
+  return StructurallyEquals(*source);
+}
+
+bool SourceCodeInfo::StructurallyEquals(const SourceCodeInfo& other) const {
+  if (&other == this) return true;
+
+  if (!::google::protobuf::internal::RepeatedMessagesEqual(
+          this->location(), other.location())) {
+    return false;
+  }
+  if (_internal_metadata_.have_unknown_fields() ||
+      other._internal_metadata_.have_unknown_fields()) {
+    return ::google::protobuf::internal::ReflectionOps::UnknownFieldsEqual(
+        _internal_metadata_.unknown_fields(),
+        other._internal_metadata_.unknown_fields());
+  }
+  return true;
+}
+
 void SourceCodeInfo::MergeFrom(const ::google::protobuf::Message& from) {
   if (GOOGLE_PREDICT_FALSE(&from == this)) MergeFromFail(__LINE__);
   const SourceCodeInfo* source =
@@ -169,6 +169,18 @@ class LIBPROTOBUF_EXPORT FileDescriptorSet : public ::google::protobuf::Message
     return *this;
   }
 
+  #if LANG_CXX11
+  FileDescriptorSet(FileDescriptorSet&& from) noexcept
+    : FileDescriptorSet() {
+    *this = ::std::move(from);
+  }
+
+  inline FileDescriptorSet& operator=(FileDescriptorSet&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -195,10 +207,15 @@ class LIBPROTOBUF_EXPORT FileDescriptorSet : public ::google::protobuf::Message
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const FileDescriptorSet& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -261,6 +278,18 @@ class LIBPROTOBUF_EXPORT FileDescriptorProto : public ::google::protobuf::Messag
     return *this;
   }
 
+  #if LANG_CXX11
+  FileDescriptorProto(FileDescriptorProto&& from) noexcept
+    : FileDescriptorProto() {
+    *this = ::std::move(from);
+  }
+
+  inline FileDescriptorProto& operator=(FileDescriptorProto&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -287,10 +316,15 @@ class LIBPROTOBUF_EXPORT FileDescriptorProto : public ::google::protobuf::Messag
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const FileDescriptorProto& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -504,6 +538,18 @@ class LIBPROTOBUF_EXPORT DescriptorProto_ExtensionRange : public ::google::proto
     return *this;
   }
 
+  #if LANG_CXX11
+  DescriptorProto_ExtensionRange(DescriptorProto_ExtensionRange&& from) noexcept
+    : DescriptorProto_ExtensionRange() {
+    *this = ::std::move(from);
+  }
+
+  inline DescriptorProto_ExtensionRange& operator=(DescriptorProto_ExtensionRange&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -530,10 +576,15 @@ class LIBPROTOBUF_EXPORT DescriptorProto_ExtensionRange : public ::google::proto
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const DescriptorProto_ExtensionRange& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -603,6 +654,18 @@ class LIBPROTOBUF_EXPORT DescriptorProto : public ::google::protobuf::Message {
     return *this;
   }
 
+  #if LANG_CXX11
+  DescriptorProto(DescriptorProto&& from) noexcept
+    : DescriptorProto() {
+    *this = ::std::move(from);
+  }
+
+  inline DescriptorProto& operator=(DescriptorProto&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -629,10 +692,15 @@ class LIBPROTOBUF_EXPORT DescriptorProto : public ::google::protobuf::Message {
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const DescriptorProto& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -789,6 +857,18 @@ class LIBPROTOBUF_EXPORT FieldDescriptorProto : public ::google::protobuf::Messa
     return *this;
   }
 
+  #if LANG_CXX11
+  FieldDescriptorProto(FieldDescriptorProto&& from) noexcept
+    : FieldDescriptorProto() {
+    *this = ::std::move(from);
+  }
+
+  inline FieldDescriptorProto& operator=(FieldDescriptorProto&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -815,10 +895,15 @@ class LIBPROTOBUF_EXPORT FieldDescriptorProto : public ::google::protobuf::Messa
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const FieldDescriptorProto& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -1045,6 +1130,18 @@ class LIBPROTOBUF_EXPORT OneofDescriptorProto : public ::google::protobuf::Messa
     return *this;
   }
 
+  #if LANG_CXX11
+  OneofDescriptorProto(OneofDescriptorProto&& from) noexcept
+    : OneofDescriptorProto() {
+    *this = ::std::move(from);
+  }
+
+  inline OneofDescriptorProto& operator=(OneofDescriptorProto&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -1071,10 +1168,15 @@ class LIBPROTOBUF_EXPORT OneofDescriptorProto : public ::google::protobuf::Messa
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const OneofDescriptorProto& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -1139,6 +1241,18 @@ class LIBPROTOBUF_EXPORT EnumDescriptorProto : public ::google::protobuf::Messag
     return *this;
   }
 
+  #if LANG_CXX11
+  EnumDescriptorProto(EnumDescriptorProto&& from) noexcept
+    : EnumDescriptorProto() {
+    *this = ::std::move(from);
+  }
+
+  inline EnumDescriptorProto& operator=(EnumDescriptorProto&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -1165,10 +1279,15 @@ class LIBPROTOBUF_EXPORT EnumDescriptorProto : public ::google::protobuf::Messag
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const EnumDescriptorProto& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -1258,6 +1377,18 @@ class LIBPROTOBUF_EXPORT EnumValueDescriptorProto : public ::google::protobuf::M
     return *this;
   }
 
+  #if LANG_CXX11
+  EnumValueDescriptorProto(EnumValueDescriptorProto&& from) noexcept
+    : EnumValueDescriptorProto() {
+    *this = ::std::move(from);
+  }
+
+  inline EnumValueDescriptorProto& operator=(EnumValueDescriptorProto&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -1284,10 +1415,15 @@ class LIBPROTOBUF_EXPORT EnumValueDescriptorProto : public ::google::protobuf::M
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const EnumValueDescriptorProto& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -1374,6 +1510,18 @@ class LIBPROTOBUF_EXPORT ServiceDescriptorProto : public ::google::protobuf::Mes
     return *this;
   }
 
+  #if LANG_CXX11
+  ServiceDescriptorProto(ServiceDescriptorProto&& from) noexcept
+    : ServiceDescriptorProto() {
+    *this = ::std::move(from);
+  }
+
+  inline ServiceDescriptorProto& operator=(ServiceDescriptorProto&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -1400,10 +1548,15 @@ class LIBPROTOBUF_EXPORT ServiceDescriptorProto : public ::google::protobuf::Mes
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const ServiceDescriptorProto& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -1493,6 +1646,18 @@ class LIBPROTOBUF_EXPORT MethodDescriptorProto : public ::google::protobuf::Mess
     return *this;
   }
 
+  #if LANG_CXX11
+  MethodDescriptorProto(MethodDescriptorProto&& from) noexcept
+    : MethodDescriptorProto() {
+    *this = ::std::move(from);
+  }
+
+  inline MethodDescriptorProto& operator=(MethodDescriptorProto&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -1519,10 +1684,15 @@ class LIBPROTOBUF_EXPORT MethodDescriptorProto : public ::google::protobuf::Mess
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const MethodDescriptorProto& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -1649,6 +1819,18 @@ class LIBPROTOBUF_EXPORT FileOptions : public ::google::protobuf::Message {
     return *this;
   }
 
+  #if LANG_CXX11
+  FileOptions(FileOptions&& from) noexcept
+    : FileOptions() {
+    *this = ::std::move(from);
+  }
+
+  inline FileOptions& operator=(FileOptions&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -1675,10 +1857,15 @@ class LIBPROTOBUF_EXPORT FileOptions : public ::google::protobuf::Message {
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const FileOptions& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -1904,6 +2091,18 @@ class LIBPROTOBUF_EXPORT MessageOptions : public ::google::protobuf::Message {
     return *this;
   }
 
+  #if LANG_CXX11
+  MessageOptions(MessageOptions&& from) noexcept
+    : MessageOptions() {
+    *this = ::std::move(from);
+  }
+
+  inline MessageOptions& operator=(MessageOptions&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -1930,10 +2129,15 @@ class LIBPROTOBUF_EXPORT MessageOptions : public ::google::protobuf::Message {
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const MessageOptions& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -2039,6 +2243,18 @@ class LIBPROTOBUF_EXPORT FieldOptions : public ::google::protobuf::Message {
     return *this;
   }
 
+  #if LANG_CXX11
+  FieldOptions(FieldOptions&& from) noexcept
+    : FieldOptions() {
+    *this = ::std::move(from);
+  }
+
+  inline FieldOptions& operator=(FieldOptions&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -2065,10 +2281,15 @@ class LIBPROTOBUF_EXPORT FieldOptions : public ::google::protobuf::Message {
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const FieldOptions& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -2209,6 +2430,18 @@ class LIBPROTOBUF_EXPORT EnumOptions : public ::google::protobuf::Message {
     return *this;
   }
 
+  #if LANG_CXX11
+  EnumOptions(EnumOptions&& from) noexcept
+    : EnumOptions() {
+    *this = ::std::move(from);
+  }
+
+  inline EnumOptions& operator=(EnumOptions&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -2235,10 +2468,15 @@ class LIBPROTOBUF_EXPORT EnumOptions : public ::google::protobuf::Message {
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const EnumOptions& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -2324,6 +2562,18 @@ class LIBPROTOBUF_EXPORT EnumValueOptions : public ::google::protobuf::Message {
     return *this;
   }
 
+  #if LANG_CXX11
+  EnumValueOptions(EnumValueOptions&& from) noexcept
+    : EnumValueOptions() {
+    *this = ::std::move(from);
+  }
+
+  inline EnumValueOptions& operator=(EnumValueOptions&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -2350,10 +2600,15 @@ class LIBPROTOBUF_EXPORT EnumValueOptions : public ::google::protobuf::Message {
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const EnumValueOptions& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -2429,6 +2684,18 @@ class LIBPROTOBUF_EXPORT ServiceOptions : public ::google::protobuf::Message {
     return *this;
   }
 
+  #if LANG_CXX11
+  ServiceOptions(ServiceOptions&& from) noexcept
+    : ServiceOptions() {
+    *this = ::std::move(from);
+  }
+
+  inline ServiceOptions& operator=(ServiceOptions&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -2455,10 +2722,15 @@ class LIBPROTOBUF_EXPORT ServiceOptions : public ::google::protobuf::Message {
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const ServiceOptions& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -2534,6 +2806,18 @@ class LIBPROTOBUF_EXPORT MethodOptions : public ::google::protobuf::Message {
     return *this;
   }
 
+  #if LANG_CXX11
+  MethodOptions(MethodOptions&& from) noexcept
+    : MethodOptions() {
+    *this = ::std::move(from);
+  }
+
+  inline MethodOptions& operator=(MethodOptions&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -2560,10 +2844,15 @@ class LIBPROTOBUF_EXPORT MethodOptions : public ::google::protobuf::Message {
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const MethodOptions& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -2639,6 +2928,18 @@ class LIBPROTOBUF_EXPORT UninterpretedOption_NamePart : public ::google::protobu
     return *this;
   }
 
+  #if LANG_CXX11
+  UninterpretedOption_NamePart(UninterpretedOption_NamePart&& from) noexcept
+    : UninterpretedOption_NamePart() {
+    *this = ::std::move(from);
+  }
+
+  inline UninterpretedOption_NamePart& operator=(UninterpretedOption_NamePart&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -2665,10 +2966,15 @@ class LIBPROTOBUF_EXPORT UninterpretedOption_NamePart : public ::google::protobu
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const UninterpretedOption_NamePart& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -2717,8 +3023,8 @@ class LIBPROTOBUF_EXPORT UninterpretedOption_NamePart : public ::google::protobu
   inline void set_has_is_extension();
   inline void clear_has_is_extension();
 
-  // helper for ByteSize()
-  int RequiredFieldsByteSizeFallback() const;
+  // helper for ByteSizeLong()
+  size_t RequiredFieldsByteSizeFallback() const;
 
   ::google::protobuf::internal::InternalMetadataWithArena _internal_metadata_;
   ::google::protobuf::uint32 _has_bits_[1];
@@ -2746,6 +3052,18 @@ class LIBPROTOBUF_EXPORT UninterpretedOption : public ::google::protobuf::Messag
     return *this;
   }
 
+  #if LANG_CXX11
+  UninterpretedOption(UninterpretedOption&& from) noexcept
+    : UninterpretedOption() {
+    *this = ::std::move(from);
+  }
+
+  inline UninterpretedOption& operator=(UninterpretedOption&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -2772,10 +3090,15 @@ class LIBPROTOBUF_EXPORT UninterpretedOption : public ::google::protobuf::Messag
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const UninterpretedOption& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -2915,6 +3238,18 @@ class LIBPROTOBUF_EXPORT SourceCodeInfo_Location : public ::google::protobuf::Me
     return *this;
   }
 
+  #if LANG_CXX11
+  SourceCodeInfo_Location(SourceCodeInfo_Location&& from) noexcept
+    : SourceCodeInfo_Location() {
+    *this = ::std::move(from);
+  }
+
+  inline SourceCodeInfo_Location& operator=(SourceCodeInfo_Location&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -2941,10 +3276,15 @@ class LIBPROTOBUF_EXPORT SourceCodeInfo_Location : public ::google::protobuf::Me
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const SourceCodeInfo_Location& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
@@ -3052,6 +3392,18 @@ class LIBPROTOBUF_EXPORT SourceCodeInfo : public ::google::protobuf::Message {
     return *this;
   }
 
+  #if LANG_CXX11
+  SourceCodeInfo(SourceCodeInfo&& from) noexcept
+    : SourceCodeInfo() {
+    *this = ::std::move(from);
+  }
+
+  inline SourceCodeInfo& operator=(SourceCodeInfo&& from) noexcept {
+    if (this != &from) InternalSwap(&from);
+    return *this;
+  }
+  #endif
+
   inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const {
     return _internal_metadata_.unknown_fields();
   }
@@ -3078,10 +3430,15 @@ class LIBPROTOBUF_EXPORT SourceCodeInfo : public ::google::protobuf::Message {
   bool IsInitialized() const;
 
   int ByteSize() const;
+  size_t ByteSizeLong() const;
+  size_t SpaceUsedLong() const;
   bool MergePartialFromCodedStream(
       ::google::protobuf::io::CodedInputStream* input);
   void SerializeWithCachedSizes(
       ::google::protobuf::io::CodedOutputStream* output) const;
+  ::google::protobuf::uint64 StructuralHash() const;
+  bool StructurallyEquals(const ::google::protobuf::Message& other) const;
+  bool StructurallyEquals(const SourceCodeInfo& other) const;
   ::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;
   int GetCachedSize() const { return _cached_size_; }
   private:
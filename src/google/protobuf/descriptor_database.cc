@@ -326,21 +326,38 @@ bool EncodedDescriptorDatabase::AddCopy(
   return Add(copy, size);
 }
 
+void EncodedDescriptorDatabase::AddDeferred(
+    const void* encoded_file_descriptor, int size) {
+  deferred_files_.push_back(make_pair(encoded_file_descriptor, size));
+}
+
+void EncodedDescriptorDatabase::IndexDeferredFiles() {
+  if (deferred_files_.empty()) return;
+  vector<pair<const void*, int> > files;
+  files.swap(deferred_files_);
+  for (int i = 0; i < files.size(); i++) {
+    Add(files[i].first, files[i].second);
+  }
+}
+
 bool EncodedDescriptorDatabase::FindFileByName(
     const string& filename,
     FileDescriptorProto* output) {
+  IndexDeferredFiles();
   return MaybeParse(index_.FindFile(filename), output);
 }
 
 bool EncodedDescriptorDatabase::FindFileContainingSymbol(
     const string& symbol_name,
     FileDescriptorProto* output) {
+  IndexDeferredFiles();
   return MaybeParse(index_.FindSymbol(symbol_name), output);
 }
 
 bool EncodedDescriptorDatabase::FindNameOfFileContainingSymbol(
     const string& symbol_name,
     string* output) {
+  IndexDeferredFiles();
   pair<const void*, int> encoded_file = index_.FindSymbol(symbol_name);
   if (encoded_file.first == NULL) return false;
 
@@ -371,6 +388,7 @@ bool EncodedDescriptorDatabase::FindFileContainingExtension(
     const string& containing_type,
     int field_number,
     FileDescriptorProto* output) {
+  IndexDeferredFiles();
   return MaybeParse(index_.FindExtension(containing_type, field_number),
                     output);
 }
@@ -378,6 +396,7 @@ bool EncodedDescriptorDatabase::FindFileContainingExtension(
 bool EncodedDescriptorDatabase::FindAllExtensionNumbers(
     const string& extendee_type,
     vector<int>* output) {
+  IndexDeferredFiles();
   return index_.FindAllExtensionNumbers(extendee_type, output);
 }
 
@@ -282,6 +282,11 @@ class LIBPROTOBUF_EXPORT EncodedDescriptorDatabase : public DescriptorDatabase {
   // need to keep it around.
   bool AddCopy(const void* encoded_file_descriptor, int size);
 
+  // Like Add(), but only remembers the pointer.  The bytes are parsed and
+  // indexed by the next Find*() call, so adding is cheap but errors are only
+  // logged then.
+  void AddDeferred(const void* encoded_file_descriptor, int size);
+
   // Like FindFileContainingSymbol but returns only the name of the file.
   bool FindNameOfFileContainingSymbol(const string& symbol_name,
                                       string* output);
@@ -300,6 +305,10 @@ class LIBPROTOBUF_EXPORT EncodedDescriptorDatabase : public DescriptorDatabase {
  private:
   SimpleDescriptorDatabase::DescriptorIndex<pair<const void*, int> > index_;
   vector<void*> files_to_delete_;
+  vector<pair<const void*, int> > deferred_files_;
+
+  // Adds the files passed to AddDeferred() to index_.
+  void IndexDeferredFiles();
 
   // If encoded_file.first is non-NULL, parse the data into *output and return
   // true, otherwise return false.
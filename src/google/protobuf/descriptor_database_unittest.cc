@@ -514,6 +514,48 @@ TEST(EncodedDescriptorDatabaseExtraTest, FindNameOfFileContainingSymbol) {
   EXPECT_FALSE(db.FindNameOfFileContainingSymbol("baz.Baz", &filename));
 }
 
+TEST(EncodedDescriptorDatabaseExtraTest, AddDeferred) {
+  FileDescriptorProto file1, file2;
+  file1.set_name("foo.proto");
+  file1.set_package("foo");
+  file1.add_message_type()->set_name("Foo");
+  file2.set_name("bar.proto");
+  file2.add_dependency("foo.proto");
+  file2.add_message_type()->set_name("Bar");
+
+  string data1 = file1.SerializeAsString();
+  string data2 = file2.SerializeAsString();
+
+  EncodedDescriptorDatabase db;
+  db.AddDeferred(data1.data(), data1.size());
+
+  // Files are indexed on the first lookup, and files deferred after that are
+  // indexed on the next one.
+  FileDescriptorProto output;
+  ASSERT_TRUE(db.FindFileByName("foo.proto", &output));
+  EXPECT_EQ(file1.DebugString(), output.DebugString());
+  EXPECT_FALSE(db.FindFileContainingSymbol("Bar", &output));
+
+  db.AddDeferred(data2.data(), data2.size());
+  ASSERT_TRUE(db.FindFileContainingSymbol("Bar", &output));
+  EXPECT_EQ(file2.DebugString(), output.DebugString());
+
+  string filename;
+  EXPECT_TRUE(db.FindNameOfFileContainingSymbol("foo.Foo", &filename));
+  EXPECT_EQ("foo.proto", filename);
+
+  // Conflicts are reported when the deferred file is indexed.
+  db.AddDeferred(data1.data(), data1.size());
+  vector<string> errors;
+  {
+    ScopedMemoryLog log;
+    EXPECT_FALSE(db.FindFileByName("baz.proto", &output));
+    errors = log.GetMessages(ERROR);
+  }
+  EXPECT_EQ(1, errors.size());
+  EXPECT_TRUE(db.FindFileByName("foo.proto", &output));
+}
+
 // ===================================================================
 
 class MergedDescriptorDatabaseTest : public testing::Test {
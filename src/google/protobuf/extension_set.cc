@@ -32,10 +32,14 @@
 //  Based on original Protocol Buffers design by
 //  Sanjay Ghemawat, Jeff Dean, and others.
 
+#include <algorithm>
+
 #include <google/protobuf/stubs/hash.h>
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/stubs/once.h>
 #include <google/protobuf/extension_set.h>
+#include <google/protobuf/generated_message_util.h>
+#include <google/protobuf/lazy_field.h>
 #include <google/protobuf/message_lite.h>
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/wire_format_lite_inl.h>
@@ -172,25 +176,34 @@ void ExtensionSet::RegisterMessageExtension(const MessageLite* containing_type,
   Register(containing_type, number, info);
 }
 
+void ExtensionSet::RegisterLazyMessageExtension(
+    const MessageLite* containing_type, int number, FieldType type,
+    const MessageLite* prototype) {
+  GOOGLE_CHECK_EQ(type, WireFormatLite::TYPE_MESSAGE);
+  ExtensionInfo info(type, false, false);
+  info.message_prototype = prototype;
+  info.is_lazy = true;
+  Register(containing_type, number, info);
+}
+
 
 // ===================================================================
 // Constructors and basic methods.
 
-ExtensionSet::ExtensionSet(::google::protobuf::Arena* arena) : arena_(arena) {
-  if (arena_ != NULL) {
-    arena_->OwnDestructor(&extensions_);
-  }
-}
+ExtensionSet::ExtensionSet(::google::protobuf::Arena* arena)
+    : flat_(NULL), flat_size_(0), flat_capacity_(0), arena_(arena) {}
 
-ExtensionSet::ExtensionSet() : arena_(NULL) {}
+ExtensionSet::ExtensionSet()
+    : flat_(NULL), flat_size_(0), flat_capacity_(0), arena_(NULL) {}
 
 ExtensionSet::~ExtensionSet() {
-  // Deletes all allocated extensions.
+  // Deletes all allocated extensions.  When on an arena, both the extensions
+  // and the flat array itself are owned by the arena.
   if (arena_ == NULL) {
-    for (map<int, Extension>::iterator iter = extensions_.begin();
-         iter != extensions_.end(); ++iter) {
+    for (KeyValue* iter = flat_begin(); iter != flat_end(); ++iter) {
       iter->second.Free();
     }
+    delete[] flat_;
   }
 }
 
@@ -200,16 +213,15 @@ ExtensionSet::~ExtensionSet() {
 //                                 vector<const FieldDescriptor*>* output) const
 
 bool ExtensionSet::Has(int number) const {
-  map<int, Extension>::const_iterator iter = extensions_.find(number);
-  if (iter == extensions_.end()) return false;
-  GOOGLE_DCHECK(!iter->second.is_repeated);
-  return !iter->second.is_cleared;
+  const Extension* ext = FindOrNull(number);
+  if (ext == NULL) return false;
+  GOOGLE_DCHECK(!ext->is_repeated);
+  return !ext->is_cleared;
 }
 
 int ExtensionSet::NumExtensions() const {
   int result = 0;
-  for (map<int, Extension>::const_iterator iter = extensions_.begin();
-       iter != extensions_.end(); ++iter) {
+  for (const KeyValue* iter = flat_begin(); iter != flat_end(); ++iter) {
     if (!iter->second.is_cleared) {
       ++result;
     }
@@ -218,27 +230,27 @@ int ExtensionSet::NumExtensions() const {
 }
 
 int ExtensionSet::ExtensionSize(int number) const {
-  map<int, Extension>::const_iterator iter = extensions_.find(number);
-  if (iter == extensions_.end()) return false;
-  return iter->second.GetSize();
+  const Extension* ext = FindOrNull(number);
+  if (ext == NULL) return false;
+  return ext->GetSize();
 }
 
 FieldType ExtensionSet::ExtensionType(int number) const {
-  map<int, Extension>::const_iterator iter = extensions_.find(number);
-  if (iter == extensions_.end()) {
+  const Extension* ext = FindOrNull(number);
+  if (ext == NULL) {
     GOOGLE_LOG(DFATAL) << "Don't lookup extension types if they aren't present (1). ";
     return 0;
   }
-  if (iter->second.is_cleared) {
+  if (ext->is_cleared) {
     GOOGLE_LOG(DFATAL) << "Don't lookup extension types if they aren't present (2). ";
   }
-  return iter->second.type;
+  return ext->type;
 }
 
 void ExtensionSet::ClearExtension(int number) {
-  map<int, Extension>::iterator iter = extensions_.find(number);
-  if (iter == extensions_.end()) return;
-  iter->second.Clear();
+  Extension* ext = FindOrNull(number);
+  if (ext == NULL) return;
+  ext->Clear();
 }
 
 // ===================================================================
@@ -264,12 +276,12 @@ enum Cardinality {
                                                                                \
 LOWERCASE ExtensionSet::Get##CAMELCASE(int number,                             \
                                        LOWERCASE default_value) const {        \
-  map<int, Extension>::const_iterator iter = extensions_.find(number);         \
-  if (iter == extensions_.end() || iter->second.is_cleared) {                  \
+  const Extension* ext = FindOrNull(number);                                   \
+  if (ext == NULL || ext->is_cleared) {                                        \
     return default_value;                                                      \
   } else {                                                                     \
-    GOOGLE_DCHECK_TYPE(iter->second, OPTIONAL, UPPERCASE);                            \
-    return iter->second.LOWERCASE##_value;                                     \
+    GOOGLE_DCHECK_TYPE(*ext, OPTIONAL, UPPERCASE);                             \
+    return ext->LOWERCASE##_value;                                             \
   }                                                                            \
 }                                                                              \
                                                                                \
@@ -289,18 +301,18 @@ void ExtensionSet::Set##CAMELCASE(int number, FieldType type,                  \
 }                                                                              \
                                                                                \
 LOWERCASE ExtensionSet::GetRepeated##CAMELCASE(int number, int index) const {  \
-  map<int, Extension>::const_iterator iter = extensions_.find(number);         \
-  GOOGLE_CHECK(iter != extensions_.end()) << "Index out-of-bounds (field is empty)."; \
-  GOOGLE_DCHECK_TYPE(iter->second, REPEATED, UPPERCASE);                              \
-  return iter->second.repeated_##LOWERCASE##_value->Get(index);                \
+  const Extension* ext = FindOrNull(number);                                   \
+  GOOGLE_CHECK(ext != NULL) << "Index out-of-bounds (field is empty).";        \
+  GOOGLE_DCHECK_TYPE(*ext, REPEATED, UPPERCASE);                               \
+  return ext->repeated_##LOWERCASE##_value->Get(index);                        \
 }                                                                              \
                                                                                \
 void ExtensionSet::SetRepeated##CAMELCASE(                                     \
     int number, int index, LOWERCASE value) {                                  \
-  map<int, Extension>::iterator iter = extensions_.find(number);               \
-  GOOGLE_CHECK(iter != extensions_.end()) << "Index out-of-bounds (field is empty)."; \
-  GOOGLE_DCHECK_TYPE(iter->second, REPEATED, UPPERCASE);                              \
-  iter->second.repeated_##LOWERCASE##_value->Set(index, value);                \
+  Extension* ext = FindOrNull(number);                                         \
+  GOOGLE_CHECK(ext != NULL) << "Index out-of-bounds (field is empty).";        \
+  GOOGLE_DCHECK_TYPE(*ext, REPEATED, UPPERCASE);                               \
+  ext->repeated_##LOWERCASE##_value->Set(index, value);                        \
 }                                                                              \
                                                                                \
 void ExtensionSet::Add##CAMELCASE(int number, FieldType type,                  \
@@ -333,13 +345,13 @@ PRIMITIVE_ACCESSORS(  BOOL,   bool,   Bool)
 
 const void* ExtensionSet::GetRawRepeatedField(int number,
                                               const void* default_value) const {
-  map<int, Extension>::const_iterator iter = extensions_.find(number);
-  if (iter == extensions_.end()) {
+  const Extension* ext = FindOrNull(number);
+  if (ext == NULL) {
     return default_value;
   }
   // We assume that all the RepeatedField<>* pointers have the same
   // size and alignment within the anonymous union in Extension.
-  return iter->second.repeated_int32_value;
+  return ext->repeated_int32_value;
 }
 
 void* ExtensionSet::MutableRawRepeatedField(int number, FieldType field_type,
@@ -407,11 +419,11 @@ void* ExtensionSet::MutableRawRepeatedField(int number, FieldType field_type,
 // Compatible version using old call signature. Does not create extensions when
 // the don't already exist; instead, just GOOGLE_CHECK-fails.
 void* ExtensionSet::MutableRawRepeatedField(int number) {
-  map<int, Extension>::iterator iter = extensions_.find(number);
-  GOOGLE_CHECK(iter == extensions_.end()) << "Extension not found.";
+  Extension* ext = FindOrNull(number);
+  GOOGLE_CHECK(ext == NULL) << "Extension not found.";
   // We assume that all the RepeatedField<>* pointers have the same
   // size and alignment within the anonymous union in Extension.
-  return iter->second.repeated_int32_value;
+  return ext->repeated_int32_value;
 }
 
 
@@ -419,13 +431,13 @@ void* ExtensionSet::MutableRawRepeatedField(int number) {
 // Enums
 
 int ExtensionSet::GetEnum(int number, int default_value) const {
-  map<int, Extension>::const_iterator iter = extensions_.find(number);
-  if (iter == extensions_.end() || iter->second.is_cleared) {
+  const Extension* ext = FindOrNull(number);
+  if (ext == NULL || ext->is_cleared) {
     // Not present.  Return the default value.
     return default_value;
   } else {
-    GOOGLE_DCHECK_TYPE(iter->second, OPTIONAL, ENUM);
-    return iter->second.enum_value;
+    GOOGLE_DCHECK_TYPE(*ext, OPTIONAL, ENUM);
+    return ext->enum_value;
   }
 }
 
@@ -444,17 +456,17 @@ void ExtensionSet::SetEnum(int number, FieldType type, int value,
 }
 
 int ExtensionSet::GetRepeatedEnum(int number, int index) const {
-  map<int, Extension>::const_iterator iter = extensions_.find(number);
-  GOOGLE_CHECK(iter != extensions_.end()) << "Index out-of-bounds (field is empty).";
-  GOOGLE_DCHECK_TYPE(iter->second, REPEATED, ENUM);
-  return iter->second.repeated_enum_value->Get(index);
+  const Extension* ext = FindOrNull(number);
+  GOOGLE_CHECK(ext != NULL) << "Index out-of-bounds (field is empty).";
+  GOOGLE_DCHECK_TYPE(*ext, REPEATED, ENUM);
+  return ext->repeated_enum_value->Get(index);
 }
 
 void ExtensionSet::SetRepeatedEnum(int number, int index, int value) {
-  map<int, Extension>::iterator iter = extensions_.find(number);
-  GOOGLE_CHECK(iter != extensions_.end()) << "Index out-of-bounds (field is empty).";
-  GOOGLE_DCHECK_TYPE(iter->second, REPEATED, ENUM);
-  iter->second.repeated_enum_value->Set(index, value);
+  Extension* ext = FindOrNull(number);
+  GOOGLE_CHECK(ext != NULL) << "Index out-of-bounds (field is empty).";
+  GOOGLE_DCHECK_TYPE(*ext, REPEATED, ENUM);
+  ext->repeated_enum_value->Set(index, value);
 }
 
 void ExtensionSet::AddEnum(int number, FieldType type,
@@ -480,13 +492,13 @@ void ExtensionSet::AddEnum(int number, FieldType type,
 
 const string& ExtensionSet::GetString(int number,
                                       const string& default_value) const {
-  map<int, Extension>::const_iterator iter = extensions_.find(number);
-  if (iter == extensions_.end() || iter->second.is_cleared) {
+  const Extension* ext = FindOrNull(number);
+  if (ext == NULL || ext->is_cleared) {
     // Not present.  Return the default value.
     return default_value;
   } else {
-    GOOGLE_DCHECK_TYPE(iter->second, OPTIONAL, STRING);
-    return *iter->second.string_value;
+    GOOGLE_DCHECK_TYPE(*ext, OPTIONAL, STRING);
+    return *ext->string_value;
   }
 }
 
@@ -506,17 +518,17 @@ string* ExtensionSet::MutableString(int number, FieldType type,
 }
 
 const string& ExtensionSet::GetRepeatedString(int number, int index) const {
-  map<int, Extension>::const_iterator iter = extensions_.find(number);
-  GOOGLE_CHECK(iter != extensions_.end()) << "Index out-of-bounds (field is empty).";
-  GOOGLE_DCHECK_TYPE(iter->second, REPEATED, STRING);
-  return iter->second.repeated_string_value->Get(index);
+  const Extension* ext = FindOrNull(number);
+  GOOGLE_CHECK(ext != NULL) << "Index out-of-bounds (field is empty).";
+  GOOGLE_DCHECK_TYPE(*ext, REPEATED, STRING);
+  return ext->repeated_string_value->Get(index);
 }
 
 string* ExtensionSet::MutableRepeatedString(int number, int index) {
-  map<int, Extension>::iterator iter = extensions_.find(number);
-  GOOGLE_CHECK(iter != extensions_.end()) << "Index out-of-bounds (field is empty).";
-  GOOGLE_DCHECK_TYPE(iter->second, REPEATED, STRING);
-  return iter->second.repeated_string_value->Mutable(index);
+  Extension* ext = FindOrNull(number);
+  GOOGLE_CHECK(ext != NULL) << "Index out-of-bounds (field is empty).";
+  GOOGLE_DCHECK_TYPE(*ext, REPEATED, STRING);
+  return ext->repeated_string_value->Mutable(index);
 }
 
 string* ExtensionSet::AddString(int number, FieldType type,
@@ -540,16 +552,16 @@ string* ExtensionSet::AddString(int number, FieldType type,
 
 const MessageLite& ExtensionSet::GetMessage(
     int number, const MessageLite& default_value) const {
-  map<int, Extension>::const_iterator iter = extensions_.find(number);
-  if (iter == extensions_.end()) {
+  const Extension* ext = FindOrNull(number);
+  if (ext == NULL) {
     // Not present.  Return the default value.
     return default_value;
   } else {
-    GOOGLE_DCHECK_TYPE(iter->second, OPTIONAL, MESSAGE);
-    if (iter->second.is_lazy) {
-      return iter->second.lazymessage_value->GetMessage(default_value);
+    GOOGLE_DCHECK_TYPE(*ext, OPTIONAL, MESSAGE);
+    if (ext->is_lazy) {
+      return ext->lazymessage_value->GetMessage(default_value);
     } else {
-      return *iter->second.message_value;
+      return *ext->message_value;
     }
   }
 }
@@ -633,52 +645,52 @@ void ExtensionSet::SetAllocatedMessage(int number, FieldType type,
 
 MessageLite* ExtensionSet::ReleaseMessage(int number,
                                           const MessageLite& prototype) {
-  map<int, Extension>::iterator iter = extensions_.find(number);
-  if (iter == extensions_.end()) {
+  Extension* ext = FindOrNull(number);
+  if (ext == NULL) {
     // Not present.  Return NULL.
     return NULL;
   } else {
-    GOOGLE_DCHECK_TYPE(iter->second, OPTIONAL, MESSAGE);
+    GOOGLE_DCHECK_TYPE(*ext, OPTIONAL, MESSAGE);
     MessageLite* ret = NULL;
-    if (iter->second.is_lazy) {
-      ret = iter->second.lazymessage_value->ReleaseMessage(prototype);
+    if (ext->is_lazy) {
+      ret = ext->lazymessage_value->ReleaseMessage(prototype);
       if (arena_ == NULL) {
-        delete iter->second.lazymessage_value;
+        delete ext->lazymessage_value;
       }
     } else {
       if (arena_ == NULL) {
-        ret = iter->second.message_value;
+        ret = ext->message_value;
       } else {
         // ReleaseMessage() always returns a heap-allocated message, and we are
         // on an arena, so we need to make a copy of this message to return.
-        ret = (iter->second.message_value)->New();
-        ret->CheckTypeAndMergeFrom(*iter->second.message_value);
+        ret = (ext->message_value)->New();
+        ret->CheckTypeAndMergeFrom(*ext->message_value);
       }
     }
-    extensions_.erase(number);
+    Erase(number);
     return ret;
   }
 }
 
 MessageLite* ExtensionSet::UnsafeArenaReleaseMessage(
     int number, const MessageLite& prototype) {
-  map<int, Extension>::iterator iter = extensions_.find(number);
-  if (iter == extensions_.end()) {
+  Extension* ext = FindOrNull(number);
+  if (ext == NULL) {
     // Not present.  Return NULL.
     return NULL;
   } else {
-    GOOGLE_DCHECK_TYPE(iter->second, OPTIONAL, MESSAGE);
+    GOOGLE_DCHECK_TYPE(*ext, OPTIONAL, MESSAGE);
     MessageLite* ret = NULL;
-    if (iter->second.is_lazy) {
+    if (ext->is_lazy) {
       ret =
-        iter->second.lazymessage_value->UnsafeArenaReleaseMessage(prototype);
+        ext->lazymessage_value->UnsafeArenaReleaseMessage(prototype);
       if (arena_ == NULL) {
-        delete iter->second.lazymessage_value;
+        delete ext->lazymessage_value;
       }
     } else {
-      ret = iter->second.message_value;
+      ret = ext->message_value;
     }
-    extensions_.erase(number);
+    Erase(number);
     return ret;
   }
 }
@@ -689,17 +701,17 @@ MessageLite* ExtensionSet::UnsafeArenaReleaseMessage(
 
 const MessageLite& ExtensionSet::GetRepeatedMessage(
     int number, int index) const {
-  map<int, Extension>::const_iterator iter = extensions_.find(number);
-  GOOGLE_CHECK(iter != extensions_.end()) << "Index out-of-bounds (field is empty).";
-  GOOGLE_DCHECK_TYPE(iter->second, REPEATED, MESSAGE);
-  return iter->second.repeated_message_value->Get(index);
+  const Extension* ext = FindOrNull(number);
+  GOOGLE_CHECK(ext != NULL) << "Index out-of-bounds (field is empty).";
+  GOOGLE_DCHECK_TYPE(*ext, REPEATED, MESSAGE);
+  return ext->repeated_message_value->Get(index);
 }
 
 MessageLite* ExtensionSet::MutableRepeatedMessage(int number, int index) {
-  map<int, Extension>::iterator iter = extensions_.find(number);
-  GOOGLE_CHECK(iter != extensions_.end()) << "Index out-of-bounds (field is empty).";
-  GOOGLE_DCHECK_TYPE(iter->second, REPEATED, MESSAGE);
-  return iter->second.repeated_message_value->Mutable(index);
+  Extension* ext = FindOrNull(number);
+  GOOGLE_CHECK(ext != NULL) << "Index out-of-bounds (field is empty).";
+  GOOGLE_DCHECK_TYPE(*ext, REPEATED, MESSAGE);
+  return ext->repeated_message_value->Mutable(index);
 }
 
 MessageLite* ExtensionSet::AddMessage(int number, FieldType type,
@@ -735,10 +747,10 @@ MessageLite* ExtensionSet::AddMessage(int number, FieldType type,
 #undef GOOGLE_DCHECK_TYPE
 
 void ExtensionSet::RemoveLast(int number) {
-  map<int, Extension>::iterator iter = extensions_.find(number);
-  GOOGLE_CHECK(iter != extensions_.end()) << "Index out-of-bounds (field is empty).";
+  Extension* ext = FindOrNull(number);
+  GOOGLE_CHECK(ext != NULL) << "Index out-of-bounds (field is empty).";
 
-  Extension* extension = &iter->second;
+  Extension* extension = &*ext;
   GOOGLE_DCHECK(extension->is_repeated);
 
   switch(cpp_type(extension->type)) {
@@ -776,20 +788,20 @@ void ExtensionSet::RemoveLast(int number) {
 }
 
 MessageLite* ExtensionSet::ReleaseLast(int number) {
-  map<int, Extension>::iterator iter = extensions_.find(number);
-  GOOGLE_CHECK(iter != extensions_.end()) << "Index out-of-bounds (field is empty).";
+  Extension* ext = FindOrNull(number);
+  GOOGLE_CHECK(ext != NULL) << "Index out-of-bounds (field is empty).";
 
-  Extension* extension = &iter->second;
+  Extension* extension = &*ext;
   GOOGLE_DCHECK(extension->is_repeated);
   GOOGLE_DCHECK(cpp_type(extension->type) == WireFormatLite::CPPTYPE_MESSAGE);
   return extension->repeated_message_value->ReleaseLast();
 }
 
 void ExtensionSet::SwapElements(int number, int index1, int index2) {
-  map<int, Extension>::iterator iter = extensions_.find(number);
-  GOOGLE_CHECK(iter != extensions_.end()) << "Index out-of-bounds (field is empty).";
+  Extension* ext = FindOrNull(number);
+  GOOGLE_CHECK(ext != NULL) << "Index out-of-bounds (field is empty).";
 
-  Extension* extension = &iter->second;
+  Extension* extension = &*ext;
   GOOGLE_DCHECK(extension->is_repeated);
 
   switch(cpp_type(extension->type)) {
@@ -829,15 +841,14 @@ void ExtensionSet::SwapElements(int number, int index1, int index2) {
 // ===================================================================
 
 void ExtensionSet::Clear() {
-  for (map<int, Extension>::iterator iter = extensions_.begin();
-       iter != extensions_.end(); ++iter) {
+  for (KeyValue* iter = flat_begin(); iter != flat_end(); ++iter) {
     iter->second.Clear();
   }
 }
 
 void ExtensionSet::MergeFrom(const ExtensionSet& other) {
-  for (map<int, Extension>::const_iterator iter = other.extensions_.begin();
-       iter != other.extensions_.end(); ++iter) {
+  for (const KeyValue* iter = other.flat_begin();
+       iter != other.flat_end(); ++iter) {
     const Extension& other_extension = iter->second;
     InternalExtensionMergeFrom(iter->first, other_extension);
   }
@@ -983,7 +994,10 @@ void ExtensionSet::InternalExtensionMergeFrom(
 
 void ExtensionSet::Swap(ExtensionSet* x) {
   if (GetArenaNoVirtual() == x->GetArenaNoVirtual()) {
-    extensions_.swap(x->extensions_);
+    using std::swap;
+    swap(flat_, x->flat_);
+    swap(flat_size_, x->flat_size_);
+    swap(flat_capacity_, x->flat_capacity_);
   } else {
     // TODO(cfallin, rohananil): We maybe able to optimize a case where we are
     // swapping from heap to arena-allocated extension set, by just Own()'ing
@@ -1000,19 +1014,17 @@ void ExtensionSet::Swap(ExtensionSet* x) {
 void ExtensionSet::SwapExtension(ExtensionSet* other,
                                  int number) {
   if (this == other) return;
-  map<int, Extension>::iterator this_iter = extensions_.find(number);
-  map<int, Extension>::iterator other_iter = other->extensions_.find(number);
+  Extension* this_ext = FindOrNull(number);
+  Extension* other_ext = other->FindOrNull(number);
 
-  if (this_iter == extensions_.end() &&
-      other_iter == other->extensions_.end()) {
+  if (this_ext == NULL && other_ext == NULL) {
     return;
   }
 
-  if (this_iter != extensions_.end() &&
-      other_iter != other->extensions_.end()) {
+  if (this_ext != NULL && other_ext != NULL) {
     if (GetArenaNoVirtual() == other->GetArenaNoVirtual()) {
       using std::swap;
-      swap(this_iter->second, other_iter->second);
+      swap(*this_ext, *other_ext);
     } else {
       // TODO(cfallin, rohananil): We could further optimize these cases,
       // especially avoid creation of ExtensionSet, and move MergeFrom logic
@@ -1020,33 +1032,33 @@ void ExtensionSet::SwapExtension(ExtensionSet* other,
       // We do it this way to reuse the copy-across-arenas logic already
       // implemented in ExtensionSet's MergeFrom.
       ExtensionSet temp;
-      temp.InternalExtensionMergeFrom(number, other_iter->second);
-      map<int, Extension>::iterator temp_iter = temp.extensions_.find(number);
-      other_iter->second.Clear();
-      other->InternalExtensionMergeFrom(number, this_iter->second);
-      this_iter->second.Clear();
-      InternalExtensionMergeFrom(number, temp_iter->second);
+      temp.InternalExtensionMergeFrom(number, *other_ext);
+      Extension* temp_ext = temp.FindOrNull(number);
+      other_ext->Clear();
+      other->InternalExtensionMergeFrom(number, *this_ext);
+      this_ext->Clear();
+      InternalExtensionMergeFrom(number, *temp_ext);
     }
     return;
   }
 
-  if (this_iter == extensions_.end()) {
+  if (this_ext == NULL) {
     if (GetArenaNoVirtual() == other->GetArenaNoVirtual()) {
-      extensions_.insert(make_pair(number, other_iter->second));
+      *Insert(number).first = *other_ext;
     } else {
-      InternalExtensionMergeFrom(number, other_iter->second);
+      InternalExtensionMergeFrom(number, *other_ext);
     }
-    other->extensions_.erase(number);
+    other->Erase(number);
     return;
   }
 
-  if (other_iter == other->extensions_.end()) {
+  if (other_ext == NULL) {
     if (GetArenaNoVirtual() == other->GetArenaNoVirtual()) {
-      other->extensions_.insert(make_pair(number, this_iter->second));
+      *other->Insert(number).first = *this_ext;
     } else {
-      other->InternalExtensionMergeFrom(number, this_iter->second);
+      other->InternalExtensionMergeFrom(number, *this_ext);
     }
-    extensions_.erase(number);
+    Erase(number);
     return;
   }
 }
@@ -1054,8 +1066,7 @@ void ExtensionSet::SwapExtension(ExtensionSet* other,
 bool ExtensionSet::IsInitialized() const {
   // Extensions are never required.  However, we need to check that all
   // embedded messages are initialized.
-  for (map<int, Extension>::const_iterator iter = extensions_.begin();
-       iter != extensions_.end(); ++iter) {
+  for (const KeyValue* iter = flat_begin(); iter != flat_end(); ++iter) {
     const Extension& extension = iter->second;
     if (cpp_type(extension.type) == WireFormatLite::CPPTYPE_MESSAGE) {
       if (extension.is_repeated) {
@@ -1269,6 +1280,10 @@ bool ExtensionSet::ParseFieldWithExtensionInfo(
       }
 
       case WireFormatLite::TYPE_MESSAGE: {
+        if (extension.is_lazy && !extension.is_repeated) {
+          if (!ParseLazyMessage(number, extension, input)) return false;
+          break;
+        }
         MessageLite* value = extension.is_repeated ?
             AddMessage(number, WireFormatLite::TYPE_MESSAGE,
                        *extension.message_prototype, extension.descriptor) :
@@ -1283,6 +1298,29 @@ bool ExtensionSet::ParseFieldWithExtensionInfo(
   return true;
 }
 
+bool ExtensionSet::ParseLazyMessage(int number, const ExtensionInfo& extension,
+                                    io::CodedInputStream* input) {
+  Extension* ext;
+  if (MaybeNewExtension(number, extension.descriptor, &ext)) {
+    ext->type = WireFormatLite::TYPE_MESSAGE;
+    ext->is_repeated = false;
+    ext->is_lazy = true;
+    ext->lazymessage_value = Arena::Create<LazyField>(arena_, arena_);
+  } else {
+    GOOGLE_DCHECK(!ext->is_repeated);
+    GOOGLE_DCHECK_EQ(cpp_type(ext->type), WireFormatLite::CPPTYPE_MESSAGE);
+  }
+  ext->is_cleared = false;
+  if (ext->is_lazy) {
+    return ext->lazymessage_value->ReadMessage(*extension.message_prototype,
+                                               input);
+  } else {
+    // The extension was already set through the eager accessors; merge into
+    // the existing message.
+    return WireFormatLite::ReadMessage(input, ext->message_value);
+  }
+}
+
 bool ExtensionSet::ParseField(uint32 tag, io::CodedInputStream* input,
                               const MessageLite* containing_type) {
   FieldSkipper skipper;
@@ -1311,9 +1349,9 @@ bool ExtensionSet::ParseField(uint32 tag, io::CodedInputStream* input,
 void ExtensionSet::SerializeWithCachedSizes(
     int start_field_number, int end_field_number,
     io::CodedOutputStream* output) const {
-  map<int, Extension>::const_iterator iter;
-  for (iter = extensions_.lower_bound(start_field_number);
-       iter != extensions_.end() && iter->first < end_field_number;
+  const KeyValue* end = flat_end();
+  for (const KeyValue* iter = LowerBound(start_field_number);
+       iter != end && iter->first < end_field_number;
        ++iter) {
     iter->second.SerializeFieldWithCachedSizes(iter->first, output);
   }
@@ -1322,8 +1360,7 @@ void ExtensionSet::SerializeWithCachedSizes(
 int ExtensionSet::ByteSize() const {
   int total_size = 0;
 
-  for (map<int, Extension>::const_iterator iter = extensions_.begin();
-       iter != extensions_.end(); ++iter) {
+  for (const KeyValue* iter = flat_begin(); iter != flat_end(); ++iter) {
     total_size += iter->second.ByteSize(iter->first);
   }
 
@@ -1333,16 +1370,95 @@ int ExtensionSet::ByteSize() const {
 // Defined in extension_set_heavy.cc.
 // int ExtensionSet::SpaceUsedExcludingSelf() const
 
+size_t ExtensionSet::SpaceUsedExcludingSelfLong() const {
+  size_t total_size = flat_capacity_ * sizeof(KeyValue);
+  for (const KeyValue* iter = flat_begin(); iter != flat_end(); ++iter) {
+    total_size += iter->second.SpaceUsedExcludingSelfLong();
+  }
+  return total_size;
+}
+
 bool ExtensionSet::MaybeNewExtension(int number,
                                      const FieldDescriptor* descriptor,
                                      Extension** result) {
-  pair<map<int, Extension>::iterator, bool> insert_result =
-    extensions_.insert(make_pair(number, Extension()));
-  *result = &insert_result.first->second;
+  pair<Extension*, bool> insert_result = Insert(number);
+  *result = insert_result.first;
   (*result)->descriptor = descriptor;
   return insert_result.second;
 }
 
+// -------------------------------------------------------------------
+// Flat storage
+
+namespace {
+
+struct KeyValueLess {
+  template <typename KeyValue>
+  bool operator()(const KeyValue& kv, int number) const {
+    return kv.first < number;
+  }
+};
+
+}  // namespace
+
+const ExtensionSet::KeyValue* ExtensionSet::LowerBound(int number) const {
+  return std::lower_bound(flat_begin(), flat_end(), number, KeyValueLess());
+}
+
+const ExtensionSet::Extension* ExtensionSet::FindOrNull(int number) const {
+  const KeyValue* it = LowerBound(number);
+  return it != flat_end() && it->first == number ? &it->second : NULL;
+}
+
+ExtensionSet::Extension* ExtensionSet::FindOrNull(int number) {
+  return const_cast<Extension*>(
+      static_cast<const ExtensionSet*>(this)->FindOrNull(number));
+}
+
+pair<ExtensionSet::Extension*, bool> ExtensionSet::Insert(int number) {
+  // Parsing sees extensions in field-number order for anything we serialized
+  // ourselves, so check for an append before paying for the binary search.
+  KeyValue* it = flat_end();
+  if (flat_size_ > 0 && number <= it[-1].first) {
+    it = const_cast<KeyValue*>(LowerBound(number));
+    if (it->first == number) return make_pair(&it->second, false);
+  }
+
+  if (flat_size_ == flat_capacity_) {
+    int index = it - flat_;
+    GrowCapacity(flat_size_ + 1);
+    it = flat_ + index;
+  }
+  std::copy_backward(it, flat_end(), flat_end() + 1);
+  ++flat_size_;
+  it->first = number;
+  memset(&it->second, 0, sizeof(it->second));
+  return make_pair(&it->second, true);
+}
+
+void ExtensionSet::Erase(int number) {
+  KeyValue* it = const_cast<KeyValue*>(LowerBound(number));
+  if (it == flat_end() || it->first != number) return;
+  std::copy(it + 1, flat_end(), it);
+  --flat_size_;
+}
+
+void ExtensionSet::GrowCapacity(int minimum) {
+  if (minimum <= flat_capacity_) return;
+  // Start small since most sets hold only a few extensions, then double.
+  int new_capacity = flat_capacity_ == 0 ? 4 : flat_capacity_;
+  while (new_capacity < minimum) {
+    new_capacity *= 2;
+  }
+  KeyValue* new_flat = Arena::CreateArray<KeyValue>(arena_, new_capacity);
+  std::copy(flat_begin(), flat_end(), new_flat);
+  if (arena_ == NULL) {
+    delete[] flat_;
+  }
+  flat_ = new_flat;
+  flat_capacity_ = new_capacity;
+}
+
 // ===================================================================
 // Methods of ExtensionSet::Extension
 
@@ -1501,52 +1617,57 @@ void ExtensionSet::Extension::SerializeFieldWithCachedSizes(
   }
 }
 
-int ExtensionSet::Extension::ByteSize(int number) const {
+int ExtensionSet::Extension::PackedDataSize() const {
   int result = 0;
-
-  if (is_repeated) {
-    if (is_packed) {
-      switch (real_type(type)) {
+  switch (real_type(type)) {
 #define HANDLE_TYPE(UPPERCASE, CAMELCASE, LOWERCASE)                        \
-        case WireFormatLite::TYPE_##UPPERCASE:                              \
-          for (int i = 0; i < repeated_##LOWERCASE##_value->size(); i++) {  \
-            result += WireFormatLite::CAMELCASE##Size(                      \
-              repeated_##LOWERCASE##_value->Get(i));                        \
-          }                                                                 \
-          break
-
-        HANDLE_TYPE(   INT32,    Int32,   int32);
-        HANDLE_TYPE(   INT64,    Int64,   int64);
-        HANDLE_TYPE(  UINT32,   UInt32,  uint32);
-        HANDLE_TYPE(  UINT64,   UInt64,  uint64);
-        HANDLE_TYPE(  SINT32,   SInt32,   int32);
-        HANDLE_TYPE(  SINT64,   SInt64,   int64);
-        HANDLE_TYPE(    ENUM,     Enum,    enum);
+    case WireFormatLite::TYPE_##UPPERCASE:                                  \
+      for (int i = 0; i < repeated_##LOWERCASE##_value->size(); i++) {      \
+        result += WireFormatLite::CAMELCASE##Size(                          \
+          repeated_##LOWERCASE##_value->Get(i));                            \
+      }                                                                     \
+      break
+
+    HANDLE_TYPE(   INT32,    Int32,   int32);
+    HANDLE_TYPE(   INT64,    Int64,   int64);
+    HANDLE_TYPE(  UINT32,   UInt32,  uint32);
+    HANDLE_TYPE(  UINT64,   UInt64,  uint64);
+    HANDLE_TYPE(  SINT32,   SInt32,   int32);
+    HANDLE_TYPE(  SINT64,   SInt64,   int64);
+    HANDLE_TYPE(    ENUM,     Enum,    enum);
 #undef HANDLE_TYPE
 
-        // Stuff with fixed size.
+    // Stuff with fixed size.
 #define HANDLE_TYPE(UPPERCASE, CAMELCASE, LOWERCASE)                        \
-        case WireFormatLite::TYPE_##UPPERCASE:                              \
-          result += WireFormatLite::k##CAMELCASE##Size *                    \
-                    repeated_##LOWERCASE##_value->size();                   \
-          break
-        HANDLE_TYPE( FIXED32,  Fixed32, uint32);
-        HANDLE_TYPE( FIXED64,  Fixed64, uint64);
-        HANDLE_TYPE(SFIXED32, SFixed32,  int32);
-        HANDLE_TYPE(SFIXED64, SFixed64,  int64);
-        HANDLE_TYPE(   FLOAT,    Float,  float);
-        HANDLE_TYPE(  DOUBLE,   Double, double);
-        HANDLE_TYPE(    BOOL,     Bool,   bool);
+    case WireFormatLite::TYPE_##UPPERCASE:                                  \
+      result += WireFormatLite::k##CAMELCASE##Size *                        \
+                repeated_##LOWERCASE##_value->size();                       \
+      break
+    HANDLE_TYPE( FIXED32,  Fixed32, uint32);
+    HANDLE_TYPE( FIXED64,  Fixed64, uint64);
+    HANDLE_TYPE(SFIXED32, SFixed32,  int32);
+    HANDLE_TYPE(SFIXED64, SFixed64,  int64);
+    HANDLE_TYPE(   FLOAT,    Float,  float);
+    HANDLE_TYPE(  DOUBLE,   Double, double);
+    HANDLE_TYPE(    BOOL,     Bool,   bool);
 #undef HANDLE_TYPE
 
-        case WireFormatLite::TYPE_STRING:
-        case WireFormatLite::TYPE_BYTES:
-        case WireFormatLite::TYPE_GROUP:
-        case WireFormatLite::TYPE_MESSAGE:
-          GOOGLE_LOG(FATAL) << "Non-primitive types can't be packed.";
-          break;
-      }
+    case WireFormatLite::TYPE_STRING:
+    case WireFormatLite::TYPE_BYTES:
+    case WireFormatLite::TYPE_GROUP:
+    case WireFormatLite::TYPE_MESSAGE:
+      GOOGLE_LOG(FATAL) << "Non-primitive types can't be packed.";
+      break;
+  }
+  return result;
+}
 
+int ExtensionSet::Extension::ByteSize(int number) const {
+  int result = 0;
+
+  if (is_repeated) {
+    if (is_packed) {
+      result = PackedDataSize();
       cached_size = result;
       if (result > 0) {
         result += io::CodedOutputStream::VarintSize32(result);
@@ -1711,6 +1832,49 @@ void ExtensionSet::Extension::Free() {
 // Defined in extension_set_heavy.cc.
 // int ExtensionSet::Extension::SpaceUsedExcludingSelf() const
 
+size_t ExtensionSet::Extension::SpaceUsedExcludingSelfLong() const {
+  size_t total_size = 0;
+  if (is_repeated) {
+    switch (cpp_type(type)) {
+#define HANDLE_TYPE(UPPERCASE, LOWERCASE)                              \
+      case WireFormatLite::CPPTYPE_##UPPERCASE:                        \
+        total_size += sizeof(*repeated_##LOWERCASE##_value) +          \
+            repeated_##LOWERCASE##_value->SpaceUsedExcludingSelfLong();\
+        break
+
+      HANDLE_TYPE(  INT32,   int32);
+      HANDLE_TYPE(  INT64,   int64);
+      HANDLE_TYPE( UINT32,  uint32);
+      HANDLE_TYPE( UINT64,  uint64);
+      HANDLE_TYPE(  FLOAT,   float);
+      HANDLE_TYPE( DOUBLE,  double);
+      HANDLE_TYPE(   BOOL,    bool);
+      HANDLE_TYPE(   ENUM,    enum);
+      HANDLE_TYPE( STRING,  string);
+      HANDLE_TYPE(MESSAGE, message);
+#undef HANDLE_TYPE
+    }
+  } else {
+    switch (cpp_type(type)) {
+      case WireFormatLite::CPPTYPE_STRING:
+        total_size += sizeof(*string_value) +
+                      StringSpaceUsedExcludingSelf(*string_value);
+        break;
+      case WireFormatLite::CPPTYPE_MESSAGE:
+        if (is_lazy) {
+          total_size += lazymessage_value->SpaceUsed();
+        } else {
+          total_size += message_value->SpaceUsedLong();
+        }
+        break;
+      default:
+        // No extra storage costs for primitive types.
+        break;
+    }
+  }
+  return total_size;
+}
+
 // ==================================================================
 // Default repeated field instances for iterator-compatible accessors
 
@@ -62,6 +62,7 @@ namespace protobuf {
   namespace io {
     class CodedInputStream;                              // coded_stream.h
     class CodedOutputStream;                             // coded_stream.h
+    class ReverseCodedBuffer;                            // coded_stream.h
   }
   namespace internal {
     class FieldSkipper;                                  // wire_format_lite.h
@@ -91,11 +92,14 @@ struct ExtensionInfo {
   inline ExtensionInfo() {}
   inline ExtensionInfo(FieldType type_param, bool isrepeated, bool ispacked)
       : type(type_param), is_repeated(isrepeated), is_packed(ispacked),
-        descriptor(NULL) {}
+        is_lazy(false), descriptor(NULL) {}
 
   FieldType type;
   bool is_repeated;
   bool is_packed;
+  // If true, this singular message extension is kept in serialized form
+  // until it is first accessed.  See LazyField.
+  bool is_lazy;
 
   struct EnumValidityCheck {
     EnumValidityFuncWithArg* func;
@@ -177,6 +181,11 @@ class LIBPROTOBUF_EXPORT ExtensionSet {
                                        int number, FieldType type,
                                        bool is_repeated, bool is_packed,
                                        const MessageLite* prototype);
+  // Like RegisterMessageExtension(), for a singular message extension marked
+  // [lazy=true].  Such extensions are parsed lazily; see LazyField.
+  static void RegisterLazyMessageExtension(const MessageLite* containing_type,
+                                           int number, FieldType type,
+                                           const MessageLite* prototype);
 
   // =================================================================
 
@@ -400,6 +409,14 @@ class LIBPROTOBUF_EXPORT ExtensionSet {
                                          int end_field_number,
                                          uint8* target) const;
 
+  // Prepends the extensions in [start_field_number, end_field_number) to
+  // *output, for generated InternalSerializeReverse() methods.  Message
+  // extensions do not need cached sizes; other extensions are sized one at a
+  // time.  Defined in extension_set_heavy.cc.
+  void InternalSerializeReverse(int start_field_number,
+                                int end_field_number,
+                                io::ReverseCodedBuffer* output) const;
+
   // Like above but serializes in MessageSet format.
   void SerializeMessageSetWithCachedSizes(io::CodedOutputStream* output) const;
   uint8* SerializeMessageSetWithCachedSizesToArray(uint8* target) const;
@@ -419,7 +436,21 @@ class LIBPROTOBUF_EXPORT ExtensionSet {
   // SpaceUsed()).
   int SpaceUsedExcludingSelf() const;
 
+  // Like SpaceUsedExcludingSelf(), but sizes message extensions with
+  // MessageLite::SpaceUsedLong(), so it works for lite messages too.
+  size_t SpaceUsedExcludingSelfLong() const;
+
+  // Implement the extension parts of Message::StructuralHash() and
+  // Message::StructurallyEquals(), matching what ReflectionOps computes for
+  // the same extensions.  Like SpaceUsedExcludingSelf(), these must not be
+  // called on ExtensionSets of lite messages.  containing_type is used to
+  // find the type of lazily parsed message extensions.
+  uint64 StructuralHash(const Descriptor* containing_type) const;
+  bool StructurallyEquals(const Descriptor* containing_type,
+                          const ExtensionSet& other) const;
+
  private:
+  friend class LazyField;
 
   // Interface of a lazily parsed singular message extension.
   class LIBPROTOBUF_EXPORT LazyMessageExtension {
@@ -517,6 +548,9 @@ class LIBPROTOBUF_EXPORT ExtensionSet {
     uint8* SerializeFieldWithCachedSizesToArray(
         int number,
         uint8* target) const;
+    void SerializeFieldReverse(
+        int number,
+        io::ReverseCodedBuffer* output) const;
     void SerializeMessageSetItemWithCachedSizes(
         int number,
         io::CodedOutputStream* output) const;
@@ -525,10 +559,23 @@ class LIBPROTOBUF_EXPORT ExtensionSet {
         uint8* target) const;
     int ByteSize(int number) const;
     int MessageSetItemByteSize(int number) const;
+    // For packed repeated fields: the size of the packed data, computed
+    // without storing it in cached_size, and the data itself.
+    int PackedDataSize() const;
+    uint8* SerializePackedDataToArray(uint8* target) const;
     void Clear();
     int GetSize() const;
     void Free();
     int SpaceUsedExcludingSelf() const;
+    size_t SpaceUsedExcludingSelfLong() const;
+    bool IsPresent() const;
+    uint64 StructuralHash(const Descriptor* containing_type, int number) const;
+    bool StructurallyEquals(const Descriptor* containing_type, int number,
+                            const Extension& other) const;
+    // Returns the value of a singular message extension, parsing it first
+    // if it is lazy.
+    const Message& GetParsedMessage(const Descriptor* containing_type,
+                                    int number) const;
   };
 
 
@@ -562,6 +609,12 @@ class LIBPROTOBUF_EXPORT ExtensionSet {
                                    io::CodedInputStream* input,
                                    FieldSkipper* field_skipper);
 
+  // Parses a singular message extension registered as lazy, keeping its
+  // contents in serialized form.  The input should be positioned at the
+  // length prefix.
+  bool ParseLazyMessage(int number, const ExtensionInfo& extension,
+                        io::CodedInputStream* input);
+
   // Like ParseField(), but this method may parse singular message extensions
   // lazily depending on the value of FLAGS_eagerly_parse_message_sets.
   bool ParseFieldMaybeLazily(int wire_type, int field_number,
@@ -590,13 +643,50 @@ class LIBPROTOBUF_EXPORT ExtensionSet {
   static inline int RepeatedMessage_SpaceUsedExcludingSelf(
       RepeatedPtrFieldBase* field);
 
-  // The Extension struct is small enough to be passed by value, so we use it
-  // directly as the value type in the map rather than use pointers.  We use
-  // a map rather than hash_map here because we expect most ExtensionSets will
-  // only contain a small number of extensions whereas hash_map is optimized
-  // for 100 elements or more.  Also, we want AppendToList() to order fields
-  // by field number.
-  std::map<int, Extension> extensions_;
+  // Extensions are stored in a flat array of (number, Extension) pairs kept
+  // sorted by field number.  The Extension struct is small enough to be
+  // stored by value, and most ExtensionSets only hold a handful of
+  // extensions, so a contiguous array beats a node-based map on both lookup
+  // (one binary search over a single cache-friendly block) and allocation
+  // (one block per set instead of one node per extension).  Keeping the
+  // array sorted also means AppendToList() and serialization visit fields
+  // in field-number order, and parsing already-sorted input only ever
+  // appends.  When the set lives on an arena, the array is allocated from
+  // that arena as well.
+  struct KeyValue {
+    int first;
+    Extension second;
+  };
+
+  // Returns the extension with the given number, or NULL if there is none.
+  Extension* FindOrNull(int number);
+  const Extension* FindOrNull(int number) const;
+
+  // Returns the first entry whose number is not less than |number|, or
+  // flat_end() if there is none.
+  const KeyValue* LowerBound(int number) const;
+
+  // Returns a pointer to the extension with the given number, inserting a
+  // zero-initialized one if it is not present.  The boolean is true if the
+  // extension was inserted.  Invalidates all pointers into the array if an
+  // insertion happens.
+  std::pair<Extension*, bool> Insert(int number);
+
+  // Removes the extension with the given number, if present.  Does not free
+  // any storage held by the extension itself.
+  void Erase(int number);
+
+  // Ensures the array can hold at least |minimum| entries.
+  void GrowCapacity(int minimum);
+
+  KeyValue* flat_begin() { return flat_; }
+  const KeyValue* flat_begin() const { return flat_; }
+  KeyValue* flat_end() { return flat_ + flat_size_; }
+  const KeyValue* flat_end() const { return flat_ + flat_size_; }
+
+  KeyValue* flat_;
+  int flat_size_;
+  int flat_capacity_;
   ::google::protobuf::Arena* arena_;
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(ExtensionSet);
 };
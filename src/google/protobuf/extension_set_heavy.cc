@@ -38,6 +38,8 @@
 #include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/extension_set.h>
+#include <google/protobuf/generated_message_util.h>
+#include <google/protobuf/lazy_field.h>
 #include <google/protobuf/message.h>
 #include <google/protobuf/repeated_field.h>
 #include <google/protobuf/wire_format.h>
@@ -94,8 +96,7 @@ class DescriptorPoolExtensionFinder : public ExtensionFinder {
 void ExtensionSet::AppendToList(const Descriptor* containing_type,
                                 const DescriptorPool* pool,
                                 vector<const FieldDescriptor*>* output) const {
-  for (map<int, Extension>::const_iterator iter = extensions_.begin();
-       iter != extensions_.end(); ++iter) {
+  for (const KeyValue* iter = flat_begin(); iter != flat_end(); ++iter) {
     bool has = false;
     if (iter->second.is_repeated) {
       has = iter->second.GetSize() > 0;
@@ -143,17 +144,17 @@ inline WireFormatLite::FieldType field_type(FieldType type) {
 const MessageLite& ExtensionSet::GetMessage(int number,
                                             const Descriptor* message_type,
                                             MessageFactory* factory) const {
-  map<int, Extension>::const_iterator iter = extensions_.find(number);
-  if (iter == extensions_.end() || iter->second.is_cleared) {
+  const Extension* ext = FindOrNull(number);
+  if (ext == NULL || ext->is_cleared) {
     // Not present.  Return the default value.
     return *factory->GetPrototype(message_type);
   } else {
-    GOOGLE_DCHECK_TYPE(iter->second, OPTIONAL, MESSAGE);
-    if (iter->second.is_lazy) {
-      return iter->second.lazymessage_value->GetMessage(
+    GOOGLE_DCHECK_TYPE(*ext, OPTIONAL, MESSAGE);
+    if (ext->is_lazy) {
+      return ext->lazymessage_value->GetMessage(
           *factory->GetPrototype(message_type));
     } else {
-      return *iter->second.message_value;
+      return *ext->message_value;
     }
   }
 }
@@ -186,28 +187,28 @@ MessageLite* ExtensionSet::MutableMessage(const FieldDescriptor* descriptor,
 
 MessageLite* ExtensionSet::ReleaseMessage(const FieldDescriptor* descriptor,
                                           MessageFactory* factory) {
-  map<int, Extension>::iterator iter = extensions_.find(descriptor->number());
-  if (iter == extensions_.end()) {
+  Extension* ext = FindOrNull(descriptor->number());
+  if (ext == NULL) {
     // Not present.  Return NULL.
     return NULL;
   } else {
-    GOOGLE_DCHECK_TYPE(iter->second, OPTIONAL, MESSAGE);
+    GOOGLE_DCHECK_TYPE(*ext, OPTIONAL, MESSAGE);
     MessageLite* ret = NULL;
-    if (iter->second.is_lazy) {
-      ret = iter->second.lazymessage_value->ReleaseMessage(
+    if (ext->is_lazy) {
+      ret = ext->lazymessage_value->ReleaseMessage(
           *factory->GetPrototype(descriptor->message_type()));
       if (arena_ == NULL) {
-        delete iter->second.lazymessage_value;
+        delete ext->lazymessage_value;
       }
     } else {
       if (arena_ != NULL) {
-        ret = (iter->second.message_value)->New();
-        ret->CheckTypeAndMergeFrom(*(iter->second.message_value));
+        ret = (ext->message_value)->New();
+        ret->CheckTypeAndMergeFrom(*(ext->message_value));
       } else {
-        ret = iter->second.message_value;
+        ret = ext->message_value;
       }
     }
-    extensions_.erase(descriptor->number());
+    Erase(descriptor->number());
     return ret;
   }
 }
@@ -257,6 +258,9 @@ bool DescriptorPoolExtensionFinder::Find(int number, ExtensionInfo* output) {
     output->type = extension->type();
     output->is_repeated = extension->is_repeated();
     output->is_packed = extension->options().packed();
+    output->is_lazy = extension->options().lazy() &&
+                      extension->type() == FieldDescriptor::TYPE_MESSAGE &&
+                      !extension->is_repeated();
     output->descriptor = extension;
     if (extension->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
       output->message_prototype =
@@ -304,12 +308,8 @@ bool ExtensionSet::ParseMessageSet(io::CodedInputStream* input,
 }
 
 int ExtensionSet::SpaceUsedExcludingSelf() const {
-  int total_size =
-      extensions_.size() * sizeof(map<int, Extension>::value_type);
-  for (map<int, Extension>::const_iterator iter = extensions_.begin(),
-       end = extensions_.end();
-       iter != end;
-       ++iter) {
+  int total_size = flat_capacity_ * sizeof(KeyValue);
+  for (const KeyValue* iter = flat_begin(); iter != flat_end(); ++iter) {
     total_size += iter->second.SpaceUsedExcludingSelf();
   }
   return total_size;
@@ -359,6 +359,11 @@ int ExtensionSet::Extension::SpaceUsedExcludingSelf() const {
       case FieldDescriptor::CPPTYPE_MESSAGE:
         if (is_lazy) {
           total_size += lazymessage_value->SpaceUsed();
+          const MessageLite* parsed = down_cast<LazyField*>(
+              lazymessage_value)->ParsedMessageOrNull();
+          if (parsed != NULL) {
+            total_size += down_cast<const Message*>(parsed)->SpaceUsed();
+          }
         } else {
           total_size += down_cast<Message*>(message_value)->SpaceUsed();
         }
@@ -371,14 +376,198 @@ int ExtensionSet::Extension::SpaceUsedExcludingSelf() const {
   return total_size;
 }
 
+bool ExtensionSet::Extension::IsPresent() const {
+  return is_repeated ? GetSize() > 0 : !is_cleared;
+}
+
+uint64 ExtensionSet::StructuralHash(const Descriptor* containing_type) const {
+  uint64 hash = 0;
+  for (const KeyValue* iter = flat_begin(); iter != flat_end(); ++iter) {
+    if (iter->second.IsPresent()) {
+      hash += iter->second.StructuralHash(containing_type, iter->first);
+    }
+  }
+  return hash;
+}
+
+bool ExtensionSet::StructurallyEquals(const Descriptor* containing_type,
+                                      const ExtensionSet& other) const {
+  // Both arrays are sorted by number, but either may hold cleared entries.
+  const KeyValue* iter = flat_begin();
+  const KeyValue* other_iter = other.flat_begin();
+  while (true) {
+    while (iter != flat_end() && !iter->second.IsPresent()) ++iter;
+    while (other_iter != other.flat_end() && !other_iter->second.IsPresent()) {
+      ++other_iter;
+    }
+    if (iter == flat_end() || other_iter == other.flat_end()) {
+      return iter == flat_end() && other_iter == other.flat_end();
+    }
+    if (iter->first != other_iter->first ||
+        !iter->second.StructurallyEquals(containing_type, iter->first,
+                                         other_iter->second)) {
+      return false;
+    }
+    ++iter;
+    ++other_iter;
+  }
+}
+
+const Message& ExtensionSet::Extension::GetParsedMessage(
+    const Descriptor* containing_type, int number) const {
+  if (!is_lazy) return *down_cast<Message*>(message_value);
+  const MessageLite* parsed =
+      down_cast<LazyField*>(lazymessage_value)->ParsedMessageOrNull();
+  if (parsed == NULL) {
+    const FieldDescriptor* field = descriptor;
+    if (field == NULL) {
+      field = containing_type->file()->pool()->FindExtensionByNumber(
+          containing_type, number);
+    }
+    GOOGLE_CHECK(field != NULL) << "Unknown extension " << number << " of "
+                         << containing_type->full_name();
+    const Message* prototype =
+        MessageFactory::generated_factory()->GetPrototype(
+            field->message_type());
+    GOOGLE_CHECK(prototype != NULL) << "No generated type for lazy extension "
+                             << field->full_name();
+    parsed = &lazymessage_value->GetMessage(*prototype);
+  }
+  return *down_cast<const Message*>(parsed);
+}
+
+uint64 ExtensionSet::Extension::StructuralHash(
+    const Descriptor* containing_type, int number) const {
+  uint64 value_hash = 0;
+  if (is_repeated) {
+    switch (cpp_type(type)) {
+#define HANDLE_TYPE(UPPERCASE, LOWERCASE)                          \
+      case FieldDescriptor::CPPTYPE_##UPPERCASE:                   \
+        value_hash = HashRepeatedValues(*repeated_##LOWERCASE##_value); \
+        break
+
+      HANDLE_TYPE(  INT32,   int32);
+      HANDLE_TYPE(  INT64,   int64);
+      HANDLE_TYPE( UINT32,  uint32);
+      HANDLE_TYPE( UINT64,  uint64);
+      HANDLE_TYPE(  FLOAT,   float);
+      HANDLE_TYPE( DOUBLE,  double);
+      HANDLE_TYPE(   BOOL,    bool);
+      HANDLE_TYPE(   ENUM,    enum);
+      HANDLE_TYPE( STRING,  string);
+#undef HANDLE_TYPE
+
+      case FieldDescriptor::CPPTYPE_MESSAGE:
+        for (int i = 0; i < repeated_message_value->size(); i++) {
+          value_hash = HashCombine(value_hash,
+              down_cast<const Message&>(
+                  repeated_message_value->Get(i)).StructuralHash());
+        }
+        break;
+    }
+  } else {
+    switch (cpp_type(type)) {
+#define HANDLE_TYPE(UPPERCASE, LOWERCASE)                          \
+      case FieldDescriptor::CPPTYPE_##UPPERCASE:                   \
+        value_hash = HashValue(LOWERCASE##_value);                 \
+        break
+
+      HANDLE_TYPE(  INT32,   int32);
+      HANDLE_TYPE(  INT64,   int64);
+      HANDLE_TYPE( UINT32,  uint32);
+      HANDLE_TYPE( UINT64,  uint64);
+      HANDLE_TYPE(  FLOAT,   float);
+      HANDLE_TYPE( DOUBLE,  double);
+      HANDLE_TYPE(   BOOL,    bool);
+      HANDLE_TYPE(   ENUM,    enum);
+#undef HANDLE_TYPE
+
+      case FieldDescriptor::CPPTYPE_STRING:
+        value_hash = HashValue(*string_value);
+        break;
+      case FieldDescriptor::CPPTYPE_MESSAGE:
+        value_hash =
+            GetParsedMessage(containing_type, number).StructuralHash();
+        break;
+    }
+  }
+  return HashCombine(number, value_hash);
+}
+
+bool ExtensionSet::Extension::StructurallyEquals(
+    const Descriptor* containing_type, int number,
+    const Extension& other) const {
+  GOOGLE_DCHECK_EQ(type, other.type);
+  GOOGLE_DCHECK_EQ(is_repeated, other.is_repeated);
+  if (is_repeated) {
+    switch (cpp_type(type)) {
+#define HANDLE_TYPE(UPPERCASE, LOWERCASE)                          \
+      case FieldDescriptor::CPPTYPE_##UPPERCASE:                   \
+        return RepeatedPrimitivesEqual(*repeated_##LOWERCASE##_value, \
+                                       *other.repeated_##LOWERCASE##_value);
+
+      HANDLE_TYPE(  INT32,   int32);
+      HANDLE_TYPE(  INT64,   int64);
+      HANDLE_TYPE( UINT32,  uint32);
+      HANDLE_TYPE( UINT64,  uint64);
+      HANDLE_TYPE(  FLOAT,   float);
+      HANDLE_TYPE( DOUBLE,  double);
+      HANDLE_TYPE(   BOOL,    bool);
+      HANDLE_TYPE(   ENUM,    enum);
+#undef HANDLE_TYPE
+
+      case FieldDescriptor::CPPTYPE_STRING:
+        return RepeatedStringsEqual(*repeated_string_value,
+                                    *other.repeated_string_value);
+      case FieldDescriptor::CPPTYPE_MESSAGE:
+        if (repeated_message_value->size() !=
+            other.repeated_message_value->size()) {
+          return false;
+        }
+        for (int i = 0; i < repeated_message_value->size(); i++) {
+          if (!down_cast<const Message&>(repeated_message_value->Get(i))
+                   .StructurallyEquals(down_cast<const Message&>(
+                       other.repeated_message_value->Get(i)))) {
+            return false;
+          }
+        }
+        return true;
+    }
+  } else {
+    switch (cpp_type(type)) {
+#define HANDLE_TYPE(UPPERCASE, LOWERCASE)                          \
+      case FieldDescriptor::CPPTYPE_##UPPERCASE:                   \
+        return ValuesEqual(LOWERCASE##_value, other.LOWERCASE##_value);
+
+      HANDLE_TYPE(  INT32,   int32);
+      HANDLE_TYPE(  INT64,   int64);
+      HANDLE_TYPE( UINT32,  uint32);
+      HANDLE_TYPE( UINT64,  uint64);
+      HANDLE_TYPE(  FLOAT,   float);
+      HANDLE_TYPE( DOUBLE,  double);
+      HANDLE_TYPE(   BOOL,    bool);
+      HANDLE_TYPE(   ENUM,    enum);
+#undef HANDLE_TYPE
+
+      case FieldDescriptor::CPPTYPE_STRING:
+        return *string_value == *other.string_value;
+      case FieldDescriptor::CPPTYPE_MESSAGE:
+        return GetParsedMessage(containing_type, number).StructurallyEquals(
+            other.GetParsedMessage(containing_type, number));
+    }
+  }
+  GOOGLE_LOG(FATAL) << "Can't get here.";
+  return false;
+}
+
 // The Serialize*ToArray methods are only needed in the heavy library, as
 // the lite library only generates SerializeWithCachedSizes.
 uint8* ExtensionSet::SerializeWithCachedSizesToArray(
     int start_field_number, int end_field_number,
     uint8* target) const {
-  map<int, Extension>::const_iterator iter;
-  for (iter = extensions_.lower_bound(start_field_number);
-       iter != extensions_.end() && iter->first < end_field_number;
+  const KeyValue* end = flat_end();
+  for (const KeyValue* iter = LowerBound(start_field_number);
+       iter != end && iter->first < end_field_number;
        ++iter) {
     target = iter->second.SerializeFieldWithCachedSizesToArray(iter->first,
                                                                target);
@@ -386,16 +575,118 @@ uint8* ExtensionSet::SerializeWithCachedSizesToArray(
   return target;
 }
 
+void ExtensionSet::InternalSerializeReverse(
+    int start_field_number, int end_field_number,
+    io::ReverseCodedBuffer* output) const {
+  const KeyValue* begin = LowerBound(start_field_number);
+  const KeyValue* iter = LowerBound(end_field_number);
+  while (iter != begin) {
+    --iter;
+    iter->second.SerializeFieldReverse(iter->first, output);
+  }
+}
+
 uint8* ExtensionSet::SerializeMessageSetWithCachedSizesToArray(
     uint8* target) const {
-  map<int, Extension>::const_iterator iter;
-  for (iter = extensions_.begin(); iter != extensions_.end(); ++iter) {
+  for (const KeyValue* iter = flat_begin(); iter != flat_end(); ++iter) {
     target = iter->second.SerializeMessageSetItemWithCachedSizesToArray(
         iter->first, target);
   }
   return target;
 }
 
+void ExtensionSet::Extension::SerializeFieldReverse(
+    int number, io::ReverseCodedBuffer* output) const {
+  if (cpp_type(type) == FieldDescriptor::CPPTYPE_MESSAGE && !is_lazy) {
+    const bool is_group = real_type(type) == FieldDescriptor::TYPE_GROUP;
+    if (is_repeated) {
+      for (int i = repeated_message_value->size() - 1; i >= 0; i--) {
+        if (is_group) {
+          WireFormatLite::WriteGroupReverse(
+              number, repeated_message_value->Get(i), output);
+        } else {
+          WireFormatLite::WriteMessageReverse(
+              number, repeated_message_value->Get(i), output);
+        }
+      }
+    } else if (!is_cleared) {
+      if (is_group) {
+        WireFormatLite::WriteGroupReverse(number, *message_value, output);
+      } else {
+        WireFormatLite::WriteMessageReverse(number, *message_value, output);
+      }
+    }
+    return;
+  }
+
+  // ByteSize() would store cached_size, so size the packed data locally.
+  if (is_repeated && is_packed) {
+    const int data_size = PackedDataSize();
+    if (data_size == 0) return;
+    SerializePackedDataToArray(output->Reserve(data_size));
+    output->WriteVarint32(data_size);
+    output->WriteTag(WireFormatLite::MakeTag(
+        number, WireFormatLite::WIRETYPE_LENGTH_DELIMITED));
+    return;
+  }
+
+  // A lazy message that was modified after parsing would be sized with
+  // ByteSize(), which writes its cached sizes; encode it back to front like
+  // any other sub-message instead.
+  if (is_lazy && !is_cleared) {
+    const LazyField* lazy_field = down_cast<LazyField*>(lazymessage_value);
+    if (!lazy_field->IsRaw()) {
+      WireFormatLite::WriteMessageReverse(
+          number, *lazy_field->ParsedMessageOrNull(), output);
+      return;
+    }
+  }
+
+  // Nothing else depends on cached sizes: an unparsed lazy message is sized
+  // by its serialized bytes.
+  const int size = ByteSize(number);
+  uint8* target = output->Reserve(size);
+  uint8* end = SerializeFieldWithCachedSizesToArray(number, target);
+  GOOGLE_DCHECK_EQ(end - target, size);
+}
+
+uint8* ExtensionSet::Extension::SerializePackedDataToArray(
+    uint8* target) const {
+  switch (real_type(type)) {
+#define HANDLE_TYPE(UPPERCASE, CAMELCASE, LOWERCASE)                        \
+    case FieldDescriptor::TYPE_##UPPERCASE:                                 \
+      for (int i = 0; i < repeated_##LOWERCASE##_value->size(); i++) {      \
+        target = WireFormatLite::Write##CAMELCASE##NoTagToArray(            \
+          repeated_##LOWERCASE##_value->Get(i), target);                    \
+      }                                                                     \
+      break
+
+    HANDLE_TYPE(   INT32,    Int32,   int32);
+    HANDLE_TYPE(   INT64,    Int64,   int64);
+    HANDLE_TYPE(  UINT32,   UInt32,  uint32);
+    HANDLE_TYPE(  UINT64,   UInt64,  uint64);
+    HANDLE_TYPE(  SINT32,   SInt32,   int32);
+    HANDLE_TYPE(  SINT64,   SInt64,   int64);
+    HANDLE_TYPE( FIXED32,  Fixed32,  uint32);
+    HANDLE_TYPE( FIXED64,  Fixed64,  uint64);
+    HANDLE_TYPE(SFIXED32, SFixed32,   int32);
+    HANDLE_TYPE(SFIXED64, SFixed64,   int64);
+    HANDLE_TYPE(   FLOAT,    Float,   float);
+    HANDLE_TYPE(  DOUBLE,   Double,  double);
+    HANDLE_TYPE(    BOOL,     Bool,    bool);
+    HANDLE_TYPE(    ENUM,     Enum,    enum);
+#undef HANDLE_TYPE
+
+    case WireFormatLite::TYPE_STRING:
+    case WireFormatLite::TYPE_BYTES:
+    case WireFormatLite::TYPE_GROUP:
+    case WireFormatLite::TYPE_MESSAGE:
+      GOOGLE_LOG(FATAL) << "Non-primitive types can't be packed.";
+      break;
+  }
+  return target;
+}
+
 uint8* ExtensionSet::Extension::SerializeFieldWithCachedSizesToArray(
     int number, uint8* target) const {
   if (is_repeated) {
@@ -406,38 +697,7 @@ uint8* ExtensionSet::Extension::SerializeFieldWithCachedSizesToArray(
           WireFormatLite::WIRETYPE_LENGTH_DELIMITED, target);
       target = WireFormatLite::WriteInt32NoTagToArray(cached_size, target);
 
-      switch (real_type(type)) {
-#define HANDLE_TYPE(UPPERCASE, CAMELCASE, LOWERCASE)                        \
-        case FieldDescriptor::TYPE_##UPPERCASE:                             \
-          for (int i = 0; i < repeated_##LOWERCASE##_value->size(); i++) {  \
-            target = WireFormatLite::Write##CAMELCASE##NoTagToArray(        \
-              repeated_##LOWERCASE##_value->Get(i), target);                \
-          }                                                                 \
-          break
-
-        HANDLE_TYPE(   INT32,    Int32,   int32);
-        HANDLE_TYPE(   INT64,    Int64,   int64);
-        HANDLE_TYPE(  UINT32,   UInt32,  uint32);
-        HANDLE_TYPE(  UINT64,   UInt64,  uint64);
-        HANDLE_TYPE(  SINT32,   SInt32,   int32);
-        HANDLE_TYPE(  SINT64,   SInt64,   int64);
-        HANDLE_TYPE( FIXED32,  Fixed32,  uint32);
-        HANDLE_TYPE( FIXED64,  Fixed64,  uint64);
-        HANDLE_TYPE(SFIXED32, SFixed32,   int32);
-        HANDLE_TYPE(SFIXED64, SFixed64,   int64);
-        HANDLE_TYPE(   FLOAT,    Float,   float);
-        HANDLE_TYPE(  DOUBLE,   Double,  double);
-        HANDLE_TYPE(    BOOL,     Bool,    bool);
-        HANDLE_TYPE(    ENUM,     Enum,    enum);
-#undef HANDLE_TYPE
-
-        case WireFormatLite::TYPE_STRING:
-        case WireFormatLite::TYPE_BYTES:
-        case WireFormatLite::TYPE_GROUP:
-        case WireFormatLite::TYPE_MESSAGE:
-          GOOGLE_LOG(FATAL) << "Non-primitive types can't be packed.";
-          break;
-      }
+      target = SerializePackedDataToArray(target);
     } else {
       switch (real_type(type)) {
 #define HANDLE_TYPE(UPPERCASE, CAMELCASE, LOWERCASE)                        \
@@ -719,8 +979,7 @@ int ExtensionSet::Extension::MessageSetItemByteSize(int number) const {
 
 void ExtensionSet::SerializeMessageSetWithCachedSizes(
     io::CodedOutputStream* output) const {
-  for (map<int, Extension>::const_iterator iter = extensions_.begin();
-       iter != extensions_.end(); ++iter) {
+  for (const KeyValue* iter = flat_begin(); iter != flat_end(); ++iter) {
     iter->second.SerializeMessageSetItemWithCachedSizes(iter->first, output);
   }
 }
@@ -728,8 +987,7 @@ void ExtensionSet::SerializeMessageSetWithCachedSizes(
 int ExtensionSet::MessageSetByteSize() const {
   int total_size = 0;
 
-  for (map<int, Extension>::const_iterator iter = extensions_.begin();
-       iter != extensions_.end(); ++iter) {
+  for (const KeyValue* iter = flat_begin(); iter != flat_end(); ++iter) {
     total_size += iter->second.MessageSetItemByteSize(iter->first);
   }
 
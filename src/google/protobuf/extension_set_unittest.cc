@@ -444,6 +444,65 @@ TEST(ExtensionSetTest, SwapExtensionWithSelf) {
   TestUtil::ExpectAllExtensionsSet(message1);
 }
 
+// Extensions are kept in a sorted array; insert them in a scrambled order so
+// that the array has to shift and grow, and check that lookups, removal and
+// serialization order are unaffected.
+void TestManyExtensionsOutOfOrder(ExtensionSet* set) {
+  const int kCount = 100;
+  for (int i = 0; i < kCount; i++) {
+    // 37 is coprime to kCount, so this visits every number in [1, kCount].
+    int number = (i * 37) % kCount + 1;
+    set->SetInt32(number, WireFormatLite::TYPE_INT32, number * 2, NULL);
+  }
+  EXPECT_EQ(kCount, set->NumExtensions());
+  for (int number = 1; number <= kCount; number++) {
+    EXPECT_TRUE(set->Has(number));
+    EXPECT_EQ(number * 2, set->GetInt32(number, -1));
+  }
+  EXPECT_FALSE(set->Has(kCount + 1));
+  EXPECT_EQ(-1, set->GetInt32(kCount + 1, -1));
+
+  ExtensionSet other(set->GetArenaNoVirtual());
+  other.SwapExtension(set, 50);
+  EXPECT_FALSE(set->Has(50));
+  EXPECT_TRUE(other.Has(50));
+  EXPECT_EQ(100, other.GetInt32(50, -1));
+  EXPECT_EQ(kCount - 1, set->NumExtensions());
+  EXPECT_TRUE(set->Has(49));
+  EXPECT_TRUE(set->Has(51));
+
+  string data;
+  data.resize(set->ByteSize());
+  uint8* target = reinterpret_cast<uint8*>(string_as_array(&data));
+  uint8* end = set->SerializeWithCachedSizesToArray(1, kCount + 1, target);
+  EXPECT_EQ(data.size(), end - target);
+
+  io::CodedInputStream input(target, data.size());
+  int last_number = 0;
+  int count = 0;
+  while (uint32 tag = input.ReadTag()) {
+    int number = WireFormatLite::GetTagFieldNumber(tag);
+    EXPECT_LT(last_number, number);
+    last_number = number;
+    uint32 value;
+    ASSERT_TRUE(input.ReadVarint32(&value));
+    EXPECT_EQ(number * 2, value);
+    count++;
+  }
+  EXPECT_EQ(kCount - 1, count);
+}
+
+TEST(ExtensionSetTest, ManyExtensionsOutOfOrder) {
+  ExtensionSet set;
+  TestManyExtensionsOutOfOrder(&set);
+}
+
+TEST(ExtensionSetTest, ManyExtensionsOutOfOrderWithArena) {
+  ::google::protobuf::Arena arena;
+  ExtensionSet set(&arena);
+  TestManyExtensionsOutOfOrder(&set);
+}
+
 TEST(ExtensionSetTest, SerializationToArray) {
   // Serialize as TestAllExtensions and parse as TestAllTypes to insure wire
   // compatibility of extensions.
@@ -545,6 +604,88 @@ TEST(ExtensionSetTest, Parsing) {
   TestUtil::ExpectAllExtensionsSet(destination);
 }
 
+// Returns a TestAllExtensions holding optional_lazy_message_extension with
+// bb set to |bb|.  The sub-message starts with a field NestedMessage does not
+// know about, so re-encoding a parsed copy would reorder the bytes.
+string MakeLazyMessageData(int bb) {
+  string payload;
+  {
+    io::StringOutputStream raw_output(&payload);
+    io::CodedOutputStream output(&raw_output);
+    WireFormatLite::WriteInt32(1000, bb * 10, &output);
+    WireFormatLite::WriteInt32(
+        unittest::TestAllTypes::NestedMessage::kBbFieldNumber, bb, &output);
+  }
+  string data;
+  {
+    io::StringOutputStream raw_output(&data);
+    io::CodedOutputStream output(&raw_output);
+    WireFormatLite::WriteBytes(
+        unittest::optional_lazy_message_extension.number(), payload, &output);
+  }
+  return data;
+}
+
+TEST(ExtensionSetTest, LazyMessageParsing) {
+  const string data = MakeLazyMessageData(42);
+  unittest::TestAllExtensions message;
+  ASSERT_TRUE(message.ParseFromString(data));
+  EXPECT_TRUE(message.HasExtension(unittest::optional_lazy_message_extension));
+
+  // Not accessed yet, so the original bytes are written back untouched.
+  EXPECT_EQ(data, message.SerializeAsString());
+
+  // Read-only access does not change that.
+  EXPECT_EQ(42,
+            message.GetExtension(unittest::optional_lazy_message_extension).bb());
+  EXPECT_EQ(data, message.SerializeAsString());
+
+  // Mutating the message makes it the authoritative copy.
+  message.MutableExtension(unittest::optional_lazy_message_extension)
+      ->set_bb(43);
+  unittest::TestAllExtensions reparsed;
+  ASSERT_TRUE(reparsed.ParseFromString(message.SerializeAsString()));
+  EXPECT_EQ(43,
+            reparsed.GetExtension(unittest::optional_lazy_message_extension).bb());
+
+  message.ClearExtension(unittest::optional_lazy_message_extension);
+  EXPECT_FALSE(message.HasExtension(unittest::optional_lazy_message_extension));
+  EXPECT_EQ(0, message.ByteSize());
+}
+
+TEST(ExtensionSetTest, LazyMessageMerging) {
+  // A repeated occurrence of the field is merged into the first one.
+  unittest::TestAllExtensions message;
+  ASSERT_TRUE(message.ParseFromString(MakeLazyMessageData(1) +
+                                      MakeLazyMessageData(2)));
+  EXPECT_EQ(2,
+            message.GetExtension(unittest::optional_lazy_message_extension).bb());
+
+  // Merging two unparsed fields, and an unparsed field into a parsed one.
+  unittest::TestAllExtensions raw1, raw2;
+  ASSERT_TRUE(raw1.ParseFromString(MakeLazyMessageData(3)));
+  ASSERT_TRUE(raw2.ParseFromString(MakeLazyMessageData(4)));
+  raw1.MergeFrom(raw2);
+  EXPECT_EQ(4,
+            raw1.GetExtension(unittest::optional_lazy_message_extension).bb());
+  message.MergeFrom(raw2);
+  EXPECT_EQ(4,
+            message.GetExtension(unittest::optional_lazy_message_extension).bb());
+
+  // Copying into an arena and releasing back to the heap.
+  ::google::protobuf::Arena arena;
+  unittest::TestAllExtensions* arena_message =
+      ::google::protobuf::Arena::CreateMessage<unittest::TestAllExtensions>(&arena);
+  ASSERT_TRUE(arena_message->ParseFromString(MakeLazyMessageData(5)));
+  arena_message->MergeFrom(raw2);
+  google::protobuf::scoped_ptr<unittest::TestAllTypes::NestedMessage> released(
+      arena_message->ReleaseExtension(
+          unittest::optional_lazy_message_extension));
+  EXPECT_EQ(4, released->bb());
+  EXPECT_FALSE(
+      arena_message->HasExtension(unittest::optional_lazy_message_extension));
+}
+
 TEST(ExtensionSetTest, PackedParsing) {
   // Serialize as TestPackedTypes and parse as TestPackedExtensions.
   unittest::TestPackedTypes source;
@@ -0,0 +1,133 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/frozen_message.h>
+
+#include <string.h>
+#include <google/protobuf/message_lite.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/stubs/stl_util.h>
+
+namespace google {
+namespace protobuf {
+
+namespace {
+
+string InitializationErrorMessage(const MessageLite& message) {
+  string result;
+  result += "Can't serialize frozen message of type \"";
+  result += message.GetTypeName();
+  result += "\" because it is missing required fields.";
+  return result;
+}
+
+}  // namespace
+
+FrozenMessage::FrozenMessage(MessageLite* message)
+  : message_(message),
+    initialized_(message->IsInitialized()) {
+  // ByteSize() is the last call that writes the cached sizes; every
+  // sub-message's _cached_size_ is final once it returns.
+  const int size = message_->ByteSize();
+  GOOGLE_CHECK_GE(size, 0) << "Error computing ByteSize (possible overflow?).";
+  STLStringResizeUninitialized(&bytes_, size);
+  if (size > 0) {
+    uint8* start = reinterpret_cast<uint8*>(io::mutable_string_data(&bytes_));
+    uint8* end = message_->SerializeWithCachedSizesToArray(start);
+    GOOGLE_CHECK_EQ(end - start, size)
+        << "Protocol message was modified concurrently while being frozen.";
+  }
+}
+
+FrozenMessage::~FrozenMessage() {
+  // Messages on an arena are freed with the arena.
+  if (message_->GetArena() == NULL) {
+    delete message_;
+  }
+}
+
+bool FrozenMessage::SerializeToCodedStream(
+    io::CodedOutputStream* output) const {
+  GOOGLE_DCHECK(initialized_) << InitializationErrorMessage(*message_);
+  return SerializePartialToCodedStream(output);
+}
+
+bool FrozenMessage::SerializePartialToCodedStream(
+    io::CodedOutputStream* output) const {
+  output->WriteString(bytes_);
+  return !output->HadError();
+}
+
+bool FrozenMessage::SerializeToZeroCopyStream(
+    io::ZeroCopyOutputStream* output) const {
+  io::CodedOutputStream encoder(output);
+  return SerializeToCodedStream(&encoder);
+}
+
+bool FrozenMessage::SerializePartialToZeroCopyStream(
+    io::ZeroCopyOutputStream* output) const {
+  io::CodedOutputStream encoder(output);
+  return SerializePartialToCodedStream(&encoder);
+}
+
+bool FrozenMessage::SerializeToString(string* output) const {
+  output->clear();
+  return AppendToString(output);
+}
+
+bool FrozenMessage::SerializePartialToString(string* output) const {
+  output->assign(bytes_);
+  return true;
+}
+
+bool FrozenMessage::SerializeToArray(void* data, int size) const {
+  GOOGLE_DCHECK(initialized_) << InitializationErrorMessage(*message_);
+  return SerializePartialToArray(data, size);
+}
+
+bool FrozenMessage::SerializePartialToArray(void* data, int size) const {
+  if (size < ByteSize()) return false;
+  if (!bytes_.empty()) memcpy(data, bytes_.data(), bytes_.size());
+  return true;
+}
+
+bool FrozenMessage::AppendToString(string* output) const {
+  GOOGLE_DCHECK(initialized_) << InitializationErrorMessage(*message_);
+  return AppendPartialToString(output);
+}
+
+bool FrozenMessage::AppendPartialToString(string* output) const {
+  output->append(bytes_);
+  return true;
+}
+
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,117 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// FrozenMessage wraps a message that will not be modified again and will be
+// serialized many times, possibly from many threads at once.  Ordinary
+// serialization calls ByteSize(), which writes the cached size of every
+// sub-message; when the same message is serialized concurrently those writes
+// race and the cache lines they touch bounce between cores.  FrozenMessage
+// computes all cached sizes exactly once, at construction, and keeps the
+// resulting bytes, so every later serialization only reads shared state.
+
+#ifndef GOOGLE_PROTOBUF_FROZEN_MESSAGE_H__
+#define GOOGLE_PROTOBUF_FROZEN_MESSAGE_H__
+
+#include <string>
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+  class MessageLite;
+namespace io {
+  class CodedOutputStream;
+  class ZeroCopyOutputStream;
+}
+
+// A read-only, pre-serialized message.  All const methods are safe to call
+// concurrently from any number of threads.
+//
+// Example:
+//   Response* response = new Response;
+//   ... fill in response ...
+//   FrozenMessage frozen(response);  // takes ownership
+//   // From any thread:
+//   frozen.SerializeToZeroCopyStream(connection_stream);
+class LIBPROTOBUF_EXPORT FrozenMessage {
+ public:
+  // Takes ownership of |message|, computes and seals its cached sizes, and
+  // serializes it once.  A message allocated on an Arena stays owned by the
+  // arena: it is not deleted with the FrozenMessage, and the arena must
+  // outlive the FrozenMessage.  The message must not be modified afterwards; use
+  // message() to read it.  Messages over 2GB cannot be frozen: the
+  // constructor crashes, as ByteSize() would have overflowed.
+  explicit FrozenMessage(MessageLite* message);
+  ~FrozenMessage();
+
+  // The frozen message.  Its cached sizes are valid for the lifetime of this
+  // object, so SerializeWithCachedSizes() and
+  // SerializeWithCachedSizesToArray() may be called on it concurrently.
+  // Calling ByteSize() (or any Serialize*() method of MessageLite, which call
+  // it) rewrites the cached sizes and loses that guarantee.
+  const MessageLite& message() const { return *message_; }
+
+  // The wire-format bytes of message(), computed at construction.
+  const string& bytes() const { return bytes_; }
+
+  // Size of bytes().  Unlike MessageLite::ByteSize() this never writes to
+  // the message.
+  int ByteSize() const { return static_cast<int>(bytes_.size()); }
+
+  // Whether message() had all of its required fields set when frozen.
+  bool IsInitialized() const { return initialized_; }
+
+  // Serialization -----------------------------------------------------
+  // These mirror the methods of the same name in MessageLite but copy
+  // bytes() instead of re-encoding the message.  As in MessageLite, the
+  // non-Partial variants require IsInitialized() (checked in debug builds).
+
+  bool SerializeToCodedStream(io::CodedOutputStream* output) const;
+  bool SerializePartialToCodedStream(io::CodedOutputStream* output) const;
+  bool SerializeToZeroCopyStream(io::ZeroCopyOutputStream* output) const;
+  bool SerializePartialToZeroCopyStream(io::ZeroCopyOutputStream* output) const;
+  bool SerializeToString(string* output) const;
+  bool SerializePartialToString(string* output) const;
+  bool SerializeToArray(void* data, int size) const;
+  bool SerializePartialToArray(void* data, int size) const;
+  bool AppendToString(string* output) const;
+  bool AppendPartialToString(string* output) const;
+
+ private:
+  MessageLite* message_;
+  string bytes_;
+  bool initialized_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(FrozenMessage);
+};
+
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_FROZEN_MESSAGE_H__
@@ -0,0 +1,169 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/frozen_message.h>
+
+#include <string>
+
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/arena.h>
+#include <google/protobuf/stubs/stl_util.h>
+#include <google/protobuf/test_util.h>
+#include <google/protobuf/unittest.pb.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace {
+
+TEST(FrozenMessageTest, BytesMatchSerializeToString) {
+  protobuf_unittest::TestAllTypes* message =
+      new protobuf_unittest::TestAllTypes;
+  TestUtil::SetAllFields(message);
+  const string expected = message->SerializeAsString();
+
+  FrozenMessage frozen(message);
+  EXPECT_EQ(&frozen.message(), message);
+  EXPECT_TRUE(frozen.IsInitialized());
+  EXPECT_EQ(expected, frozen.bytes());
+  EXPECT_EQ(static_cast<int>(expected.size()), frozen.ByteSize());
+
+  string output = "garbage";
+  EXPECT_TRUE(frozen.SerializeToString(&output));
+  EXPECT_EQ(expected, output);
+
+  output = "prefix";
+  EXPECT_TRUE(frozen.AppendToString(&output));
+  EXPECT_EQ("prefix" + expected, output);
+
+  string array(expected.size(), '\0');
+  EXPECT_TRUE(frozen.SerializeToArray(string_as_array(&array), array.size()));
+  EXPECT_EQ(expected, array);
+  EXPECT_FALSE(frozen.SerializeToArray(string_as_array(&array),
+                                       array.size() - 1));
+
+  output.clear();
+  {
+    io::StringOutputStream zero_copy(&output);
+    EXPECT_TRUE(frozen.SerializeToZeroCopyStream(&zero_copy));
+  }
+  EXPECT_EQ(expected, output);
+
+  protobuf_unittest::TestAllTypes parsed;
+  ASSERT_TRUE(parsed.ParseFromString(frozen.bytes()));
+  TestUtil::ExpectAllFieldsSet(parsed);
+}
+
+TEST(FrozenMessageTest, CachedSizesAreSealed) {
+  protobuf_unittest::TestAllTypes* message =
+      new protobuf_unittest::TestAllTypes;
+  TestUtil::SetAllFields(message);
+  FrozenMessage frozen(message);
+
+  // The message's cached sizes are valid without another ByteSize() call,
+  // so it can be re-encoded read-only.
+  const MessageLite& sealed = frozen.message();
+  ASSERT_EQ(frozen.ByteSize(), sealed.GetCachedSize());
+  EXPECT_EQ(message->optional_nested_message().ByteSize(),
+            message->optional_nested_message().GetCachedSize());
+  string output(frozen.ByteSize(), '\0');
+  uint8* start = reinterpret_cast<uint8*>(string_as_array(&output));
+  uint8* end = sealed.SerializeWithCachedSizesToArray(start);
+  EXPECT_EQ(frozen.ByteSize(), end - start);
+  EXPECT_EQ(frozen.bytes(), output);
+}
+
+TEST(FrozenMessageTest, Empty) {
+  FrozenMessage frozen(new protobuf_unittest::TestAllTypes);
+  EXPECT_EQ(0, frozen.ByteSize());
+  EXPECT_TRUE(frozen.bytes().empty());
+  string output = "garbage";
+  EXPECT_TRUE(frozen.SerializeToString(&output));
+  EXPECT_TRUE(output.empty());
+}
+
+TEST(FrozenMessageTest, ArenaMessage) {
+  // The arena keeps ownership of the message; destroying the FrozenMessage
+  // first must not free it.
+  Arena arena;
+  protobuf_unittest::TestAllTypes* message =
+      Arena::CreateMessage<protobuf_unittest::TestAllTypes>(&arena);
+  TestUtil::SetAllFields(message);
+  {
+    FrozenMessage frozen(message);
+    EXPECT_EQ(message->SerializeAsString(), frozen.bytes());
+  }
+  TestUtil::ExpectAllFieldsSet(*message);
+}
+
+TEST(FrozenMessageTest, MissingRequiredFields) {
+  protobuf_unittest::TestRequired* message =
+      new protobuf_unittest::TestRequired;
+  message->set_a(1);
+  FrozenMessage frozen(message);
+  EXPECT_FALSE(frozen.IsInitialized());
+
+  string output;
+  EXPECT_TRUE(frozen.SerializePartialToString(&output));
+  EXPECT_EQ(message->SerializePartialAsString(), output);
+#ifdef PROTOBUF_HAS_DEATH_TEST  // death tests do not work on Windows yet.
+  EXPECT_DEBUG_DEATH(frozen.SerializeToString(&output),
+                     "missing required fields");
+#endif  // PROTOBUF_HAS_DEATH_TEST
+}
+
+TEST(FrozenMessageTest, SerializeToCodedStream) {
+  protobuf_unittest::TestAllTypes* message =
+      new protobuf_unittest::TestAllTypes;
+  TestUtil::SetAllFields(message);
+  FrozenMessage frozen(message);
+
+  string output;
+  {
+    io::StringOutputStream zero_copy(&output);
+    io::CodedOutputStream coded(&zero_copy);
+    coded.WriteVarint32(frozen.ByteSize());
+    EXPECT_TRUE(frozen.SerializeToCodedStream(&coded));
+  }
+  io::CodedInputStream input(reinterpret_cast<const uint8*>(output.data()),
+                             output.size());
+  uint32 size;
+  ASSERT_TRUE(input.ReadVarint32(&size));
+  EXPECT_EQ(frozen.ByteSize(), static_cast<int>(size));
+  string bytes;
+  ASSERT_TRUE(input.ReadString(&bytes, size));
+  EXPECT_EQ(frozen.bytes(), bytes);
+}
+
+}  // namespace
+}  // namespace protobuf
+}  // namespace google
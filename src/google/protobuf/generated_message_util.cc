@@ -60,6 +60,36 @@ void InitEmptyString() {
   OnShutdown(&DeleteEmptyString);
 }
 
+int StringSpaceUsedExcludingSelf(const string& str) {
+  const void* start = &str;
+  const void* end = &str + 1;
+
+  if (start <= str.data() && str.data() < end) {
+    // The string's data is stored inside the string object itself.
+    return 0;
+  } else {
+    return str.capacity();
+  }
+}
+
+uint64 HashBytes(const void* data, size_t size) {
+  const uint8* bytes = static_cast<const uint8*>(data);
+  uint64 hash = HashMix(size);
+  while (size >= sizeof(uint64)) {
+    uint64 word;
+    memcpy(&word, bytes, sizeof(word));
+    hash = HashCombine(hash, word);
+    bytes += sizeof(word);
+    size -= sizeof(word);
+  }
+  if (size > 0) {
+    uint64 word = 0;
+    memcpy(&word, bytes, size);
+    hash = HashCombine(hash, word);
+  }
+  return hash;
+}
+
 
 }  // namespace internal
 }  // namespace protobuf
@@ -39,6 +39,7 @@
 #define GOOGLE_PROTOBUF_GENERATED_MESSAGE_UTIL_H__
 
 #include <assert.h>
+#include <string.h>
 #include <string>
 
 #include <google/protobuf/stubs/once.h>
@@ -106,6 +107,141 @@ template <class Type> bool AllAreInitialized(const Type& t) {
   return true;
 }
 
+// Helpers for the StructuralHash() and StructurallyEquals() methods of
+// generated messages; see MessageHash() in message.h.  A message's hash is
+// the sum of one term per present field, so it does not depend on the order
+// in which fields are visited.  Floating-point values compare bitwise.
+//
+// Containers are passed as template types, like AllAreInitialized() above,
+// so this header does not have to include them.
+
+// Scrambles the bits of a 64-bit value (the MurmurHash3 finalizer).
+inline uint64 HashMix(uint64 value) {
+  value ^= value >> 33;
+  value *= GOOGLE_ULONGLONG(0xff51afd7ed558ccd);
+  value ^= value >> 33;
+  value *= GOOGLE_ULONGLONG(0xc4ceb9fe1a85ec53);
+  value ^= value >> 33;
+  return value;
+}
+
+// Combines two hashes.  Unlike addition, the result depends on the order.
+inline uint64 HashCombine(uint64 seed, uint64 value) {
+  return HashMix(value ^ (seed * GOOGLE_ULONGLONG(0x9e3779b97f4a7c15) +
+                          GOOGLE_ULONGLONG(0x2545f4914f6cdd1d)));
+}
+
+LIBPROTOBUF_EXPORT uint64 HashBytes(const void* data, size_t size);
+
+inline uint64 HashValue(int32 value) {
+  return HashMix(static_cast<uint64>(static_cast<int64>(value)));
+}
+inline uint64 HashValue(int64 value) {
+  return HashMix(static_cast<uint64>(value));
+}
+inline uint64 HashValue(uint32 value) { return HashMix(value); }
+inline uint64 HashValue(uint64 value) { return HashMix(value); }
+inline uint64 HashValue(bool value) { return HashMix(value ? 1 : 0); }
+inline uint64 HashValue(float value) {
+  uint32 bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return HashMix(bits);
+}
+inline uint64 HashValue(double value) {
+  uint64 bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return HashMix(bits);
+}
+inline uint64 HashValue(const string& value) {
+  return HashBytes(value.data(), value.size());
+}
+
+template <typename Type> bool ValuesEqual(const Type& a, const Type& b) {
+  return a == b;
+}
+inline bool ValuesEqual(float a, float b) {
+  return memcmp(&a, &b, sizeof(a)) == 0;
+}
+inline bool ValuesEqual(double a, double b) {
+  return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+// Type is a RepeatedField or a RepeatedPtrField<string>.
+template <class Type> uint64 HashRepeatedValues(const Type& t) {
+  uint64 hash = 0;
+  for (int i = 0; i < t.size(); i++) {
+    hash = HashCombine(hash, HashValue(t.Get(i)));
+  }
+  return hash;
+}
+template <class Type> uint64 HashRepeatedMessages(const Type& t) {
+  uint64 hash = 0;
+  for (int i = 0; i < t.size(); i++) {
+    hash = HashCombine(hash, t.Get(i).StructuralHash());
+  }
+  return hash;
+}
+
+// Type is a RepeatedField; equal elements have equal bytes.
+template <class Type> bool RepeatedPrimitivesEqual(const Type& a,
+                                                   const Type& b) {
+  return a.size() == b.size() &&
+         (a.size() == 0 ||
+          memcmp(a.data(), b.data(), a.size() * sizeof(*a.data())) == 0);
+}
+template <class Type> bool RepeatedStringsEqual(const Type& a, const Type& b) {
+  if (a.size() != b.size()) return false;
+  for (int i = 0; i < a.size(); i++) {
+    if (a.Get(i) != b.Get(i)) return false;
+  }
+  return true;
+}
+template <class Type> bool RepeatedMessagesEqual(const Type& a,
+                                                 const Type& b) {
+  if (a.size() != b.size()) return false;
+  for (int i = 0; i < a.size(); i++) {
+    if (!a.Get(i).StructurallyEquals(b.Get(i))) return false;
+  }
+  return true;
+}
+
+// Type is a Map.  Entries are combined by addition, so iteration order does
+// not matter.
+template <class Type> uint64 HashMapValues(const Type& t) {
+  uint64 hash = 0;
+  for (typename Type::const_iterator it = t.begin(); it != t.end(); ++it) {
+    hash += HashCombine(HashValue(it->first), HashValue(it->second));
+  }
+  return hash;
+}
+template <class Type> uint64 HashMapMessages(const Type& t) {
+  uint64 hash = 0;
+  for (typename Type::const_iterator it = t.begin(); it != t.end(); ++it) {
+    hash += HashCombine(HashValue(it->first), it->second.StructuralHash());
+  }
+  return hash;
+}
+template <class Type> bool MapValuesEqual(const Type& a, const Type& b) {
+  if (a.size() != b.size()) return false;
+  for (typename Type::const_iterator it = a.begin(); it != a.end(); ++it) {
+    typename Type::const_iterator other = b.find(it->first);
+    if (other == b.end() || !ValuesEqual(it->second, other->second)) {
+      return false;
+    }
+  }
+  return true;
+}
+template <class Type> bool MapMessagesEqual(const Type& a, const Type& b) {
+  if (a.size() != b.size()) return false;
+  for (typename Type::const_iterator it = a.begin(); it != a.end(); ++it) {
+    typename Type::const_iterator other = b.find(it->first);
+    if (other == b.end() || !it->second.StructurallyEquals(other->second)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace internal
 }  // namespace protobuf
 
@@ -0,0 +1,497 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "config.h"
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+#include <string.h>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include <google/protobuf/io/async_stream.h>
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+namespace io {
+
+namespace {
+
+// Defaults for both adaptors.  Blocks are larger than the 8k used by the
+// synchronous adaptors so that each system call does more work per wakeup
+// of the background thread.
+static const int kDefaultBlockSize = 65536;
+static const int kDefaultQueueDepth = 2;
+
+}  // namespace
+
+// ===================================================================
+
+// A fixed set of blocks cycling between a producer and a consumer, one of
+// which may be a background thread.  Free blocks go to the producer, which
+// fills them and pushes them onto the queue; the consumer pops them and
+// eventually releases them back to the free list.
+//
+// Without pthreads no background thread is started and all calls come from
+// one thread, so the callers must arrange that nothing ever has to wait.
+class AsyncBlockQueue {
+ public:
+  AsyncBlockQueue(int block_count, int block_size);
+  // Closes the queue and joins the background thread, if any.
+  ~AsyncBlockQueue();
+
+  // Starts a background thread which calls body(arg) until it returns false.
+  // Returns false, starting nothing, if threads are not available.
+  bool StartThread(bool (*body)(void*), void* arg);
+
+  // Producer side.  AcquireFree() waits for a free block; it returns NULL
+  // once the queue is closed.  Finish() marks the end of the data.
+  uint8* AcquireFree();
+  void PushFilled(uint8* block, int size);
+  void Finish();
+
+  // Consumer side.  PopFilled() waits for a filled block; it returns false
+  // once the queue is empty and finished or closed.
+  bool PopFilled(uint8** block, int* size);
+  void ReleaseFree(uint8* block);
+
+  // Waits until every block has been released.
+  void WaitUntilIdle();
+
+  // Records a failure, visible to both sides.
+  void SetFailed();
+  bool failed();
+
+  // Wakes up and stops both sides, then joins the background thread.
+  void Close();
+
+ private:
+  void Lock();
+  void Unlock();
+  // Waits for another thread to change the state.  Must hold the lock.
+  void Wait();
+  // Wakes up all waiting threads.  Must hold the lock.
+  void Broadcast();
+
+#ifdef HAVE_PTHREAD
+  static void* ThreadMain(void* queue);
+
+  pthread_mutex_t mutex_;
+  pthread_cond_t changed_;
+  pthread_t thread_;
+#endif
+  bool has_thread_;
+  bool (*body_)(void*);
+  void* body_arg_;
+
+  vector<uint8*> blocks_;
+  vector<uint8*> free_;
+  deque<pair<uint8*, int> > filled_;
+  bool finished_;
+  bool closed_;
+  bool failed_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(AsyncBlockQueue);
+};
+
+AsyncBlockQueue::AsyncBlockQueue(int block_count, int block_size)
+  : has_thread_(false),
+    body_(NULL),
+    body_arg_(NULL),
+    finished_(false),
+    closed_(false),
+    failed_(false) {
+#ifdef HAVE_PTHREAD
+  pthread_mutex_init(&mutex_, NULL);
+  pthread_cond_init(&changed_, NULL);
+#endif
+  for (int i = 0; i < block_count; i++) {
+    blocks_.push_back(new uint8[block_size]);
+  }
+  free_ = blocks_;
+}
+
+AsyncBlockQueue::~AsyncBlockQueue() {
+  Close();
+#ifdef HAVE_PTHREAD
+  pthread_cond_destroy(&changed_);
+  pthread_mutex_destroy(&mutex_);
+#endif
+  for (int i = 0; i < blocks_.size(); i++) {
+    delete [] blocks_[i];
+  }
+}
+
+bool AsyncBlockQueue::StartThread(bool (*body)(void*), void* arg) {
+  GOOGLE_CHECK(!has_thread_);
+  body_ = body;
+  body_arg_ = arg;
+#ifdef HAVE_PTHREAD
+  has_thread_ = pthread_create(&thread_, NULL, &ThreadMain, this) == 0;
+#endif
+  return has_thread_;
+}
+
+#ifdef HAVE_PTHREAD
+void* AsyncBlockQueue::ThreadMain(void* queue) {
+  AsyncBlockQueue* self = reinterpret_cast<AsyncBlockQueue*>(queue);
+  while (self->body_(self->body_arg_)) {}
+  return NULL;
+}
+#endif
+
+uint8* AsyncBlockQueue::AcquireFree() {
+  Lock();
+  while (free_.empty() && !closed_) Wait();
+  uint8* block = NULL;
+  if (!closed_) {
+    block = free_.back();
+    free_.pop_back();
+  }
+  Unlock();
+  return block;
+}
+
+void AsyncBlockQueue::PushFilled(uint8* block, int size) {
+  Lock();
+  filled_.push_back(make_pair(block, size));
+  Broadcast();
+  Unlock();
+}
+
+void AsyncBlockQueue::Finish() {
+  Lock();
+  finished_ = true;
+  Broadcast();
+  Unlock();
+}
+
+bool AsyncBlockQueue::PopFilled(uint8** block, int* size) {
+  Lock();
+  while (filled_.empty() && !finished_ && !closed_) Wait();
+  const bool result = !filled_.empty();
+  if (result) {
+    *block = filled_.front().first;
+    *size = filled_.front().second;
+    filled_.pop_front();
+  }
+  Unlock();
+  return result;
+}
+
+void AsyncBlockQueue::ReleaseFree(uint8* block) {
+  Lock();
+  free_.push_back(block);
+  Broadcast();
+  Unlock();
+}
+
+void AsyncBlockQueue::WaitUntilIdle() {
+  Lock();
+  while (free_.size() < blocks_.size() && !closed_) Wait();
+  Unlock();
+}
+
+void AsyncBlockQueue::SetFailed() {
+  Lock();
+  failed_ = true;
+  Unlock();
+}
+
+bool AsyncBlockQueue::failed() {
+  Lock();
+  const bool result = failed_;
+  Unlock();
+  return result;
+}
+
+void AsyncBlockQueue::Close() {
+  Lock();
+  closed_ = true;
+  Broadcast();
+  Unlock();
+#ifdef HAVE_PTHREAD
+  if (has_thread_) {
+    pthread_join(thread_, NULL);
+    has_thread_ = false;
+  }
+#endif
+}
+
+#ifdef HAVE_PTHREAD
+
+void AsyncBlockQueue::Lock() {
+  pthread_mutex_lock(&mutex_);
+}
+
+void AsyncBlockQueue::Unlock() {
+  pthread_mutex_unlock(&mutex_);
+}
+
+void AsyncBlockQueue::Wait() {
+  pthread_cond_wait(&changed_, &mutex_);
+}
+
+void AsyncBlockQueue::Broadcast() {
+  pthread_cond_broadcast(&changed_);
+}
+
+#else  // HAVE_PTHREAD
+
+void AsyncBlockQueue::Lock() {}
+void AsyncBlockQueue::Unlock() {}
+
+void AsyncBlockQueue::Wait() {
+  GOOGLE_LOG(FATAL) << "AsyncBlockQueue would wait forever.";
+}
+
+void AsyncBlockQueue::Broadcast() {}
+
+#endif  // !HAVE_PTHREAD
+
+// ===================================================================
+
+AsyncCopyingInputStreamAdaptor::AsyncCopyingInputStreamAdaptor(
+    CopyingInputStream* copying_stream, int block_size, int queue_depth)
+  : copying_stream_(copying_stream),
+    owns_copying_stream_(false),
+    block_size_(block_size > 0 ? block_size : kDefaultBlockSize),
+    threaded_(false),
+    read_done_(false),
+    current_(NULL),
+    current_size_(0),
+    backup_bytes_(0),
+    position_(0) {
+  // One block being read into, queue_depth waiting, and one held by the
+  // caller.
+  queue_.reset(new AsyncBlockQueue(
+      (queue_depth > 0 ? queue_depth : kDefaultQueueDepth) + 2, block_size_));
+  threaded_ = queue_->StartThread(&ReadBlockThunk, this);
+}
+
+AsyncCopyingInputStreamAdaptor::~AsyncCopyingInputStreamAdaptor() {
+  // Stop the background thread before the stream it reads goes away.
+  queue_->Close();
+  if (owns_copying_stream_) {
+    delete copying_stream_;
+  }
+}
+
+bool AsyncCopyingInputStreamAdaptor::Next(const void** data, int* size) {
+  if (backup_bytes_ > 0) {
+    // We have data left over from a previous BackUp(), so just return that.
+    *data = current_ + current_size_ - backup_bytes_;
+    *size = backup_bytes_;
+    backup_bytes_ = 0;
+    return true;
+  }
+
+  if (current_ != NULL) {
+    queue_->ReleaseFree(current_);
+    current_ = NULL;
+  }
+  if (!threaded_) ReadBlock();
+  if (!queue_->PopFilled(&current_, &current_size_)) {
+    // EOF or read error.
+    current_ = NULL;
+    current_size_ = 0;
+    return false;
+  }
+  position_ += current_size_;
+
+  *data = current_;
+  *size = current_size_;
+  return true;
+}
+
+void AsyncCopyingInputStreamAdaptor::BackUp(int count) {
+  GOOGLE_CHECK(backup_bytes_ == 0 && current_ != NULL)
+    << " BackUp() can only be called after Next().";
+  GOOGLE_CHECK_LE(count, current_size_)
+    << " Can't back up over more bytes than were returned by the last call"
+       " to Next().";
+  GOOGLE_CHECK_GE(count, 0)
+    << " Parameter to BackUp() can't be negative.";
+
+  backup_bytes_ = count;
+}
+
+bool AsyncCopyingInputStreamAdaptor::Skip(int count) {
+  GOOGLE_CHECK_GE(count, 0);
+
+  // The data has most likely been read already, so skip through the blocks.
+  const void* data;
+  int size;
+  while (count > 0) {
+    if (!Next(&data, &size)) return false;
+    if (size > count) {
+      BackUp(size - count);
+      count = 0;
+    } else {
+      count -= size;
+    }
+  }
+  return true;
+}
+
+int64 AsyncCopyingInputStreamAdaptor::ByteCount() const {
+  return position_ - backup_bytes_;
+}
+
+bool AsyncCopyingInputStreamAdaptor::ReadBlock() {
+  if (read_done_) return false;
+  uint8* block = queue_->AcquireFree();
+  if (block == NULL) {
+    // Closed.
+    return false;
+  }
+
+  const int bytes = copying_stream_->Read(block, block_size_);
+  if (bytes <= 0) {
+    // EOF or read error.
+    if (bytes < 0) queue_->SetFailed();
+    read_done_ = true;
+    queue_->ReleaseFree(block);
+    queue_->Finish();
+    return false;
+  }
+  queue_->PushFilled(block, bytes);
+  return true;
+}
+
+bool AsyncCopyingInputStreamAdaptor::ReadBlockThunk(void* adaptor) {
+  return reinterpret_cast<AsyncCopyingInputStreamAdaptor*>(adaptor)
+      ->ReadBlock();
+}
+
+// ===================================================================
+
+AsyncCopyingOutputStreamAdaptor::AsyncCopyingOutputStreamAdaptor(
+    CopyingOutputStream* copying_stream, int block_size, int queue_depth)
+  : copying_stream_(copying_stream),
+    owns_copying_stream_(false),
+    block_size_(block_size > 0 ? block_size : kDefaultBlockSize),
+    threaded_(false),
+    current_(NULL),
+    current_used_(0),
+    position_(0) {
+  // One block held by the caller, queue_depth waiting, and one being
+  // written.
+  queue_.reset(new AsyncBlockQueue(
+      (queue_depth > 0 ? queue_depth : kDefaultQueueDepth) + 2, block_size_));
+  threaded_ = queue_->StartThread(&WriteBlockThunk, this);
+}
+
+AsyncCopyingOutputStreamAdaptor::~AsyncCopyingOutputStreamAdaptor() {
+  Flush();
+  // Stop the background thread before the stream it writes goes away.
+  queue_->Close();
+  if (owns_copying_stream_) {
+    delete copying_stream_;
+  }
+}
+
+bool AsyncCopyingOutputStreamAdaptor::Flush() {
+  QueueCurrentBlock();
+  queue_->WaitUntilIdle();
+  return !queue_->failed();
+}
+
+bool AsyncCopyingOutputStreamAdaptor::Next(void** data, int* size) {
+  QueueCurrentBlock();
+  if (queue_->failed()) {
+    // Already failed on a previous write.
+    return false;
+  }
+
+  current_ = queue_->AcquireFree();
+  if (current_ == NULL) return false;
+  current_used_ = block_size_;
+
+  *data = current_;
+  *size = current_used_;
+  return true;
+}
+
+void AsyncCopyingOutputStreamAdaptor::BackUp(int count) {
+  GOOGLE_CHECK(current_ != NULL)
+    << " BackUp() can only be called after Next().";
+  GOOGLE_CHECK_LE(count, current_used_)
+    << " Can't back up over more bytes than were returned by the last call"
+       " to Next().";
+  GOOGLE_CHECK_GE(count, 0)
+    << " Parameter to BackUp() can't be negative.";
+
+  current_used_ -= count;
+}
+
+int64 AsyncCopyingOutputStreamAdaptor::ByteCount() const {
+  return position_ + (current_ != NULL ? current_used_ : 0);
+}
+
+void AsyncCopyingOutputStreamAdaptor::QueueCurrentBlock() {
+  if (current_ == NULL) return;
+  if (current_used_ > 0) {
+    queue_->PushFilled(current_, current_used_);
+    position_ += current_used_;
+    if (!threaded_) WriteBlock();
+  } else {
+    queue_->ReleaseFree(current_);
+  }
+  current_ = NULL;
+  current_used_ = 0;
+}
+
+bool AsyncCopyingOutputStreamAdaptor::WriteBlock() {
+  uint8* block;
+  int size;
+  if (!queue_->PopFilled(&block, &size)) {
+    // Closed.
+    return false;
+  }
+  // Once a write has failed, later blocks are dropped.
+  if (!queue_->failed() && !copying_stream_->Write(block, size)) {
+    queue_->SetFailed();
+  }
+  queue_->ReleaseFree(block);
+  return true;
+}
+
+bool AsyncCopyingOutputStreamAdaptor::WriteBlockThunk(void* adaptor) {
+  return reinterpret_cast<AsyncCopyingOutputStreamAdaptor*>(adaptor)
+      ->WriteBlock();
+}
+
+}  // namespace io
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,187 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains asynchronous versions of CopyingInputStreamAdaptor and
+// CopyingOutputStreamAdaptor.  They move the blocking Read()/Write() calls of
+// the underlying CopyingInputStream or CopyingOutputStream onto a background
+// thread, so that parsing or serializing overlaps with I/O: the input
+// adaptor reads ahead while the caller parses, and the output adaptor writes
+// behind while the caller serializes.
+//
+// On platforms without pthreads the adaptors behave like their synchronous
+// counterparts.
+
+#ifndef GOOGLE_PROTOBUF_IO_ASYNC_STREAM_H__
+#define GOOGLE_PROTOBUF_IO_ASYNC_STREAM_H__
+
+#include <google/protobuf/io/zero_copy_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+namespace io {
+
+// A bounded queue of blocks passed between the caller and the background
+// thread.  Defined in async_stream.cc.
+class AsyncBlockQueue;
+
+// ===================================================================
+
+// A ZeroCopyInputStream which reads from a CopyingInputStream on a
+// background thread.  Up to queue_depth blocks are read ahead of the block
+// most recently returned by Next().  Reading starts as soon as the adaptor is
+// constructed.
+//
+// The CopyingInputStream is only ever used by the background thread, and
+// destroying the adaptor waits for any Read() in progress to return.
+class LIBPROTOBUF_EXPORT AsyncCopyingInputStreamAdaptor
+    : public ZeroCopyInputStream {
+ public:
+  // Creates a stream that reads from the given CopyingInputStream.  If a
+  // block_size is given, it specifies the size of each Read(); if a
+  // queue_depth is given, it specifies how many blocks may be read ahead.
+  // Otherwise reasonable defaults are used.  The caller retains ownership of
+  // copying_stream unless SetOwnsCopyingStream(true) is called.
+  explicit AsyncCopyingInputStreamAdaptor(CopyingInputStream* copying_stream,
+                                          int block_size = -1,
+                                          int queue_depth = -1);
+  ~AsyncCopyingInputStreamAdaptor();
+
+  // Call SetOwnsCopyingStream(true) to tell the adaptor to delete the
+  // underlying CopyingInputStream when it is destroyed.
+  void SetOwnsCopyingStream(bool value) { owns_copying_stream_ = value; }
+
+  // implements ZeroCopyInputStream ----------------------------------
+  bool Next(const void** data, int* size);
+  void BackUp(int count);
+  bool Skip(int count);
+  int64 ByteCount() const;
+
+ private:
+  // Reads one block into the queue.  Returns false at EOF or on error.
+  // Called repeatedly on the background thread, or inline from Next() if
+  // there is none.
+  bool ReadBlock();
+  static bool ReadBlockThunk(void* adaptor);
+
+  // The underlying copying stream.
+  CopyingInputStream* copying_stream_;
+  bool owns_copying_stream_;
+  const int block_size_;
+
+  scoped_ptr<AsyncBlockQueue> queue_;
+  bool threaded_;     // Is a background thread calling ReadBlock()?
+  bool read_done_;    // Has ReadBlock() seen EOF or an error?
+
+  // The block last returned by Next(), or NULL.
+  uint8* current_;
+  int current_size_;
+
+  // Number of bytes at the end of current_ which were backed up over by a
+  // call to BackUp().  These need to be returned again.
+  int backup_bytes_;
+
+  // Total size of the blocks returned by Next().
+  int64 position_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(AsyncCopyingInputStreamAdaptor);
+};
+
+// ===================================================================
+
+// A ZeroCopyOutputStream which writes to a CopyingOutputStream on a
+// background thread.  Each call to Next() hands the previous block to the
+// background thread and returns a free one; Next() only waits if queue_depth
+// blocks are already waiting to be written.
+//
+// Write errors are reported by a later call to Next() or Flush().
+class LIBPROTOBUF_EXPORT AsyncCopyingOutputStreamAdaptor
+    : public ZeroCopyOutputStream {
+ public:
+  // Creates a stream that writes to the given CopyingOutputStream.  If a
+  // block_size is given, it specifies the size of the buffers returned by
+  // Next(); if a queue_depth is given, it specifies how many blocks may be
+  // waiting to be written.  Otherwise reasonable defaults are used.  The
+  // caller retains ownership of copying_stream unless
+  // SetOwnsCopyingStream(true) is called.
+  explicit AsyncCopyingOutputStreamAdaptor(CopyingOutputStream* copying_stream,
+                                           int block_size = -1,
+                                           int queue_depth = -1);
+  // Flushes, then waits for the background thread to exit.
+  ~AsyncCopyingOutputStreamAdaptor();
+
+  // Writes all pending data to the underlying stream and waits for the
+  // writes to complete.  Returns false if a write error occurred on the
+  // underlying stream.  (The underlying stream itself is not necessarily
+  // flushed.)
+  bool Flush();
+
+  // Call SetOwnsCopyingStream(true) to tell the adaptor to delete the
+  // underlying CopyingOutputStream when it is destroyed.
+  void SetOwnsCopyingStream(bool value) { owns_copying_stream_ = value; }
+
+  // implements ZeroCopyOutputStream ---------------------------------
+  bool Next(void** data, int* size);
+  void BackUp(int count);
+  int64 ByteCount() const;
+
+ private:
+  // Hands current_ to the background thread (or writes it inline).
+  void QueueCurrentBlock();
+  // Writes one queued block.  Returns false once the queue is closed.
+  // Called repeatedly on the background thread, or inline if there is none.
+  bool WriteBlock();
+  static bool WriteBlockThunk(void* adaptor);
+
+  // The underlying copying stream.
+  CopyingOutputStream* copying_stream_;
+  bool owns_copying_stream_;
+  const int block_size_;
+
+  scoped_ptr<AsyncBlockQueue> queue_;
+  bool threaded_;     // Is a background thread calling WriteBlock()?
+
+  // The block last returned by Next(), or NULL, and the number of bytes of
+  // it that are in use.
+  uint8* current_;
+  int current_used_;
+
+  // Total size of the blocks handed to the background thread.
+  int64 position_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(AsyncCopyingOutputStreamAdaptor);
+};
+
+}  // namespace io
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_IO_ASYNC_STREAM_H__
@@ -0,0 +1,322 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifdef _MSC_VER
+#include <io.h>
+#else
+#include <sys/uio.h>
+#include <unistd.h>
+#include <limits.h>
+#endif
+#include <errno.h>
+#include <string.h>
+#include <algorithm>
+
+#include <google/protobuf/io/buffer_chain.h>
+#include <google/protobuf/arena.h>
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+namespace io {
+
+namespace {
+
+// Blocks allocated by BufferChainOutputStream start at kMinBlockSize and
+// double up to kMaxBlockSize.
+static const int kMinBlockSize = 1024;
+static const int kMaxBlockSize = 1 << 20;
+
+#ifndef _MSC_VER
+// Most blocks handed to a single writev() call.
+#if defined(IOV_MAX) && IOV_MAX < 1024
+static const int kMaxIovecs = IOV_MAX;
+#else
+static const int kMaxIovecs = 1024;
+#endif
+#endif  // !_MSC_VER
+
+}  // namespace
+
+// ===================================================================
+
+BufferChain::BufferChain(Arena* arena)
+  : size_(0),
+    arena_(arena) {
+}
+
+BufferChain::~BufferChain() {
+  Clear();
+}
+
+void BufferChain::AppendToString(string* output) const {
+  output->reserve(output->size() + size_);
+  for (int i = 0; i < block_count(); i++) {
+    output->append(blocks_[i].data, blocks_[i].size);
+  }
+}
+
+string BufferChain::ToString() const {
+  string result;
+  AppendToString(&result);
+  return result;
+}
+
+bool BufferChain::WriteToFileDescriptor(int file_descriptor,
+                                        int* errno_out) const {
+  int index = 0;
+  int offset = 0;  // Bytes of blocks_[index] already written.
+#ifdef _MSC_VER
+  // No writev() on Windows; write the blocks one at a time.
+  while (index < block_count()) {
+    int bytes;
+    do {
+      bytes = write(file_descriptor, blocks_[index].data + offset,
+                    blocks_[index].size - offset);
+    } while (bytes < 0 && errno == EINTR);
+#else
+  struct iovec iov[kMaxIovecs];
+  while (index < block_count()) {
+    int count = 0;
+    for (int i = index; i < block_count() && count < kMaxIovecs; i++) {
+      const int skip = (i == index) ? offset : 0;
+      iov[count].iov_base = blocks_[i].data + skip;
+      iov[count].iov_len = blocks_[i].size - skip;
+      ++count;
+    }
+    ssize_t bytes;
+    do {
+      bytes = writev(file_descriptor, iov, count);
+    } while (bytes < 0 && errno == EINTR);
+#endif
+    if (bytes <= 0) {
+      // Write error.
+      if (errno_out != NULL) *errno_out = (bytes < 0) ? errno : EIO;
+      return false;
+    }
+
+    // Advance past what was written; writes may be partial.
+    while (bytes > 0) {
+      const int remaining = blocks_[index].size - offset;
+      if (bytes >= remaining) {
+        bytes -= remaining;
+        ++index;
+        offset = 0;
+      } else {
+        offset += bytes;
+        bytes = 0;
+      }
+    }
+  }
+  return true;
+}
+
+void BufferChain::Clear() {
+  if (arena_ == NULL) {
+    for (int i = 0; i < block_count(); i++) {
+      if (blocks_[i].capacity > 0) delete [] blocks_[i].data;
+    }
+  }
+  blocks_.clear();
+  size_ = 0;
+}
+
+BufferChain::Block* BufferChain::AddBlock(int capacity) {
+  Block block;
+  block.data = (arena_ == NULL) ? new char[capacity]
+                                : Arena::CreateArray<char>(arena_, capacity);
+  block.size = 0;
+  block.capacity = capacity;
+  blocks_.push_back(block);
+  return &blocks_.back();
+}
+
+void BufferChain::AddAliasedBlock(const void* data, int size) {
+  TrimLastBlock();
+  Block block;
+  block.data = const_cast<char*>(reinterpret_cast<const char*>(data));
+  block.size = size;
+  block.capacity = 0;
+  blocks_.push_back(block);
+  size_ += size;
+}
+
+void BufferChain::TrimLastBlock() {
+  if (!blocks_.empty() && blocks_.back().size == 0) {
+    if (arena_ == NULL && blocks_.back().capacity > 0) {
+      delete [] blocks_.back().data;
+    }
+    blocks_.pop_back();
+  }
+}
+
+// ===================================================================
+
+BufferChainOutputStream::BufferChainOutputStream(BufferChain* chain,
+                                                 int block_size,
+                                                 int min_aliased_size)
+  : chain_(chain),
+    block_size_(block_size),
+    min_aliased_size_(min_aliased_size),
+    next_block_size_(kMinBlockSize),
+    last_returned_size_(0) {
+}
+
+BufferChainOutputStream::~BufferChainOutputStream() {
+}
+
+bool BufferChainOutputStream::Next(void** data, int* size) {
+  BufferChain::Block* block =
+      chain_->blocks_.empty() ? NULL : &chain_->blocks_.back();
+  if (block == NULL || block->size >= block->capacity) {
+    // Out of space, or the last block is aliased; start a new block.
+    int capacity = block_size_;
+    if (capacity <= 0) {
+      capacity = next_block_size_;
+      next_block_size_ = min(next_block_size_ * 2, kMaxBlockSize);
+    }
+    block = chain_->AddBlock(capacity);
+  }
+
+  last_returned_size_ = block->capacity - block->size;
+  *data = block->data + block->size;
+  *size = last_returned_size_;
+  block->size = block->capacity;
+  chain_->size_ += last_returned_size_;
+  return true;
+}
+
+void BufferChainOutputStream::BackUp(int count) {
+  GOOGLE_CHECK_GT(last_returned_size_, 0)
+      << "BackUp() can only be called after a successful Next().";
+  GOOGLE_CHECK_LE(count, last_returned_size_);
+  GOOGLE_CHECK_GE(count, 0);
+  chain_->blocks_.back().size -= count;
+  chain_->size_ -= count;
+  chain_->TrimLastBlock();
+  last_returned_size_ = 0;  // Don't let caller back up further.
+}
+
+int64 BufferChainOutputStream::ByteCount() const {
+  return chain_->size();
+}
+
+bool BufferChainOutputStream::WriteAliasedRaw(const void* data, int size) {
+  last_returned_size_ = 0;  // Don't let caller back up.
+  if (size >= min_aliased_size_) {
+    chain_->AddAliasedBlock(data, size);
+    return true;
+  }
+
+  // Too small to be worth a block of its own; copy it.
+  const char* in = reinterpret_cast<const char*>(data);
+  while (size > 0) {
+    void* out;
+    int out_size;
+    Next(&out, &out_size);
+    const int n = min(size, out_size);
+    memcpy(out, in, n);
+    in += n;
+    size -= n;
+    if (n < out_size) BackUp(out_size - n);
+  }
+  last_returned_size_ = 0;
+  return true;
+}
+
+// ===================================================================
+
+BufferChainInputStream::BufferChainInputStream(const BufferChain* chain)
+  : chain_(chain),
+    block_index_(0),
+    block_offset_(0),
+    position_(0),
+    last_returned_size_(0) {
+}
+
+BufferChainInputStream::~BufferChainInputStream() {
+}
+
+bool BufferChainInputStream::Next(const void** data, int* size) {
+  while (block_index_ < chain_->block_count() &&
+         block_offset_ == chain_->block_size(block_index_)) {
+    ++block_index_;
+    block_offset_ = 0;
+  }
+  if (block_index_ == chain_->block_count()) {
+    // We're at the end of the chain.
+    last_returned_size_ = 0;   // Don't let caller back up.
+    return false;
+  }
+
+  last_returned_size_ = chain_->block_size(block_index_) - block_offset_;
+  *data = chain_->block_data(block_index_) + block_offset_;
+  *size = last_returned_size_;
+  block_offset_ += last_returned_size_;
+  position_ += last_returned_size_;
+  return true;
+}
+
+void BufferChainInputStream::BackUp(int count) {
+  GOOGLE_CHECK_GT(last_returned_size_, 0)
+      << "BackUp() can only be called after a successful Next().";
+  GOOGLE_CHECK_LE(count, last_returned_size_);
+  GOOGLE_CHECK_GE(count, 0);
+  block_offset_ -= count;
+  position_ -= count;
+  last_returned_size_ = 0;  // Don't let caller back up further.
+}
+
+bool BufferChainInputStream::Skip(int count) {
+  GOOGLE_CHECK_GE(count, 0);
+  last_returned_size_ = 0;   // Don't let caller back up.
+  while (count > 0) {
+    if (block_index_ == chain_->block_count()) return false;
+    const int available = chain_->block_size(block_index_) - block_offset_;
+    if (available == 0) {
+      ++block_index_;
+      block_offset_ = 0;
+      continue;
+    }
+    const int n = min(available, count);
+    block_offset_ += n;
+    position_ += n;
+    count -= n;
+  }
+  return true;
+}
+
+int64 BufferChainInputStream::ByteCount() const {
+  return position_;
+}
+
+}  // namespace io
+}  // namespace protobuf
+}  // namespace google
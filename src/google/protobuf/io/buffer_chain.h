@@ -0,0 +1,183 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains BufferChain, an in-memory byte sequence stored as a
+// list of separately allocated blocks, plus ZeroCopy streams for writing and
+// reading it.  Unlike StringOutputStream, growing a BufferChain never moves
+// data that has already been written, so serializing a very large message
+// does not copy it repeatedly or briefly need twice its size in memory.
+
+#ifndef GOOGLE_PROTOBUF_IO_BUFFER_CHAIN_H__
+#define GOOGLE_PROTOBUF_IO_BUFFER_CHAIN_H__
+
+#include <string>
+#include <vector>
+#include <google/protobuf/io/zero_copy_stream.h>
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+  class Arena;
+namespace io {
+
+// ===================================================================
+
+// A sequence of bytes held in a chain of blocks.  Blocks are either owned by
+// the chain (allocated by BufferChainOutputStream::Next()) or aliased (added
+// by BufferChainOutputStream::WriteAliasedRaw()); aliased memory remains the
+// property of the caller and must outlive the chain.
+//
+// If an Arena is given, owned blocks are allocated on it and are freed with
+// the arena rather than by the chain.  The chain itself may then be cleared
+// or destroyed without releasing memory, so it is best suited to short-lived
+// arenas such as one per request.
+class LIBPROTOBUF_EXPORT BufferChain {
+ public:
+  explicit BufferChain(Arena* arena = NULL);
+  ~BufferChain();
+
+  // Total number of bytes in the chain.
+  int64 size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // Access to the individual blocks, in order.  No block is empty.
+  int block_count() const { return blocks_.size(); }
+  const char* block_data(int index) const { return blocks_[index].data; }
+  int block_size(int index) const { return blocks_[index].size; }
+
+  // Appends the contents of the chain to *output.
+  void AppendToString(string* output) const;
+  string ToString() const;
+
+  // Writes the whole chain to a file descriptor using writev(), gathering up
+  // to IOV_MAX blocks per system call.  Returns false and sets *errno_out
+  // (if not NULL) on error, in which case an unknown prefix of the chain may
+  // have been written.
+  bool WriteToFileDescriptor(int file_descriptor, int* errno_out) const;
+
+  // Removes all blocks, freeing the owned ones unless they live on an arena.
+  void Clear();
+
+  Arena* arena() const { return arena_; }
+
+ private:
+  friend class BufferChainOutputStream;
+
+  struct Block {
+    char* data;
+    int size;
+    int capacity;  // 0 for aliased blocks, which can never grow.
+  };
+
+  // Appends an owned block with the given capacity and no data.
+  Block* AddBlock(int capacity);
+  // Appends an aliased block.
+  void AddAliasedBlock(const void* data, int size);
+  // Drops a trailing empty block, if any.
+  void TrimLastBlock();
+
+  vector<Block> blocks_;
+  int64 size_;
+  Arena* arena_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(BufferChain);
+};
+
+// ===================================================================
+
+// A ZeroCopyOutputStream which appends to a BufferChain.
+//
+// Blocks start small and double in size up to a cap, so small messages do
+// not waste memory while large ones need few blocks.  The stream supports
+// aliasing: with CodedOutputStream::EnableAliasing(true), large string and
+// bytes fields written through WriteRawMaybeAliased() (as generated code
+// does) are linked into the chain by reference instead of being copied.
+// Those fields must then outlive the chain.
+class LIBPROTOBUF_EXPORT BufferChainOutputStream : public ZeroCopyOutputStream {
+ public:
+  // Create a stream that appends to *chain, which must outlive the stream.
+  // If a block_size is given, every block allocated by the stream has that
+  // size; otherwise blocks grow geometrically.  Writes of fewer than
+  // min_aliased_size bytes through WriteAliasedRaw() are copied instead of
+  // aliased, since a separate block for them would cost more than the copy.
+  explicit BufferChainOutputStream(BufferChain* chain, int block_size = -1,
+                                   int min_aliased_size = 1024);
+  ~BufferChainOutputStream();
+
+  // implements ZeroCopyOutputStream ---------------------------------
+  bool Next(void** data, int* size);
+  void BackUp(int count);
+  int64 ByteCount() const;
+  bool WriteAliasedRaw(const void* data, int size);
+  bool AllowsAliasing() const { return true; }
+
+ private:
+  BufferChain* chain_;
+  const int block_size_;
+  const int min_aliased_size_;
+  int next_block_size_;       // Size of the next block when growing.
+  int last_returned_size_;    // How many bytes we returned last time Next()
+                              // was called (used for error checking only).
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(BufferChainOutputStream);
+};
+
+// ===================================================================
+
+// A ZeroCopyInputStream which reads a BufferChain, returning one block (or
+// what is left of it) from each call to Next().  The chain must not be
+// modified while the stream is in use.
+class LIBPROTOBUF_EXPORT BufferChainInputStream : public ZeroCopyInputStream {
+ public:
+  explicit BufferChainInputStream(const BufferChain* chain);
+  ~BufferChainInputStream();
+
+  // implements ZeroCopyInputStream ----------------------------------
+  bool Next(const void** data, int* size);
+  void BackUp(int count);
+  bool Skip(int count);
+  int64 ByteCount() const;
+
+ private:
+  const BufferChain* chain_;
+  int block_index_;         // Block currently being read.
+  int block_offset_;        // Position within that block.
+  int64 position_;
+  int last_returned_size_;  // How many bytes we returned last time Next()
+                            // was called (used for error checking only).
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(BufferChainInputStream);
+};
+
+}  // namespace io
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_IO_BUFFER_CHAIN_H__
@@ -104,11 +104,13 @@ void CodedInputStream::BackUpInputToCurrentPosition() {
 
 inline void CodedInputStream::RecomputeBufferLimits() {
   buffer_end_ += buffer_size_after_limit_;
-  int closest_limit = min(current_limit_, total_bytes_limit_);
+  int64 closest_limit = min(current_limit_, total_bytes_limit_);
   if (closest_limit < total_bytes_read_) {
     // The limit position is in the current buffer.  We must adjust
-    // the buffer size accordingly.
-    buffer_size_after_limit_ = total_bytes_read_ - closest_limit;
+    // the buffer size accordingly.  The difference is bounded by the size of
+    // the buffer, so it fits in an int.
+    buffer_size_after_limit_ =
+        static_cast<int>(total_bytes_read_ - closest_limit);
     buffer_end_ -= buffer_size_after_limit_;
   } else {
     buffer_size_after_limit_ = 0;
@@ -117,18 +119,18 @@ inline void CodedInputStream::RecomputeBufferLimits() {
 
 CodedInputStream::Limit CodedInputStream::PushLimit(int byte_limit) {
   // Current position relative to the beginning of the stream.
-  int current_position = CurrentPosition();
+  int64 current_position = CurrentPosition();
 
   Limit old_limit = current_limit_;
 
   // security: byte_limit is possibly evil, so check for negative values
   // and overflow.
   if (byte_limit >= 0 &&
-      byte_limit <= INT_MAX - current_position) {
+      byte_limit <= kint64max - current_position) {
     current_limit_ = current_position + byte_limit;
   } else {
     // Negative or overflow.
-    current_limit_ = INT_MAX;
+    current_limit_ = kint64max;
   }
 
   // We need to enforce all limits, not just the new one, so if the previous
@@ -165,17 +167,19 @@ bool CodedInputStream::DecrementRecursionDepthAndPopLimit(Limit limit) {
 }
 
 int CodedInputStream::BytesUntilLimit() const {
-  if (current_limit_ == INT_MAX) return -1;
-  int current_position = CurrentPosition();
+  if (current_limit_ == kint64max) return -1;
+  int64 current_position = CurrentPosition();
 
-  return current_limit_ - current_position;
+  // Every limit was pushed with an int byte count, so the distance to the
+  // nearest one always fits in an int.
+  return static_cast<int>(current_limit_ - current_position);
 }
 
 void CodedInputStream::SetTotalBytesLimit(
-    int total_bytes_limit, int warning_threshold) {
+    int64 total_bytes_limit, int64 warning_threshold) {
   // Make sure the limit isn't already past, since this could confuse other
   // code.
-  int current_position = CurrentPosition();
+  int64 current_position = CurrentPosition();
   total_bytes_limit_ = max(current_position, total_bytes_limit);
   if (warning_threshold >= 0) {
     total_bytes_warning_threshold_ = warning_threshold;
@@ -186,8 +190,8 @@ void CodedInputStream::SetTotalBytesLimit(
   RecomputeBufferLimits();
 }
 
-int CodedInputStream::BytesUntilTotalBytesLimit() const {
-  if (total_bytes_limit_ == INT_MAX) return -1;
+int64 CodedInputStream::BytesUntilTotalBytesLimit() const {
+  if (total_bytes_limit_ == kint64max) return -1;
   return total_bytes_limit_ - CurrentPosition();
 }
 
@@ -221,13 +225,14 @@ bool CodedInputStream::Skip(int count) {
   buffer_end_ = buffer_;
 
   // Make sure this skip doesn't try to skip past the current limit.
-  int closest_limit = min(current_limit_, total_bytes_limit_);
-  int bytes_until_limit = closest_limit - total_bytes_read_;
+  int64 closest_limit = min(current_limit_, total_bytes_limit_);
+  int64 bytes_until_limit = closest_limit - total_bytes_read_;
   if (bytes_until_limit < count) {
-    // We hit the limit.  Skip up to it then fail.
+    // We hit the limit.  Skip up to it then fail.  bytes_until_limit is less
+    // than count here, so it fits in an int.
     if (bytes_until_limit > 0) {
       total_bytes_read_ = closest_limit;
-      input_->Skip(bytes_until_limit);
+      input_->Skip(static_cast<int>(bytes_until_limit));
     }
     return false;
   }
@@ -271,9 +276,9 @@ bool CodedInputStream::ReadStringFallback(string* buffer, int size) {
     buffer->clear();
   }
 
-  int closest_limit = min(current_limit_, total_bytes_limit_);
-  if (closest_limit != INT_MAX) {
-    int bytes_to_limit = closest_limit - CurrentPosition();
+  int64 closest_limit = min(current_limit_, total_bytes_limit_);
+  if (closest_limit != kint64max) {
+    int64 bytes_to_limit = closest_limit - CurrentPosition();
     if (bytes_to_limit > 0 && size > 0 && size <= bytes_to_limit) {
       buffer->reserve(size);
     }
@@ -406,7 +411,7 @@ uint32 CodedInputStream::ReadTagSlow() {
       // Refresh failed.  Make sure that it failed due to EOF, not because
       // we hit total_bytes_limit_, which, unlike normal limits, is not a
       // valid place to end a message.
-      int current_position = total_bytes_read_ - buffer_size_after_limit_;
+      int64 current_position = total_bytes_read_ - buffer_size_after_limit_;
       if (current_position >= total_bytes_limit_) {
         // Hit total_bytes_limit_.  But if we also hit the normal limit,
         // we're still OK.
@@ -536,7 +541,7 @@ bool CodedInputStream::Refresh() {
   if (buffer_size_after_limit_ > 0 || overflow_bytes_ > 0 ||
       total_bytes_read_ == current_limit_) {
     // We've hit a limit.  Stop.
-    int current_position = total_bytes_read_ - buffer_size_after_limit_;
+    int64 current_position = total_bytes_read_ - buffer_size_after_limit_;
 
     if (current_position >= total_bytes_limit_ &&
         total_bytes_limit_ != current_limit_) {
@@ -568,22 +573,24 @@ bool CodedInputStream::Refresh() {
     buffer_end_ = buffer_ + buffer_size;
     GOOGLE_CHECK_GE(buffer_size, 0);
 
-    if (total_bytes_read_ <= INT_MAX - buffer_size) {
+    if (total_bytes_read_ <= kint64max - buffer_size) {
       total_bytes_read_ += buffer_size;
     } else {
-      // Overflow.  Reset buffer_end_ to not include the bytes beyond INT_MAX.
+      // Overflow.  Reset buffer_end_ to not include the bytes beyond
+      // kint64max.
       // We can't get that far anyway, because total_bytes_limit_ is guaranteed
       // to be less than it.  We need to keep track of the number of bytes
       // we discarded, though, so that we can call input_->BackUp() to back
       // up over them on destruction.
 
       // The following line is equivalent to:
-      //   overflow_bytes_ = total_bytes_read_ + buffer_size - INT_MAX;
+      //   overflow_bytes_ = total_bytes_read_ + buffer_size - kint64max;
       // except that it avoids overflows.  Signed integer overflow has
       // undefined results according to the C standard.
-      overflow_bytes_ = total_bytes_read_ - (INT_MAX - buffer_size);
+      overflow_bytes_ =
+          static_cast<int>(total_bytes_read_ - (kint64max - buffer_size));
       buffer_end_ -= overflow_bytes_;
-      total_bytes_read_ = INT_MAX;
+      total_bytes_read_ = kint64max;
     }
 
     RecomputeBufferLimits();
@@ -597,13 +604,16 @@ bool CodedInputStream::Refresh() {
 
 // CodedOutputStream =================================================
 
+bool CodedOutputStream::default_serialization_deterministic_ = false;
+
 CodedOutputStream::CodedOutputStream(ZeroCopyOutputStream* output)
   : output_(output),
     buffer_(NULL),
     buffer_size_(0),
     total_bytes_(0),
     had_error_(false),
-    aliasing_enabled_(false) {
+    aliasing_enabled_(false),
+    serialization_deterministic_(default_serialization_deterministic_) {
   // Eagerly Refresh() so buffer space is immediately available.
   Refresh();
   // The Refresh() may have failed. If the client doesn't write any data,
@@ -924,6 +934,43 @@ uint8* CodedOutputStream::WriteStringWithSizeToArray(const string& str,
   return WriteStringToArray(str, target);
 }
 
+// ===================================================================
+
+ReverseCodedBuffer::ReverseCodedBuffer()
+  : buffer_(NULL),
+    head_(NULL),
+    end_(NULL) {
+}
+
+ReverseCodedBuffer::~ReverseCodedBuffer() {
+  delete [] buffer_;
+}
+
+void ReverseCodedBuffer::WriteRaw(const void* data, int size) {
+  memcpy(Reserve(size), data, size);
+}
+
+void ReverseCodedBuffer::Grow(int size) {
+  static const int kMinimumSize = 256;
+  int used = ByteCount();
+  GOOGLE_CHECK_LE(size, INT_MAX - used)
+      << "Serialized data would exceed 2GB.";
+  int64 capacity = static_cast<int64>(end_ - buffer_) * 2;
+  capacity = std::max<int64>(capacity, kMinimumSize);
+  capacity = std::max<int64>(capacity, static_cast<int64>(used) + size);
+  capacity = std::min<int64>(capacity, INT_MAX);
+
+  uint8* new_buffer = new uint8[capacity];
+  uint8* new_end = new_buffer + capacity;
+  if (used > 0) {
+    memcpy(new_end - used, head_, used);
+  }
+  delete [] buffer_;
+  buffer_ = new_buffer;
+  head_ = new_end - used;
+  end_ = new_end;
+}
+
 }  // namespace io
 }  // namespace protobuf
 }  // namespace google
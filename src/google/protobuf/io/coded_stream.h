@@ -143,6 +143,7 @@ namespace io {
 // Defined in this file.
 class CodedInputStream;
 class CodedOutputStream;
+class ReverseCodedBuffer;
 
 // Defined in other files.
 class ZeroCopyInputStream;           // zero_copy_stream.h
@@ -305,8 +306,10 @@ class LIBPROTOBUF_EXPORT CodedInputStream {
 
   // Opaque type used with PushLimit() and PopLimit().  Do not modify
   // values of this type yourself.  The only reason that this isn't a
-  // struct with private internals is for efficiency.
-  typedef int Limit;
+  // struct with private internals is for efficiency.  Limits are absolute
+  // stream positions, so they are 64 bits wide to allow a single message to
+  // be larger than 2GB.
+  typedef int64 Limit;
 
   // Places a limit on the number of bytes that the stream may read,
   // starting from the current position.  Once the stream hits this limit,
@@ -330,7 +333,8 @@ class LIBPROTOBUF_EXPORT CodedInputStream {
   int BytesUntilLimit() const;
 
   // Returns current position relative to the beginning of the input stream.
-  int CurrentPosition() const;
+  // This may exceed 2GB when a large total bytes limit has been set.
+  int64 CurrentPosition() const;
 
   // Total Bytes Limit -----------------------------------------------
   // To prevent malicious users from sending excessively large messages
@@ -344,10 +348,14 @@ class LIBPROTOBUF_EXPORT CodedInputStream {
   // maximum message length should be limited to the shortest length that
   // will not harm usability.  The theoretical shortest message that could
   // cause integer overflows is 512MB.  The default limit is 64MB.  Apps
-  // should set shorter limits if possible.  If warning_threshold is not -1,
-  // a warning will be printed to stderr after warning_threshold bytes are
-  // read.  For backwards compatibility all negative values get squashed to -1,
-  // as other negative values might have special internal meanings.
+  // should set shorter limits if possible.  Limits above 2GB are allowed;
+  // positions are tracked with 64-bit integers, so a single message streamed
+  // from a ZeroCopyInputStream may be arbitrarily large, although every
+  // individual length-delimited field must still be smaller than 2GB.  If
+  // warning_threshold is not -1, a warning will be printed to stderr after
+  // warning_threshold bytes are read.  For backwards compatibility all
+  // negative values get squashed to -1, as other negative values might have
+  // special internal meanings.
   // An error will always be printed to stderr if the limit is reached.
   //
   // This is unrelated to PushLimit()/PopLimit().
@@ -367,11 +375,11 @@ class LIBPROTOBUF_EXPORT CodedInputStream {
   //   that, then call Message::ParseFromCodedStream() instead.  Then
   //   you can adjust the limit.  Yes, it's more work, but you're doing
   //   something unusual.
-  void SetTotalBytesLimit(int total_bytes_limit, int warning_threshold);
+  void SetTotalBytesLimit(int64 total_bytes_limit, int64 warning_threshold);
 
   // The Total Bytes Limit minus the Current Position, or -1 if there
   // is no Total Bytes Limit.
-  int BytesUntilTotalBytesLimit() const;
+  int64 BytesUntilTotalBytesLimit() const;
 
   // Recursion Limit -------------------------------------------------
   // To prevent corrupt or malicious messages from causing stack overflows,
@@ -492,10 +500,10 @@ class LIBPROTOBUF_EXPORT CodedInputStream {
   const uint8* buffer_;
   const uint8* buffer_end_;     // pointer to the end of the buffer.
   ZeroCopyInputStream* input_;
-  int total_bytes_read_;  // total bytes read from input_, including
-                          // the current buffer
+  int64 total_bytes_read_;  // total bytes read from input_, including
+                            // the current buffer
 
-  // If total_bytes_read_ surpasses INT_MAX, we record the extra bytes here
+  // If total_bytes_read_ surpasses kint64max, we record the extra bytes here
   // so that we can BackUp() on destruction.
   int overflow_bytes_;
 
@@ -511,7 +519,7 @@ class LIBPROTOBUF_EXPORT CodedInputStream {
   bool aliasing_enabled_;
 
   // Limits
-  Limit current_limit_;   // if position = -1, no limit is applied
+  Limit current_limit_;   // if position = kint64max, no limit is applied
 
   // For simplicity, if the current buffer crosses a limit (either a normal
   // limit created by PushLimit() or the total bytes limit), buffer_size_
@@ -524,13 +532,13 @@ class LIBPROTOBUF_EXPORT CodedInputStream {
 
   // Maximum number of bytes to read, period.  This is unrelated to
   // current_limit_.  Set using SetTotalBytesLimit().
-  int total_bytes_limit_;
+  int64 total_bytes_limit_;
 
   // If positive/0: Limit for bytes read after which a warning due to size
   // should be logged.
   // If -1: Printing of warning disabled. Can be set by client.
   // If -2: Internal: Limit has been reached, print full size when destructing.
-  int total_bytes_warning_threshold_;
+  int64 total_bytes_warning_threshold_;
 
   // Current recursion budget, controlled by IncrementRecursionDepth() and
   // similar.  Starts at recursion_limit_ and goes down: if this reaches
@@ -671,6 +679,21 @@ class LIBPROTOBUF_EXPORT CodedOutputStream {
   // is called.
   inline uint8* GetDirectBufferForNBytesAndAdvance(int size);
 
+  // Number of bytes that can be written between BeginFastWrite() and
+  // EndFastWrite().
+  static const int kSlopBytes = 64;
+
+  // Returns a pointer at which up to kSlopBytes bytes may be written, e.g.
+  // using the *ToArray static methods, without any bounds checks.  This is
+  // the current buffer if at least kSlopBytes of it are left, or an internal
+  // patch buffer otherwise.  Either way the write has to be finished by
+  // calling EndFastWrite() before any other non-const method is called.
+  // This lets a run of small values be written with a single bounds check.
+  inline uint8* BeginFastWrite();
+  // Finishes a write started by BeginFastWrite().  "end" must point just
+  // past the last byte written.
+  inline void EndFastWrite(uint8* end);
+
   // Write raw bytes, copying them from the given buffer.
   void WriteRaw(const void* buffer, int size);
   // Like WriteRaw()  but will try to write aliased data if aliasing is
@@ -702,6 +725,32 @@ class LIBPROTOBUF_EXPORT CodedOutputStream {
   // remains live until all of the data has been consumed from the stream.
   void EnableAliasing(bool enabled);
 
+  // Instructs the CodedOutputStream to have messages written through it emit
+  // map entries ordered by key, so that equal messages serialize to equal
+  // bytes.  This is slower than ordinary serialization, which writes map
+  // entries in hash order.  The output is not a canonical form: it may change
+  // between protobuf versions, and unknown fields are written as received.
+  void SetSerializationDeterministic(bool value) {
+    serialization_deterministic_ = value;
+  }
+  // See SetSerializationDeterministic().
+  bool IsSerializationDeterministic() const {
+    return serialization_deterministic_;
+  }
+
+  // Makes SetSerializationDeterministic(true) the default for every
+  // CodedOutputStream constructed afterwards, and makes SerializeToString(),
+  // SerializeToArray() and friends produce deterministic output as well.
+  // This is a process-wide setting: call it once during startup, before any
+  // thread serializes a message.
+  static void SetDefaultSerializationDeterministic() {
+    default_serialization_deterministic_ = true;
+  }
+  // See SetDefaultSerializationDeterministic().
+  static bool IsDefaultSerializationDeterministic() {
+    return default_serialization_deterministic_;
+  }
+
   // Write a 32-bit little-endian integer.
   void WriteLittleEndian32(uint32 value);
   // Like WriteLittleEndian32()  but writing directly to the target array.
@@ -762,7 +811,7 @@ class LIBPROTOBUF_EXPORT CodedOutputStream {
   };
 
   // Returns the total number of bytes written since this object was created.
-  inline int ByteCount() const;
+  inline int64 ByteCount() const;
 
   // Returns true if there was an underlying I/O error since this object was
   // created.
@@ -774,9 +823,13 @@ class LIBPROTOBUF_EXPORT CodedOutputStream {
   ZeroCopyOutputStream* output_;
   uint8* buffer_;
   int buffer_size_;
-  int total_bytes_;  // Sum of sizes of all buffers seen so far.
+  int64 total_bytes_;  // Sum of sizes of all buffers seen so far.
   bool had_error_;   // Whether an error occurred during output.
   bool aliasing_enabled_;  // See EnableAliasing().
+  bool serialization_deterministic_;  // See SetSerializationDeterministic().
+  uint8 patch_buffer_[kSlopBytes];  // See BeginFastWrite().
+
+  static bool default_serialization_deterministic_;
 
   // Advance the buffer by a given number of bytes.
   void Advance(int amount);
@@ -806,6 +859,62 @@ class LIBPROTOBUF_EXPORT CodedOutputStream {
   static int VarintSize32Fallback(uint32 value);
 };
 
+// Class which encodes the same varint and fixed-width values as
+// CodedOutputStream, but back to front into a growable in-memory buffer:
+// every Write*() call places its bytes in front of everything written so
+// far.  Serializing a message this way means that by the time the tag and
+// length of a length-delimited field have to be written, its contents are
+// already in the buffer and the length is simply the number of bytes added
+// since it was started.  No ByteSize() pass is needed beforehand.
+//
+//   ReverseCodedBuffer buffer;
+//   int end = buffer.ByteCount();
+//   buffer.WriteString(text);
+//   buffer.WriteVarint32(buffer.ByteCount() - end);
+//   buffer.WriteTag(tag);
+//   output->assign(reinterpret_cast<const char*>(buffer.data()),
+//                  buffer.ByteCount());
+//
+// The buffer grows by doubling, copying the bytes written so far to the end
+// of the new block.
+class LIBPROTOBUF_EXPORT ReverseCodedBuffer {
+ public:
+  ReverseCodedBuffer();
+  ~ReverseCodedBuffer();
+
+  // Returns a pointer to |size| bytes immediately in front of the data
+  // written so far.  The caller must fill all of them, front to back, e.g.
+  // with the CodedOutputStream::Write*ToArray() methods.
+  inline uint8* Reserve(int size);
+
+  // Each of these prepends the encoding of its argument.
+  void WriteRaw(const void* buffer, int size);
+  inline void WriteString(const string& str);
+  inline void WriteLittleEndian32(uint32 value);
+  inline void WriteLittleEndian64(uint64 value);
+  inline void WriteVarint32(uint32 value);
+  inline void WriteVarint64(uint64 value);
+  inline void WriteVarint32SignExtended(int32 value);
+  inline void WriteTag(uint32 value);
+
+  // Returns the number of bytes written so far.
+  inline int ByteCount() const;
+
+  // Returns the bytes written so far, in wire order.  Invalidated by the
+  // next Write*() or Reserve() call.
+  const uint8* data() const { return head_; }
+
+ private:
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(ReverseCodedBuffer);
+
+  // Reallocates so that at least |size| bytes are free in front of head_.
+  void Grow(int size);
+
+  uint8* buffer_;  // Start of the allocated block.
+  uint8* head_;    // First written byte; bytes [buffer_, head_) are free.
+  uint8* end_;     // End of the allocated block and of the written data.
+};
+
 // inline methods ====================================================
 // The vast majority of varints are only one byte.  These inline
 // methods optimize for that case.
@@ -1012,7 +1121,7 @@ inline bool CodedInputStream::ExpectAtEnd() {
   }
 }
 
-inline int CodedInputStream::CurrentPosition() const {
+inline int64 CodedInputStream::CurrentPosition() const {
   return total_bytes_read_ - (BufferSize() + buffer_size_after_limit_);
 }
 
@@ -1026,6 +1135,20 @@ inline uint8* CodedOutputStream::GetDirectBufferForNBytesAndAdvance(int size) {
   }
 }
 
+inline uint8* CodedOutputStream::BeginFastWrite() {
+  return buffer_size_ >= kSlopBytes ? buffer_ : patch_buffer_;
+}
+
+inline void CodedOutputStream::EndFastWrite(uint8* end) {
+  // The current buffer cannot have changed since BeginFastWrite(), so this
+  // makes the same choice it did.
+  if (buffer_size_ >= kSlopBytes) {
+    Advance(end - buffer_);
+  } else {
+    WriteRaw(patch_buffer_, end - patch_buffer_);
+  }
+}
+
 inline uint8* CodedOutputStream::WriteVarint32ToArray(uint32 value,
                                                         uint8* target) {
   if (value < 0x80) {
@@ -1138,7 +1261,7 @@ inline uint8* CodedOutputStream::WriteStringToArray(
   return WriteRawToArray(str.data(), static_cast<int>(str.size()), target);
 }
 
-inline int CodedOutputStream::ByteCount() const {
+inline int64 CodedOutputStream::ByteCount() const {
   return total_bytes_ - buffer_size_;
 }
 
@@ -1192,7 +1315,7 @@ inline CodedInputStream::CodedInputStream(ZeroCopyInputStream* input)
     last_tag_(0),
     legitimate_message_end_(false),
     aliasing_enabled_(false),
-    current_limit_(kint32max),
+    current_limit_(kint64max),
     buffer_size_after_limit_(0),
     total_bytes_limit_(kDefaultTotalBytesLimit),
     total_bytes_warning_threshold_(kDefaultTotalBytesWarningThreshold),
@@ -1229,6 +1352,52 @@ inline bool CodedInputStream::IsFlat() const {
   return input_ == NULL;
 }
 
+inline uint8* ReverseCodedBuffer::Reserve(int size) {
+  if (head_ - buffer_ < size) {
+    Grow(size);
+  }
+  head_ -= size;
+  return head_;
+}
+
+inline void ReverseCodedBuffer::WriteString(const string& str) {
+  WriteRaw(str.data(), static_cast<int>(str.size()));
+}
+
+inline void ReverseCodedBuffer::WriteLittleEndian32(uint32 value) {
+  CodedOutputStream::WriteLittleEndian32ToArray(value, Reserve(sizeof(value)));
+}
+
+inline void ReverseCodedBuffer::WriteLittleEndian64(uint64 value) {
+  CodedOutputStream::WriteLittleEndian64ToArray(value, Reserve(sizeof(value)));
+}
+
+inline void ReverseCodedBuffer::WriteVarint32(uint32 value) {
+  CodedOutputStream::WriteVarint32ToArray(
+      value, Reserve(CodedOutputStream::VarintSize32(value)));
+}
+
+inline void ReverseCodedBuffer::WriteVarint64(uint64 value) {
+  CodedOutputStream::WriteVarint64ToArray(
+      value, Reserve(CodedOutputStream::VarintSize64(value)));
+}
+
+inline void ReverseCodedBuffer::WriteVarint32SignExtended(int32 value) {
+  if (value < 0) {
+    WriteVarint64(static_cast<uint64>(value));
+  } else {
+    WriteVarint32(static_cast<uint32>(value));
+  }
+}
+
+inline void ReverseCodedBuffer::WriteTag(uint32 value) {
+  WriteVarint32(value);
+}
+
+inline int ReverseCodedBuffer::ByteCount() const {
+  return static_cast<int>(end_ - head_);
+}
+
 }  // namespace io
 }  // namespace protobuf
 
@@ -1127,8 +1127,7 @@ TEST_F(CodedStreamTest, NegativeLimit) {
   CodedInputStream coded_input(&input);
 
   CodedInputStream::Limit limit = coded_input.PushLimit(-1234);
-  // BytesUntilLimit() returns -1 to mean "no limit", which actually means
-  // "the limit is INT_MAX relative to the beginning of the stream".
+  // BytesUntilLimit() returns -1 to mean "no limit".
   EXPECT_EQ(-1, coded_input.BytesUntilLimit());
   coded_input.PopLimit(limit);
 }
@@ -1140,24 +1139,23 @@ TEST_F(CodedStreamTest, NegativeLimitAfterReading) {
   ASSERT_TRUE(coded_input.Skip(128));
 
   CodedInputStream::Limit limit = coded_input.PushLimit(-64);
-  // BytesUntilLimit() returns -1 to mean "no limit", which actually means
-  // "the limit is INT_MAX relative to the beginning of the stream".
+  // BytesUntilLimit() returns -1 to mean "no limit".
   EXPECT_EQ(-1, coded_input.BytesUntilLimit());
   coded_input.PopLimit(limit);
 }
 
 TEST_F(CodedStreamTest, OverflowLimit) {
   // Check what happens when we push a limit large enough that its absolute
-  // position is more than 2GB into the stream.
+  // position is more than 2GB into the stream.  Positions are 64-bit, so the
+  // limit is kept as requested.
   ArrayInputStream input(buffer_, sizeof(buffer_));
   CodedInputStream coded_input(&input);
   ASSERT_TRUE(coded_input.Skip(128));
 
   CodedInputStream::Limit limit = coded_input.PushLimit(INT_MAX);
-  // BytesUntilLimit() returns -1 to mean "no limit", which actually means
-  // "the limit is INT_MAX relative to the beginning of the stream".
-  EXPECT_EQ(-1, coded_input.BytesUntilLimit());
+  EXPECT_EQ(INT_MAX, coded_input.BytesUntilLimit());
   coded_input.PopLimit(limit);
+  EXPECT_EQ(-1, coded_input.BytesUntilLimit());
 }
 
 TEST_F(CodedStreamTest, TotalBytesLimit) {
@@ -1307,6 +1305,42 @@ TEST_F(CodedStreamTest, RecursionLimit) {
   EXPECT_FALSE(coded_input.IncrementRecursionDepth());     // 7
 }
 
+// -------------------------------------------------------------------
+// Fast writes
+
+TEST_1D(CodedStreamTest, FastWrite, kBlockSizes) {
+  // Writes through BeginFastWrite() must produce the same bytes as the
+  // bounds-checked writes, whether or not they cross buffer boundaries.
+  string expected;
+  {
+    StringOutputStream output(&expected);
+    CodedOutputStream coded_output(&output);
+    for (int i = 0; i < 100; i++) {
+      coded_output.WriteTag(i * 131);
+      coded_output.WriteVarint64(static_cast<uint64>(i) << (i % 64));
+      coded_output.WriteLittleEndian32(i);
+    }
+  }
+
+  ArrayOutputStream output(buffer_, sizeof(buffer_), kBlockSizes_case);
+  {
+    CodedOutputStream coded_output(&output);
+    for (int i = 0; i < 100; i++) {
+      uint8* target = coded_output.BeginFastWrite();
+      target = CodedOutputStream::WriteTagToArray(i * 131, target);
+      target = CodedOutputStream::WriteVarint64ToArray(
+          static_cast<uint64>(i) << (i % 64), target);
+      target = CodedOutputStream::WriteLittleEndian32ToArray(i, target);
+      coded_output.EndFastWrite(target);
+    }
+    EXPECT_FALSE(coded_output.HadError());
+    EXPECT_EQ(expected.size(), coded_output.ByteCount());
+  }
+
+  ASSERT_EQ(expected.size(), output.ByteCount());
+  EXPECT_EQ(expected, string(reinterpret_cast<char*>(buffer_),
+                             expected.size()));
+}
 
 class ReallyBigInputStream : public ZeroCopyInputStream {
  public:
@@ -1370,6 +1404,174 @@ TEST_F(CodedStreamTest, InputOver2G) {
   EXPECT_EQ(0, errors.size());
 }
 
+// An input stream of unlimited length which hands out the same zeroed buffer
+// over and over, so that positions beyond 2GB can be reached cheaply.
+class EndlessInputStream : public ZeroCopyInputStream {
+ public:
+  EndlessInputStream() : position_(0) {
+    memset(buffer_, 0, sizeof(buffer_));
+  }
+  ~EndlessInputStream() {}
+
+  // implements ZeroCopyInputStream ----------------------------------
+  bool Next(const void** data, int* size) {
+    *data = buffer_;
+    *size = sizeof(buffer_);
+    position_ += sizeof(buffer_);
+    return true;
+  }
+  void BackUp(int count)  { position_ -= count; }
+  bool Skip(int count)    { position_ += count; return true; }
+  int64 ByteCount() const { return position_; }
+
+ private:
+  char buffer_[8192];
+  int64 position_;
+};
+
+// Likewise for output; everything written is discarded.
+class EndlessOutputStream : public ZeroCopyOutputStream {
+ public:
+  EndlessOutputStream() : buffer_(new char[kBufferSize]), position_(0) {}
+  ~EndlessOutputStream() {}
+
+  // implements ZeroCopyOutputStream ---------------------------------
+  bool Next(void** data, int* size) {
+    *data = buffer_.get();
+    *size = kBufferSize;
+    position_ += kBufferSize;
+    return true;
+  }
+  void BackUp(int count)  { position_ -= count; }
+  int64 ByteCount() const { return position_; }
+
+ private:
+  static const int kBufferSize = 1 << 20;
+
+  scoped_array<char> buffer_;
+  int64 position_;
+};
+
+TEST_F(CodedStreamTest, LimitsOver2G) {
+  EndlessInputStream input;
+  const int64 kTotalBytesLimit = GOOGLE_LONGLONG(4) << 30;
+  const int64 kPosition = static_cast<int64>(INT_MAX) + (1 << 30);
+
+  vector<string> errors;
+
+  {
+    CodedInputStream coded_input(&input);
+    coded_input.SetTotalBytesLimit(kTotalBytesLimit, -1);
+    EXPECT_EQ(kTotalBytesLimit, coded_input.BytesUntilTotalBytesLimit());
+
+    ASSERT_TRUE(coded_input.Skip(INT_MAX));
+    ASSERT_TRUE(coded_input.Skip(1 << 30));
+    EXPECT_EQ(kPosition, coded_input.CurrentPosition());
+
+    // Limits pushed beyond 2GB are still enforced.
+    CodedInputStream::Limit limit = coded_input.PushLimit(16);
+    EXPECT_EQ(16, coded_input.BytesUntilLimit());
+    uint64 value;
+    EXPECT_TRUE(coded_input.ReadLittleEndian64(&value));
+    EXPECT_TRUE(coded_input.ReadLittleEndian64(&value));
+    EXPECT_TRUE(coded_input.ExpectAtEnd());
+    coded_input.PopLimit(limit);
+    EXPECT_EQ(kPosition + 16, coded_input.CurrentPosition());
+    EXPECT_EQ(kTotalBytesLimit - kPosition - 16,
+              coded_input.BytesUntilTotalBytesLimit());
+
+    // So is the total bytes limit.
+    EXPECT_FALSE(coded_input.Skip(INT_MAX));
+    EXPECT_EQ(kTotalBytesLimit, coded_input.CurrentPosition());
+
+    ScopedMemoryLog error_log;
+    EXPECT_EQ(0, coded_input.ReadTag());
+    EXPECT_FALSE(coded_input.ConsumedEntireMessage());
+    errors = error_log.GetMessages(ERROR);
+  }
+
+  ASSERT_EQ(1, errors.size());
+  EXPECT_PRED_FORMAT2(testing::IsSubstring,
+    "A protocol message was rejected because it was too big", errors[0]);
+  EXPECT_EQ(kTotalBytesLimit, input.ByteCount());
+}
+
+TEST_F(CodedStreamTest, OutputOver2G) {
+  EndlessOutputStream output;
+  const int64 kExpectedSize = static_cast<int64>(INT_MAX) + (1 << 30) + 2;
+
+  {
+    CodedOutputStream coded_output(&output);
+    ASSERT_TRUE(coded_output.Skip(INT_MAX));
+    ASSERT_TRUE(coded_output.Skip(1 << 30));
+    coded_output.WriteVarint32(300);
+    EXPECT_EQ(kExpectedSize, coded_output.ByteCount());
+  }
+
+  EXPECT_EQ(kExpectedSize, output.ByteCount());
+}
+
+// ===================================================================
+// ReverseCodedBuffer
+
+TEST_1D(CodedStreamTest, ReverseWriteVarint64, kVarintCases) {
+  ReverseCodedBuffer buffer;
+  buffer.WriteVarint64(kVarintCases_case.value);
+  ASSERT_EQ(kVarintCases_case.size, buffer.ByteCount());
+  EXPECT_EQ(0, memcmp(buffer.data(), kVarintCases_case.bytes,
+                      kVarintCases_case.size));
+}
+
+TEST_F(CodedStreamTest, ReverseWritesPrepend) {
+  // Write the same values forwards and backwards.
+  string forward;
+  {
+    StringOutputStream output(&forward);
+    CodedOutputStream coded_output(&output);
+    coded_output.WriteTag(8);
+    coded_output.WriteVarint32SignExtended(-1);
+    coded_output.WriteLittleEndian32(0x12345678);
+    coded_output.WriteLittleEndian64(ULL(0x0123456789abcdef));
+    coded_output.WriteString("hello");
+    coded_output.WriteVarint32(300);
+  }
+
+  ReverseCodedBuffer buffer;
+  buffer.WriteVarint32(300);
+  buffer.WriteString("hello");
+  buffer.WriteLittleEndian64(ULL(0x0123456789abcdef));
+  buffer.WriteLittleEndian32(0x12345678);
+  buffer.WriteVarint32SignExtended(-1);
+  buffer.WriteTag(8);
+
+  EXPECT_EQ(forward, string(reinterpret_cast<const char*>(buffer.data()),
+                            buffer.ByteCount()));
+}
+
+TEST_F(CodedStreamTest, ReverseBufferGrows) {
+  ReverseCodedBuffer buffer;
+  EXPECT_EQ(0, buffer.ByteCount());
+
+  // Cross several reallocations, including one larger than doubling.
+  string expected;
+  for (int i = 0; i < 1000; i++) {
+    string piece(i % 7 + 1, 'a' + i % 26);
+    buffer.WriteString(piece);
+    expected = piece + expected;
+  }
+  string big(100000, 'z');
+  buffer.WriteString(big);
+  expected = big + expected;
+
+  uint8* reserved = buffer.Reserve(3);
+  memcpy(reserved, "abc", 3);
+  expected = "abc" + expected;
+
+  ASSERT_EQ(expected.size(), buffer.ByteCount());
+  EXPECT_TRUE(expected == string(reinterpret_cast<const char*>(buffer.data()),
+                                 buffer.ByteCount()));
+}
+
 // ===================================================================
 
 
@@ -0,0 +1,226 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/io/delimited_message_stream.h>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream.h>
+#include <google/protobuf/message_lite.h>
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+namespace io {
+
+namespace {
+
+// Same as CodedInputStream's default total bytes limit.
+static const int kDefaultMaxMessageSize = 64 << 20;
+
+// Longest possible varint32 size prefix.
+static const int kMaxVarint32Bytes = 5;
+
+}  // namespace
+
+// ===================================================================
+
+DelimitedMessageReader::DelimitedMessageReader(ZeroCopyInputStream* input)
+  : coded_input_(new CodedInputStream(input)),
+    max_message_size_(kDefaultMaxMessageSize),
+    had_error_(false) {
+}
+
+DelimitedMessageReader::~DelimitedMessageReader() {
+}
+
+void DelimitedMessageReader::SetMaxMessageSize(int max_message_size) {
+  max_message_size_ = max_message_size;
+}
+
+bool DelimitedMessageReader::ReadMessage(MessageLite* message) {
+  return ReadMessageInternal(message, true);
+}
+
+bool DelimitedMessageReader::ReadPartialMessage(MessageLite* message) {
+  return ReadMessageInternal(message, false);
+}
+
+int DelimitedMessageReader::ReadMessages(const MessageLite& prototype,
+                                         Arena* arena, int max_count,
+                                         vector<MessageLite*>* output) {
+  int count = 0;
+  while (count < max_count) {
+    MessageLite* message = prototype.New(arena);
+    if (!ReadMessage(message)) {
+      if (arena == NULL) delete message;
+      break;
+    }
+    output->push_back(message);
+    ++count;
+  }
+  return count;
+}
+
+int64 DelimitedMessageReader::ByteCount() const {
+  return coded_input_->CurrentPosition();
+}
+
+bool DelimitedMessageReader::ReadMessageInternal(MessageLite* message,
+                                                 bool check_initialized) {
+  if (had_error_) return false;
+
+  // The limit only has to cover this message.
+  coded_input_->SetTotalBytesLimit(
+      coded_input_->CurrentPosition() + kMaxVarint32Bytes + max_message_size_,
+      -1);
+
+  // A clean end of stream is only allowed between messages.
+  const void* data;
+  int available;
+  if (!coded_input_->GetDirectBufferPointer(&data, &available)) {
+    return false;
+  }
+
+  uint32 size;
+  if (!coded_input_->ReadVarint32(&size) ||
+      size > static_cast<uint32>(max_message_size_)) {
+    had_error_ = true;
+    return false;
+  }
+
+  message->Clear();
+  CodedInputStream::Limit old_limit = coded_input_->PushLimit(size);
+  if (!message->MergePartialFromCodedStream(coded_input_.get()) ||
+      !coded_input_->ConsumedEntireMessage()) {
+    had_error_ = true;
+    return false;
+  }
+  coded_input_->PopLimit(old_limit);
+
+  if (check_initialized && !message->IsInitialized()) {
+    GOOGLE_LOG(ERROR) << "Can't parse message of type \""
+               << message->GetTypeName()
+               << "\" because it is missing required fields: "
+               << message->InitializationErrorString();
+    had_error_ = true;
+    return false;
+  }
+  return true;
+}
+
+// ===================================================================
+
+DelimitedMessageWriter::DelimitedMessageWriter(ZeroCopyOutputStream* output)
+  : output_(output),
+    base_position_(0),
+    had_error_(false) {
+}
+
+DelimitedMessageWriter::~DelimitedMessageWriter() {
+}
+
+bool DelimitedMessageWriter::WriteMessage(const MessageLite& message) {
+  const MessageLite* messages[] = { &message };
+  return WriteMessages(messages, 1);
+}
+
+bool DelimitedMessageWriter::WriteMessages(const MessageLite* const* messages,
+                                           int count) {
+  if (HadError()) return false;
+  if (coded_output_.get() == NULL) {
+    coded_output_.reset(new CodedOutputStream(output_));
+  }
+
+  // ByteSize() caches each message's size for the writes below.
+  int64 total_size = 0;
+  for (int i = 0; i < count; i++) {
+    GOOGLE_DCHECK(messages[i]->IsInitialized())
+        << "Can't serialize message of type \"" << messages[i]->GetTypeName()
+        << "\" because it is missing required fields: "
+        << messages[i]->InitializationErrorString();
+    const int size = messages[i]->ByteSize();
+    GOOGLE_CHECK_GE(size, 0)
+        << "Error computing ByteSize (possible overflow?).";
+    total_size += CodedOutputStream::VarintSize32(size) + size;
+  }
+
+  // Deterministic output has to go through the stream, which orders map
+  // entries; the array writers below cannot.
+  if (total_size <= kint32max &&
+      !coded_output_->IsSerializationDeterministic()) {
+    uint8* target = coded_output_->GetDirectBufferForNBytesAndAdvance(
+        static_cast<int>(total_size));
+    if (target != NULL) {
+      // The whole batch fits in the current buffer.
+      for (int i = 0; i < count; i++) {
+        target = CodedOutputStream::WriteVarint32ToArray(
+            messages[i]->GetCachedSize(), target);
+        target = messages[i]->SerializeWithCachedSizesToArray(target);
+      }
+      return true;
+    }
+  }
+
+  for (int i = 0; i < count; i++) {
+    WriteMessageWithCachedSize(*messages[i], messages[i]->GetCachedSize());
+  }
+  return !HadError();
+}
+
+bool DelimitedMessageWriter::Flush() {
+  if (coded_output_.get() != NULL) {
+    base_position_ += coded_output_->ByteCount();
+    had_error_ |= coded_output_->HadError();
+    // Destroying the CodedOutputStream backs up over its unused buffer.  The
+    // next write creates a new one.
+    coded_output_.reset();
+  }
+  return !had_error_;
+}
+
+bool DelimitedMessageWriter::HadError() const {
+  return had_error_ ||
+         (coded_output_.get() != NULL && coded_output_->HadError());
+}
+
+int64 DelimitedMessageWriter::ByteCount() const {
+  return base_position_ +
+         (coded_output_.get() != NULL ? coded_output_->ByteCount() : 0);
+}
+
+void DelimitedMessageWriter::WriteMessageWithCachedSize(
+    const MessageLite& message, int size) {
+  coded_output_->WriteVarint32(size);
+  message.SerializeWithCachedSizes(coded_output_.get());
+}
+
+}  // namespace io
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,167 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains DelimitedMessageReader and DelimitedMessageWriter,
+// which read and write streams of messages each preceded by its size as a
+// varint -- the format produced by writing WriteVarint32(ByteSize()) before
+// each message, used by many on-disk and IPC formats.
+//
+// Both classes keep a single CodedInputStream or CodedOutputStream open
+// across messages instead of constructing one per message, so consecutive
+// small messages share the underlying stream's buffers.  The reader resets
+// CodedInputStream's total bytes limit for every message, so streams of any
+// total length can be read; only a single message is limited in size.
+
+#ifndef GOOGLE_PROTOBUF_IO_DELIMITED_MESSAGE_STREAM_H__
+#define GOOGLE_PROTOBUF_IO_DELIMITED_MESSAGE_STREAM_H__
+
+#include <vector>
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+  class Arena;
+  class MessageLite;
+namespace io {
+  class CodedInputStream;
+  class CodedOutputStream;
+  class ZeroCopyInputStream;
+  class ZeroCopyOutputStream;
+
+// ===================================================================
+
+// Reads size-delimited messages from a ZeroCopyInputStream.
+//
+// Example:
+//   FileInputStream file_input(fd);
+//   DelimitedMessageReader reader(&file_input);
+//   MyRecord record;
+//   while (reader.ReadMessage(&record)) {
+//     ... use record ...
+//   }
+//   if (reader.HadError()) { ... corrupt or truncated input ... }
+class LIBPROTOBUF_EXPORT DelimitedMessageReader {
+ public:
+  // The input must outlive the reader.  When the reader is destroyed, any
+  // data it read ahead is returned to the input with BackUp().
+  explicit DelimitedMessageReader(ZeroCopyInputStream* input);
+  ~DelimitedMessageReader();
+
+  // Sets the largest message size that will be accepted.  The default is
+  // CodedInputStream's default total bytes limit, 64MB.  A larger size
+  // prefix is treated as an error.
+  void SetMaxMessageSize(int max_message_size);
+
+  // Clears *message and parses the next message into it.  Returns false at
+  // the end of the stream or if the next message could not be read (in
+  // which case HadError() is true).  As with ParseFromCodedStream(),
+  // messages missing required fields are errors; see ReadPartialMessage().
+  bool ReadMessage(MessageLite* message);
+  // Like ReadMessage(), but allows missing required fields.
+  bool ReadPartialMessage(MessageLite* message);
+
+  // Reads up to max_count messages, each created with prototype.New(arena),
+  // and appends them to *output.  Returns the number of messages read.  If
+  // arena is NULL, the caller takes ownership of the messages.  Reading
+  // stops early at the end of the stream or on error.
+  int ReadMessages(const MessageLite& prototype, Arena* arena, int max_count,
+                   vector<MessageLite*>* output);
+
+  // True if a read failed for any reason other than a clean end of stream:
+  // a truncated or oversized message, a parse error, or missing required
+  // fields.
+  bool HadError() const { return had_error_; }
+
+  // Total number of bytes read from the input.
+  int64 ByteCount() const;
+
+ private:
+  bool ReadMessageInternal(MessageLite* message, bool check_initialized);
+
+  scoped_ptr<CodedInputStream> coded_input_;
+  int max_message_size_;
+  bool had_error_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(DelimitedMessageReader);
+};
+
+// ===================================================================
+
+// Writes size-delimited messages to a ZeroCopyOutputStream.
+//
+// Messages are written into the output's buffers as they come, so many
+// small messages turn into a few large writes to the underlying stream.
+// Call Flush() (or destroy the writer) before using the output stream
+// directly, e.g. to flush a FileOutputStream.
+class LIBPROTOBUF_EXPORT DelimitedMessageWriter {
+ public:
+  // The output must outlive the writer.
+  explicit DelimitedMessageWriter(ZeroCopyOutputStream* output);
+  // Returns any unused buffer space to the output.
+  ~DelimitedMessageWriter();
+
+  // Writes the size of the message followed by the message.  Returns false
+  // on a write error.  As with SerializeToCodedStream(), the message must be
+  // initialized (checked in debug builds).
+  bool WriteMessage(const MessageLite& message);
+
+  // Writes count messages.  The sizes of all of them are computed first, so
+  // that when the output's buffer has room for the whole batch it is
+  // written with a single buffer reservation.
+  bool WriteMessages(const MessageLite* const* messages, int count);
+
+  // Returns any unused buffer space to the output with BackUp(), so that
+  // the output's ByteCount() matches the data written.  Returns false if a
+  // write error has occurred.
+  bool Flush();
+
+  // True if a write error has occurred.
+  bool HadError() const;
+
+  // Total number of bytes written.
+  int64 ByteCount() const;
+
+ private:
+  // Writes one message whose size has already been computed.
+  void WriteMessageWithCachedSize(const MessageLite& message, int size);
+
+  ZeroCopyOutputStream* output_;
+  scoped_ptr<CodedOutputStream> coded_output_;  // NULL until first write.
+  int64 base_position_;  // Bytes written by previous CodedOutputStreams.
+  bool had_error_;       // Error seen by a previous CodedOutputStream.
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(DelimitedMessageWriter);
+};
+
+}  // namespace io
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_IO_DELIMITED_MESSAGE_STREAM_H__
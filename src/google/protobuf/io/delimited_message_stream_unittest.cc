@@ -0,0 +1,286 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/io/delimited_message_stream.h>
+
+#include <string>
+#include <vector>
+
+#include <google/protobuf/arena.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/stl_util.h>
+#include <google/protobuf/test_util.h>
+#include <google/protobuf/unittest.pb.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace io {
+namespace {
+
+using protobuf_unittest::TestAllTypes;
+using protobuf_unittest::TestRequired;
+
+class DelimitedMessageStreamTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    for (int i = 0; i < 50; i++) {
+      TestAllTypes message;
+      if (i % 3 == 0) TestUtil::SetAllFields(&message);
+      message.set_optional_int32(i);
+      message.set_optional_string(string(i * 7, 'a' + i % 26));
+      messages_.push_back(message);
+    }
+  }
+
+  // The stream a hand-rolled writer would produce.
+  string Expected() {
+    string result;
+    StringOutputStream output(&result);
+    CodedOutputStream coded(&output);
+    for (int i = 0; i < messages_.size(); i++) {
+      coded.WriteVarint32(messages_[i].ByteSize());
+      messages_[i].SerializeWithCachedSizes(&coded);
+    }
+    return result;
+  }
+
+  void ExpectMessagesRead(DelimitedMessageReader* reader) {
+    TestAllTypes message;
+    for (int i = 0; i < messages_.size(); i++) {
+      ASSERT_TRUE(reader->ReadMessage(&message)) << i;
+      EXPECT_EQ(messages_[i].SerializeAsString(), message.SerializeAsString());
+    }
+    EXPECT_FALSE(reader->ReadMessage(&message));
+    EXPECT_FALSE(reader->HadError());
+  }
+
+  vector<TestAllTypes> messages_;
+};
+
+TEST_F(DelimitedMessageStreamTest, WriteMessage) {
+  string data;
+  {
+    StringOutputStream output(&data);
+    DelimitedMessageWriter writer(&output);
+    for (int i = 0; i < messages_.size(); i++) {
+      EXPECT_TRUE(writer.WriteMessage(messages_[i]));
+    }
+    EXPECT_TRUE(writer.Flush());
+    EXPECT_EQ(output.ByteCount(), writer.ByteCount());
+  }
+  EXPECT_EQ(Expected(), data);
+}
+
+TEST_F(DelimitedMessageStreamTest, WriteMessagesInBatches) {
+  vector<const MessageLite*> pointers;
+  for (int i = 0; i < messages_.size(); i++) {
+    pointers.push_back(&messages_[i]);
+  }
+
+  // Block sizes small enough that batches don't fit in one buffer, and
+  // large enough that they do.
+  const int kBlockSizes[] = {3, 64, 1 << 20};
+  for (int i = 0; i < GOOGLE_ARRAYSIZE(kBlockSizes); i++) {
+    string data(1 << 21, '\0');
+    ArrayOutputStream output(string_as_array(&data), data.size(),
+                             kBlockSizes[i]);
+    {
+      DelimitedMessageWriter writer(&output);
+      EXPECT_TRUE(writer.WriteMessages(&pointers[0], 10));
+      EXPECT_TRUE(writer.WriteMessages(&pointers[10], pointers.size() - 10));
+      EXPECT_FALSE(writer.HadError());
+    }
+    data.resize(output.ByteCount());
+    EXPECT_EQ(Expected(), data);
+  }
+}
+
+TEST_F(DelimitedMessageStreamTest, WriteError) {
+  char buffer[100];
+  ArrayOutputStream output(buffer, sizeof(buffer));
+  DelimitedMessageWriter writer(&output);
+  TestAllTypes message;
+  TestUtil::SetAllFields(&message);
+  EXPECT_FALSE(writer.WriteMessage(message));
+  EXPECT_TRUE(writer.HadError());
+  EXPECT_FALSE(writer.WriteMessage(message));
+}
+
+TEST_F(DelimitedMessageStreamTest, ReadMessage) {
+  const string data = Expected();
+  const int kBlockSizes[] = {-1, 1, 7, 64};
+  for (int i = 0; i < GOOGLE_ARRAYSIZE(kBlockSizes); i++) {
+    ArrayInputStream input(data.data(), data.size(), kBlockSizes[i]);
+    DelimitedMessageReader reader(&input);
+    ExpectMessagesRead(&reader);
+    EXPECT_EQ(data.size(), reader.ByteCount());
+  }
+}
+
+TEST_F(DelimitedMessageStreamTest, ReaderReturnsUnreadData) {
+  string data = Expected() + "trailer";
+  ArrayInputStream input(data.data(), data.size());
+  {
+    DelimitedMessageReader reader(&input);
+    TestAllTypes message;
+    for (int i = 0; i < messages_.size(); i++) {
+      ASSERT_TRUE(reader.ReadMessage(&message));
+    }
+  }
+  // Destroying the reader backed up over the data it read ahead.
+  EXPECT_EQ(data.size() - 7, input.ByteCount());
+}
+
+TEST_F(DelimitedMessageStreamTest, ReadMessagesOnArena) {
+  const string data = Expected();
+  ArrayInputStream input(data.data(), data.size(), 64);
+  DelimitedMessageReader reader(&input);
+
+  Arena arena;
+  vector<MessageLite*> batch;
+  EXPECT_EQ(20, reader.ReadMessages(TestAllTypes::default_instance(), &arena,
+                                    20, &batch));
+  EXPECT_EQ(30, reader.ReadMessages(TestAllTypes::default_instance(), &arena,
+                                    100, &batch));
+  EXPECT_EQ(0, reader.ReadMessages(TestAllTypes::default_instance(), &arena,
+                                   100, &batch));
+  EXPECT_FALSE(reader.HadError());
+  ASSERT_EQ(messages_.size(), batch.size());
+  for (int i = 0; i < batch.size(); i++) {
+    EXPECT_EQ(&arena, batch[i]->GetArena());
+    EXPECT_EQ(messages_[i].SerializeAsString(), batch[i]->SerializeAsString());
+  }
+}
+
+TEST_F(DelimitedMessageStreamTest, ReadMessagesWithoutArena) {
+  const string data = Expected();
+  ArrayInputStream input(data.data(), data.size());
+  DelimitedMessageReader reader(&input);
+
+  vector<MessageLite*> batch;
+  EXPECT_EQ(messages_.size(),
+            reader.ReadMessages(TestAllTypes::default_instance(), NULL, 1000,
+                                &batch));
+  ASSERT_EQ(messages_.size(), batch.size());
+  EXPECT_EQ(messages_.back().SerializeAsString(),
+            batch.back()->SerializeAsString());
+  STLDeleteElements(&batch);
+}
+
+TEST_F(DelimitedMessageStreamTest, Truncated) {
+  string data = Expected();
+  data.resize(data.size() - 1);
+  ArrayInputStream input(data.data(), data.size(), 5);
+  DelimitedMessageReader reader(&input);
+  TestAllTypes message;
+  for (int i = 0; i < messages_.size() - 1; i++) {
+    ASSERT_TRUE(reader.ReadMessage(&message));
+  }
+  EXPECT_FALSE(reader.ReadMessage(&message));
+  EXPECT_TRUE(reader.HadError());
+}
+
+TEST_F(DelimitedMessageStreamTest, MaxMessageSize) {
+  const string data = Expected();
+  ArrayInputStream input(data.data(), data.size());
+  DelimitedMessageReader reader(&input);
+  reader.SetMaxMessageSize(messages_[0].ByteSize() - 1);
+  TestAllTypes message;
+  EXPECT_FALSE(reader.ReadMessage(&message));
+  EXPECT_TRUE(reader.HadError());
+}
+
+TEST_F(DelimitedMessageStreamTest, StreamLargerThanTotalBytesLimit) {
+  // Each message is well under CodedInputStream's 64MB default limit, but
+  // all together they are not.
+  const int kTotalBytesLimit = 64 << 20;
+  TestAllTypes message;
+  message.set_optional_bytes(string(1 << 20, 'x'));
+  const int kCount = kTotalBytesLimit / (1 << 20) + 4;
+
+  string data;
+  {
+    StringOutputStream output(&data);
+    DelimitedMessageWriter writer(&output);
+    for (int i = 0; i < kCount; i++) {
+      ASSERT_TRUE(writer.WriteMessage(message));
+    }
+  }
+  ASSERT_GT(data.size(), kTotalBytesLimit);
+
+  ArrayInputStream input(data.data(), data.size());
+  DelimitedMessageReader reader(&input);
+  TestAllTypes parsed;
+  for (int i = 0; i < kCount; i++) {
+    ASSERT_TRUE(reader.ReadMessage(&parsed)) << i;
+  }
+  EXPECT_FALSE(reader.ReadMessage(&parsed));
+  EXPECT_FALSE(reader.HadError());
+}
+
+TEST_F(DelimitedMessageStreamTest, MissingRequiredFields) {
+  TestRequired message;
+  message.set_a(1);
+  string data;
+  {
+    StringOutputStream output(&data);
+    CodedOutputStream coded(&output);
+    for (int i = 0; i < 2; i++) {
+      coded.WriteVarint32(message.ByteSize());
+      message.SerializeWithCachedSizes(&coded);
+    }
+  }
+
+  {
+    ArrayInputStream input(data.data(), data.size());
+    DelimitedMessageReader reader(&input);
+    TestRequired parsed;
+    EXPECT_TRUE(reader.ReadPartialMessage(&parsed));
+    EXPECT_EQ(1, parsed.a());
+    EXPECT_TRUE(reader.ReadPartialMessage(&parsed));
+    EXPECT_FALSE(reader.ReadPartialMessage(&parsed));
+    EXPECT_FALSE(reader.HadError());
+  }
+  {
+    ArrayInputStream input(data.data(), data.size());
+    DelimitedMessageReader reader(&input);
+    TestRequired parsed;
+    EXPECT_FALSE(reader.ReadMessage(&parsed));
+    EXPECT_TRUE(reader.HadError());
+  }
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,154 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/io/dictionary_trainer.h>
+
+#include <string.h>
+#include <algorithm>
+#include <utility>
+
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/hash.h>
+
+namespace google {
+namespace protobuf {
+namespace io {
+
+namespace {
+
+// Length of the substrings whose frequencies are counted.
+const int kKmerSize = 8;
+// Length of the pieces the dictionary is assembled from.
+const int kSegmentSize = 64;
+
+bool ScoreLess(const pair<int64, int>& a, const pair<int64, int>& b) {
+  return a.first < b.first;
+}
+
+}  // namespace
+
+const int DictionaryTrainer::kMaxDictionarySize;
+
+DictionaryTrainer::DictionaryTrainer() {}
+DictionaryTrainer::~DictionaryTrainer() {}
+
+void DictionaryTrainer::AddSample(const string& sample) {
+  corpus_.append(sample);
+  sample_ends_.push_back(corpus_.size());
+}
+
+string DictionaryTrainer::Train(int max_size) const {
+  max_size = min(max_size, kMaxDictionarySize);
+  const int size = corpus_.size();
+  if (max_size <= 0 || size < kKmerSize) return "";
+
+  // Number each distinct k-mer, counting the samples it occurs in.
+  // kmer_ids[i] is the number of the k-mer starting at corpus_[i], or -1 if
+  // it would run past the end of its sample.
+  vector<int> kmer_ids(size, -1);
+  vector<int> frequency;
+  vector<int> last_sample;
+  hash_map<uint64, int> ids;
+  for (int sample = 0; sample < sample_ends_.size(); sample++) {
+    const int begin = sample == 0 ? 0 : sample_ends_[sample - 1];
+    const int end = sample_ends_[sample];
+    for (int i = begin; i + kKmerSize <= end; i++) {
+      uint64 kmer;
+      memcpy(&kmer, corpus_.data() + i, kKmerSize);
+      pair<hash_map<uint64, int>::iterator, bool> inserted =
+          ids.insert(make_pair(kmer, static_cast<int>(frequency.size())));
+      const int id = inserted.first->second;
+      if (inserted.second) {
+        frequency.push_back(0);
+        last_sample.push_back(-1);
+      }
+      if (last_sample[id] != sample) {
+        last_sample[id] = sample;
+        ++frequency[id];
+      }
+      kmer_ids[i] = id;
+    }
+  }
+  for (int i = 0; i < frequency.size(); i++) {
+    if (frequency[i] < 2) frequency[i] = 0;
+  }
+
+  // Choose the best segment of each epoch.  A segment's score is the sum of
+  // the frequencies of the distinct k-mers starting in it, maintained
+  // incrementally as a window slides across the epoch.
+  const int window = kSegmentSize - kKmerSize + 1;
+  const int segment_count = (max_size + kSegmentSize - 1) / kSegmentSize;
+  const int epoch_size = max(size / segment_count, kSegmentSize);
+  vector<int> active(frequency.size(), 0);  // Occurrences in the window.
+  vector<pair<int64, int> > segments;       // (score, offset)
+  for (int epoch = 0; epoch < size; epoch += epoch_size) {
+    const int epoch_end = min(size, epoch + epoch_size);
+    int64 score = 0;
+    int64 best_score = 0;
+    int best_begin = -1;
+    for (int i = epoch; i < epoch_end; i++) {
+      int id = kmer_ids[i];
+      if (id >= 0 && active[id]++ == 0) score += frequency[id];
+      if (i - window >= epoch) {
+        id = kmer_ids[i - window];
+        if (id >= 0 && --active[id] == 0) score -= frequency[id];
+      }
+      if (i - window + 1 >= epoch && score > best_score) {
+        best_score = score;
+        best_begin = i - window + 1;
+      }
+    }
+    for (int i = max(epoch, epoch_end - window); i < epoch_end; i++) {
+      if (kmer_ids[i] >= 0) active[kmer_ids[i]] = 0;
+    }
+
+    if (best_begin < 0) continue;
+    for (int i = best_begin; i < best_begin + window; i++) {
+      if (kmer_ids[i] >= 0) frequency[kmer_ids[i]] = 0;
+    }
+    segments.push_back(make_pair(best_score, best_begin));
+  }
+
+  // Best segments last.
+  stable_sort(segments.begin(), segments.end(), &ScoreLess);
+  string dictionary;
+  for (int i = 0; i < segments.size(); i++) {
+    const int begin = segments[i].second;
+    dictionary.append(corpus_, begin, min(kSegmentSize, size - begin));
+  }
+  if (dictionary.size() > max_size) {
+    dictionary.erase(0, dictionary.size() - max_size);
+  }
+  return dictionary;
+}
+
+}  // namespace io
+}  // namespace protobuf
+}  // namespace google
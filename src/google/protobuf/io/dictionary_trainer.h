@@ -0,0 +1,93 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains DictionaryTrainer, which builds a preset dictionary
+// for compressing many small, similar inputs -- typically individual
+// serialized messages -- from a corpus of samples.
+//
+// A dictionary gives each small input shared history to refer back to.
+// Use it with GzipOutputStream::Options::dictionary and
+// GzipInputStream::SetDictionary().  protoc's --train_dictionary flag
+// trains one from a stream of messages of a given type.
+
+#ifndef GOOGLE_PROTOBUF_IO_DICTIONARY_TRAINER_H__
+#define GOOGLE_PROTOBUF_IO_DICTIONARY_TRAINER_H__
+
+#include <string>
+#include <vector>
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+namespace io {
+
+// Picks the substrings which occur in the most samples.
+//
+// The corpus is divided into as many epochs as the dictionary has segments.
+// In each epoch, the segment whose 8-byte substrings occur in the most
+// other samples is selected, and those substrings then stop counting, so
+// that later segments cover different content.  Substrings found in only
+// one sample never count.  This is the COVER algorithm used by zstd's
+// dictionary builder, simplified to fixed parameters.
+//
+// Example:
+//   DictionaryTrainer trainer;
+//   for (...) trainer.AddSample(message.SerializeAsString());
+//   string dictionary = trainer.Train(16 * 1024);
+class LIBPROTOBUF_EXPORT DictionaryTrainer {
+ public:
+  // deflate only uses the last 32k of a dictionary.
+  static const int kMaxDictionarySize = 32 * 1024;
+
+  DictionaryTrainer();
+  ~DictionaryTrainer();
+
+  // Adds a sample to the corpus.  The sample is copied.
+  void AddSample(const string& sample);
+  int sample_count() const { return sample_ends_.size(); }
+
+  // Returns a dictionary of at most min(max_size, kMaxDictionarySize)
+  // bytes.  The most valuable content is placed at the end, where deflate
+  // can reach it with the shortest distances.  Returns an empty string if
+  // the corpus has nothing in common between samples.
+  string Train(int max_size) const;
+
+ private:
+  string corpus_;            // All samples, concatenated.
+  vector<int> sample_ends_;  // End offset of each sample in corpus_.
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(DictionaryTrainer);
+};
+
+}  // namespace io
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_IO_DICTIONARY_TRAINER_H__
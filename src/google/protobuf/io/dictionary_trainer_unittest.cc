@@ -0,0 +1,179 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "config.h"
+
+#include <google/protobuf/io/dictionary_trainer.h>
+
+#include <string>
+#include <vector>
+
+#if HAVE_ZLIB
+#include <google/protobuf/io/gzip_stream.h>
+#endif
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/strutil.h>
+#include <google/protobuf/unittest.pb.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace io {
+namespace {
+
+using protobuf_unittest::TestAllTypes;
+
+// Small messages sharing most of their content, like typical RPC payloads.
+vector<string> MakeSamples(int count) {
+  vector<string> samples;
+  for (int i = 0; i < count; i++) {
+    TestAllTypes message;
+    message.set_optional_int32(i * 37);
+    message.set_optional_int64(1400000000000LL + i * 1000);
+    message.set_optional_string("https://example.com/api/v2/items/" +
+                                SimpleItoa(i % 50) + "?fields=name,owner");
+    message.set_optional_bytes("user-agent: example-client/1.0");
+    message.add_repeated_string("status=active");
+    message.add_repeated_string("region=" + SimpleItoa(i % 5));
+    message.mutable_optional_nested_message()->set_bb(i % 3);
+    samples.push_back(message.SerializeAsString());
+  }
+  return samples;
+}
+
+TEST(DictionaryTrainerTest, Empty) {
+  DictionaryTrainer trainer;
+  EXPECT_EQ(0, trainer.sample_count());
+  EXPECT_EQ("", trainer.Train(1024));
+}
+
+TEST(DictionaryTrainerTest, NothingInCommon) {
+  DictionaryTrainer trainer;
+  trainer.AddSample("abcdefghijklmnop");
+  trainer.AddSample("0123456789ABCDEF");
+  EXPECT_EQ(2, trainer.sample_count());
+  EXPECT_EQ("", trainer.Train(1024));
+}
+
+TEST(DictionaryTrainerTest, CommonContent) {
+  DictionaryTrainer trainer;
+  for (int i = 0; i < 20; i++) {
+    trainer.AddSample(SimpleItoa(i) + " shared text in every sample " +
+                      SimpleItoa(i * 7919));
+  }
+  string dictionary = trainer.Train(1024);
+  EXPECT_NE(string::npos, dictionary.find("shared text in every sample"))
+      << dictionary;
+}
+
+TEST(DictionaryTrainerTest, MaxSize) {
+  DictionaryTrainer trainer;
+  vector<string> samples = MakeSamples(1000);
+  for (int i = 0; i < samples.size(); i++) {
+    trainer.AddSample(samples[i]);
+  }
+  EXPECT_LE(trainer.Train(100).size(), 100);
+  EXPECT_LE(trainer.Train(1 << 20).size(),
+            DictionaryTrainer::kMaxDictionarySize);
+  EXPECT_GT(trainer.Train(4096).size(), 1024);
+}
+
+#if HAVE_ZLIB
+string Compress(const string& data, const string& dictionary) {
+  string result;
+  {
+    StringOutputStream output(&result);
+    GzipOutputStream::Options options;
+    options.format = GzipOutputStream::ZLIB;
+    options.dictionary = dictionary;
+    GzipOutputStream gzout(&output, options);
+    void* buffer;
+    int size;
+    GOOGLE_CHECK(gzout.Next(&buffer, &size));
+    GOOGLE_CHECK_GE(size, data.size());
+    memcpy(buffer, data.data(), data.size());
+    gzout.BackUp(size - data.size());
+    GOOGLE_CHECK(gzout.Close());
+  }
+  return result;
+}
+
+bool Uncompress(const string& data, const string& dictionary,
+                string* result) {
+  result->clear();
+  ArrayInputStream input(data.data(), data.size());
+  GzipInputStream gzin(&input, GzipInputStream::ZLIB);
+  if (!dictionary.empty()) gzin.SetDictionary(dictionary);
+  const void* buffer;
+  int size;
+  while (gzin.Next(&buffer, &size)) {
+    result->append(static_cast<const char*>(buffer), size);
+  }
+  return gzin.ZlibErrorCode() == Z_STREAM_END;
+}
+
+TEST(DictionaryTrainerTest, CompressesSmallMessages) {
+  // Train on one set of messages and compress another.
+  vector<string> samples = MakeSamples(2000);
+  DictionaryTrainer trainer;
+  for (int i = 0; i < 1000; i++) {
+    trainer.AddSample(samples[i]);
+  }
+  const string dictionary = trainer.Train(8 * 1024);
+
+  int original_size = 0;
+  int plain_size = 0;
+  int dictionary_size = 0;
+  for (int i = 1000; i < samples.size(); i++) {
+    string plain = Compress(samples[i], "");
+    string with_dictionary = Compress(samples[i], dictionary);
+    original_size += samples[i].size();
+    plain_size += plain.size();
+    dictionary_size += with_dictionary.size();
+
+    string uncompressed;
+    ASSERT_TRUE(Uncompress(with_dictionary, dictionary, &uncompressed));
+    ASSERT_TRUE(uncompressed == samples[i]);
+    // Without the dictionary the data cannot be decompressed.
+    EXPECT_FALSE(Uncompress(with_dictionary, "", &uncompressed));
+  }
+
+  // Each message alone barely compresses; with the dictionary it does so
+  // several-fold.
+  EXPECT_GT(plain_size * 10, original_size * 7);
+  EXPECT_LT(dictionary_size * 3, original_size);
+}
+#endif  // HAVE_ZLIB
+
+}  // namespace
+}  // namespace io
+}  // namespace protobuf
+}  // namespace google
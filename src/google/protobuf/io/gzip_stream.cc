@@ -38,17 +38,54 @@
 #if HAVE_ZLIB
 #include <google/protobuf/io/gzip_stream.h>
 
+#ifdef _MSC_VER
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+#include <errno.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
 #include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/stl_util.h>
 
 namespace google {
 namespace protobuf {
 namespace io {
 
 static const int kDefaultBufferSize = 65536;
+static const int kDefaultChunkSize = 128 * 1024;
+static const int kDefaultNumThreads = 4;
+// Size of the deflate window, and so of the preset dictionary given to each
+// chunk of a ParallelGzipOutputStream.
+static const int kWindowSize = 32 * 1024;
 
 GzipInputStream::GzipInputStream(
     ZeroCopyInputStream* sub_stream, Format format, int buffer_size)
-    : format_(format), sub_stream_(sub_stream), zerror_(Z_OK), byte_count_(0) {
+    : format_(format), sub_stream_(sub_stream), zerror_(Z_OK), byte_count_(0),
+      resumed_(false), resume_bits_(0) {
+  Init(buffer_size);
+}
+
+GzipInputStream::GzipInputStream(
+    ZeroCopyInputStream* sub_stream, const GzipIndex& index, int checkpoint,
+    int buffer_size)
+    : format_(AUTO), sub_stream_(sub_stream), zerror_(Z_OK),
+      byte_count_(index.checkpoint(checkpoint).uncompressed_offset),
+      resumed_(true),
+      resume_bits_(index.checkpoint(checkpoint).bits),
+      resume_window_(index.checkpoint(checkpoint).window) {
+  Init(buffer_size);
+}
+
+void GzipInputStream::Init(int buffer_size) {
   zcontext_.zalloc = Z_NULL;
   zcontext_.zfree = Z_NULL;
   zcontext_.opaque = Z_NULL;
@@ -100,7 +137,8 @@ int GzipInputStream::Inflate(int flush) {
     zcontext_.next_in = static_cast<Bytef*>(const_cast<void*>(in));
     zcontext_.avail_in = in_size;
     if (first) {
-      int error = internalInflateInit2(&zcontext_, format_);
+      int error = resumed_ ? InflateInitResumed()
+                           : internalInflateInit2(&zcontext_, format_);
       if (error != Z_OK) {
         return error;
       }
@@ -110,6 +148,40 @@ int GzipInputStream::Inflate(int flush) {
   zcontext_.avail_out = output_buffer_length_;
   output_position_ = output_buffer_;
   int error = inflate(&zcontext_, flush);
+  if (error == Z_NEED_DICT && !dictionary_.empty()) {
+    error = inflateSetDictionary(
+        &zcontext_, reinterpret_cast<const Bytef*>(dictionary_.data()),
+        dictionary_.size());
+    if (error == Z_OK) {
+      error = inflate(&zcontext_, flush);
+    }
+  }
+  return error;
+}
+
+int GzipInputStream::InflateInitResumed() {
+  // Checkpoints are inside the deflate data, past any gzip or zlib header.
+  int error = inflateInit2(&zcontext_, -15);
+  if (error != Z_OK) {
+    return error;
+  }
+  if (resume_bits_ != 0) {
+    if (zcontext_.avail_in == 0) {
+      return Z_DATA_ERROR;
+    }
+    int value = zcontext_.next_in[0] >> (8 - resume_bits_);
+    ++zcontext_.next_in;
+    --zcontext_.avail_in;
+    error = inflatePrime(&zcontext_, resume_bits_, value);
+    if (error != Z_OK) {
+      return error;
+    }
+  }
+  if (!resume_window_.empty()) {
+    error = inflateSetDictionary(
+        &zcontext_, reinterpret_cast<const Bytef*>(resume_window_.data()),
+        resume_window_.size());
+  }
   return error;
 }
 
@@ -131,6 +203,11 @@ bool GzipInputStream::Next(const void** data, int* size) {
     return true;
   }
   if (zerror_ == Z_STREAM_END) {
+    if (resumed_) {
+      // What follows is the trailer of the stream that was resumed, not
+      // another stream.
+      return false;
+    }
     if (zcontext_.next_out != NULL) {
       // sub_stream_ may have concatenated streams to follow
       zerror_ = inflateEnd(&zcontext_);
@@ -236,6 +313,13 @@ void GzipOutputStream::Init(ZeroCopyOutputStream* sub_stream,
       /* windowBits */15 | windowBitsFormat,
       /* memLevel (default) */8,
       options.compression_strategy);
+  if (zerror_ == Z_OK && !options.dictionary.empty()) {
+    GOOGLE_CHECK_EQ(options.format, ZLIB)
+        << "A preset dictionary requires the ZLIB format.";
+    zerror_ = deflateSetDictionary(
+        &zcontext_, reinterpret_cast<const Bytef*>(options.dictionary.data()),
+        options.dictionary.size());
+  }
 }
 
 GzipOutputStream::~GzipOutputStream() {
@@ -324,6 +408,657 @@ bool GzipOutputStream::Close() {
   return ok;
 }
 
+// ===================================================================
+
+struct ParallelGzipOutputStream::Chunk {
+  string input;
+  string dictionary;  // Preceding input, for deflateSetDictionary().
+  bool last;          // Ends the deflate stream.
+
+  // Filled in by the worker.
+  string output;
+  int input_size;
+  uLong check;        // CRC-32 or Adler-32 of the input.
+  bool ok;
+  bool done;
+};
+
+// Compresses chunks on a fixed set of threads.  Each thread keeps its own
+// raw-deflate z_stream, reset between chunks.  Without pthreads, or if no
+// thread could be started, chunks are compressed by Submit() itself.
+class ParallelGzipOutputStream::WorkerPool {
+ public:
+  explicit WorkerPool(const Options& options);
+  ~WorkerPool();
+
+  void Submit(Chunk* chunk);
+  // Returns chunk->done.  If wait is true, first waits until it is done.
+  bool IsDone(Chunk* chunk, bool wait);
+
+ private:
+  // Initializes a z_stream for raw deflate with the pool's options.
+  bool InitStream(z_stream* stream);
+  void Compress(z_stream* stream, bool stream_ok, Chunk* chunk);
+
+  const Options options_;
+
+  // Used when there are no threads.
+  z_stream inline_stream_;
+  bool inline_stream_initialized_;
+  bool inline_stream_ok_;
+
+#ifdef HAVE_PTHREAD
+  static void* ThreadMain(void* pool);
+  void Run();
+
+  pthread_mutex_t mutex_;
+  pthread_cond_t work_available_;
+  pthread_cond_t work_done_;
+  vector<pthread_t> threads_;
+  deque<Chunk*> queue_;
+  bool shutting_down_;
+#endif
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(WorkerPool);
+};
+
+ParallelGzipOutputStream::WorkerPool::WorkerPool(const Options& options)
+    : options_(options),
+      inline_stream_initialized_(false),
+      inline_stream_ok_(false) {
+#ifdef HAVE_PTHREAD
+  shutting_down_ = false;
+  pthread_mutex_init(&mutex_, NULL);
+  pthread_cond_init(&work_available_, NULL);
+  pthread_cond_init(&work_done_, NULL);
+  for (int i = 0; i < options_.num_threads; i++) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, &ThreadMain, this) != 0) break;
+    threads_.push_back(thread);
+  }
+#endif
+}
+
+ParallelGzipOutputStream::WorkerPool::~WorkerPool() {
+#ifdef HAVE_PTHREAD
+  pthread_mutex_lock(&mutex_);
+  shutting_down_ = true;
+  pthread_cond_broadcast(&work_available_);
+  pthread_mutex_unlock(&mutex_);
+  for (int i = 0; i < threads_.size(); i++) {
+    pthread_join(threads_[i], NULL);
+  }
+  pthread_cond_destroy(&work_done_);
+  pthread_cond_destroy(&work_available_);
+  pthread_mutex_destroy(&mutex_);
+#endif
+  if (inline_stream_initialized_ && inline_stream_ok_) {
+    deflateEnd(&inline_stream_);
+  }
+}
+
+bool ParallelGzipOutputStream::WorkerPool::InitStream(z_stream* stream) {
+  stream->zalloc = Z_NULL;
+  stream->zfree = Z_NULL;
+  stream->opaque = Z_NULL;
+  // Negative windowBits selects raw deflate; the caller writes the gzip or
+  // zlib header and trailer.
+  return deflateInit2(stream, options_.compression_level, Z_DEFLATED, -15,
+                      8, options_.compression_strategy) == Z_OK;
+}
+
+void ParallelGzipOutputStream::WorkerPool::Compress(
+    z_stream* stream, bool stream_ok, Chunk* chunk) {
+  const Bytef* input = reinterpret_cast<const Bytef*>(chunk->input.data());
+  chunk->input_size = chunk->input.size();
+  if (options_.format == GzipOutputStream::ZLIB) {
+    chunk->check = adler32(adler32(0, Z_NULL, 0), input, chunk->input_size);
+  } else {
+    chunk->check = crc32(crc32(0, Z_NULL, 0), input, chunk->input_size);
+  }
+
+  chunk->ok = stream_ok && deflateReset(stream) == Z_OK;
+  if (chunk->ok && !chunk->dictionary.empty()) {
+    chunk->ok = deflateSetDictionary(
+        stream, reinterpret_cast<const Bytef*>(chunk->dictionary.data()),
+        chunk->dictionary.size()) == Z_OK;
+  }
+  if (chunk->ok) {
+    // deflateBound() does not count the sync flush marker.
+    STLStringResizeUninitialized(
+        &chunk->output, deflateBound(stream, chunk->input_size) + 16);
+    stream->next_in = const_cast<Bytef*>(input);
+    stream->avail_in = chunk->input_size;
+    int produced = 0;
+    const int flush = chunk->last ? Z_FINISH : Z_SYNC_FLUSH;
+    while (true) {
+      stream->next_out =
+          reinterpret_cast<Bytef*>(string_as_array(&chunk->output)) +
+          produced;
+      stream->avail_out = chunk->output.size() - produced;
+      int error = deflate(stream, flush);
+      produced = chunk->output.size() - stream->avail_out;
+      if (error == Z_STREAM_END ||
+          (error == Z_OK && flush == Z_SYNC_FLUSH && stream->avail_out > 0)) {
+        break;
+      }
+      if (error != Z_OK && error != Z_BUF_ERROR) {
+        chunk->ok = false;
+        break;
+      }
+      STLStringResizeUninitialized(&chunk->output,
+                                   chunk->output.size() * 2);
+    }
+    chunk->output.resize(produced);
+  }
+
+  // The input is no longer needed; free it before the chunk is written.
+  string().swap(chunk->input);
+  string().swap(chunk->dictionary);
+}
+
+void ParallelGzipOutputStream::WorkerPool::Submit(Chunk* chunk) {
+  chunk->done = false;
+#ifdef HAVE_PTHREAD
+  if (!threads_.empty()) {
+    pthread_mutex_lock(&mutex_);
+    queue_.push_back(chunk);
+    pthread_cond_signal(&work_available_);
+    pthread_mutex_unlock(&mutex_);
+    return;
+  }
+#endif
+  if (!inline_stream_initialized_) {
+    inline_stream_initialized_ = true;
+    inline_stream_ok_ = InitStream(&inline_stream_);
+  }
+  Compress(&inline_stream_, inline_stream_ok_, chunk);
+  chunk->done = true;
+}
+
+bool ParallelGzipOutputStream::WorkerPool::IsDone(Chunk* chunk, bool wait) {
+#ifdef HAVE_PTHREAD
+  if (!threads_.empty()) {
+    pthread_mutex_lock(&mutex_);
+    while (wait && !chunk->done) {
+      pthread_cond_wait(&work_done_, &mutex_);
+    }
+    bool done = chunk->done;
+    pthread_mutex_unlock(&mutex_);
+    return done;
+  }
+#endif
+  return chunk->done;
+}
+
+#ifdef HAVE_PTHREAD
+void* ParallelGzipOutputStream::WorkerPool::ThreadMain(void* pool) {
+  static_cast<WorkerPool*>(pool)->Run();
+  return NULL;
+}
+
+void ParallelGzipOutputStream::WorkerPool::Run() {
+  z_stream stream;
+  bool stream_ok = InitStream(&stream);
+
+  pthread_mutex_lock(&mutex_);
+  while (true) {
+    while (queue_.empty() && !shutting_down_) {
+      pthread_cond_wait(&work_available_, &mutex_);
+    }
+    if (queue_.empty()) break;
+    Chunk* chunk = queue_.front();
+    queue_.pop_front();
+    pthread_mutex_unlock(&mutex_);
+
+    Compress(&stream, stream_ok, chunk);
+
+    pthread_mutex_lock(&mutex_);
+    chunk->done = true;
+    pthread_cond_broadcast(&work_done_);
+  }
+  pthread_mutex_unlock(&mutex_);
+
+  if (stream_ok) deflateEnd(&stream);
+}
+#endif  // HAVE_PTHREAD
+
+// -------------------------------------------------------------------
+
+ParallelGzipOutputStream::Options::Options()
+    : format(GzipOutputStream::GZIP),
+      chunk_size(kDefaultChunkSize),
+      num_threads(kDefaultNumThreads),
+      compression_level(Z_DEFAULT_COMPRESSION),
+      compression_strategy(Z_DEFAULT_STRATEGY) {}
+
+ParallelGzipOutputStream::ParallelGzipOutputStream(
+    ZeroCopyOutputStream* sub_stream)
+    : sub_stream_(sub_stream),
+      options_(),
+      pool_(new WorkerPool(options_)),
+      position_(0),
+      bytes_submitted_(0),
+      had_error_(false),
+      closed_(false) {
+  Init();
+}
+
+ParallelGzipOutputStream::ParallelGzipOutputStream(
+    ZeroCopyOutputStream* sub_stream, const Options& options)
+    : sub_stream_(sub_stream),
+      options_(options),
+      pool_(new WorkerPool(options_)),
+      position_(0),
+      bytes_submitted_(0),
+      had_error_(false),
+      closed_(false) {
+  Init();
+}
+
+void ParallelGzipOutputStream::Init() {
+  GOOGLE_CHECK_GT(options_.chunk_size, 0);
+  if (options_.format == GzipOutputStream::ZLIB) {
+    check_ = adler32(0, Z_NULL, 0);
+    // CMF: deflate with a 32k window.  FLG: the compression level hint,
+    // chosen as zlib does, and check bits making the header a multiple
+    // of 31.
+    int level = options_.compression_level;
+    if (level == Z_DEFAULT_COMPRESSION) level = 6;
+    int level_flags;
+    if (options_.compression_strategy >= Z_HUFFMAN_ONLY || level < 2) {
+      level_flags = 0;
+    } else if (level < 6) {
+      level_flags = 1;
+    } else if (level == 6) {
+      level_flags = 2;
+    } else {
+      level_flags = 3;
+    }
+    int header = (0x78 << 8) | (level_flags << 6);
+    header += 31 - header % 31;
+    uint8 bytes[2] = { static_cast<uint8>(header >> 8),
+                       static_cast<uint8>(header) };
+    WriteRaw(bytes, sizeof(bytes));
+  } else {
+    check_ = crc32(0, Z_NULL, 0);
+    // Magic, deflate, no flags, no mtime, no extra flags, unknown OS.
+    static const uint8 kGzipHeader[10] = {
+      0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff
+    };
+    WriteRaw(kGzipHeader, sizeof(kGzipHeader));
+  }
+}
+
+ParallelGzipOutputStream::~ParallelGzipOutputStream() {
+  Close();
+  // Stop the workers before freeing any chunk they might still hold.
+  pool_.reset();
+  for (int i = 0; i < in_flight_.size(); i++) {
+    delete in_flight_[i];
+  }
+}
+
+bool ParallelGzipOutputStream::Next(void** data, int* size) {
+  GOOGLE_CHECK(!closed_) << "Next() called after Close().";
+  if (current_ != NULL && position_ == current_->input.size()) {
+    SubmitChunk(false);
+    WriteFinishedChunks(false);
+  }
+  if (had_error_) return false;
+  if (current_ == NULL) {
+    current_.reset(new Chunk);
+    STLStringResizeUninitialized(&current_->input, options_.chunk_size);
+    position_ = 0;
+  }
+  *data = string_as_array(&current_->input) + position_;
+  *size = current_->input.size() - position_;
+  position_ = current_->input.size();
+  return true;
+}
+
+void ParallelGzipOutputStream::BackUp(int count) {
+  GOOGLE_CHECK(current_ != NULL);
+  GOOGLE_CHECK_GE(position_, count);
+  position_ -= count;
+}
+
+int64 ParallelGzipOutputStream::ByteCount() const {
+  return bytes_submitted_ + (current_ == NULL ? 0 : position_);
+}
+
+void ParallelGzipOutputStream::SubmitChunk(bool last) {
+  if (current_ == NULL) current_.reset(new Chunk);
+  Chunk* chunk = current_.release();
+  chunk->input.resize(position_);
+  chunk->last = last;
+  chunk->dictionary = dictionary_;
+  position_ = 0;
+  bytes_submitted_ += chunk->input.size();
+
+  // Keep the last kWindowSize bytes of input for the next chunk.
+  if (chunk->input.size() >= kWindowSize) {
+    dictionary_.assign(chunk->input, chunk->input.size() - kWindowSize,
+                       kWindowSize);
+  } else {
+    dictionary_.append(chunk->input);
+    if (dictionary_.size() > kWindowSize) {
+      dictionary_.erase(0, dictionary_.size() - kWindowSize);
+    }
+  }
+
+  in_flight_.push_back(chunk);
+  pool_->Submit(chunk);
+}
+
+void ParallelGzipOutputStream::WriteFinishedChunks(bool wait_for_all) {
+  // Bound the memory held by outstanding chunks.
+  const int max_in_flight = 2 * max(options_.num_threads, 1);
+  while (!in_flight_.empty()) {
+    Chunk* chunk = in_flight_.front();
+    bool wait = wait_for_all || in_flight_.size() > max_in_flight;
+    if (!pool_->IsDone(chunk, wait)) break;
+    in_flight_.pop_front();
+
+    if (!chunk->ok) {
+      had_error_ = true;
+    } else {
+      WriteRaw(chunk->output.data(), chunk->output.size());
+      if (options_.format == GzipOutputStream::ZLIB) {
+        check_ = adler32_combine(check_, chunk->check, chunk->input_size);
+      } else {
+        check_ = crc32_combine(check_, chunk->check, chunk->input_size);
+      }
+    }
+    delete chunk;
+  }
+}
+
+void ParallelGzipOutputStream::WriteRaw(const void* data, int size) {
+  const uint8* in = static_cast<const uint8*>(data);
+  while (size > 0 && !had_error_) {
+    void* buffer;
+    int buffer_size;
+    if (!sub_stream_->Next(&buffer, &buffer_size)) {
+      had_error_ = true;
+      return;
+    }
+    int n = min(size, buffer_size);
+    memcpy(buffer, in, n);
+    in += n;
+    size -= n;
+    if (n < buffer_size) sub_stream_->BackUp(buffer_size - n);
+  }
+}
+
+bool ParallelGzipOutputStream::Flush() {
+  if (closed_) return !had_error_;
+  if (position_ > 0) SubmitChunk(false);
+  WriteFinishedChunks(true);
+  return !had_error_;
+}
+
+bool ParallelGzipOutputStream::Close() {
+  if (closed_) return !had_error_;
+  closed_ = true;
+  SubmitChunk(true);
+  WriteFinishedChunks(true);
+
+  uint8 trailer[8];
+  if (options_.format == GzipOutputStream::ZLIB) {
+    // Adler-32, big-endian.
+    for (int i = 0; i < 4; i++) {
+      trailer[i] = static_cast<uint8>(check_ >> (24 - 8 * i));
+    }
+    WriteRaw(trailer, 4);
+  } else {
+    // CRC-32 and input size modulo 2^32, little-endian.
+    const uint32 input_size = static_cast<uint32>(bytes_submitted_);
+    for (int i = 0; i < 4; i++) {
+      trailer[i] = static_cast<uint8>(check_ >> (8 * i));
+      trailer[4 + i] = static_cast<uint8>(input_size >> (8 * i));
+    }
+    WriteRaw(trailer, 8);
+  }
+  return !had_error_;
+}
+
+// ===================================================================
+
+static const char kIndexMagic[] = "PBGZIDX1";
+static const int kIndexMagicSize = 8;
+
+GzipIndex::GzipIndex() : uncompressed_size_(0) {}
+GzipIndex::~GzipIndex() {}
+
+bool GzipIndex::Build(ZeroCopyInputStream* input, int64 span) {
+  checkpoints_.clear();
+  uncompressed_size_ = 0;
+
+  z_stream zcontext;
+  zcontext.zalloc = Z_NULL;
+  zcontext.zfree = Z_NULL;
+  zcontext.opaque = Z_NULL;
+  zcontext.next_in = Z_NULL;
+  zcontext.avail_in = 0;
+  // Accept either a gzip or a zlib header.
+  if (inflateInit2(&zcontext, 32 + 15) != Z_OK) {
+    return false;
+  }
+
+  // The output is decompressed into a circular buffer holding the last
+  // kWindowSize bytes, which is copied into each checkpoint.
+  scoped_array<Bytef> window(new Bytef[kWindowSize]);
+  zcontext.avail_out = 0;
+  int64 total_in = 0;
+  int64 total_out = 0;
+  int64 last_checkpoint = 0;
+  int error = Z_OK;
+  while (error != Z_STREAM_END) {
+    if (zcontext.avail_in == 0) {
+      const void* data;
+      int size;
+      if (!input->Next(&data, &size)) {
+        error = Z_DATA_ERROR;  // Truncated stream.
+        break;
+      }
+      zcontext.next_in = static_cast<Bytef*>(const_cast<void*>(data));
+      zcontext.avail_in = size;
+    }
+    if (zcontext.avail_out == 0) {
+      zcontext.next_out = window.get();
+      zcontext.avail_out = kWindowSize;
+    }
+    total_in += zcontext.avail_in;
+    total_out += zcontext.avail_out;
+    // Z_BLOCK stops at each deflate block boundary.
+    error = inflate(&zcontext, Z_BLOCK);
+    total_in -= zcontext.avail_in;
+    total_out -= zcontext.avail_out;
+    if (error == Z_NEED_DICT) error = Z_DATA_ERROR;
+    if (error != Z_OK && error != Z_BUF_ERROR && error != Z_STREAM_END) {
+      break;
+    }
+
+    // Bit 7 of data_type: at a block boundary (or just past the header).
+    // Bit 6: the last block has been decoded.
+    if ((zcontext.data_type & 128) != 0 && (zcontext.data_type & 64) == 0 &&
+        (checkpoints_.empty() || total_out - last_checkpoint > span)) {
+      checkpoints_.push_back(Checkpoint());
+      Checkpoint* checkpoint = &checkpoints_.back();
+      checkpoint->compressed_offset = total_in;
+      checkpoint->bits = zcontext.data_type & 7;
+      checkpoint->uncompressed_offset = total_out;
+      const int filled = kWindowSize - zcontext.avail_out;
+      const char* window_data = reinterpret_cast<const char*>(window.get());
+      if (total_out < kWindowSize) {
+        checkpoint->window.assign(window_data, filled);
+      } else {
+        checkpoint->window.assign(window_data + filled, kWindowSize - filled);
+        checkpoint->window.append(window_data, filled);
+      }
+      last_checkpoint = total_out;
+    }
+  }
+
+  if (error == Z_STREAM_END) {
+    if (zcontext.avail_in > 0) input->BackUp(zcontext.avail_in);
+    uncompressed_size_ = total_out;
+  } else {
+    checkpoints_.clear();
+  }
+  inflateEnd(&zcontext);
+  return error == Z_STREAM_END;
+}
+
+bool GzipIndex::Serialize(ZeroCopyOutputStream* output) const {
+  CodedOutputStream coded_output(output);
+  coded_output.WriteRaw(kIndexMagic, kIndexMagicSize);
+  coded_output.WriteVarint64(uncompressed_size_);
+  coded_output.WriteVarint32(checkpoints_.size());
+  for (int i = 0; i < checkpoints_.size(); i++) {
+    const Checkpoint& checkpoint = checkpoints_[i];
+    coded_output.WriteVarint64(checkpoint.compressed_offset);
+    coded_output.WriteVarint32(checkpoint.bits);
+    coded_output.WriteVarint64(checkpoint.uncompressed_offset);
+    coded_output.WriteVarint32(checkpoint.window.size());
+    coded_output.WriteString(checkpoint.window);
+  }
+  return !coded_output.HadError();
+}
+
+bool GzipIndex::Parse(ZeroCopyInputStream* input) {
+  checkpoints_.clear();
+  uncompressed_size_ = 0;
+
+  CodedInputStream coded_input(input);
+  // Each checkpoint may hold a whole window.
+  coded_input.SetTotalBytesLimit(kint32max, -1);
+  string magic;
+  uint64 uncompressed_size;
+  uint32 count;
+  if (!coded_input.ReadString(&magic, kIndexMagicSize) ||
+      magic != string(kIndexMagic, kIndexMagicSize) ||
+      !coded_input.ReadVarint64(&uncompressed_size) ||
+      !coded_input.ReadVarint32(&count)) {
+    return false;
+  }
+
+  vector<Checkpoint> checkpoints;
+  int64 previous_offset = 0;
+  for (uint32 i = 0; i < count; i++) {
+    uint64 compressed_offset, uncompressed_offset;
+    uint32 bits, window_size;
+    if (!coded_input.ReadVarint64(&compressed_offset) ||
+        !coded_input.ReadVarint32(&bits) ||
+        !coded_input.ReadVarint64(&uncompressed_offset) ||
+        !coded_input.ReadVarint32(&window_size) ||
+        bits > 7 || window_size > kWindowSize ||
+        (bits != 0 && compressed_offset == 0) ||
+        uncompressed_offset < previous_offset ||
+        uncompressed_offset > uncompressed_size) {
+      return false;
+    }
+    checkpoints.push_back(Checkpoint());
+    Checkpoint* checkpoint = &checkpoints.back();
+    checkpoint->compressed_offset = compressed_offset;
+    checkpoint->bits = bits;
+    checkpoint->uncompressed_offset = uncompressed_offset;
+    if (!coded_input.ReadString(&checkpoint->window, window_size)) {
+      return false;
+    }
+    previous_offset = uncompressed_offset;
+  }
+
+  checkpoints_.swap(checkpoints);
+  uncompressed_size_ = uncompressed_size;
+  return true;
+}
+
+int GzipIndex::FindCheckpoint(int64 uncompressed_offset) const {
+  // Find the last checkpoint whose offset is <= uncompressed_offset.
+  int low = -1;
+  int high = checkpoints_.size();
+  while (high - low > 1) {
+    int mid = low + (high - low) / 2;
+    if (checkpoints_[mid].uncompressed_offset <= uncompressed_offset) {
+      low = mid;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+// -------------------------------------------------------------------
+
+SeekableGzipInputStream::SeekableGzipInputStream(
+    int file_descriptor, const GzipIndex* index, int buffer_size)
+    : file_(file_descriptor),
+      index_(index),
+      buffer_size_(buffer_size),
+      errno_(0) {}
+
+SeekableGzipInputStream::~SeekableGzipInputStream() {
+  // The GzipInputStream reads from file_stream_.
+  gzip_stream_.reset();
+}
+
+bool SeekableGzipInputStream::Seek(int64 uncompressed_offset) {
+  gzip_stream_.reset();
+  file_stream_.reset();
+
+  int checkpoint = index_->FindCheckpoint(uncompressed_offset);
+  if (checkpoint < 0 || uncompressed_offset > index_->uncompressed_size()) {
+    return false;
+  }
+  if (lseek(file_, index_->checkpoint_input_offset(checkpoint), SEEK_SET) ==
+      static_cast<off_t>(-1)) {
+    errno_ = errno;
+    return false;
+  }
+  file_stream_.reset(new FileInputStream(file_));
+  gzip_stream_.reset(new GzipInputStream(file_stream_.get(), *index_,
+                                         checkpoint, buffer_size_));
+
+  int64 skip =
+      uncompressed_offset - index_->checkpoint(checkpoint).uncompressed_offset;
+  while (skip > 0) {
+    int count = static_cast<int>(min<int64>(skip, kint32max));
+    if (!gzip_stream_->Skip(count)) {
+      errno_ = file_stream_->GetErrno();
+      gzip_stream_.reset();
+      file_stream_.reset();
+      return false;
+    }
+    skip -= count;
+  }
+  return true;
+}
+
+bool SeekableGzipInputStream::Next(const void** data, int* size) {
+  if (gzip_stream_ == NULL && !Seek(0)) return false;
+  if (!gzip_stream_->Next(data, size)) {
+    errno_ = file_stream_->GetErrno();
+    return false;
+  }
+  return true;
+}
+
+void SeekableGzipInputStream::BackUp(int count) {
+  GOOGLE_CHECK(gzip_stream_ != NULL);
+  gzip_stream_->BackUp(count);
+}
+
+bool SeekableGzipInputStream::Skip(int count) {
+  if (gzip_stream_ == NULL && !Seek(0)) return false;
+  return gzip_stream_->Skip(count);
+}
+
+int64 SeekableGzipInputStream::ByteCount() const {
+  return gzip_stream_ == NULL ? 0 : gzip_stream_->ByteCount();
+}
+
 }  // namespace io
 }  // namespace protobuf
 }  // namespace google
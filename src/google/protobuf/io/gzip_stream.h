@@ -39,12 +39,22 @@
 //
 // GzipOutputStream is an ZeroCopyOutputStream that compresses data to
 // an underlying ZeroCopyOutputStream.
+//
+// ParallelGzipOutputStream produces the same formats as GzipOutputStream,
+// but compresses on several threads.
+//
+// GzipIndex records checkpoints in a compressed stream from which
+// decompression can resume, and SeekableGzipInputStream uses one to read a
+// compressed file from an arbitrary offset.
 
 #ifndef GOOGLE_PROTOBUF_IO_GZIP_STREAM_H__
 #define GOOGLE_PROTOBUF_IO_GZIP_STREAM_H__
 
 #include <zlib.h>
 
+#include <deque>
+#include <string>
+#include <vector>
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/io/zero_copy_stream.h>
 
@@ -52,6 +62,9 @@ namespace google {
 namespace protobuf {
 namespace io {
 
+class FileInputStream;
+class GzipIndex;
+
 // A ZeroCopyInputStream that reads compressed data through zlib
 class LIBPROTOBUF_EXPORT GzipInputStream : public ZeroCopyInputStream {
  public:
@@ -72,8 +85,26 @@ class LIBPROTOBUF_EXPORT GzipInputStream : public ZeroCopyInputStream {
       ZeroCopyInputStream* sub_stream,
       Format format = AUTO,
       int buffer_size = -1);
+
+  // Resumes decompression at checkpoint number `checkpoint` of index.
+  // sub_stream must start at index.checkpoint_input_offset(checkpoint)
+  // within the compressed data.  The stream ends at the end of the
+  // compressed stream containing the checkpoint, and ByteCount() counts
+  // from the start of the uncompressed data.  The index need not outlive
+  // this stream.
+  GzipInputStream(
+      ZeroCopyInputStream* sub_stream,
+      const GzipIndex& index,
+      int checkpoint,
+      int buffer_size = -1);
+
   virtual ~GzipInputStream();
 
+  // Sets the preset dictionary to supply when the compressed data asks for
+  // one, i.e. for zlib streams written with GzipOutputStream::Options::
+  // dictionary.  Must be called before the first call to Next().
+  void SetDictionary(const string& dictionary) { dictionary_ = dictionary; }
+
   // Return last error message or NULL if no error.
   inline const char* ZlibErrorMessage() const {
     return zcontext_.msg;
@@ -100,7 +131,18 @@ class LIBPROTOBUF_EXPORT GzipInputStream : public ZeroCopyInputStream {
   void* output_position_;
   size_t output_buffer_length_;
   int64 byte_count_;
+  string dictionary_;
+
+  // Set when resuming at a checkpoint: the raw deflate stream is started
+  // with the checkpoint's leftover bits and window.
+  bool resumed_;
+  int resume_bits_;
+  string resume_window_;
 
+  // Shared constructor code.
+  void Init(int buffer_size);
+  // Starts inflating at the checkpoint, consuming the partial byte if any.
+  int InflateInitResumed();
   int Inflate(int flush);
   void DoNextOutput(const void** data, int* size);
 
@@ -135,6 +177,15 @@ class LIBPROTOBUF_EXPORT GzipOutputStream : public ZeroCopyOutputStream {
     // zlib.h for definitions of these constants.
     int compression_strategy;
 
+    // A preset dictionary: bytes likely to occur in the data, such as one
+    // produced by DictionaryTrainer.  Compression starts as if the
+    // dictionary had just been written, which helps a lot for small inputs
+    // like single messages.  Only the ZLIB format can record the use of a
+    // dictionary, so this requires format == ZLIB, and the reader must be
+    // given the same dictionary with GzipInputStream::SetDictionary().
+    // Only the last 32k is used.  Defaults to empty.
+    string dictionary;
+
     Options();  // Initializes with default values.
   };
 
@@ -203,6 +254,216 @@ class LIBPROTOBUF_EXPORT GzipOutputStream : public ZeroCopyOutputStream {
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(GzipOutputStream);
 };
 
+// A ZeroCopyOutputStream that compresses data to an underlying
+// ZeroCopyOutputStream on several threads, in the manner of pigz.
+//
+// The input is split into chunks which are deflated independently and in
+// parallel, each primed with the last 32k of the chunk before it as a
+// preset dictionary so that matches may still span chunk boundaries.  Every
+// chunk but the last ends with a sync flush, so the compressed chunks
+// concatenate into a single ordinary deflate stream; the result is a
+// standard gzip or zlib stream which GzipInputStream (or any other
+// decompressor) can read.  The output is slightly larger than
+// GzipOutputStream's, by a few bytes per chunk.
+//
+// Compressed chunks are written to the underlying stream by the calling
+// thread, in order, from within Next(), Flush() and Close().
+class LIBPROTOBUF_EXPORT ParallelGzipOutputStream
+    : public ZeroCopyOutputStream {
+ public:
+  struct LIBPROTOBUF_EXPORT Options {
+    // GZIP or ZLIB.  Defaults to GZIP.
+    GzipOutputStream::Format format;
+
+    // Number of input bytes compressed as one unit of work.  Defaults to
+    // 128kB.
+    int chunk_size;
+
+    // Number of compression threads.  Defaults to 4.  If zero, or if
+    // threads are not available, chunks are compressed on the calling
+    // thread.
+    int num_threads;
+
+    // As in GzipOutputStream::Options.
+    int compression_level;
+    int compression_strategy;
+
+    Options();  // Initializes with default values.
+  };
+
+  // Create a ParallelGzipOutputStream with default options.
+  explicit ParallelGzipOutputStream(ZeroCopyOutputStream* sub_stream);
+
+  // Create a ParallelGzipOutputStream with the given options.
+  ParallelGzipOutputStream(ZeroCopyOutputStream* sub_stream,
+                           const Options& options);
+
+  // Calls Close() if it has not been called.
+  virtual ~ParallelGzipOutputStream();
+
+  // Compresses the data written so far, waits for all chunks to finish and
+  // writes them to the underlying stream.  Each flush ends a chunk early,
+  // so frequent flushes cost compression ratio and parallelism.  It is the
+  // caller's responsibility to flush the underlying stream if necessary.
+  // Returns true if no error.
+  bool Flush();
+
+  // Writes out all data and closes the gzip stream.  It is the caller's
+  // responsibility to close the underlying stream if necessary.  Returns
+  // true if no error.
+  bool Close();
+
+  // implements ZeroCopyOutputStream ---------------------------------
+  bool Next(void** data, int* size);
+  void BackUp(int count);
+  int64 ByteCount() const;
+
+ private:
+  struct Chunk;
+  class WorkerPool;
+
+  // Shared constructor code.  Writes the stream header.
+  void Init();
+  // Hands the current chunk to the workers.
+  void SubmitChunk(bool last);
+  // Writes finished chunks to sub_stream_, in order.  If wait_for_all is
+  // true, waits for every submitted chunk; otherwise waits only while too
+  // many chunks are outstanding.
+  void WriteFinishedChunks(bool wait_for_all);
+  void WriteRaw(const void* data, int size);
+
+  ZeroCopyOutputStream* sub_stream_;
+  const Options options_;
+  scoped_ptr<WorkerPool> pool_;
+
+  scoped_ptr<Chunk> current_;  // Chunk being filled; NULL between chunks.
+  int position_;               // Bytes of current_->input filled.
+  string dictionary_;          // Last 32k of input submitted so far.
+  deque<Chunk*> in_flight_;    // Submitted chunks, in order.
+
+  int64 bytes_submitted_;      // Input bytes in submitted chunks.
+  uLong check_;                // CRC-32 or Adler-32 of the written chunks.
+  bool had_error_;
+  bool closed_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(ParallelGzipOutputStream);
+};
+
+// An index of checkpoints into a gzip or zlib stream.  At each checkpoint
+// decompression can be resumed without decoding anything before it, using
+// GzipInputStream's checkpoint constructor, so a reader can jump close to
+// any offset of a large compressed file, and disjoint ranges can be
+// decompressed in parallel.
+//
+// A checkpoint costs up to 32k (the deflate window at that point), so the
+// span between checkpoints trades index size against the amount of data
+// decompressed and discarded on each seek.  Only the first stream of a file
+// holding several concatenated gzip streams is indexed.
+class LIBPROTOBUF_EXPORT GzipIndex {
+ public:
+  struct Checkpoint {
+    // Bytes of compressed data consumed before the checkpoint.  If bits is
+    // nonzero, the last of them is shared with the data after it.
+    int64 compressed_offset;
+    // Number of bits (0-7) of the byte at compressed_offset - 1 which
+    // belong to the data after the checkpoint.
+    int bits;
+    // Offset of the checkpoint in the uncompressed data.
+    int64 uncompressed_offset;
+    // Up to 32k of uncompressed data preceding the checkpoint.
+    string window;
+  };
+
+  GzipIndex();
+  ~GzipIndex();
+
+  // Decompresses the stream read from input, which must start at the
+  // beginning of a gzip or zlib stream, and records a checkpoint at the
+  // start of the first deflate block and then at the first block boundary
+  // after every span bytes of uncompressed data.  Input following the end
+  // of the compressed stream is returned with BackUp().  Returns false if
+  // the input is not a valid compressed stream.
+  bool Build(ZeroCopyInputStream* input, int64 span);
+
+  // Writes the index to a sidecar stream, to be read back by Parse().  The
+  // windows are stored uncompressed; wrap the output in a GzipOutputStream
+  // if the index size matters.
+  bool Serialize(ZeroCopyOutputStream* output) const;
+  // Replaces the index with one read from a stream written by Serialize().
+  bool Parse(ZeroCopyInputStream* input);
+
+  int checkpoint_count() const { return checkpoints_.size(); }
+  const Checkpoint& checkpoint(int i) const { return checkpoints_[i]; }
+  // Size of the uncompressed data.
+  int64 uncompressed_size() const { return uncompressed_size_; }
+
+  // Returns the last checkpoint at or before uncompressed_offset, or -1 if
+  // the index is empty.
+  int FindCheckpoint(int64 uncompressed_offset) const;
+
+  // Offset in the compressed data at which a GzipInputStream resuming at
+  // checkpoint i must start reading.
+  int64 checkpoint_input_offset(int i) const {
+    return checkpoints_[i].compressed_offset - (checkpoints_[i].bits ? 1 : 0);
+  }
+
+ private:
+  vector<Checkpoint> checkpoints_;
+  int64 uncompressed_size_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(GzipIndex);
+};
+
+// A ZeroCopyInputStream that decompresses a gzip or zlib file and can seek
+// to any uncompressed offset using a GzipIndex.
+//
+// Example:
+//   GzipIndex index;
+//   ... index.Build() once, or index.Parse() a saved sidecar ...
+//   SeekableGzipInputStream input(fd, &index);
+//   input.Seek(offset_of_record);
+//   ... read from input ...
+//
+// The file descriptor is repositioned with lseek(), so threads decompressing
+// different ranges of the same file in parallel must each open the file.
+class LIBPROTOBUF_EXPORT SeekableGzipInputStream : public ZeroCopyInputStream {
+ public:
+  // The index must have been built from this file and must outlive the
+  // stream.  The file descriptor is not closed.  Reading starts at the
+  // beginning of the uncompressed data.
+  SeekableGzipInputStream(int file_descriptor, const GzipIndex* index,
+                          int buffer_size = -1);
+  ~SeekableGzipInputStream();
+
+  // Positions the stream so that the next call to Next() returns the data
+  // at uncompressed_offset.  Decompression resumes at the nearest preceding
+  // checkpoint, so at most about one index span is decompressed and
+  // discarded.  Returns false on I/O or decompression errors, or if the
+  // offset is past the end of the data.
+  bool Seek(int64 uncompressed_offset);
+
+  // If an I/O error has occurred, this is the errno from that error.
+  // Otherwise, this is zero.
+  int GetErrno() const { return errno_; }
+
+  // implements ZeroCopyInputStream ----------------------------------
+  bool Next(const void** data, int* size);
+  void BackUp(int count);
+  bool Skip(int count);
+  int64 ByteCount() const;
+
+ private:
+  const int file_;
+  const GzipIndex* index_;
+  const int buffer_size_;
+  int errno_;
+
+  scoped_ptr<FileInputStream> file_stream_;
+  scoped_ptr<GzipInputStream> gzip_stream_;  // NULL before the first Seek().
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(SeekableGzipInputStream);
+};
+
 }  // namespace io
 }  // namespace protobuf
 
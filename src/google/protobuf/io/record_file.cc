@@ -0,0 +1,677 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "config.h"
+
+#ifdef _MSC_VER
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <string.h>
+#include <algorithm>
+
+#include <google/protobuf/io/record_file.h>
+#include <google/protobuf/arena.h>
+#include <google/protobuf/message_lite.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#if HAVE_ZLIB
+#include <google/protobuf/io/gzip_stream.h>
+#endif
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/once.h>
+#include <google/protobuf/stubs/stl_util.h>
+
+namespace google {
+namespace protobuf {
+namespace io {
+
+namespace {
+
+const char kFileMagic[] = "PBRECFIL";
+const char kTrailerMagic[] = "PBRECIDX";
+const int kMagicSize = 8;
+const uint32 kBlockMagic = 0x4b4c4250;  // "PBLK"
+
+const int kBlockHeaderSize = 7 * 4;
+const int kIndexEntrySize = 8 + 8 + 4;
+const int kTrailerSize = 8 + 4 + 4 + kMagicSize;
+
+// Block flags.
+const uint32 kCompressed = 1;
+
+const int kDefaultBlockSize = 64 * 1024;
+
+// -------------------------------------------------------------------
+// CRC32C (Castagnoli), computed four bytes at a time with the usual
+// sliced tables.
+
+uint32 crc32c_table[4][256];
+GOOGLE_PROTOBUF_DECLARE_ONCE(crc32c_table_once);
+
+void InitCrc32cTable() {
+  for (int i = 0; i < 256; i++) {
+    uint32 crc = i;
+    for (int j = 0; j < 8; j++) {
+      crc = (crc >> 1) ^ (0x82f63b78 & (0 - (crc & 1)));
+    }
+    crc32c_table[0][i] = crc;
+  }
+  for (int i = 0; i < 256; i++) {
+    for (int t = 1; t < 4; t++) {
+      uint32 prev = crc32c_table[t - 1][i];
+      crc32c_table[t][i] = (prev >> 8) ^ crc32c_table[0][prev & 0xff];
+    }
+  }
+}
+
+uint32 Crc32c(const void* data, size_t size) {
+  ::google::protobuf::GoogleOnceInit(&crc32c_table_once, &InitCrc32cTable);
+  const uint8* p = static_cast<const uint8*>(data);
+  uint32 crc = 0xffffffff;
+  while (size >= 4) {
+    crc ^= static_cast<uint32>(p[0]) |
+           (static_cast<uint32>(p[1]) << 8) |
+           (static_cast<uint32>(p[2]) << 16) |
+           (static_cast<uint32>(p[3]) << 24);
+    crc = crc32c_table[3][crc & 0xff] ^
+          crc32c_table[2][(crc >> 8) & 0xff] ^
+          crc32c_table[1][(crc >> 16) & 0xff] ^
+          crc32c_table[0][crc >> 24];
+    p += 4;
+    size -= 4;
+  }
+  while (size > 0) {
+    crc = (crc >> 8) ^ crc32c_table[0][(crc ^ *p) & 0xff];
+    ++p;
+    --size;
+  }
+  return ~crc;
+}
+
+// -------------------------------------------------------------------
+
+inline uint8* WriteFixed32(uint32 value, uint8* target) {
+  return CodedOutputStream::WriteLittleEndian32ToArray(value, target);
+}
+inline uint8* WriteFixed64(uint64 value, uint8* target) {
+  return CodedOutputStream::WriteLittleEndian64ToArray(value, target);
+}
+inline const uint8* ReadFixed32(const uint8* buffer, uint32* value) {
+  return CodedInputStream::ReadLittleEndian32FromArray(buffer, value);
+}
+inline const uint8* ReadFixed64(const uint8* buffer, uint64* value) {
+  return CodedInputStream::ReadLittleEndian64FromArray(buffer, value);
+}
+
+// Copies size bytes into a ZeroCopyOutputStream.
+bool WriteToStream(ZeroCopyOutputStream* output,
+                   const void* data, int size) {
+  const uint8* in = static_cast<const uint8*>(data);
+  while (size > 0) {
+    void* buffer;
+    int buffer_size;
+    if (!output->Next(&buffer, &buffer_size)) return false;
+    int n = min(size, buffer_size);
+    memcpy(buffer, in, n);
+    in += n;
+    size -= n;
+    if (n < buffer_size) output->BackUp(buffer_size - n);
+  }
+  return true;
+}
+
+// Finds the next record of a block payload, advancing *position past it.
+// Returns false at the end of the payload or if the payload is malformed
+// (in which case *position is set to -1).
+bool NextRecord(const string& payload, int* position,
+                const uint8** data, int* size) {
+  int remaining = payload.size() - *position;
+  if (remaining <= 0) return false;
+  const uint8* start =
+      reinterpret_cast<const uint8*>(payload.data()) + *position;
+  CodedInputStream input(start, remaining);
+  uint32 length;
+  if (!input.ReadVarint32(&length) ||
+      length > static_cast<uint32>(remaining - input.CurrentPosition())) {
+    *position = -1;
+    return false;
+  }
+  *data = start + input.CurrentPosition();
+  *size = length;
+  *position += input.CurrentPosition() + length;
+  return true;
+}
+
+}  // namespace
+
+// ===================================================================
+
+RecordFileWriter::Options::Options()
+  : block_size(kDefaultBlockSize),
+    compress(false),
+    compression_level(-1) {}
+
+RecordFileWriter::RecordFileWriter(ZeroCopyOutputStream* output,
+                                   const Options& options)
+  : output_(output),
+    options_(options),
+    pending_records_(0),
+    offset_(0),
+    record_count_(0),
+    had_error_(false),
+    closed_(false) {
+#if !HAVE_ZLIB
+  if (options_.compress) {
+    GOOGLE_LOG(ERROR) << "RecordFileWriter: compression requested, but "
+                         "protobuf was built without zlib.  Blocks will be "
+                         "stored uncompressed.";
+  }
+#endif
+  if (options_.block_size > 0) pending_.reserve(options_.block_size);
+  WriteRaw(kFileMagic, kMagicSize);
+}
+
+RecordFileWriter::~RecordFileWriter() {
+  if (!closed_) Close();
+}
+
+uint8* RecordFileWriter::ReserveRecord(int size) {
+  int old_size = pending_.size();
+  STLStringResizeUninitialized(
+      &pending_, old_size + CodedOutputStream::VarintSize32(size) + size);
+  uint8* target = reinterpret_cast<uint8*>(string_as_array(&pending_)) +
+                  old_size;
+  return CodedOutputStream::WriteVarint32ToArray(size, target);
+}
+
+bool RecordFileWriter::FinishRecord() {
+  ++pending_records_;
+  ++record_count_;
+  if (pending_.size() >= options_.block_size) return FlushBlock();
+  return !had_error_;
+}
+
+bool RecordFileWriter::WriteRecord(const MessageLite& message) {
+  GOOGLE_DCHECK(!closed_);
+  GOOGLE_DCHECK(message.IsInitialized())
+      << "Can't serialize message of type \"" << message.GetTypeName()
+      << "\" because it is missing required fields: "
+      << message.InitializationErrorString();
+  int size = message.ByteSize();
+  uint8* target = ReserveRecord(size);
+  uint8* end = message.SerializeWithCachedSizesToArray(target);
+  GOOGLE_DCHECK_EQ(end - target, size)
+      << message.GetTypeName() << " was modified concurrently during "
+      << "serialization.";
+  return FinishRecord();
+}
+
+bool RecordFileWriter::WriteSerializedRecord(const string& serialized) {
+  GOOGLE_DCHECK(!closed_);
+  uint8* target = ReserveRecord(serialized.size());
+  memcpy(target, serialized.data(), serialized.size());
+  return FinishRecord();
+}
+
+bool RecordFileWriter::FlushBlock() {
+  if (pending_records_ == 0) return !had_error_;
+
+  const string* stored = &pending_;
+  uint32 flags = 0;
+#if HAVE_ZLIB
+  string compressed;
+  if (options_.compress) {
+    GzipOutputStream::Options gzip_options;
+    gzip_options.format = GzipOutputStream::ZLIB;
+    if (options_.compression_level >= 0) {
+      gzip_options.compression_level = options_.compression_level;
+    }
+    StringOutputStream string_output(&compressed);
+    GzipOutputStream gzip_output(&string_output, gzip_options);
+    if (!WriteToStream(&gzip_output, pending_.data(), pending_.size()) ||
+        !gzip_output.Close()) {
+      GOOGLE_LOG(ERROR) << "RecordFileWriter: compression failed: "
+                        << (gzip_output.ZlibErrorMessage() == NULL ? "" :
+                            gzip_output.ZlibErrorMessage());
+      had_error_ = true;
+      return false;
+    }
+    stored = &compressed;
+    flags |= kCompressed;
+  }
+#endif
+
+  BlockInfo info;
+  info.offset = offset_;
+  info.first_record = record_count_ - pending_records_;
+  info.record_count = pending_records_;
+
+  uint8 header[kBlockHeaderSize];
+  uint8* p = header;
+  p = WriteFixed32(kBlockMagic, p);
+  p = WriteFixed32(stored->size(), p);
+  p = WriteFixed32(pending_.size(), p);
+  p = WriteFixed32(pending_records_, p);
+  p = WriteFixed32(flags, p);
+  p = WriteFixed32(Crc32c(stored->data(), stored->size()), p);
+  p = WriteFixed32(Crc32c(header, p - header), p);
+  GOOGLE_DCHECK_EQ(p - header, kBlockHeaderSize);
+
+  WriteRaw(header, kBlockHeaderSize);
+  WriteRaw(stored->data(), stored->size());
+  index_.push_back(info);
+
+  pending_.clear();
+  pending_records_ = 0;
+  return !had_error_;
+}
+
+bool RecordFileWriter::WriteRaw(const void* data, int size) {
+  if (had_error_) return false;
+  if (!WriteToStream(output_, data, size)) {
+    had_error_ = true;
+    return false;
+  }
+  offset_ += size;
+  return true;
+}
+
+bool RecordFileWriter::Close() {
+  if (closed_) return !had_error_;
+  closed_ = true;
+  FlushBlock();
+
+  const int64 index_offset = offset_;
+  string index;
+  STLStringResizeUninitialized(&index, index_.size() * kIndexEntrySize);
+  uint8* p = reinterpret_cast<uint8*>(string_as_array(&index));
+  for (int i = 0; i < index_.size(); i++) {
+    p = WriteFixed64(index_[i].offset, p);
+    p = WriteFixed64(index_[i].first_record, p);
+    p = WriteFixed32(index_[i].record_count, p);
+  }
+  WriteRaw(index.data(), index.size());
+
+  uint8 trailer[kTrailerSize];
+  p = trailer;
+  p = WriteFixed64(index_offset, p);
+  p = WriteFixed32(index_.size(), p);
+  p = WriteFixed32(Crc32c(index.data(), index.size()), p);
+  memcpy(p, kTrailerMagic, kMagicSize);
+  WriteRaw(trailer, kTrailerSize);
+
+  return !had_error_;
+}
+
+// ===================================================================
+
+RecordFileReader::BlockVisitor::~BlockVisitor() {}
+
+RecordFileReader::RecordFileReader(int file_descriptor)
+  : file_(file_descriptor),
+    record_count_(0),
+    errno_(0),
+    cached_block_(-1),
+    cached_record_(0),
+    cached_position_(0) {}
+
+RecordFileReader::~RecordFileReader() {}
+
+int RecordFileReader::GetErrno() const {
+  MutexLock lock(&errno_mutex_);
+  return errno_;
+}
+
+void RecordFileReader::SetErrno(int error) const {
+  MutexLock lock(&errno_mutex_);
+  errno_ = error;
+}
+
+bool RecordFileReader::ReadAt(int64 offset, int size, uint8* buffer) const {
+#ifdef _WIN32
+  MutexLock lock(&seek_mutex_);
+  if (_lseeki64(file_, offset, SEEK_SET) < 0) {
+    SetErrno(errno);
+    return false;
+  }
+#endif
+  while (size > 0) {
+    int result;
+    do {
+#ifdef _WIN32
+      result = read(file_, buffer, size);
+#else
+      result = pread(file_, buffer, size, offset);
+#endif
+    } while (result < 0 && errno == EINTR);
+    if (result < 0) {
+      SetErrno(errno);
+      return false;
+    }
+    if (result == 0) return false;  // Truncated file.
+    buffer += result;
+    offset += result;
+    size -= result;
+  }
+  return true;
+}
+
+bool RecordFileReader::Open() {
+  index_.clear();
+  record_count_ = 0;
+  cached_block_ = -1;
+
+  struct stat info;
+  if (fstat(file_, &info) != 0) {
+    SetErrno(errno);
+    return false;
+  }
+  const int64 file_size = info.st_size;
+  if (file_size < kMagicSize + kTrailerSize) return false;
+
+  uint8 magic[kMagicSize];
+  if (!ReadAt(0, kMagicSize, magic) ||
+      memcmp(magic, kFileMagic, kMagicSize) != 0) {
+    return false;
+  }
+
+  uint8 trailer[kTrailerSize];
+  if (!ReadAt(file_size - kTrailerSize, kTrailerSize, trailer) ||
+      memcmp(trailer + kTrailerSize - kMagicSize, kTrailerMagic,
+             kMagicSize) != 0) {
+    return false;
+  }
+  uint64 index_offset;
+  uint32 block_count, index_crc;
+  const uint8* p = trailer;
+  p = ReadFixed64(p, &index_offset);
+  p = ReadFixed32(p, &block_count);
+  p = ReadFixed32(p, &index_crc);
+  const int64 index_end = file_size - kTrailerSize;
+  if (index_offset < kMagicSize || index_offset > index_end ||
+      (index_end - index_offset) != block_count * int64(kIndexEntrySize)) {
+    return false;
+  }
+
+  string index;
+  STLStringResizeUninitialized(&index, index_end - index_offset);
+  uint8* index_data = reinterpret_cast<uint8*>(string_as_array(&index));
+  if (!ReadAt(index_offset, index.size(), index_data) ||
+      Crc32c(index.data(), index.size()) != index_crc) {
+    return false;
+  }
+
+  // Each block ends where the next one (or the index) begins.  Blocks must
+  // be contiguous and each must be at least as large as its header.
+  vector<BlockInfo> blocks(block_count);
+  int64 record_count = 0;
+  p = index_data;
+  for (int i = 0; i < block_count; i++) {
+    uint64 offset, first_record;
+    uint32 count;
+    p = ReadFixed64(p, &offset);
+    p = ReadFixed64(p, &first_record);
+    p = ReadFixed32(p, &count);
+    if (first_record != record_count || offset > index_offset ||
+        (i == 0 && offset != kMagicSize)) {
+      return false;
+    }
+    blocks[i].offset = offset;
+    blocks[i].first_record = first_record;
+    blocks[i].record_count = count;
+    if (i > 0) blocks[i - 1].end = offset;
+    record_count += count;
+  }
+  if (block_count > 0) blocks[block_count - 1].end = index_offset;
+  for (int i = 0; i < block_count; i++) {
+    if (blocks[i].end - blocks[i].offset < kBlockHeaderSize) return false;
+  }
+
+  index_.swap(blocks);
+  record_count_ = record_count;
+  return true;
+}
+
+int64 RecordFileReader::block_first_record(int block) const {
+  GOOGLE_DCHECK_GE(block, 0);
+  GOOGLE_DCHECK_LT(block, index_.size());
+  return index_[block].first_record;
+}
+
+bool RecordFileReader::ReadBlockPayload(int block, string* payload) const {
+  const BlockInfo& info = index_[block];
+  const int64 block_size = info.end - info.offset;
+  if (block_size > kint32max) return false;
+
+  string data;
+  STLStringResizeUninitialized(&data, block_size);
+  uint8* buffer = reinterpret_cast<uint8*>(string_as_array(&data));
+  if (!ReadAt(info.offset, block_size, buffer)) return false;
+
+  uint32 magic, stored_size, uncompressed_size, record_count, flags;
+  uint32 payload_crc, header_crc;
+  const uint8* p = buffer;
+  p = ReadFixed32(p, &magic);
+  p = ReadFixed32(p, &stored_size);
+  p = ReadFixed32(p, &uncompressed_size);
+  p = ReadFixed32(p, &record_count);
+  p = ReadFixed32(p, &flags);
+  p = ReadFixed32(p, &payload_crc);
+  const uint32 expected_header_crc = Crc32c(buffer, p - buffer);
+  p = ReadFixed32(p, &header_crc);
+  if (header_crc != expected_header_crc ||
+      magic != kBlockMagic ||
+      stored_size != block_size - kBlockHeaderSize ||
+      record_count != info.record_count ||
+      (flags & ~kCompressed) != 0 ||
+      Crc32c(p, stored_size) != payload_crc) {
+    return false;
+  }
+
+  if ((flags & kCompressed) == 0) {
+    if (uncompressed_size != stored_size) return false;
+    data.erase(0, kBlockHeaderSize);
+    payload->swap(data);
+    return true;
+  }
+
+#if HAVE_ZLIB
+  payload->clear();
+  payload->reserve(uncompressed_size);
+  ArrayInputStream array_input(p, stored_size);
+  GzipInputStream gzip_input(&array_input, GzipInputStream::ZLIB);
+  const void* chunk;
+  int chunk_size;
+  while (gzip_input.Next(&chunk, &chunk_size)) {
+    if (payload->size() + chunk_size > uncompressed_size) return false;
+    payload->append(static_cast<const char*>(chunk), chunk_size);
+  }
+  return gzip_input.ZlibErrorCode() >= 0 &&
+         payload->size() == uncompressed_size;
+#else
+  GOOGLE_LOG(ERROR) << "RecordFileReader: block is compressed, but protobuf "
+                       "was built without zlib.";
+  return false;
+#endif
+}
+
+bool RecordFileReader::ReadBlockRecords(int block,
+                                        const MessageLite& prototype,
+                                        Arena* arena,
+                                        vector<MessageLite*>* records) const {
+  GOOGLE_DCHECK_GE(block, 0);
+  GOOGLE_DCHECK_LT(block, index_.size());
+  string payload;
+  if (!ReadBlockPayload(block, &payload)) return false;
+
+  records->reserve(records->size() + index_[block].record_count);
+  int position = 0;
+  int count = 0;
+  const uint8* data;
+  int size;
+  while (NextRecord(payload, &position, &data, &size)) {
+    MessageLite* message = prototype.New(arena);
+    records->push_back(message);
+    if (!message->ParseFromArray(data, size)) return false;
+    ++count;
+  }
+  return position != -1 && count == index_[block].record_count;
+}
+
+int RecordFileReader::FindBlock(int64 index) const {
+  // Find the last block whose first record is <= index.
+  int low = 0;
+  int high = index_.size();
+  while (high - low > 1) {
+    int mid = low + (high - low) / 2;
+    if (index_[mid].first_record <= index) {
+      low = mid;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+bool RecordFileReader::ReadRecord(int64 index, MessageLite* message) {
+  if (index < 0 || index >= record_count_) return false;
+
+  int block = FindBlock(index);
+  if (block != cached_block_ || index < cached_record_) {
+    cached_block_ = -1;
+    if (!ReadBlockPayload(block, &cached_payload_)) return false;
+    cached_block_ = block;
+    cached_record_ = index_[block].first_record;
+    cached_position_ = 0;
+  }
+
+  const uint8* data;
+  int size;
+  while (true) {
+    if (!NextRecord(cached_payload_, &cached_position_, &data, &size)) {
+      cached_block_ = -1;
+      return false;
+    }
+    if (cached_record_++ == index) break;
+  }
+  return message->ParseFromArray(data, size);
+}
+
+// -------------------------------------------------------------------
+
+// State shared by the threads of one ScanParallel() call.
+class RecordFileReader::ScanState {
+ public:
+  ScanState(const RecordFileReader* reader, const MessageLite* prototype,
+            BlockVisitor* visitor)
+    : reader_(reader), prototype_(prototype), visitor_(visitor),
+      next_block_(0), ok_(true) {}
+
+  // Processes blocks until none are left or one has failed.
+  void Run() {
+    while (true) {
+      int block;
+      {
+        MutexLock lock(&mutex_);
+        if (!ok_ || next_block_ >= reader_->block_count()) return;
+        block = next_block_++;
+      }
+      Arena arena;
+      vector<MessageLite*> records;
+      if (!reader_->ReadBlockRecords(block, *prototype_, &arena, &records) ||
+          !visitor_->VisitBlock(block, reader_->block_first_record(block),
+                                records)) {
+        MutexLock lock(&mutex_);
+        ok_ = false;
+      }
+    }
+  }
+
+  bool ok() {
+    MutexLock lock(&mutex_);
+    return ok_;
+  }
+
+#ifdef HAVE_PTHREAD
+  static void* ThreadMain(void* state) {
+    static_cast<ScanState*>(state)->Run();
+    return NULL;
+  }
+#endif
+
+ private:
+  const RecordFileReader* reader_;
+  const MessageLite* prototype_;
+  BlockVisitor* visitor_;
+
+  Mutex mutex_;
+  int next_block_;
+  bool ok_;
+};
+
+bool RecordFileReader::ScanParallel(const MessageLite& prototype,
+                                    int num_threads,
+                                    BlockVisitor* visitor) const {
+  ScanState state(this, &prototype, visitor);
+  num_threads = min(num_threads, block_count());
+
+#ifdef HAVE_PTHREAD
+  // The calling thread is one of the workers.
+  vector<pthread_t> threads;
+  for (int i = 1; i < num_threads; i++) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, &ScanState::ThreadMain, &state) != 0) {
+      break;
+    }
+    threads.push_back(thread);
+  }
+  state.Run();
+  for (int i = 0; i < threads.size(); i++) {
+    pthread_join(threads[i], NULL);
+  }
+#else
+  state.Run();
+#endif
+
+  return state.ok();
+}
+
+}  // namespace io
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,256 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains RecordFileWriter and RecordFileReader, which store a
+// sequence of messages in a block-structured, indexed container file.
+//
+// Records are grouped into blocks of roughly Options::block_size bytes.
+// Each block has a header carrying its size, record count and CRC32C
+// checksums, and may optionally be compressed with zlib.  After the last
+// block the writer appends an index of all blocks and a fixed-size trailer
+// pointing at it, so a reader can:
+//   * find the block holding record N with a binary search and decode only
+//     that block (RecordFileReader::ReadRecord()), and
+//   * hand disjoint blocks to different threads, each parsing into its own
+//     Arena (RecordFileReader::ScanParallel()).
+//
+// File layout (all integers little-endian):
+//   file header:   8-byte magic "PBRECFIL"
+//   block:         28-byte header followed by stored_size payload bytes
+//     fixed32 magic, fixed32 stored_size, fixed32 uncompressed_size,
+//     fixed32 record_count, fixed32 flags, fixed32 payload_crc32c,
+//     fixed32 header_crc32c (of the preceding 24 bytes)
+//   index:         20 bytes per block
+//     fixed64 block_offset, fixed64 first_record, fixed32 record_count
+//   trailer:       fixed64 index_offset, fixed32 block_count,
+//                  fixed32 index_crc32c, 8-byte magic "PBRECIDX"
+// The uncompressed payload of a block is the block's records, each
+// preceded by its size as a varint (the DelimitedMessageWriter format).
+
+#ifndef GOOGLE_PROTOBUF_IO_RECORD_FILE_H__
+#define GOOGLE_PROTOBUF_IO_RECORD_FILE_H__
+
+#include <string>
+#include <vector>
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+  class Arena;
+  class MessageLite;
+namespace io {
+  class ZeroCopyOutputStream;
+
+// ===================================================================
+
+// Writes a record file to a ZeroCopyOutputStream, typically a
+// FileOutputStream positioned at the start of an empty file.
+//
+// Example:
+//   FileOutputStream file_output(fd);
+//   RecordFileWriter writer(&file_output, RecordFileWriter::Options());
+//   for (...) writer.WriteRecord(record);
+//   if (!writer.Close() || !file_output.Close()) { ... error ... }
+class LIBPROTOBUF_EXPORT RecordFileWriter {
+ public:
+  struct LIBPROTOBUF_EXPORT Options {
+    // A block is finished once its uncompressed records reach this many
+    // bytes.  Smaller blocks make random access cheaper and split the file
+    // into more units of parallel work; larger blocks compress better.
+    // Default is 64k.
+    int block_size;
+
+    // Compress each block with zlib.  Ignored (with an error logged) if
+    // protobuf was built without zlib.  Default is false.
+    bool compress;
+
+    // zlib compression level when compress is true; -1 selects zlib's
+    // default.
+    int compression_level;
+
+    Options();  // Initializes with default values.
+  };
+
+  // The output must outlive the writer.
+  RecordFileWriter(ZeroCopyOutputStream* output, const Options& options);
+  // Calls Close() if it has not been called.
+  ~RecordFileWriter();
+
+  // Appends a record.  Returns false if a previous write failed.  As with
+  // SerializeToString(), the message must be initialized (checked in debug
+  // builds).
+  bool WriteRecord(const MessageLite& message);
+  // Appends a record that has already been serialized.
+  bool WriteSerializedRecord(const string& serialized);
+
+  // Writes the last partial block, the index and the trailer.  The file is
+  // not readable until Close() has returned true.  No further records may
+  // be written.  This does not close or flush the underlying stream.
+  bool Close();
+
+  // Number of records written so far.
+  int64 record_count() const { return record_count_; }
+
+ private:
+  struct BlockInfo {
+    int64 offset;
+    int64 first_record;
+    int record_count;
+  };
+
+  // Appends the size prefix of a record of the given size to pending_ and
+  // returns a pointer to where the record's bytes go.
+  uint8* ReserveRecord(int size);
+  // Counts the record just added and flushes the block if it is full.
+  bool FinishRecord();
+  // Writes pending_ as a block.
+  bool FlushBlock();
+  bool WriteRaw(const void* data, int size);
+
+  ZeroCopyOutputStream* output_;
+  const Options options_;
+  string pending_;          // Delimited records of the current block.
+  int pending_records_;
+  vector<BlockInfo> index_;
+  int64 offset_;            // Bytes written to output_.
+  int64 record_count_;
+  bool had_error_;
+  bool closed_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(RecordFileWriter);
+};
+
+// ===================================================================
+
+// Reads a record file through a file descriptor.  Blocks are read with
+// positioned reads, so after Open() has succeeded ReadBlockRecords() and
+// ScanParallel() may be called from several threads at once.
+// ReadRecord() keeps a cache of the last decoded block and is not
+// thread-safe.
+class LIBPROTOBUF_EXPORT RecordFileReader {
+ public:
+  // Receives the records of each block from ScanParallel().
+  class LIBPROTOBUF_EXPORT BlockVisitor {
+   public:
+    virtual ~BlockVisitor();
+
+    // Called once per block, possibly from several threads at once.  The
+    // records are owned by an Arena which is destroyed when this returns.
+    // first_record is the index of records[0] within the file.  Return
+    // false to stop the scan.
+    virtual bool VisitBlock(int block, int64 first_record,
+                            const vector<MessageLite*>& records) = 0;
+  };
+
+  // The file descriptor must remain open for the life of the reader.
+  explicit RecordFileReader(int file_descriptor);
+  ~RecordFileReader();
+
+  // Reads and verifies the trailer and index.  Returns false if the file is
+  // not a complete record file or the index is corrupt.
+  bool Open();
+
+  // Valid after Open() succeeds.
+  int64 record_count() const { return record_count_; }
+  int block_count() const { return index_.size(); }
+  // Index of the first record in the given block.
+  int64 block_first_record(int block) const;
+
+  // Parses record number index into *message.  Sequential calls continue
+  // from the previous record instead of re-reading the block.  Returns
+  // false if index is out of range, the block is corrupt, or the record
+  // cannot be parsed.
+  bool ReadRecord(int64 index, MessageLite* message);
+
+  // Reads the given block, verifying its checksums, and appends its records
+  // to *records, each created with prototype.New(arena).  If arena is NULL,
+  // the caller takes ownership of the messages.  Returns false on a read,
+  // checksum or parse error.  Thread-safe.
+  bool ReadBlockRecords(int block, const MessageLite& prototype, Arena* arena,
+                        vector<MessageLite*>* records) const;
+
+  // Parses every block on num_threads threads and passes each block's
+  // records to the visitor.  Blocks are handed out in order to whichever
+  // thread is free, and each block is parsed into its own Arena.  Returns
+  // false if any block could not be read or the visitor returned false.
+  // Without thread support in the build, the scan runs on the calling
+  // thread.
+  bool ScanParallel(const MessageLite& prototype, int num_threads,
+                    BlockVisitor* visitor) const;
+
+  // If an I/O error has occurred, this is the errno from that error.
+  // Otherwise, this is zero.  If several concurrent reads fail, this is the
+  // errno of one of them.
+  int GetErrno() const;
+
+ private:
+  struct BlockInfo {
+    int64 offset;        // Offset of the block header.
+    int64 end;           // Offset just past the block's payload.
+    int64 first_record;
+    int record_count;
+  };
+  class ScanState;
+
+  // Reads exactly size bytes at offset into *buffer.  Thread-safe.
+  bool ReadAt(int64 offset, int size, uint8* buffer) const;
+  // Records an I/O error for GetErrno().  Thread-safe.
+  void SetErrno(int error) const;
+  // Reads the block's uncompressed payload into *payload.  Thread-safe.
+  bool ReadBlockPayload(int block, string* payload) const;
+  // Returns the block containing the given record.
+  int FindBlock(int64 index) const;
+
+  const int file_;
+  vector<BlockInfo> index_;
+  int64 record_count_;
+  // ReadAt() runs concurrently under ReadBlockRecords() and ScanParallel(),
+  // so errno_ is guarded by errno_mutex_.
+  mutable Mutex errno_mutex_;
+  mutable int errno_;
+#ifdef _WIN32
+  // Windows has no pread(); seeks and reads are serialized instead.
+  mutable Mutex seek_mutex_;
+#endif
+
+  // ReadRecord() cache.
+  int cached_block_;       // -1 if nothing is cached.
+  string cached_payload_;
+  int64 cached_record_;    // Index of the record at cached_position_.
+  int cached_position_;    // Offset of the next record in cached_payload_.
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(RecordFileReader);
+};
+
+}  // namespace io
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_IO_RECORD_FILE_H__
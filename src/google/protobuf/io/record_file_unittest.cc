@@ -0,0 +1,311 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "config.h"
+
+#ifdef _MSC_VER
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#include <google/protobuf/io/record_file.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <google/protobuf/arena.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/test_util.h>
+#include <google/protobuf/unittest.pb.h>
+#include <google/protobuf/testing/googletest.h>
+#include <google/protobuf/testing/file.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace io {
+namespace {
+
+using protobuf_unittest::TestAllTypes;
+
+#ifndef O_BINARY
+#ifdef _O_BINARY
+#define O_BINARY _O_BINARY
+#else
+#define O_BINARY 0     // If this isn't defined, the platform doesn't need it.
+#endif
+#endif
+
+class RecordFileTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    filename_ = TestTempDir() + "/record_file_test_file";
+    fd_ = -1;
+  }
+
+  virtual void TearDown() {
+    if (fd_ >= 0) close(fd_);
+  }
+
+  TestAllTypes MakeRecord(int i) {
+    TestAllTypes message;
+    if (i % 10 == 0) TestUtil::SetAllFields(&message);
+    message.set_optional_int32(i);
+    message.set_optional_string(string(i % 100, 'a' + i % 26));
+    return message;
+  }
+
+  // Writes records [0, count) to the test file.
+  void WriteFile(int count, const RecordFileWriter::Options& options) {
+    int fd = open(filename_.c_str(),
+                  O_RDWR | O_CREAT | O_TRUNC | O_BINARY, 0777);
+    ASSERT_GE(fd, 0);
+    FileOutputStream output(fd);
+    {
+      RecordFileWriter writer(&output, options);
+      for (int i = 0; i < count; i++) {
+        ASSERT_TRUE(writer.WriteRecord(MakeRecord(i)));
+      }
+      EXPECT_EQ(count, writer.record_count());
+      ASSERT_TRUE(writer.Close());
+    }
+    ASSERT_TRUE(output.Close());
+  }
+
+  RecordFileReader* OpenReader() {
+    if (fd_ >= 0) close(fd_);
+    fd_ = open(filename_.c_str(), O_RDONLY | O_BINARY);
+    GOOGLE_CHECK_GE(fd_, 0);
+    return new RecordFileReader(fd_);
+  }
+
+  void ExpectAllRecords(int count) {
+    scoped_ptr<RecordFileReader> reader(OpenReader());
+    ASSERT_TRUE(reader->Open());
+    ASSERT_EQ(count, reader->record_count());
+    TestAllTypes message;
+    for (int i = 0; i < count; i++) {
+      ASSERT_TRUE(reader->ReadRecord(i, &message)) << i;
+      EXPECT_EQ(MakeRecord(i).SerializeAsString(),
+                message.SerializeAsString()) << i;
+    }
+    EXPECT_FALSE(reader->ReadRecord(count, &message));
+    EXPECT_FALSE(reader->ReadRecord(-1, &message));
+  }
+
+  string filename_;
+  int fd_;
+};
+
+TEST_F(RecordFileTest, WriteAndRead) {
+  RecordFileWriter::Options options;
+  options.block_size = 1024;
+  WriteFile(1000, options);
+  ExpectAllRecords(1000);
+
+  scoped_ptr<RecordFileReader> reader(OpenReader());
+  ASSERT_TRUE(reader->Open());
+  EXPECT_GT(reader->block_count(), 10);
+  EXPECT_EQ(0, reader->block_first_record(0));
+}
+
+TEST_F(RecordFileTest, RandomAccess) {
+  RecordFileWriter::Options options;
+  options.block_size = 512;
+  WriteFile(500, options);
+
+  scoped_ptr<RecordFileReader> reader(OpenReader());
+  ASSERT_TRUE(reader->Open());
+  TestAllTypes message;
+  // Backwards, and jumping around within and across blocks.
+  for (int i = 499; i >= 0; i -= 7) {
+    ASSERT_TRUE(reader->ReadRecord(i, &message)) << i;
+    EXPECT_EQ(i, message.optional_int32());
+  }
+  for (int i = 0; i < 500; i += 3) {
+    ASSERT_TRUE(reader->ReadRecord(i, &message)) << i;
+    EXPECT_EQ(i, message.optional_int32());
+  }
+  ASSERT_TRUE(reader->ReadRecord(250, &message));
+  EXPECT_EQ(250, message.optional_int32());
+}
+
+TEST_F(RecordFileTest, Empty) {
+  WriteFile(0, RecordFileWriter::Options());
+  scoped_ptr<RecordFileReader> reader(OpenReader());
+  ASSERT_TRUE(reader->Open());
+  EXPECT_EQ(0, reader->record_count());
+  EXPECT_EQ(0, reader->block_count());
+  TestAllTypes message;
+  EXPECT_FALSE(reader->ReadRecord(0, &message));
+}
+
+TEST_F(RecordFileTest, LargeRecords) {
+  // Records larger than the block size each get a block of their own.
+  RecordFileWriter::Options options;
+  options.block_size = 16;
+  WriteFile(200, options);
+  ExpectAllRecords(200);
+}
+
+#if HAVE_ZLIB
+TEST_F(RecordFileTest, Compressed) {
+  RecordFileWriter::Options options;
+  options.block_size = 4096;
+  WriteFile(1000, options);
+  string uncompressed;
+  ASSERT_TRUE(File::ReadFileToString(filename_, &uncompressed));
+
+  options.compress = true;
+  WriteFile(1000, options);
+  string compressed;
+  ASSERT_TRUE(File::ReadFileToString(filename_, &compressed));
+  EXPECT_LT(compressed.size(), uncompressed.size() / 2);
+
+  ExpectAllRecords(1000);
+}
+#endif  // HAVE_ZLIB
+
+// Records what ScanParallel() passes to it.
+class CollectingVisitor : public RecordFileReader::BlockVisitor {
+ public:
+  CollectingVisitor() : stop_at_block_(-1) {}
+
+  virtual bool VisitBlock(int block, int64 first_record,
+                          const vector<MessageLite*>& records) {
+    MutexLock lock(&mutex_);
+    for (int i = 0; i < records.size(); i++) {
+      const TestAllTypes* message =
+          static_cast<const TestAllTypes*>(records[i]);
+      EXPECT_EQ(first_record + i, message->optional_int32());
+      EXPECT_TRUE(message->GetArena() != NULL);
+      seen_.push_back(message->optional_int32());
+    }
+    return block != stop_at_block_;
+  }
+
+  Mutex mutex_;
+  vector<int> seen_;
+  int stop_at_block_;
+};
+
+TEST_F(RecordFileTest, ScanParallel) {
+  RecordFileWriter::Options options;
+  options.block_size = 1024;
+  WriteFile(2000, options);
+
+  for (int threads = 1; threads <= 8; threads *= 2) {
+    SCOPED_TRACE(threads);
+    scoped_ptr<RecordFileReader> reader(OpenReader());
+    ASSERT_TRUE(reader->Open());
+    CollectingVisitor visitor;
+    EXPECT_TRUE(reader->ScanParallel(TestAllTypes::default_instance(),
+                                     threads, &visitor));
+    ASSERT_EQ(2000, visitor.seen_.size());
+    sort(visitor.seen_.begin(), visitor.seen_.end());
+    for (int i = 0; i < 2000; i++) {
+      ASSERT_EQ(i, visitor.seen_[i]);
+    }
+  }
+}
+
+TEST_F(RecordFileTest, ScanParallelStops) {
+  RecordFileWriter::Options options;
+  options.block_size = 1024;
+  WriteFile(2000, options);
+
+  scoped_ptr<RecordFileReader> reader(OpenReader());
+  ASSERT_TRUE(reader->Open());
+  CollectingVisitor visitor;
+  visitor.stop_at_block_ = 0;
+  EXPECT_FALSE(reader->ScanParallel(TestAllTypes::default_instance(), 1,
+                                    &visitor));
+  EXPECT_LT(visitor.seen_.size(), 2000);
+}
+
+TEST_F(RecordFileTest, CorruptBlock) {
+  RecordFileWriter::Options options;
+  options.block_size = 1024;
+  WriteFile(1000, options);
+
+  string contents;
+  ASSERT_TRUE(File::ReadFileToString(filename_, &contents));
+  contents[contents.size() / 2] ^= 0x40;
+  ASSERT_TRUE(File::WriteStringToFile(contents, filename_));
+
+  // The index is intact, so the file opens, but exactly one block fails its
+  // checksum.
+  scoped_ptr<RecordFileReader> reader(OpenReader());
+  ASSERT_TRUE(reader->Open());
+  int bad_blocks = 0;
+  for (int i = 0; i < reader->block_count(); i++) {
+    vector<MessageLite*> records;
+    Arena arena;
+    if (!reader->ReadBlockRecords(i, TestAllTypes::default_instance(),
+                                  &arena, &records)) {
+      ++bad_blocks;
+    }
+  }
+  EXPECT_EQ(1, bad_blocks);
+
+  CollectingVisitor visitor;
+  EXPECT_FALSE(reader->ScanParallel(TestAllTypes::default_instance(), 4,
+                                    &visitor));
+}
+
+TEST_F(RecordFileTest, CorruptIndex) {
+  WriteFile(100, RecordFileWriter::Options());
+  string contents;
+  ASSERT_TRUE(File::ReadFileToString(filename_, &contents));
+
+  // Flip a bit in the index, just before the trailer.
+  string corrupt = contents;
+  corrupt[corrupt.size() - 30] ^= 1;
+  ASSERT_TRUE(File::WriteStringToFile(corrupt, filename_));
+  scoped_ptr<RecordFileReader> reader(OpenReader());
+  EXPECT_FALSE(reader->Open());
+
+  // A truncated file has no trailer.
+  ASSERT_TRUE(File::WriteStringToFile(
+      contents.substr(0, contents.size() - 1), filename_));
+  reader.reset(OpenReader());
+  EXPECT_FALSE(reader->Open());
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace protobuf
+}  // namespace google
@@ -40,6 +40,9 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #endif
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
 #include <errno.h>
 #include <iostream>
 #include <algorithm>
@@ -171,6 +174,187 @@ int FileInputStream::CopyingFileInputStream::Skip(int count) {
 
 // ===================================================================
 
+namespace {
+
+// Window size used by MmapInputStream on 32-bit platforms, where mapping a
+// whole multi-gigabyte file could exhaust the address space.
+static const int64 kDefaultMmapWindowSize = 64 << 20;
+
+// How much of each new window MmapInputStream asks the kernel to read
+// ahead immediately.  The rest is left to sequential read-ahead.
+static const int64 kMmapWillNeedSize = 8 << 20;
+
+}  // namespace
+
+MmapInputStream::MmapInputStream(int file_descriptor, int64 window_size)
+  : file_(file_descriptor),
+    close_on_delete_(false),
+    is_closed_(false),
+    errno_(0),
+    start_offset_(0),
+    end_offset_(0),
+    window_size_(window_size),
+    position_(0),
+    map_base_(NULL),
+    map_offset_(0),
+    map_length_(0),
+    last_returned_size_(0) {
+#ifdef _WIN32
+  fallback_.reset(new FileInputStream(file_descriptor));
+#else
+  struct stat info;
+  const off_t offset = lseek(file_, 0, SEEK_CUR);
+  if (offset == (off_t)-1 || fstat(file_, &info) != 0 ||
+      !S_ISREG(info.st_mode)) {
+    // Not a regular file; it can't be mapped.
+    fallback_.reset(new FileInputStream(file_descriptor));
+    return;
+  }
+  start_offset_ = offset;
+  end_offset_ = max<int64>(info.st_size, offset);
+
+  if (window_size_ <= 0) {
+    window_size_ = (sizeof(void*) >= 8) ? end_offset_ : kDefaultMmapWindowSize;
+  }
+  // mmap() offsets must be page-aligned, so windows are whole pages.
+  const int64 page_size = sysconf(_SC_PAGESIZE);
+  window_size_ = max((window_size_ + page_size - 1) / page_size * page_size,
+                     page_size);
+#endif
+}
+
+MmapInputStream::~MmapInputStream() {
+  Unmap();
+  if (fallback_.get() == NULL && close_on_delete_ && !is_closed_) {
+    if (!Close()) {
+      GOOGLE_LOG(ERROR) << "close() failed: " << strerror(errno_);
+    }
+  }
+}
+
+bool MmapInputStream::Close() {
+  if (fallback_.get() != NULL) return fallback_->Close();
+  GOOGLE_CHECK(!is_closed_);
+
+  Unmap();
+  is_closed_ = true;
+  if (close_no_eintr(file_) != 0) {
+    errno_ = errno;
+    return false;
+  }
+  return true;
+}
+
+void MmapInputStream::SetCloseOnDelete(bool value) {
+  if (fallback_.get() != NULL) {
+    fallback_->SetCloseOnDelete(value);
+  } else {
+    close_on_delete_ = value;
+  }
+}
+
+int MmapInputStream::GetErrno() {
+  return fallback_.get() != NULL ? fallback_->GetErrno() : errno_;
+}
+
+bool MmapInputStream::Next(const void** data, int* size) {
+  if (fallback_.get() != NULL) return fallback_->Next(data, size);
+
+  const int64 file_offset = start_offset_ + position_;
+  if (errno_ != 0 || file_offset >= end_offset_) {
+    // At EOF, or the stream is broken.
+    last_returned_size_ = 0;   // Don't let caller back up.
+    return false;
+  }
+  if (map_base_ == NULL || file_offset < map_offset_ ||
+      file_offset >= map_offset_ + map_length_) {
+    if (!MapWindow(file_offset)) {
+      last_returned_size_ = 0;
+      return false;
+    }
+  }
+
+  last_returned_size_ = static_cast<int>(
+      min<int64>(map_offset_ + map_length_ - file_offset, kint32max));
+  *data = map_base_ + (file_offset - map_offset_);
+  *size = last_returned_size_;
+  position_ += last_returned_size_;
+  return true;
+}
+
+void MmapInputStream::BackUp(int count) {
+  if (fallback_.get() != NULL) {
+    fallback_->BackUp(count);
+    return;
+  }
+
+  GOOGLE_CHECK_GT(last_returned_size_, 0)
+      << "BackUp() can only be called after a successful Next().";
+  GOOGLE_CHECK_LE(count, last_returned_size_);
+  GOOGLE_CHECK_GE(count, 0);
+  position_ -= count;
+  last_returned_size_ = 0;  // Don't let caller back up further.
+}
+
+bool MmapInputStream::Skip(int count) {
+  if (fallback_.get() != NULL) return fallback_->Skip(count);
+
+  GOOGLE_CHECK_GE(count, 0);
+  last_returned_size_ = 0;   // Don't let caller back up.
+  const int64 remaining = end_offset_ - start_offset_ - position_;
+  if (count > remaining) {
+    position_ += remaining;
+    return false;
+  }
+  position_ += count;
+  return true;
+}
+
+int64 MmapInputStream::ByteCount() const {
+  if (fallback_.get() != NULL) return fallback_->ByteCount();
+  return position_;
+}
+
+bool MmapInputStream::MapWindow(int64 file_offset) {
+  Unmap();
+#ifdef _WIN32
+  GOOGLE_LOG(FATAL) << "MmapInputStream can't map files on this platform.";
+  return false;
+#else
+  const int64 page_size = sysconf(_SC_PAGESIZE);
+  const int64 aligned_offset = file_offset - file_offset % page_size;
+  const int64 length = min(window_size_, end_offset_ - aligned_offset);
+  void* base = mmap(NULL, length, PROT_READ, MAP_PRIVATE, file_,
+                    aligned_offset);
+  if (base == MAP_FAILED) {
+    errno_ = errno;
+    return false;
+  }
+#ifdef MADV_SEQUENTIAL
+  madvise(base, length, MADV_SEQUENTIAL);
+#endif
+#ifdef MADV_WILLNEED
+  madvise(base, min(length, kMmapWillNeedSize), MADV_WILLNEED);
+#endif
+
+  map_base_ = reinterpret_cast<char*>(base);
+  map_offset_ = aligned_offset;
+  map_length_ = length;
+  return true;
+#endif
+}
+
+void MmapInputStream::Unmap() {
+#ifndef _WIN32
+  if (map_base_ != NULL) {
+    munmap(map_base_, map_length_);
+    map_base_ = NULL;
+  }
+#endif
+}
+
+// ===================================================================
+
 FileOutputStream::FileOutputStream(int file_descriptor, int block_size)
   : copying_output_(file_descriptor),
     impl_(&copying_output_, block_size) {
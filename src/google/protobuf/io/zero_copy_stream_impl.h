@@ -131,6 +131,82 @@ class LIBPROTOBUF_EXPORT FileInputStream : public ZeroCopyInputStream {
 
 // ===================================================================
 
+// A ZeroCopyInputStream which reads a file by mapping it into memory.
+//
+// Unlike FileInputStream, Next() returns pointers directly into the mapping,
+// so the data is never copied by read().  Files larger than the window size
+// are mapped one window at a time; a window is unmapped once the reader
+// moves past it, so the pointer returned by Next() is only valid until the
+// next call to Next(), Skip() or BackUp(), as for any ZeroCopyInputStream.
+// The kernel is told that access is sequential so that it reads ahead and
+// drops pages behind the reader.
+//
+// Reading starts at the descriptor's current offset and continues to the end
+// of the file as it was when the stream was created.  If the descriptor does
+// not refer to a regular file (e.g. a pipe), or memory mapping is not
+// available on this platform, MmapInputStream falls back to reading through
+// a FileInputStream.
+class LIBPROTOBUF_EXPORT MmapInputStream : public ZeroCopyInputStream {
+ public:
+  // Creates a stream that reads from the given Unix file descriptor.  If a
+  // window_size is given, at most that many bytes (rounded up to a whole
+  // number of pages) are mapped at once.  Otherwise the whole file is mapped
+  // on 64-bit platforms and 64MB windows are used on 32-bit ones.
+  explicit MmapInputStream(int file_descriptor, int64 window_size = -1);
+  ~MmapInputStream();
+
+  // Unmaps the file and closes the descriptor.  Returns false if an error
+  // occurs; use GetErrno() to examine the error.
+  bool Close();
+
+  // By default, the file descriptor is not closed when the stream is
+  // destroyed.  Call SetCloseOnDelete(true) to change that.
+  void SetCloseOnDelete(bool value);
+
+  // If an I/O error has occurred, this is the errno from that error.
+  // Otherwise, this is zero.
+  int GetErrno();
+
+  // True if the file is being read through a memory mapping, false if the
+  // stream fell back to read().
+  bool IsMapped() const { return fallback_.get() == NULL; }
+
+  // implements ZeroCopyInputStream ----------------------------------
+  bool Next(const void** data, int* size);
+  void BackUp(int count);
+  bool Skip(int count);
+  int64 ByteCount() const;
+
+ private:
+  // Maps the window containing the given file offset.
+  bool MapWindow(int64 file_offset);
+  void Unmap();
+
+  const int file_;
+  bool close_on_delete_;
+  bool is_closed_;
+  int errno_;
+
+  int64 start_offset_;  // File offset at which reading started.
+  int64 end_offset_;    // Size of the file when the stream was created.
+  int64 window_size_;
+  int64 position_;      // Bytes consumed, relative to start_offset_.
+
+  char* map_base_;      // Current mapping, or NULL.
+  int64 map_offset_;    // File offset of map_base_.
+  int64 map_length_;
+
+  int last_returned_size_;  // How many bytes we returned last time Next()
+                            // was called (used for error checking only).
+
+  // Used instead of the mapping when the file can't be mapped.
+  scoped_ptr<FileInputStream> fallback_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(MmapInputStream);
+};
+
+// ===================================================================
+
 // A ZeroCopyOutputStream which writes to a file descriptor.
 //
 // FileOutputStream is preferred over using an ofstream with
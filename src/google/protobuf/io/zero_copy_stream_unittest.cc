@@ -61,13 +61,18 @@
 #include <sstream>
 
 #include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/io/async_stream.h>
+#include <google/protobuf/io/buffer_chain.h>
 #include <google/protobuf/io/coded_stream.h>
 
 #if HAVE_ZLIB
 #include <google/protobuf/io/gzip_stream.h>
 #endif
 
+#include <google/protobuf/arena.h>
 #include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/stl_util.h>
+#include <google/protobuf/stubs/strutil.h>
 #include <google/protobuf/testing/googletest.h>
 #include <google/protobuf/testing/file.h>
 #include <gtest/gtest.h>
@@ -592,6 +597,176 @@ TEST_F(IoTest, CompressionOptions) {
   EXPECT_TRUE(Uncompress(zlib_compressed) == golden);
 }
 
+TEST_F(IoTest, ParallelGzipIo) {
+  const int kChunkSizes[] = {1, 7, 64, 4096};
+  const int kThreadCounts[] = {0, 1, 3};
+  for (int format = 0; format < 2; format++) {
+    for (int i = 0; i < GOOGLE_ARRAYSIZE(kChunkSizes); i++) {
+      for (int j = 0; j < GOOGLE_ARRAYSIZE(kThreadCounts); j++) {
+        ParallelGzipOutputStream::Options options;
+        options.format =
+            format == 0 ? GzipOutputStream::GZIP : GzipOutputStream::ZLIB;
+        options.chunk_size = kChunkSizes[i];
+        options.num_threads = kThreadCounts[j];
+        string compressed;
+        {
+          StringOutputStream output(&compressed);
+          ParallelGzipOutputStream gzout(&output, options);
+          WriteStuff(&gzout);
+          EXPECT_TRUE(gzout.Close());
+        }
+        {
+          ArrayInputStream input(compressed.data(), compressed.size());
+          GzipInputStream gzin(&input, format == 0 ? GzipInputStream::GZIP
+                                                   : GzipInputStream::ZLIB);
+          ReadStuff(&gzin);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(IoTest, ParallelGzipLarge) {
+  // Text with long-range repetition, so that chunks which were not primed
+  // with the preceding data would compress noticeably worse.
+  string data;
+  for (int i = 0; data.size() < 2 << 20; i++) {
+    data += "record " + SimpleItoa(i % 5000) + " of a long log file\n";
+  }
+
+  string serial = Compress(data, GzipOutputStream::Options());
+
+  ParallelGzipOutputStream::Options options;
+  options.chunk_size = 64 * 1024;
+  string parallel;
+  {
+    StringOutputStream output(&parallel);
+    ParallelGzipOutputStream gzout(&output, options);
+    WriteToOutput(&gzout, data.data(), data.size() / 2);
+    EXPECT_TRUE(gzout.Flush());
+    WriteToOutput(&gzout, data.data() + data.size() / 2,
+                  data.size() - data.size() / 2);
+    EXPECT_EQ(data.size(), gzout.ByteCount());
+    EXPECT_TRUE(gzout.Close());
+  }
+  EXPECT_TRUE(Uncompress(parallel) == data);
+  EXPECT_LT(parallel.size(), serial.size() * 21 / 20);
+}
+
+TEST_F(IoTest, ParallelGzipEmpty) {
+  string compressed;
+  {
+    StringOutputStream output(&compressed);
+    ParallelGzipOutputStream gzout(&output);
+  }
+  EXPECT_EQ("", Uncompress(compressed));
+}
+
+// Text which is compressible, but not so much that the compressed stream
+// has only a few deflate blocks.
+string IndexTestData() {
+  string data;
+  for (int i = 0; data.size() < 1 << 20; i++) {
+    data += "line " + SimpleItoa(i * 7919 % 100003) + " of " +
+            SimpleItoa(i) + "\n";
+  }
+  return data;
+}
+
+TEST_F(IoTest, GzipIndexResume) {
+  const string data = IndexTestData();
+  for (int format = 0; format < 3; format++) {
+    SCOPED_TRACE(format);
+    string compressed;
+    if (format < 2) {
+      GzipOutputStream::Options options;
+      options.format =
+          format == 0 ? GzipOutputStream::GZIP : GzipOutputStream::ZLIB;
+      compressed = Compress(data, options);
+    } else {
+      StringOutputStream output(&compressed);
+      ParallelGzipOutputStream gzout(&output);
+      WriteToOutput(&gzout, data.data(), data.size());
+      EXPECT_TRUE(gzout.Close());
+    }
+
+    GzipIndex index;
+    {
+      ArrayInputStream input(compressed.data(), compressed.size());
+      ASSERT_TRUE(index.Build(&input, 64 * 1024));
+    }
+    EXPECT_EQ(data.size(), index.uncompressed_size());
+    ASSERT_GT(index.checkpoint_count(), 2);
+    EXPECT_EQ(0, index.checkpoint(0).uncompressed_offset);
+
+    // Decompress each range between checkpoints independently.
+    for (int i = 0; i < index.checkpoint_count(); i++) {
+      const int64 begin = index.checkpoint(i).uncompressed_offset;
+      const int64 end = i + 1 < index.checkpoint_count()
+                            ? index.checkpoint(i + 1).uncompressed_offset
+                            : data.size();
+      const int64 input_offset = index.checkpoint_input_offset(i);
+      ArrayInputStream input(compressed.data() + input_offset,
+                             compressed.size() - input_offset, 4096);
+      GzipInputStream gzin(&input, index, i);
+      string range(end - begin, '\0');
+      EXPECT_EQ(range.size(),
+                ReadFromInput(&gzin, string_as_array(&range), range.size()));
+      EXPECT_TRUE(range == data.substr(begin, end - begin)) << i;
+      if (i + 1 == index.checkpoint_count()) {
+        // The stream ends with the compressed data.
+        uint8 byte;
+        EXPECT_EQ(0, ReadFromInput(&gzin, &byte, 1));
+      }
+    }
+  }
+}
+
+TEST_F(IoTest, GzipIndexSerialize) {
+  const string data = IndexTestData();
+  string compressed = Compress(data, GzipOutputStream::Options());
+  GzipIndex index;
+  {
+    ArrayInputStream input(compressed.data(), compressed.size());
+    ASSERT_TRUE(index.Build(&input, 100 * 1024));
+  }
+
+  string serialized;
+  {
+    StringOutputStream output(&serialized);
+    EXPECT_TRUE(index.Serialize(&output));
+  }
+  GzipIndex parsed;
+  {
+    ArrayInputStream input(serialized.data(), serialized.size());
+    ASSERT_TRUE(parsed.Parse(&input));
+  }
+  EXPECT_EQ(index.uncompressed_size(), parsed.uncompressed_size());
+  ASSERT_EQ(index.checkpoint_count(), parsed.checkpoint_count());
+  for (int i = 0; i < index.checkpoint_count(); i++) {
+    EXPECT_EQ(index.checkpoint(i).compressed_offset,
+              parsed.checkpoint(i).compressed_offset);
+    EXPECT_EQ(index.checkpoint(i).bits, parsed.checkpoint(i).bits);
+    EXPECT_EQ(index.checkpoint(i).uncompressed_offset,
+              parsed.checkpoint(i).uncompressed_offset);
+    EXPECT_TRUE(index.checkpoint(i).window == parsed.checkpoint(i).window);
+  }
+  EXPECT_EQ(-1, parsed.FindCheckpoint(-1));
+  EXPECT_EQ(0, parsed.FindCheckpoint(0));
+  EXPECT_EQ(parsed.checkpoint_count() - 1,
+            parsed.FindCheckpoint(data.size()));
+
+  {
+    string truncated = serialized.substr(0, serialized.size() - 1);
+    ArrayInputStream input(truncated.data(), truncated.size());
+    EXPECT_FALSE(parsed.Parse(&input));
+  }
+
+  // Not a compressed stream.
+  ArrayInputStream input(data.data(), data.size());
+  EXPECT_FALSE(index.Build(&input, 1024));
+}
+
 TEST_F(IoTest, TwoSessionWriteGzip) {
   // Test that two concatenated gzip streams can be read correctly
 
@@ -711,6 +886,138 @@ TEST_F(IoTest, StringIo) {
 }
 
 
+TEST_F(IoTest, BufferChainIo) {
+  for (int i = 0; i < kBlockSizeCount; i++) {
+    for (int j = 0; j < kBlockSizeCount; j++) {
+      BufferChain chain;
+      {
+        BufferChainOutputStream output(&chain, kBlockSizes[i]);
+        WriteStuff(&output);
+      }
+      EXPECT_EQ(68, chain.size());
+      for (int k = 0; k < chain.block_count(); k++) {
+        EXPECT_GT(chain.block_size(k), 0);
+      }
+      {
+        BufferChainInputStream input(&chain);
+        ReadStuff(&input);
+      }
+      {
+        string str = chain.ToString();
+        ArrayInputStream input(str.data(), str.size(), kBlockSizes[j]);
+        ReadStuff(&input);
+      }
+    }
+  }
+}
+
+TEST_F(IoTest, BufferChainLarge) {
+  BufferChain chain;
+  {
+    BufferChainOutputStream output(&chain);
+    WriteStuffLarge(&output);
+  }
+  // Blocks grow geometrically, so 200k only needs a handful.
+  EXPECT_LT(chain.block_count(), 16);
+  BufferChainInputStream input(&chain);
+  ReadStuffLarge(&input);
+}
+
+TEST_F(IoTest, BufferChainOnArena) {
+  Arena arena;
+  BufferChain chain(&arena);
+  EXPECT_EQ(&arena, chain.arena());
+  {
+    BufferChainOutputStream output(&chain, 5);
+    WriteStuff(&output);
+  }
+  BufferChainInputStream input(&chain);
+  ReadStuff(&input);
+}
+
+TEST_F(IoTest, BufferChainAliasing) {
+  const string large(100000, 'x');
+  const string small = "small";
+  BufferChain chain;
+  {
+    BufferChainOutputStream output(&chain);
+    EXPECT_TRUE(output.AllowsAliasing());
+    CodedOutputStream coded(&output);
+    coded.EnableAliasing(true);
+    coded.WriteVarint32(large.size());
+    coded.WriteRawMaybeAliased(large.data(), large.size());
+    coded.WriteVarint32(small.size());
+    coded.WriteRawMaybeAliased(small.data(), small.size());
+    EXPECT_FALSE(coded.HadError());
+  }
+
+  // The large string is linked in by reference; the small one is copied.
+  bool found_large = false;
+  for (int i = 0; i < chain.block_count(); i++) {
+    if (chain.block_data(i) == large.data()) {
+      EXPECT_EQ(static_cast<int>(large.size()), chain.block_size(i));
+      found_large = true;
+    }
+    EXPECT_NE(small.data(), chain.block_data(i));
+  }
+  EXPECT_TRUE(found_large);
+
+  BufferChainInputStream input(&chain);
+  CodedInputStream coded(&input);
+  string value;
+  uint32 size;
+  ASSERT_TRUE(coded.ReadVarint32(&size));
+  ASSERT_TRUE(coded.ReadString(&value, size));
+  EXPECT_EQ(large, value);
+  ASSERT_TRUE(coded.ReadVarint32(&size));
+  ASSERT_TRUE(coded.ReadString(&value, size));
+  EXPECT_EQ(small, value);
+  EXPECT_FALSE(coded.ReadVarint32(&size));
+}
+
+TEST_F(IoTest, BufferChainFileIo) {
+  string filename = TestTempDir() + "/zero_copy_stream_test_file";
+
+  // With small blocks the chain needs several writev() calls.
+  for (int i = 0; i < kBlockSizeCount; i++) {
+    int file =
+      open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_BINARY, 0777);
+    ASSERT_GE(file, 0);
+
+    BufferChain chain;
+    {
+      BufferChainOutputStream output(&chain, kBlockSizes[i]);
+      WriteStuffLarge(&output);
+    }
+    int error = 0;
+    EXPECT_TRUE(chain.WriteToFileDescriptor(file, &error));
+    EXPECT_EQ(0, error);
+
+    // Rewind.
+    ASSERT_NE(lseek(file, 0, SEEK_SET), (off_t)-1);
+
+    {
+      FileInputStream input(file);
+      ReadStuffLarge(&input);
+      EXPECT_EQ(0, input.GetErrno());
+    }
+
+    close(file);
+  }
+}
+
+TEST_F(IoTest, BufferChainWriteError) {
+  BufferChain chain;
+  {
+    BufferChainOutputStream output(&chain);
+    WriteStuff(&output);
+  }
+  int error = 0;
+  EXPECT_FALSE(chain.WriteToFileDescriptor(-1, &error));
+  EXPECT_EQ(EBADF, error);
+}
+
+
 // To test files, we create a temporary file, write, read, truncate, repeat.
 TEST_F(IoTest, FileIo) {
   string filename = TestTempDir() + "/zero_copy_stream_test_file";
@@ -775,6 +1082,43 @@ TEST_F(IoTest, GzipFileIo) {
     }
   }
 }
+
+TEST_F(IoTest, SeekableGzipFile) {
+  const string data = IndexTestData();
+  string filename = TestTempDir() + "/zero_copy_stream_test_file";
+  GOOGLE_CHECK_OK(File::SetContents(
+      filename, Compress(data, GzipOutputStream::Options()), true));
+  int file = open(filename.c_str(), O_RDONLY | O_BINARY);
+  ASSERT_GE(file, 0);
+
+  GzipIndex index;
+  {
+    FileInputStream input(file);
+    ASSERT_TRUE(index.Build(&input, 64 * 1024));
+  }
+
+  SeekableGzipInputStream input(file, &index);
+  // Reading starts at the beginning.
+  ReadString(&input, data.substr(0, 100));
+
+  const int64 kOffsets[] = {
+    12345, data.size() / 2, 1, data.size() - 10, 200000
+  };
+  for (int i = 0; i < GOOGLE_ARRAYSIZE(kOffsets); i++) {
+    SCOPED_TRACE(kOffsets[i]);
+    ASSERT_TRUE(input.Seek(kOffsets[i]));
+    ReadString(&input, data.substr(kOffsets[i], 10));
+  }
+
+  ASSERT_TRUE(input.Seek(data.size()));
+  const void* buffer;
+  int size;
+  EXPECT_FALSE(input.Next(&buffer, &size));
+  EXPECT_FALSE(input.Seek(data.size() + 1));
+  EXPECT_EQ(0, input.GetErrno());
+
+  close(file);
+}
 #endif
 
 // MSVC raises various debugging exceptions if we try to use a file
@@ -872,6 +1216,197 @@ TEST_F(IoTest, PipeIo) {
   }
 }
 
+TEST_F(IoTest, MmapIo) {
+  string filename = TestTempDir() + "/zero_copy_stream_test_file";
+  // Whole-file mapping, one page at a time, and a few pages at a time.
+  const int64 kWindowSizes[] = {-1, 1, 3 * 4096};
+
+  for (int i = 0; i < GOOGLE_ARRAYSIZE(kWindowSizes); i++) {
+    int file =
+      open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_BINARY, 0777);
+    ASSERT_GE(file, 0);
+
+    {
+      FileOutputStream output(file);
+      WriteStuffLarge(&output);
+      EXPECT_TRUE(output.Flush());
+    }
+
+    // Rewind.
+    ASSERT_NE(lseek(file, 0, SEEK_SET), (off_t)-1);
+
+    {
+      MmapInputStream input(file, kWindowSizes[i]);
+#ifndef _WIN32
+      EXPECT_TRUE(input.IsMapped());
+#endif
+      ReadStuffLarge(&input);
+      EXPECT_EQ(0, input.GetErrno());
+    }
+
+    close(file);
+  }
+}
+
+TEST_F(IoTest, MmapReturnsWholeFile) {
+  string filename = TestTempDir() + "/zero_copy_stream_test_file";
+  int file =
+    open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_BINARY, 0777);
+  ASSERT_GE(file, 0);
+  {
+    FileOutputStream output(file);
+    WriteStuffLarge(&output);
+  }
+
+  // Start reading part way into the file, at an offset that is not
+  // page-aligned.
+  ASSERT_NE(lseek(file, 13, SEEK_SET), (off_t)-1);
+  {
+    MmapInputStream input(file);
+    if (input.IsMapped()) {
+      // The whole rest of the file comes back from one Next().
+      const void* data;
+      int size;
+      ASSERT_TRUE(input.Next(&data, &size));
+      EXPECT_EQ(200055 - 13, size);
+      EXPECT_EQ("Some te", string(reinterpret_cast<const char*>(data), 7));
+      input.BackUp(size - 7);
+      EXPECT_EQ(7, input.ByteCount());
+      EXPECT_TRUE(input.Skip(size - 7));
+      EXPECT_FALSE(input.Next(&data, &size));
+      EXPECT_FALSE(input.Skip(1));
+    }
+  }
+  close(file);
+}
+
+TEST_F(IoTest, MmapPipeFallsBack) {
+  int files[2];
+  ASSERT_EQ(pipe(files), 0);
+
+  {
+    FileOutputStream output(files[1]);
+    WriteStuff(&output);
+    EXPECT_EQ(0, output.GetErrno());
+  }
+  close(files[1]);  // Send EOF.
+
+  {
+    MmapInputStream input(files[0]);
+    EXPECT_FALSE(input.IsMapped());
+    ReadStuff(&input);
+    EXPECT_EQ(0, input.GetErrno());
+  }
+  close(files[0]);
+}
+
+// CopyingInputStream and CopyingOutputStream over a string, for testing the
+// asynchronous adaptors.  Read() returns at most max_read bytes at a time.
+class StringCopyingInputStream : public CopyingInputStream {
+ public:
+  StringCopyingInputStream(const string& data, int max_read)
+    : data_(data), position_(0), max_read_(max_read) {}
+
+  int Read(void* buffer, int size) {
+    int bytes = min(min(size, max_read_),
+                    static_cast<int>(data_.size()) - position_);
+    memcpy(buffer, data_.data() + position_, bytes);
+    position_ += bytes;
+    return bytes;
+  }
+
+ private:
+  const string data_;
+  int position_;
+  const int max_read_;
+};
+
+class StringCopyingOutputStream : public CopyingOutputStream {
+ public:
+  explicit StringCopyingOutputStream(string* output, int fail_after = -1)
+    : output_(output), fail_after_(fail_after) {}
+
+  bool Write(const void* buffer, int size) {
+    if (fail_after_ >= 0 && output_->size() + size > fail_after_) {
+      return false;
+    }
+    output_->append(reinterpret_cast<const char*>(buffer), size);
+    return true;
+  }
+
+ private:
+  string* output_;
+  const int fail_after_;
+};
+
+TEST_F(IoTest, AsyncIo) {
+  const int kQueueDepths[] = {-1, 1, 8};
+  for (int i = 0; i < kBlockSizeCount; i++) {
+    for (int j = 0; j < kBlockSizeCount; j++) {
+      for (int k = 0; k < GOOGLE_ARRAYSIZE(kQueueDepths); k++) {
+        string str;
+        {
+          StringCopyingOutputStream copying_output(&str);
+          AsyncCopyingOutputStreamAdaptor output(
+              &copying_output, kBlockSizes[i], kQueueDepths[k]);
+          WriteStuff(&output);
+          EXPECT_TRUE(output.Flush());
+        }
+        EXPECT_EQ(68, str.size());
+        {
+          StringCopyingInputStream copying_input(str, 11);
+          AsyncCopyingInputStreamAdaptor input(
+              &copying_input, kBlockSizes[j], kQueueDepths[k]);
+          ReadStuff(&input);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(IoTest, AsyncIoLarge) {
+  string str;
+  {
+    AsyncCopyingOutputStreamAdaptor output(
+        new StringCopyingOutputStream(&str));
+    output.SetOwnsCopyingStream(true);
+    WriteStuffLarge(&output);
+  }
+  {
+    AsyncCopyingInputStreamAdaptor input(
+        new StringCopyingInputStream(str, 4096));
+    input.SetOwnsCopyingStream(true);
+    ReadStuffLarge(&input);
+  }
+}
+
+TEST_F(IoTest, AsyncIoAbandonedInput) {
+  // Destroying the adaptor before reading everything stops the read-ahead.
+  string str(1 << 20, 'x');
+  StringCopyingInputStream copying_input(str, 1024);
+  AsyncCopyingInputStreamAdaptor input(&copying_input, 1024, 4);
+  const void* data;
+  int size;
+  ASSERT_TRUE(input.Next(&data, &size));
+  EXPECT_EQ(1024, size);
+}
+
+TEST_F(IoTest, AsyncIoWriteError) {
+  string str;
+  StringCopyingOutputStream copying_output(&str, 100);
+  AsyncCopyingOutputStreamAdaptor output(&copying_output, 64);
+  void* data;
+  int size;
+  ASSERT_TRUE(output.Next(&data, &size));
+  memset(data, 'a', size);
+  EXPECT_TRUE(output.Flush());
+  ASSERT_TRUE(output.Next(&data, &size));
+  memset(data, 'b', size);
+  EXPECT_FALSE(output.Flush());
+  EXPECT_FALSE(output.Next(&data, &size));
+  EXPECT_EQ(string(64, 'a'), str);
+}
+
 // Test using C++ iostreams.
 TEST_F(IoTest, IostreamIo) {
   for (int i = 0; i < kBlockSizeCount; i++) {
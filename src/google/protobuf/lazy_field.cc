@@ -0,0 +1,233 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <google/protobuf/lazy_field.h>
+
+#include <google/protobuf/arena.h>
+#include <google/protobuf/generated_message_util.h>
+#include <google/protobuf/message_lite.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite_inl.h>
+
+namespace google {
+namespace protobuf {
+namespace internal {
+
+LazyField::LazyField()
+    : message_(0), raw_is_current_(true), arena_(NULL) {}
+
+LazyField::LazyField(::google::protobuf::Arena* arena)
+    : message_(0), raw_is_current_(true), arena_(arena) {}
+
+LazyField::~LazyField() {
+  if (arena_ == NULL) {
+    delete parsed_message();
+  }
+}
+
+MessageLite* LazyField::ParseIfNeeded(const MessageLite& prototype) const {
+  MessageLite* result = parsed_message();
+  if (result != NULL) return result;
+
+  // Several const callers may race to get here.  Each parses its own copy
+  // and only the first to publish it wins; raw_ is not modified, so this is
+  // safe.
+  MessageLite* parsed = prototype.New(arena_);
+  parsed->ParsePartialFromString(raw_);
+  AtomicWord previous = Release_CompareAndSwap(
+      &message_, 0, reinterpret_cast<AtomicWord>(parsed));
+  if (previous != 0) {
+    if (arena_ == NULL) {
+      delete parsed;
+    }
+    return reinterpret_cast<MessageLite*>(previous);
+  }
+  return parsed;
+}
+
+void LazyField::DiscardRaw() {
+  raw_is_current_ = false;
+  string().swap(raw_);
+}
+
+ExtensionSet::LazyMessageExtension* LazyField::New(
+    ::google::protobuf::Arena* arena) const {
+  return Arena::Create<LazyField>(arena, arena);
+}
+
+const MessageLite& LazyField::GetMessage(const MessageLite& prototype) const {
+  return *ParseIfNeeded(prototype);
+}
+
+MessageLite* LazyField::MutableMessage(const MessageLite& prototype) {
+  MessageLite* result = ParseIfNeeded(prototype);
+  DiscardRaw();
+  return result;
+}
+
+void LazyField::SetAllocatedMessage(MessageLite* message) {
+  MessageLite* old_message = parsed_message();
+  if (arena_ == NULL) {
+    delete old_message;
+  }
+  if (message->GetArena() != arena_) {
+    MessageLite* copy = message->New(arena_);
+    copy->CheckTypeAndMergeFrom(*message);
+    if (message->GetArena() == NULL) {
+      delete message;
+    }
+    message = copy;
+  }
+  message_ = reinterpret_cast<AtomicWord>(message);
+  DiscardRaw();
+}
+
+MessageLite* LazyField::ReleaseMessage(const MessageLite& prototype) {
+  MessageLite* result = UnsafeArenaReleaseMessage(prototype);
+  if (arena_ != NULL) {
+    // ReleaseMessage() always returns a heap-allocated message.
+    MessageLite* copy = result->New();
+    copy->CheckTypeAndMergeFrom(*result);
+    result = copy;
+  }
+  return result;
+}
+
+MessageLite* LazyField::UnsafeArenaReleaseMessage(
+    const MessageLite& prototype) {
+  MessageLite* result = ParseIfNeeded(prototype);
+  message_ = 0;
+  raw_.clear();
+  raw_is_current_ = true;
+  return result;
+}
+
+bool LazyField::IsInitialized() const {
+  // We never check required fields of lazy messages; see the class comment.
+  return true;
+}
+
+int LazyField::ByteSize() const {
+  if (raw_is_current_) {
+    return raw_.size();
+  } else {
+    return parsed_message()->ByteSize();
+  }
+}
+
+int LazyField::SpaceUsed() const {
+  return sizeof(*this) + StringSpaceUsedExcludingSelf(raw_);
+}
+
+void LazyField::MergeFrom(const ExtensionSet::LazyMessageExtension& other) {
+  const LazyField& other_field = down_cast<const LazyField&>(other);
+  if (this == &other_field) return;
+  MessageLite* this_message = parsed_message();
+  MessageLite* other_message = other_field.parsed_message();
+
+  if (raw_is_current_ && other_field.raw_is_current_ &&
+      this_message == NULL) {
+    // Concatenating two serialized messages merges them, so nothing needs
+    // to be parsed.
+    raw_.append(other_field.raw_);
+  } else if (this_message != NULL) {
+    if (other_field.raw_is_current_) {
+      io::CodedInputStream input(
+          reinterpret_cast<const uint8*>(other_field.raw_.data()),
+          other_field.raw_.size());
+      this_message->MergePartialFromCodedStream(&input);
+    } else {
+      this_message->CheckTypeAndMergeFrom(*other_message);
+    }
+    DiscardRaw();
+  } else {
+    // this is raw and other has been modified, so other_message is set;
+    // use it as the prototype.
+    MutableMessage(*other_message)->CheckTypeAndMergeFrom(*other_message);
+  }
+}
+
+void LazyField::Clear() {
+  MessageLite* current = parsed_message();
+  if (current != NULL) {
+    // Keep the message object, since references to it may have been
+    // handed out.
+    current->Clear();
+  }
+  raw_.clear();
+  raw_is_current_ = true;
+}
+
+bool LazyField::ReadMessage(const MessageLite& prototype,
+                            io::CodedInputStream* input) {
+  if (!raw_is_current_ || parsed_message() != NULL) {
+    // Already parsed; merge into the parsed message.
+    return WireFormatLite::ReadMessage(input, MutableMessage(prototype));
+  }
+  uint32 length;
+  if (!input->ReadVarint32(&length)) return false;
+  if (raw_.empty()) {
+    return input->ReadString(&raw_, length);
+  }
+  // A repeated occurrence of a singular message field is merged into the
+  // previous one, which for serialized messages means appending.
+  string more;
+  if (!input->ReadString(&more, length)) return false;
+  raw_.append(more);
+  return true;
+}
+
+void LazyField::WriteMessage(int number,
+                             io::CodedOutputStream* output) const {
+  if (raw_is_current_) {
+    WireFormatLite::WriteTag(number, WireFormatLite::WIRETYPE_LENGTH_DELIMITED,
+                             output);
+    output->WriteVarint32(raw_.size());
+    output->WriteString(raw_);
+  } else {
+    WireFormatLite::WriteMessage(number, *parsed_message(), output);
+  }
+}
+
+uint8* LazyField::WriteMessageToArray(int number, uint8* target) const {
+  if (raw_is_current_) {
+    target = WireFormatLite::WriteTagToArray(
+        number, WireFormatLite::WIRETYPE_LENGTH_DELIMITED, target);
+    target = io::CodedOutputStream::WriteVarint32ToArray(raw_.size(), target);
+    return io::CodedOutputStream::WriteStringToArray(raw_, target);
+  } else {
+    return WireFormatLite::WriteMessageToArray(number, *parsed_message(), target);
+  }
+}
+
+}  // namespace internal
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,144 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// This header is internal to the protocol buffer library.
+
+#ifndef GOOGLE_PROTOBUF_LAZY_FIELD_H__
+#define GOOGLE_PROTOBUF_LAZY_FIELD_H__
+
+#include <string>
+
+#include <google/protobuf/stubs/atomicops.h>
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/extension_set.h>
+
+namespace google {
+namespace protobuf {
+class Arena;
+class MessageLite;
+namespace io {
+class CodedInputStream;
+class CodedOutputStream;
+}  // namespace io
+}  // namespace protobuf
+
+namespace protobuf {
+namespace internal {
+
+// LazyField holds a singular message-typed field in serialized form until
+// it is first accessed.  Parsing only copies the field's bytes; they are
+// parsed into a message the first time the message itself is requested, and
+// are written back out untouched if the field is serialized without having
+// been modified.  This makes it cheap to parse messages with large
+// sub-messages that most readers never look at.
+//
+// Const accessors are safe to call concurrently: the first one to need the
+// parsed message builds it and publishes it with an atomic compare-and-swap.
+// Non-const methods require exclusive access as usual.
+//
+// As permitted by the [lazy=true] contract in descriptor.proto, LazyField
+// never checks required fields of the message it holds, so IsInitialized()
+// always returns true.  Malformed bytes are likewise only noticed when the
+// message is first accessed, at which point the message holds whatever
+// could be parsed.
+//
+// Currently only used for extensions; see ExtensionSet::ParseField().
+class LIBPROTOBUF_EXPORT LazyField : public ExtensionSet::LazyMessageExtension {
+ public:
+  LazyField();
+  explicit LazyField(::google::protobuf::Arena* arena);
+  virtual ~LazyField();
+
+  // True if the field is still held in serialized form, i.e. it has never
+  // been parsed or has not been modified since it was.
+  bool IsRaw() const { return raw_is_current_; }
+
+  // Returns the parsed message, or NULL if the field has not been parsed.
+  const MessageLite* ParsedMessageOrNull() const { return parsed_message(); }
+
+  // Implements ExtensionSet::LazyMessageExtension -------------------
+
+  virtual ExtensionSet::LazyMessageExtension* New(
+      ::google::protobuf::Arena* arena) const;
+  virtual const MessageLite& GetMessage(const MessageLite& prototype) const;
+  virtual MessageLite* MutableMessage(const MessageLite& prototype);
+  virtual void SetAllocatedMessage(MessageLite* message);
+  virtual MessageLite* ReleaseMessage(const MessageLite& prototype);
+  virtual MessageLite* UnsafeArenaReleaseMessage(const MessageLite& prototype);
+
+  virtual bool IsInitialized() const;
+  virtual int ByteSize() const;
+  // Counts this object and the serialized bytes only.  MessageLite cannot
+  // report its memory use, so ExtensionSet::SpaceUsedExcludingSelf() adds
+  // the parsed message, if any, itself.
+  virtual int SpaceUsed() const;
+
+  virtual void MergeFrom(const ExtensionSet::LazyMessageExtension& other);
+  virtual void Clear();
+
+  virtual bool ReadMessage(const MessageLite& prototype,
+                           io::CodedInputStream* input);
+  virtual void WriteMessage(int number, io::CodedOutputStream* output) const;
+  virtual uint8* WriteMessageToArray(int number, uint8* target) const;
+
+ private:
+  // Returns the parsed message, or NULL if it has not been parsed yet.
+  MessageLite* parsed_message() const {
+    return reinterpret_cast<MessageLite*>(Acquire_Load(&message_));
+  }
+
+  // Returns the parsed message, parsing raw_ into a new message first if
+  // needed.
+  MessageLite* ParseIfNeeded(const MessageLite& prototype) const;
+
+  // Frees the serialized bytes after the parsed message has become the only
+  // valid copy of the field.
+  void DiscardRaw();
+
+  // The serialized message.  Only meaningful while raw_is_current_.
+  string raw_;
+  // The parsed message (a MessageLite*), or NULL.  Written at most once by
+  // const methods, so it is accessed atomically.
+  mutable AtomicWord message_;
+  // If true, raw_ holds the current value of the field, and message_, if
+  // set, is an unmodified parse of it.  If false, message_ is set and is the
+  // only valid copy.
+  bool raw_is_current_;
+  ::google::protobuf::Arena* arena_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(LazyField);
+};
+
+}  // namespace internal
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_LAZY_FIELD_H__
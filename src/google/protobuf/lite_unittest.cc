@@ -345,6 +345,21 @@ int main(int argc, char* argv[]) {
     GOOGLE_CHECK_EQ(0, empty_message.unknown_fields().size());
   }
 
+  {
+    // Test SpaceUsedLong() without reflection.
+    protobuf_unittest::TestAllTypesLite message;
+    GOOGLE_CHECK_EQ(sizeof(message), message.SpaceUsedLong());
+    google::protobuf::TestUtilLite::SetAllFields(&message);
+    size_t full_size = message.SpaceUsedLong();
+    GOOGLE_CHECK_GT(full_size, sizeof(message));
+    message.add_repeated_string("a string long enough to live on the heap");
+    GOOGLE_CHECK_GT(message.SpaceUsedLong(), full_size);
+
+    protobuf_unittest::TestEmptyMessageLite empty_message;
+    SetAllTypesInEmptyMessageUnknownFields(&empty_message);
+    GOOGLE_CHECK_GT(empty_message.SpaceUsedLong(), sizeof(empty_message));
+  }
+
   cout << "PASS" << endl;
   return 0;
 }
@@ -107,6 +107,15 @@ class Map {
     insert(other.begin(), other.end());
   }
 
+#if LANG_CXX11
+  // Moving takes over the other map's elements without copying them; the
+  // moved-from map is left empty.
+  Map(Map&& other) noexcept
+      : default_enum_value_(other.default_enum_value_) {
+    elements_.swap(other.elements_);
+  }
+#endif
+
   ~Map() { clear(); }
 
   // Iterators
@@ -291,6 +300,16 @@ class Map {
     return *this;
   }
 
+#if LANG_CXX11
+  Map& operator=(Map&& other) noexcept {
+    if (this != &other) {
+      clear();
+      elements_.swap(other.elements_);
+    }
+    return *this;
+  }
+#endif
+
  private:
   // Set default enum value only for proto2 map field whose value is enum type.
   void SetDefaultEnumValue(int default_enum_value) {
@@ -197,10 +197,46 @@ class MapField : public MapFieldBase {
   // take the ownership.
   EntryType* NewEntryWrapper(const Key& key, const T& t) const;
 
+  // Used in the implementation of parsing. Reads one length-delimited entry
+  // into the map without materializing a MapEntry for it.
+  bool MergeEntryFromCodedStream(io::CodedInputStream* input);
+  // Used in the implementation of ByteSize(). Returns the size of one entry,
+  // excluding its tag and length prefix.
+  static int EntryByteSize(const Key& key, const T& t);
+  // Used in the implementation of serializing. Writes one entry as a
+  // length-delimited field, relying on sizes cached by EntryByteSize().
+  static void SerializeEntry(int field_number, const Key& key, const T& t,
+                             io::CodedOutputStream* output);
+  static uint8* SerializeEntryToArray(int field_number, const Key& key,
+                                      const T& t, uint8* target);
+  // Used in the implementation of InternalSerializeReverse(). Prepends one
+  // entry without computing or caching any sizes.
+  static void SerializeEntryReverse(int field_number, const Key& key,
+                                    const T& t,
+                                    io::ReverseCodedBuffer* output);
+  // Like calling SerializeEntry() on each element of the map, but in key
+  // order.  Used when the stream asks for deterministic serialization; only
+  // pointers to the map's elements are sorted, not the elements themselves.
+  static void SerializeSortedEntries(int field_number, const Map<Key, T>& map,
+                                     io::CodedOutputStream* output);
+
  private:
   // MapField needs MapEntry's default instance to create new MapEntry.
   void InitDefaultEntryOnce() const;
 
+  // Tags of the key and value fields inside an entry.
+  static const uint8 kKeyTag = GOOGLE_PROTOBUF_WIRE_FORMAT_MAKE_TAG(
+      EntryType::kKeyFieldNumber, KeyProtoHandler::kWireType);
+  static const uint8 kValueTag = GOOGLE_PROTOBUF_WIRE_FORMAT_MAKE_TAG(
+      EntryType::kValueFieldNumber, ValueProtoHandler::kWireType);
+  static const int kTagSize = 1;
+
+  // Parses the fields of one entry, with the same rules as
+  // MapEntry::MergePartialFromCodedStream().
+  static bool MergeEntryFields(io::CodedInputStream* input, KeyCpp* key,
+                               ValCpp* value);
+  static int EntryCachedSize(const Key& key, const T& t);
+
   // Convenient methods to get internal google::protobuf::Map
   const Map<Key, T>& GetInternalMap() const;
   Map<Key, T>* MutableInternalMap();
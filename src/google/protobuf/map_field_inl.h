@@ -31,10 +31,12 @@
 #ifndef GOOGLE_PROTOBUF_MAP_FIELD_INL_H__
 #define GOOGLE_PROTOBUF_MAP_FIELD_INL_H__
 
+#include <algorithm>
 #include <memory>
 #ifndef _SHARED_PTR_H
 #include <google/protobuf/stubs/shared_ptr.h>
 #endif
+#include <vector>
 
 #include <google/protobuf/map_field.h>
 #include <google/protobuf/map_type_handler.h>
@@ -174,6 +176,159 @@ MapField<Key, T, KeyProto, ValueProto, default_enum_value>::NewEnumEntryWrapper(
   return EntryType::EnumWrap(key, t);
 }
 
+// Moves a value parsed by MapField::MergeEntryFromCodedStream() into the map.
+// Enum values are parsed as int and need a cast; every other type is stored
+// as parsed and can be swapped in.
+template <typename From, typename To>
+struct MapValueMover {
+  static inline void Move(From* from, To* to) { *to = static_cast<To>(*from); }
+};
+
+template <typename Type>
+struct MapValueMover<Type, Type> {
+  static inline void Move(Type* from, Type* to) {
+    MapCppTypeHandler<Type>::Move(from, to);
+  }
+};
+
+template <typename Key, typename T, FieldDescriptor::Type KeyProto,
+          FieldDescriptor::Type ValueProto, int default_enum_value>
+bool MapField<Key, T, KeyProto, ValueProto, default_enum_value>::
+    MergeEntryFromCodedStream(io::CodedInputStream* input) {
+  // The key and value are parsed into locals and then moved into the map
+  // node, instead of going through a heap-allocated MapEntry whose fields
+  // are copied out afterwards.
+  uint32 length;
+  if (!input->ReadVarint32(&length)) return false;
+  if (!input->IncrementRecursionDepth()) return false;
+  io::CodedInputStream::Limit limit = input->PushLimit(length);
+
+  KeyCpp key = KeyCpp();
+  ValCpp value = ValCpp();
+  MapValueInitializer<kIsValueEnum, ValCpp>::Initialize(value,
+                                                        default_enum_value);
+  if (!MergeEntryFields(input, &key, &value)) return false;
+  if (!input->ConsumedEntireMessage()) return false;
+  input->PopLimit(limit);
+  input->DecrementRecursionDepth();
+
+  MapValueMover<ValCpp, T>::Move(&value, &(*MutableMap())[key]);
+  return true;
+}
+
+template <typename Key, typename T, FieldDescriptor::Type KeyProto,
+          FieldDescriptor::Type ValueProto, int default_enum_value>
+bool MapField<Key, T, KeyProto, ValueProto, default_enum_value>::
+    MergeEntryFields(io::CodedInputStream* input, KeyCpp* key, ValCpp* value) {
+  for (;;) {
+    uint32 tag = input->ReadTag();
+    switch (tag) {
+      case kKeyTag:
+        if (!KeyProtoHandler::Read(input, key)) return false;
+        if (!input->ExpectTag(kValueTag)) break;
+        GOOGLE_FALLTHROUGH_INTENDED;
+
+      case kValueTag:
+        if (!ValueProtoHandler::Read(input, value)) return false;
+        if (input->ExpectAtEnd()) return true;
+        break;
+
+      default:
+        if (tag == 0 ||
+            WireFormatLite::GetTagWireType(tag) ==
+            WireFormatLite::WIRETYPE_END_GROUP) {
+          return true;
+        }
+        if (!WireFormatLite::SkipField(input, tag)) return false;
+        break;
+    }
+  }
+}
+
+template <typename Key, typename T, FieldDescriptor::Type KeyProto,
+          FieldDescriptor::Type ValueProto, int default_enum_value>
+int MapField<Key, T, KeyProto, ValueProto, default_enum_value>::EntryByteSize(
+    const Key& key, const T& t) {
+  // Like MapEntry, always counts both the key and the value.
+  return kTagSize + KeyProtoHandler::ByteSize(key) +
+         kTagSize + ValueProtoHandler::ByteSize(t);
+}
+
+template <typename Key, typename T, FieldDescriptor::Type KeyProto,
+          FieldDescriptor::Type ValueProto, int default_enum_value>
+int MapField<Key, T, KeyProto, ValueProto, default_enum_value>::
+    EntryCachedSize(const Key& key, const T& t) {
+  return kTagSize + KeyProtoHandler::GetCachedSize(key) +
+         kTagSize + ValueProtoHandler::GetCachedSize(t);
+}
+
+template <typename Key, typename T, FieldDescriptor::Type KeyProto,
+          FieldDescriptor::Type ValueProto, int default_enum_value>
+void MapField<Key, T, KeyProto, ValueProto, default_enum_value>::
+    SerializeEntry(int field_number, const Key& key, const T& t,
+                   io::CodedOutputStream* output) {
+  WireFormatLite::WriteTag(field_number,
+                           WireFormatLite::WIRETYPE_LENGTH_DELIMITED, output);
+  output->WriteVarint32(EntryCachedSize(key, t));
+  KeyProtoHandler::Write(EntryType::kKeyFieldNumber, key, output);
+  ValueProtoHandler::Write(EntryType::kValueFieldNumber, t, output);
+}
+
+template <typename Key, typename T, FieldDescriptor::Type KeyProto,
+          FieldDescriptor::Type ValueProto, int default_enum_value>
+uint8* MapField<Key, T, KeyProto, ValueProto, default_enum_value>::
+    SerializeEntryToArray(int field_number, const Key& key, const T& t,
+                          uint8* target) {
+  target = WireFormatLite::WriteTagToArray(
+      field_number, WireFormatLite::WIRETYPE_LENGTH_DELIMITED, target);
+  target = io::CodedOutputStream::WriteVarint32ToArray(
+      EntryCachedSize(key, t), target);
+  target = KeyProtoHandler::WriteToArray(EntryType::kKeyFieldNumber, key,
+                                         target);
+  return ValueProtoHandler::WriteToArray(EntryType::kValueFieldNumber, t,
+                                         target);
+}
+
+template <typename Key, typename T, FieldDescriptor::Type KeyProto,
+          FieldDescriptor::Type ValueProto, int default_enum_value>
+void MapField<Key, T, KeyProto, ValueProto, default_enum_value>::
+    SerializeEntryReverse(int field_number, const Key& key, const T& t,
+                          io::ReverseCodedBuffer* output) {
+  const int end = output->ByteCount();
+  ValueProtoHandler::WriteReverse(EntryType::kValueFieldNumber, t, output);
+  KeyProtoHandler::WriteReverse(EntryType::kKeyFieldNumber, key, output);
+  output->WriteVarint32(output->ByteCount() - end);
+  output->WriteTag(WireFormatLite::MakeTag(
+      field_number, WireFormatLite::WIRETYPE_LENGTH_DELIMITED));
+}
+
+// Orders pointers to map elements by key.  Integer keys compare
+// numerically and string keys bytewise, so the result does not depend on
+// how the map hashes.
+template <typename Key, typename T>
+struct MapPairPtrLess {
+  bool operator()(const MapPair<Key, T>* a, const MapPair<Key, T>* b) const {
+    return a->first < b->first;
+  }
+};
+
+template <typename Key, typename T, FieldDescriptor::Type KeyProto,
+          FieldDescriptor::Type ValueProto, int default_enum_value>
+void MapField<Key, T, KeyProto, ValueProto, default_enum_value>::
+    SerializeSortedEntries(int field_number, const Map<Key, T>& map,
+                           io::CodedOutputStream* output) {
+  std::vector<const MapPair<Key, T>*> items;
+  items.reserve(map.size());
+  for (typename Map<Key, T>::const_iterator it = map.begin();
+       it != map.end(); ++it) {
+    items.push_back(&*it);
+  }
+  std::sort(items.begin(), items.end(), MapPairPtrLess<Key, T>());
+  for (size_t i = 0; i < items.size(); i++) {
+    SerializeEntry(field_number, items[i]->first, items[i]->second, output);
+  }
+}
+
 template <typename Key, typename T, FieldDescriptor::Type KeyProto,
           FieldDescriptor::Type ValueProto, int default_enum_value>
 const Map<Key, T>& MapField<Key, T, KeyProto, ValueProto,
@@ -34,9 +34,11 @@
 #include <google/protobuf/stubs/shared_ptr.h>
 #endif
 #include <sstream>
+#include <utility>
 
 #include <google/protobuf/stubs/casts.h>
 #include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/stl_util.h>
 #include <google/protobuf/stubs/stringprintf.h>
 #include <google/protobuf/testing/file.h>
 #include <google/protobuf/map_lite_unittest.pb.h>
@@ -505,6 +507,58 @@ TEST_F(MapImplTest, Assigner) {
   EXPECT_EQ(value2, other.at(key2));
 }
 
+#if LANG_CXX11
+TEST_F(MapImplTest, MoveConstructor) {
+  int32 key1 = 0;
+  int32 key2 = 1;
+  int32 value1 = 100;
+  int32 value2 = 101;
+
+  map_[key1] = value1;
+  map_[key2] = value2;
+  const int32* value1_ptr = &map_[key1];
+
+  Map<int32, int32> other(std::move(map_));
+
+  EXPECT_EQ(2, other.size());
+  EXPECT_EQ(value1, other.at(key1));
+  EXPECT_EQ(value2, other.at(key2));
+  // The elements are taken over, not copied.
+  EXPECT_EQ(value1_ptr, &other.at(key1));
+  EXPECT_TRUE(map_.empty());
+}
+
+TEST_F(MapImplTest, MoveAssigner) {
+  int32 key1 = 0;
+  int32 key2 = 1;
+  int32 value1 = 100;
+  int32 value2 = 101;
+
+  map_[key1] = value1;
+  map_[key2] = value2;
+  const int32* value1_ptr = &map_[key1];
+
+  Map<int32, int32> other;
+  int32 key_other = 123;
+  int32 value_other = 321;
+  other[key_other] = value_other;
+
+  other = std::move(map_);
+
+  EXPECT_EQ(2, other.size());
+  EXPECT_EQ(value1, other.at(key1));
+  EXPECT_EQ(value2, other.at(key2));
+  EXPECT_EQ(value1_ptr, &other.at(key1));
+  EXPECT_TRUE(other.find(key_other) == other.end());
+
+  // Self move leaves the map intact.
+  Map<int32, int32>* p = &other;
+  other = std::move(*p);
+  EXPECT_EQ(2, other.size());
+  EXPECT_EQ(value1, other.at(key1));
+}
+#endif  // LANG_CXX11
+
 TEST_F(MapImplTest, Rehash) {
   const int test_size = 50;
   std::map<int32, int32> reference_map;
@@ -1737,6 +1791,141 @@ TEST(GeneratedMapFieldTest, CorruptedWireFormat) {
   EXPECT_FALSE(message.ParseFromString(data));
 }
 
+TEST(GeneratedMapFieldTest, DuplicatedEntryReplacesMessageValue) {
+  unittest::TestMap message;
+
+  // Two entries with key 1; only the first one has a value.
+  string data = "\x8A\x01\x06\x08\x01\x12\x02\x08\x05"
+                "\x8A\x01\x02\x08\x01";
+
+  EXPECT_TRUE(message.ParseFromString(data));
+  EXPECT_EQ(1, message.map_int32_foreign_message().size());
+  EXPECT_FALSE(message.map_int32_foreign_message().at(1).has_c());
+}
+
+TEST(GeneratedMapFieldTest, UnorderedStringWireFormat) {
+  unittest::TestMap message;
+
+  // Value before key, followed by an unknown field.
+  string data = "\x72\x09\x12\x02v1\x0A\x01k\x18\x01";
+
+  EXPECT_TRUE(message.ParseFromString(data));
+  EXPECT_EQ(1, message.map_string_string().size());
+  EXPECT_EQ("v1", message.map_string_string().at("k"));
+}
+
+TEST(GeneratedMapFieldTest, DeterministicSerialization) {
+  unittest::TestMap message;
+  (*message.mutable_map_int32_int32())[3] = 3;
+  (*message.mutable_map_int32_int32())[1] = 1;
+  (*message.mutable_map_int32_int32())[2] = 2;
+
+  string data;
+  {
+    io::StringOutputStream raw_output(&data);
+    io::CodedOutputStream output(&raw_output);
+    output.SetSerializationDeterministic(true);
+    ASSERT_TRUE(message.SerializeToCodedStream(&output));
+  }
+
+  EXPECT_TRUE(data == string("\x0A\x04\x08\x01\x10\x01"
+                             "\x0A\x04\x08\x02\x10\x02"
+                             "\x0A\x04\x08\x03\x10\x03", 18));
+}
+
+TEST(GeneratedMapFieldTest, DeterministicSerializationIgnoresInsertionOrder) {
+  unittest::TestMessageMap message1, message2;
+  for (int i = 0; i < 100; i++) {
+    unittest::TestAllTypes* value1 =
+        &(*message1.mutable_map_int32_message())[i];
+    unittest::TestAllTypes* value2 =
+        &(*message2.mutable_map_int32_message())[99 - i];
+    value1->set_optional_int32(i);
+    value2->set_optional_int32(99 - i);
+  }
+
+  string data1, data2;
+  {
+    io::StringOutputStream raw_output(&data1);
+    io::CodedOutputStream output(&raw_output);
+    output.SetSerializationDeterministic(true);
+    ASSERT_TRUE(message1.SerializeToCodedStream(&output));
+  }
+  {
+    io::StringOutputStream raw_output(&data2);
+    io::CodedOutputStream output(&raw_output);
+    output.SetSerializationDeterministic(true);
+    ASSERT_TRUE(message2.SerializeToCodedStream(&output));
+  }
+
+  EXPECT_TRUE(data1 == data2);
+  EXPECT_EQ(message1.ByteSize(), static_cast<int>(data1.size()));
+}
+
+#ifdef PROTOBUF_HAS_DEATH_TEST
+// Returns true if SerializeToString() and SerializeToArray() order map
+// entries by key once deterministic output is the process default.
+bool SerializesDeterministicallyByDefault() {
+  unittest::TestMap message1, message2;
+  for (int i = 0; i < 100; i++) {
+    (*message1.mutable_map_int32_int32())[i] = i;
+    (*message2.mutable_map_int32_int32())[99 - i] = 99 - i;
+  }
+
+  io::CodedOutputStream::SetDefaultSerializationDeterministic();
+  string data1 = message1.SerializeAsString();
+  string data2 = message2.SerializeAsString();
+  string array_data(message1.ByteSize(), '\0');
+  return message2.SerializeToArray(string_as_array(&array_data),
+                                   array_data.size()) &&
+         message1.ByteSize() == static_cast<int>(data1.size()) &&
+         data1 == data2 && data1 == array_data;
+}
+
+TEST(GeneratedMapFieldTest, DefaultDeterministicSerialization) {
+  // The default cannot be turned off again, so set it in a child process.
+  EXPECT_EXIT(exit(SerializesDeterministicallyByDefault() ? 0 : 1),
+              ::testing::ExitedWithCode(0), "");
+}
+#endif  // PROTOBUF_HAS_DEATH_TEST
+
+TEST(GeneratedMapFieldTest, StructuralHashIgnoresInsertionOrder) {
+  unittest::TestMessageMap message1, message2;
+  for (int i = 0; i < 100; i++) {
+    (*message1.mutable_map_int32_message())[i].set_optional_int32(i);
+    (*message2.mutable_map_int32_message())[99 - i].set_optional_int32(99 - i);
+  }
+  EXPECT_TRUE(MessageEquals(message1, message2));
+  EXPECT_EQ(MessageHash(message1), MessageHash(message2));
+
+  // Entries come out of the serialized messages in different orders, so
+  // reflection has to match them up by key.
+  DynamicMessageFactory factory;
+  google::protobuf::scoped_ptr<Message> dynamic1(
+      factory.GetPrototype(message1.GetDescriptor())->New());
+  google::protobuf::scoped_ptr<Message> dynamic2(
+      factory.GetPrototype(message1.GetDescriptor())->New());
+  ASSERT_TRUE(dynamic1->ParseFromString(message1.SerializeAsString()));
+  ASSERT_TRUE(dynamic2->ParseFromString(message2.SerializeAsString()));
+  EXPECT_TRUE(MessageEquals(*dynamic1, *dynamic2));
+  EXPECT_TRUE(MessageEquals(*dynamic1, message2));
+  EXPECT_EQ(MessageHash(message1), MessageHash(*dynamic1));
+  EXPECT_EQ(MessageHash(message1), MessageHash(*dynamic2));
+
+  (*message2.mutable_map_int32_message())[50].set_optional_int32(0);
+  EXPECT_FALSE(MessageEquals(message1, message2));
+  EXPECT_NE(MessageHash(message1), MessageHash(message2));
+  ASSERT_TRUE(dynamic2->ParseFromString(message2.SerializeAsString()));
+  EXPECT_FALSE(MessageEquals(*dynamic1, *dynamic2));
+}
+
+TEST(GeneratedMapFieldTest, StructuralHashMatchesReflection) {
+  unittest::TestMap message;
+  MapTestUtil::SetMapFields(&message);
+  EXPECT_EQ(message.Message::StructuralHash(), MessageHash(message));
+  EXPECT_TRUE(message.Message::StructurallyEquals(message));
+}
+
 TEST(GeneratedMapFieldTest, MessageLiteMap) {
   unittest::MapLite from, to;
   (*from.mutable_map_field())[1] = 1;
@@ -2184,6 +2373,45 @@ TEST(WireFormatForMapFieldTest, SerializeMap) {
   EXPECT_TRUE(dynamic_data == generated_data);
 }
 
+TEST(WireFormatForMapFieldTest, SerializeMapDeterministically) {
+  unittest::TestMap message;
+  string generated_data;
+  string dynamic_data;
+
+  MapTestUtil::SetMapFields(&message);
+  (*message.mutable_map_string_string())["a"] = "x";
+  (*message.mutable_map_string_string())["\xff"] = "y";
+  (*message.mutable_map_int32_int32())[-1] = 1;
+
+  // Serialize using the generated code.
+  {
+    message.ByteSize();
+    io::StringOutputStream raw_output(&generated_data);
+    io::CodedOutputStream output(&raw_output);
+    output.SetSerializationDeterministic(true);
+    message.SerializeWithCachedSizes(&output);
+    ASSERT_FALSE(output.HadError());
+  }
+
+  // Serialize using WireFormat.
+  {
+    io::StringOutputStream raw_output(&dynamic_data);
+    io::CodedOutputStream output(&raw_output);
+    output.SetSerializationDeterministic(true);
+    int size = WireFormat::ByteSize(message);
+    WireFormat::SerializeWithCachedSizes(message, size, &output);
+    ASSERT_FALSE(output.HadError());
+  }
+
+  // Both order the entries by key.
+  EXPECT_TRUE(dynamic_data == generated_data);
+
+  unittest::TestMap parsed;
+  ASSERT_TRUE(parsed.ParseFromString(generated_data));
+  EXPECT_EQ(4, parsed.map_string_string().size());
+  EXPECT_EQ(3, parsed.map_int32_int32().size());
+}
+
 TEST(WireFormatForMapFieldTest, MapParseHelpers) {
   string data;
 
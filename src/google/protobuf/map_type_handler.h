@@ -102,10 +102,12 @@ class MapCppTypeHandler : public MapCommonTypeHandler<Type> {
   // SpaceUsedInMapEntry: Return bytes used by value in MapEntry, excluding
   // those already calculate in sizeof(MapField).
   static int SpaceUsedInMapEntry(const Type* value) {
-    return value->SpaceUsed();
+    return static_cast<int>(value->SpaceUsedLong());
   }
   // Return bytes used by value in Map.
-  static int SpaceUsedInMap(const Type& value) { return value.SpaceUsed(); }
+  static int SpaceUsedInMap(const Type& value) {
+    return static_cast<int>(value.SpaceUsedLong());
+  }
   static inline void Clear(Type** value) {
     if (*value != NULL) (*value)->Type::Clear();
   }
@@ -116,6 +118,8 @@ class MapCppTypeHandler : public MapCommonTypeHandler<Type> {
   static inline void Merge(const Type& from, Type** to) {
     (*to)->MergeFrom(from);
   }
+  // Move a value parsed by MapField into its slot in google::protobuf::Map.
+  static inline void Move(Type* from, Type* to) { to->Swap(from); }
 
   static void Delete(const Type* ptr) { delete ptr; }
 
@@ -152,6 +156,7 @@ class MapCppTypeHandler<string> : public MapCommonTypeHandler<string> {
  public:
   static const bool kIsStringOrMessage = true;
   static inline void Merge(const string& from, string** to) { **to = from; }
+  static inline void Move(string* from, string* to) { to->swap(*from); }
   static inline void Clear(string** value) { (*value)->clear(); }
   static inline void ClearMaybeByDefaultEnum(string** value, int default_enum) {
     (*value)->clear();
@@ -190,6 +195,7 @@ class MapPrimitiveTypeHandler : public MapCommonTypeHandler<Type> {
   static const bool kIsStringOrMessage = false;
   static inline void Delete(const Type& x) {}
   static inline void Merge(const Type& from, Type* to) { *to = from; }
+  static inline void Move(Type* from, Type* to) { *to = *from; }
   static inline int SpaceUsedInMapEntry(const Type& value) { return 0; }
   static inline int SpaceUsedInMap(const Type& value) { return sizeof(Type); }
   static inline void AssignDefaultValue(Type* value) {}
@@ -291,6 +297,8 @@ class MapProtoTypeHandler {
                            io::CodedOutputStream* output);
   static inline uint8* WriteToArray(int field, const CppType& value,
                                     uint8* output);
+  static inline void WriteReverse(int field, const CppType& value,
+                                  io::ReverseCodedBuffer* output);
   template <typename ValueType>
   static inline bool Read(io::CodedInputStream* input, ValueType* value);
 };
@@ -431,6 +439,22 @@ WRITE_METHOD(BOOL    , Bool)
 
 #undef WRITE_METHOD
 
+template <>
+inline void MapProtoTypeHandler<FieldDescriptor::TYPE_MESSAGE>::WriteReverse(
+    int field, const Message& value, io::ReverseCodedBuffer* output) {
+  WireFormatLite::WriteMessageReverse(field, value, output);
+}
+
+// Other types have no nested sizes, so they are written front to back into
+// space reserved for exactly their encoding.
+template <FieldDescriptor::Type Type>
+inline void MapProtoTypeHandler<Type>::WriteReverse(
+    int field, const CppType& value, io::ReverseCodedBuffer* output) {
+  const int size = WireFormatLite::TagSize(
+      field, static_cast<WireFormatLite::FieldType>(Type)) + ByteSize(value);
+  WriteToArray(field, value, output->Reserve(size));
+}
+
 template <>
 template <typename ValueType>
 inline bool MapProtoTypeHandler<FieldDescriptor::TYPE_MESSAGE>::Read(
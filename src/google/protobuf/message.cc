@@ -161,6 +161,18 @@ int Message::SpaceUsed() const {
   return GetReflection()->SpaceUsed(*this);
 }
 
+size_t Message::SpaceUsedLong() const {
+  return GetReflection()->SpaceUsed(*this);
+}
+
+uint64 Message::StructuralHash() const {
+  return ReflectionOps::Hash(*this);
+}
+
+bool Message::StructurallyEquals(const Message& other) const {
+  return ReflectionOps::Equals(*this, other);
+}
+
 bool Message::SerializeToFileDescriptor(int file_descriptor) const {
   io::FileOutputStream output(file_descriptor);
   return SerializeToZeroCopyStream(&output);
@@ -231,6 +231,17 @@ class LIBPROTOBUF_EXPORT Message : public MessageLite {
   // Reflection object's SpaceUsed() method.
   virtual int SpaceUsed() const;
 
+  // See MessageLite::SpaceUsedLong().  Generated classes compute this
+  // directly; the default implementation calls the Reflection object's
+  // SpaceUsed() method.
+  virtual size_t SpaceUsedLong() const;
+
+  // See MessageHash() and MessageEquals() below, which call these.
+  // Generated classes implement them without reflection; the default
+  // implementations use ReflectionOps.
+  virtual uint64 StructuralHash() const;
+  virtual bool StructurallyEquals(const Message& other) const;
+
   // Debugging & Testing----------------------------------------------
 
   // Generates a human readable form of this message, useful for debugging
@@ -327,6 +338,28 @@ class LIBPROTOBUF_EXPORT Message : public MessageLite {
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(Message);
 };
 
+// Returns a hash of the contents of "message", without serializing it.
+// Messages for which MessageEquals() is true have the same hash, so the two
+// can be used together as a hash table key.  Hash values may change between
+// protobuf releases and platforms, so do not persist them.
+inline uint64 MessageHash(const Message& message) {
+  return message.StructuralHash();
+}
+
+// Returns true if "a" and "b" have the same type and the same fields set to
+// the same values.  Floating-point values are compared bitwise.  The order
+// of map entries does not matter, and neither does the order of unknown
+// fields with different field numbers.  Unknown fields with the same number
+// must appear in the same order, as they would in a repeated field.
+//
+// For generated messages neither function allocates memory, other than to
+// parse a [lazy] extension that has not been accessed yet.  Other messages,
+// such as DynamicMessage, go through reflection, which may allocate to list
+// extensions or to sort map entries that are in different orders.
+inline bool MessageEquals(const Message& a, const Message& b) {
+  return a.StructurallyEquals(b);
+}
+
 namespace internal {
 // Forward-declare interfaces used to implement RepeatedFieldRef.
 // These are protobuf internals that users shouldn't care about.
@@ -35,6 +35,7 @@
 
 #include <google/protobuf/message_lite.h>
 #include <google/protobuf/arena.h>
+#include <algorithm>
 #include <string>
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/io/coded_stream.h>
@@ -58,9 +59,9 @@ namespace {
 // protobuf implementation but is more likely caused by concurrent modification
 // of the message.  This function attempts to distinguish between the two and
 // provide a useful error message.
-void ByteSizeConsistencyError(int byte_size_before_serialization,
-                              int byte_size_after_serialization,
-                              int bytes_produced_by_serialization) {
+void ByteSizeConsistencyError(size_t byte_size_before_serialization,
+                              size_t byte_size_after_serialization,
+                              size_t bytes_produced_by_serialization) {
   GOOGLE_CHECK_EQ(byte_size_before_serialization, byte_size_after_serialization)
       << "Protocol message was modified concurrently during serialization.";
   GOOGLE_CHECK_EQ(bytes_produced_by_serialization, byte_size_before_serialization)
@@ -70,6 +71,74 @@ void ByteSizeConsistencyError(int byte_size_before_serialization,
   GOOGLE_LOG(FATAL) << "This shouldn't be called if all the sizes are equal.";
 }
 
+// Returned by the default ByteSizeLong() when ByteSize() overflowed.  No
+// message can actually be this large.
+const size_t kByteSizeOverflow = ~static_cast<size_t>(0);
+
+// Returns true, logging an error, if ByteSizeLong() could not compute the
+// message's size.  The serialization helpers then fail instead of writing.
+bool ByteSizeOverflowed(size_t byte_size) {
+  if (byte_size != kByteSizeOverflow) return false;
+  // Messages >2G cannot be serialized due to overflow computing ByteSize.
+  GOOGLE_LOG(ERROR) << "Error computing ByteSize (possible overflow?).";
+  return true;
+}
+
+// A ZeroCopyOutputStream over a flat array, which may be larger than 2GB,
+// for messages whose size is already known.  Once the array is full, further
+// data is discarded but still counted, so that ByteCount() reports how much
+// a message that changed after its size was cached actually produced.
+class FlatArrayOutputStream : public io::ZeroCopyOutputStream {
+ public:
+  FlatArrayOutputStream(uint8* data, size_t size)
+    : data_(data), size_(size), position_(0) {}
+
+  bool Next(void** data, int* size) {
+    if (position_ < size_) {
+      *data = data_ + position_;
+      *size = static_cast<int>(
+          std::min<size_t>(size_ - position_, kint32max));
+    } else {
+      *data = overflow_;
+      *size = sizeof(overflow_);
+    }
+    position_ += *size;
+    return true;
+  }
+  void BackUp(int count) { position_ -= count; }
+  int64 ByteCount() const { return position_; }
+
+ private:
+  uint8* const data_;
+  const size_t size_;
+  size_t position_;
+  uint8 overflow_[256];
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(FlatArrayOutputStream);
+};
+
+// Writes a message whose sizes are already cached into a flat array of
+// exactly that size, and returns the end of the written data.  As with
+// SerializeWithCachedSizesToArray(), the result only differs from
+// target + size if the message changed after its size was cached; callers
+// report that with ByteSizeConsistencyError().
+//
+// SerializeWithCachedSizesToArray() cannot order map entries, so when
+// deterministic output is the process default this goes through a
+// CodedOutputStream, which picks up the default.
+uint8* SerializeToFlatArray(const MessageLite& message, uint8* target,
+                            size_t size) {
+  if (!io::CodedOutputStream::IsDefaultSerializationDeterministic()) {
+    return message.SerializeWithCachedSizesToArray(target);
+  }
+  FlatArrayOutputStream out(target, size);
+  {
+    io::CodedOutputStream coded_out(&out);
+    message.SerializeWithCachedSizes(&coded_out);
+  }
+  return target + out.ByteCount();
+}
+
 string InitializationErrorMessage(const char* action,
                                   const MessageLite& message) {
   // Note:  We want to avoid depending on strutil in the lite library, otherwise
@@ -224,6 +293,17 @@ bool MessageLite::ParsePartialFromArray(const void* data, int size) {
 
 // ===================================================================
 
+size_t MessageLite::ByteSizeLong() const {
+  const int size = ByteSize();
+  return size < 0 ? kByteSizeOverflow : size;
+}
+
+size_t MessageLite::SpaceUsedLong() const {
+  GOOGLE_LOG(DFATAL) << "SpaceUsedLong() is not implemented for "
+                     << GetTypeName() << ".";
+  return 0;
+}
+
 uint8* MessageLite::SerializeWithCachedSizesToArray(uint8* target) const {
   // We only optimize this when using optimize_for = SPEED.  In other cases
   // we just use the CodedOutputStream path.
@@ -235,6 +315,17 @@ uint8* MessageLite::SerializeWithCachedSizesToArray(uint8* target) const {
   return target + size;
 }
 
+void MessageLite::InternalSerializeReverse(
+    io::ReverseCodedBuffer* output) const {
+  const int size = ByteSize();
+  GOOGLE_CHECK_GE(size, 0) << "Error computing ByteSize (possible overflow?).";
+  uint8* start = output->Reserve(size);
+  uint8* end = SerializeWithCachedSizesToArray(start);
+  if (end - start != size) {
+    ByteSizeConsistencyError(size, ByteSize(), end - start);
+  }
+}
+
 bool MessageLite::SerializeToCodedStream(io::CodedOutputStream* output) const {
   GOOGLE_DCHECK(IsInitialized()) << InitializationErrorMessage("serialize", *this);
   return SerializePartialToCodedStream(output);
@@ -242,30 +333,32 @@ bool MessageLite::SerializeToCodedStream(io::CodedOutputStream* output) const {
 
 bool MessageLite::SerializePartialToCodedStream(
     io::CodedOutputStream* output) const {
-  const int size = ByteSize();  // Force size to be cached.
-  if (size < 0) {
-    // Messages >2G cannot be serialized due to overflow computing ByteSize.
-    GOOGLE_LOG(ERROR) << "Error computing ByteSize (possible overflow?).";
-    return false;
-  }
-
-  uint8* buffer = output->GetDirectBufferForNBytesAndAdvance(size);
+  const size_t size = ByteSizeLong();  // Force size to be cached.
+  if (ByteSizeOverflowed(size)) return false;
+
+  // Messages of 2GB or more never fit in the stream's buffer, so they always
+  // take the streaming path below, as does deterministic output, which
+  // SerializeWithCachedSizesToArray() cannot produce.
+  uint8* buffer = size <= static_cast<size_t>(kint32max) &&
+                  !output->IsSerializationDeterministic() ?
+      output->GetDirectBufferForNBytesAndAdvance(static_cast<int>(size)) :
+      NULL;
   if (buffer != NULL) {
     uint8* end = SerializeWithCachedSizesToArray(buffer);
-    if (end - buffer != size) {
-      ByteSizeConsistencyError(size, ByteSize(), end - buffer);
+    if (static_cast<size_t>(end - buffer) != size) {
+      ByteSizeConsistencyError(size, ByteSizeLong(), end - buffer);
     }
     return true;
   } else {
-    int original_byte_count = output->ByteCount();
+    int64 original_byte_count = output->ByteCount();
     SerializeWithCachedSizes(output);
     if (output->HadError()) {
       return false;
     }
-    int final_byte_count = output->ByteCount();
+    int64 final_byte_count = output->ByteCount();
 
-    if (final_byte_count - original_byte_count != size) {
-      ByteSizeConsistencyError(size, ByteSize(),
+    if (static_cast<size_t>(final_byte_count - original_byte_count) != size) {
+      ByteSizeConsistencyError(size, ByteSizeLong(),
                                final_byte_count - original_byte_count);
     }
 
@@ -291,20 +384,20 @@ bool MessageLite::AppendToString(string* output) const {
 }
 
 bool MessageLite::AppendPartialToString(string* output) const {
-  int old_size = output->size();
-  int byte_size = ByteSize();
-  if (byte_size < 0) {
-    // Messages >2G cannot be serialized due to overflow computing ByteSize.
-    GOOGLE_LOG(ERROR) << "Error computing ByteSize (possible overflow?).";
+  size_t old_size = output->size();
+  size_t byte_size = ByteSizeLong();
+  if (ByteSizeOverflowed(byte_size)) return false;
+  if (byte_size > output->max_size() - old_size) {
+    GOOGLE_LOG(ERROR) << "Serialized message is too large for a string.";
     return false;
   }
 
   STLStringResizeUninitialized(output, old_size + byte_size);
   uint8* start =
       reinterpret_cast<uint8*>(io::mutable_string_data(output) + old_size);
-  uint8* end = SerializeWithCachedSizesToArray(start);
-  if (end - start != byte_size) {
-    ByteSizeConsistencyError(byte_size, ByteSize(), end - start);
+  uint8* end = SerializeToFlatArray(*this, start, byte_size);
+  if (static_cast<size_t>(end - start) != byte_size) {
+    ByteSizeConsistencyError(byte_size, ByteSizeLong(), end - start);
   }
   return true;
 }
@@ -319,18 +412,35 @@ bool MessageLite::SerializePartialToString(string* output) const {
   return AppendPartialToString(output);
 }
 
+bool MessageLite::SerializeToStringSinglePass(string* output) const {
+  GOOGLE_DCHECK(IsInitialized()) << InitializationErrorMessage("serialize", *this);
+  return SerializePartialToStringSinglePass(output);
+}
+
+bool MessageLite::SerializePartialToStringSinglePass(string* output) const {
+  io::ReverseCodedBuffer buffer;
+  InternalSerializeReverse(&buffer);
+  output->clear();
+  if (buffer.ByteCount() > 0) {
+    output->assign(reinterpret_cast<const char*>(buffer.data()),
+                   buffer.ByteCount());
+  }
+  return true;
+}
+
 bool MessageLite::SerializeToArray(void* data, int size) const {
   GOOGLE_DCHECK(IsInitialized()) << InitializationErrorMessage("serialize", *this);
   return SerializePartialToArray(data, size);
 }
 
 bool MessageLite::SerializePartialToArray(void* data, int size) const {
-  int byte_size = ByteSize();
-  if (size < byte_size) return false;
+  size_t byte_size = ByteSizeLong();
+  if (ByteSizeOverflowed(byte_size)) return false;
+  if (size < 0 || static_cast<size_t>(size) < byte_size) return false;
   uint8* start = reinterpret_cast<uint8*>(data);
-  uint8* end = SerializeWithCachedSizesToArray(start);
-  if (end - start != byte_size) {
-    ByteSizeConsistencyError(byte_size, ByteSize(), end - start);
+  uint8* end = SerializeToFlatArray(*this, start, byte_size);
+  if (static_cast<size_t>(end - start) != byte_size) {
+    ByteSizeConsistencyError(byte_size, ByteSizeLong(), end - start);
   }
   return true;
 }
@@ -47,6 +47,7 @@ namespace protobuf {
 namespace io {
   class CodedInputStream;
   class CodedOutputStream;
+  class ReverseCodedBuffer;
   class ZeroCopyInputStream;
   class ZeroCopyOutputStream;
 }
@@ -229,11 +230,31 @@ class LIBPROTOBUF_EXPORT MessageLite {
   // Like AppendToString(), but allows missing required fields.
   bool AppendPartialToString(string* output) const;
 
+  // Like SerializeToString(), but encodes the message back to front in a
+  // single pass instead of calling ByteSize() first.  Messages generated with
+  // the C++ generator option "single_pass_serialization" do not touch their
+  // cached sizes this way, including those of their extensions and of
+  // parsed lazy extensions, so several threads may serialize one at the same
+  // time.  The output only differs from SerializeToString() in the order of
+  // map entries.
+  bool SerializeToStringSinglePass(string* output) const;
+  // Like SerializeToStringSinglePass(), but allows missing required fields.
+  bool SerializePartialToStringSinglePass(string* output) const;
+
   // Computes the serialized size of the message.  This recursively calls
   // ByteSize() on all embedded messages.  If a subclass does not override
   // this, it MUST override SetCachedSize().
   virtual int ByteSize() const = 0;
 
+  // Like ByteSize(), but returns a size_t so that messages larger than 2GB
+  // can be measured.  Such messages can only be serialized to a
+  // CodedOutputStream or ZeroCopyOutputStream, or appended to a string; their
+  // embedded messages must each still be smaller than 2GB.  The default
+  // implementation returns ByteSize(), or ~size_t(0) if ByteSize()
+  // overflowed to a negative value, which makes serialization fail; generated
+  // code overrides it and implements ByteSize() in terms of it.
+  virtual size_t ByteSizeLong() const;
+
   // Serializes the message without recomputing the size.  The message must
   // not have changed since the last call to ByteSize(); if it has, the results
   // are undefined.
@@ -245,7 +266,22 @@ class LIBPROTOBUF_EXPORT MessageLite {
   // must point at a byte array of at least ByteSize() bytes.
   virtual uint8* SerializeWithCachedSizesToArray(uint8* target) const;
 
-  // Returns the result of the last call to ByteSize().  An embedded message's
+  // Prepends the serialized message to *output; used by
+  // SerializeToStringSinglePass().  The default implementation calls
+  // ByteSize() and SerializeWithCachedSizesToArray().  Generated code
+  // overrides it when the "single_pass_serialization" option is set.
+  virtual void InternalSerializeReverse(io::ReverseCodedBuffer* output) const;
+
+  // Computes (an estimate of) the total number of bytes currently used for
+  // storing the message in memory, including sizeof(*this), without going
+  // through reflection.  Memory owned by an arena is not counted, so a
+  // message allocated on an arena reports zero.  Generated code overrides
+  // this; Message overrides it with a reflection-based fallback, and the
+  // MessageLite default reports an error and returns zero.
+  virtual size_t SpaceUsedLong() const;
+
+  // Returns the result of the last call to ByteSize().  The result is not
+  // meaningful if that size did not fit in an int.  An embedded message's
   // size is needed both to serialize it (because embedded messages are
   // length-delimited) and to compute the outer message's size.  Caching
   // the size avoids computing it multiple times.
@@ -262,6 +298,25 @@ class LIBPROTOBUF_EXPORT MessageLite {
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(MessageLite);
 };
 
+namespace internal {
+
+// Converts the result of ByteSizeLong() to the value stored as a message's
+// cached size.  Sizes above 2GB cannot be cached; only the outermost message
+// may be that large, and its own cached size is never used to serialize it.
+inline int ToCachedSize(size_t size) {
+  return static_cast<int>(size);
+}
+
+// Converts the result of ByteSizeLong() to the result of ByteSize(), which
+// is only meaningful for messages smaller than 2GB.
+inline int ToIntSize(size_t size) {
+  GOOGLE_DCHECK_LE(size, static_cast<size_t>(kint32max))
+      << "Message is too large for ByteSize(); use ByteSizeLong().";
+  return static_cast<int>(size);
+}
+
+}  // namespace internal
+
 }  // namespace protobuf
 
 }  // namespace google
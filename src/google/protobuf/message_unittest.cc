@@ -50,6 +50,7 @@
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/descriptor.pb.h>
 #include <google/protobuf/unittest.pb.h>
+#include <google/protobuf/unittest_optimize_for.pb.h>
 #include <google/protobuf/test_util.h>
 
 #include <google/protobuf/stubs/common.h>
@@ -244,11 +245,18 @@ TEST(MessageTest, CheckOverflow) {
 
 namespace {
 
-class NegativeByteSize : public unittest::TestRequired {
+// Optimized for code size, so ByteSizeLong() is MessageLite's default, which
+// is based on ByteSize().
+class NegativeByteSize : public protobuf_unittest::TestOptimizedForSize {
  public:
   virtual int ByteSize() const { return -1; }
 };
 
+class HugeByteSize : public unittest::TestRequired {
+ public:
+  virtual size_t ByteSizeLong() const { return string().max_size(); }
+};
+
 }  // namespace
 
 TEST(MessageTest, SerializationFailsOnNegativeByteSize) {
@@ -261,6 +269,15 @@ TEST(MessageTest, SerializationFailsOnNegativeByteSize) {
   EXPECT_FALSE(message.SerializePartialToCodedStream(&coded_output));
 }
 
+TEST(MessageTest, SerializationFailsOnHugeByteSize) {
+  // A message too large to fit in a string must be rejected without touching
+  // the output.
+  HugeByteSize message;
+  string string_output = "x";
+  EXPECT_FALSE(message.AppendPartialToString(&string_output));
+  EXPECT_EQ("x", string_output);
+}
+
 TEST(MessageTest, BypassInitializationCheckOnSerialize) {
   unittest::TestRequired message;
   io::ArrayOutputStream raw_output(NULL, 0);
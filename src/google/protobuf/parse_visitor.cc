@@ -0,0 +1,231 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <google/protobuf/parse_visitor.h>
+
+#include <algorithm>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/wire_format.h>
+#include <google/protobuf/wire_format_lite_inl.h>
+#include <google/protobuf/io/coded_stream.h>
+
+namespace google {
+namespace protobuf {
+
+using internal::WireFormat;
+using internal::WireFormatLite;
+
+namespace {
+
+bool ParseMessage(const Descriptor* descriptor, io::CodedInputStream* input,
+                  ParseVisitor* visitor);
+
+// Reads one value of a non-message, non-string type and reports it.
+bool ParseScalar(const FieldDescriptor* field, io::CodedInputStream* input,
+                 ParseVisitor* visitor) {
+  switch (field->type()) {
+#define HANDLE_TYPE(TYPE, CPPTYPE, METHOD)                                  \
+    case FieldDescriptor::TYPE_##TYPE: {                                    \
+      CPPTYPE value;                                                        \
+      if (!WireFormatLite::ReadPrimitive<                                   \
+              CPPTYPE, WireFormatLite::TYPE_##TYPE>(input, &value)) {       \
+        return false;                                                       \
+      }                                                                     \
+      visitor->METHOD(field, value);                                        \
+      return true;                                                          \
+    }
+
+    HANDLE_TYPE( INT32,  int32, VisitInt32)
+    HANDLE_TYPE( INT64,  int64, VisitInt64)
+    HANDLE_TYPE(SINT32,  int32, VisitInt32)
+    HANDLE_TYPE(SINT64,  int64, VisitInt64)
+    HANDLE_TYPE(UINT32, uint32, VisitUInt32)
+    HANDLE_TYPE(UINT64, uint64, VisitUInt64)
+
+    HANDLE_TYPE( FIXED32, uint32, VisitUInt32)
+    HANDLE_TYPE( FIXED64, uint64, VisitUInt64)
+    HANDLE_TYPE(SFIXED32,  int32, VisitInt32)
+    HANDLE_TYPE(SFIXED64,  int64, VisitInt64)
+
+    HANDLE_TYPE(FLOAT , float , VisitFloat)
+    HANDLE_TYPE(DOUBLE, double, VisitDouble)
+
+    HANDLE_TYPE(BOOL, bool, VisitBool)
+    HANDLE_TYPE(ENUM, int , VisitEnum)
+#undef HANDLE_TYPE
+
+    default:
+      GOOGLE_LOG(DFATAL) << "Not a scalar field: " << field->full_name();
+      return false;
+  }
+}
+
+// Reports a string or bytes value as the chunks it occupies in the input's
+// buffers.
+bool ParseString(const FieldDescriptor* field, io::CodedInputStream* input,
+                 ParseVisitor* visitor) {
+  uint32 length;
+  if (!input->ReadVarint32(&length)) return false;
+  int size = static_cast<int>(length);
+  if (size < 0) return false;  // security: length is user-supplied
+  if (!visitor->BeginString(field, size)) return input->Skip(size);
+
+  while (size > 0) {
+    const void* data;
+    int chunk_size;
+    if (!input->GetDirectBufferPointer(&data, &chunk_size)) return false;
+    chunk_size = std::min(chunk_size, size);
+    visitor->StringChunk(field, static_cast<const char*>(data), chunk_size);
+    input->Skip(chunk_size);
+    size -= chunk_size;
+  }
+  visitor->EndString(field);
+  return true;
+}
+
+bool ParseSubMessage(uint32 tag, const FieldDescriptor* field,
+                     io::CodedInputStream* input, ParseVisitor* visitor) {
+  if (field->type() == FieldDescriptor::TYPE_GROUP) {
+    if (!visitor->BeginMessage(field)) {
+      return WireFormatLite::SkipField(input, tag);
+    }
+    if (!input->IncrementRecursionDepth()) return false;
+    if (!ParseMessage(field->message_type(), input, visitor)) return false;
+    input->DecrementRecursionDepth();
+    // Make sure the last thing read was an end tag for this group.
+    if (!input->LastTagWas(WireFormatLite::MakeTag(
+            field->number(), WireFormatLite::WIRETYPE_END_GROUP))) {
+      return false;
+    }
+  } else {
+    uint32 length;
+    if (!input->ReadVarint32(&length)) return false;
+    if (!visitor->BeginMessage(field)) return input->Skip(length);
+    std::pair<io::CodedInputStream::Limit, int> p =
+        input->IncrementRecursionDepthAndPushLimit(length);
+    if (p.second < 0) return false;
+    if (!ParseMessage(field->message_type(), input, visitor)) return false;
+    if (!input->DecrementRecursionDepthAndPopLimit(p.first)) return false;
+  }
+  visitor->EndMessage(field);
+  return true;
+}
+
+bool ParseField(uint32 tag, const FieldDescriptor* field,
+                io::CodedInputStream* input, ParseVisitor* visitor) {
+  WireFormatLite::WireType wire_type = WireFormatLite::GetTagWireType(tag);
+
+  if (field == NULL) {
+    return WireFormatLite::SkipField(input, tag);
+  } else if (wire_type == WireFormat::WireTypeForFieldType(field->type())) {
+    switch (field->type()) {
+      case FieldDescriptor::TYPE_STRING:
+      case FieldDescriptor::TYPE_BYTES:
+        return ParseString(field, input, visitor);
+      case FieldDescriptor::TYPE_GROUP:
+      case FieldDescriptor::TYPE_MESSAGE:
+        return ParseSubMessage(tag, field, input, visitor);
+      default:
+        return ParseScalar(field, input, visitor);
+    }
+  } else if (field->is_packable() &&
+             wire_type == WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+    uint32 length;
+    if (!input->ReadVarint32(&length)) return false;
+    io::CodedInputStream::Limit limit = input->PushLimit(length);
+    while (input->BytesUntilLimit() > 0) {
+      if (!ParseScalar(field, input, visitor)) return false;
+    }
+    input->PopLimit(limit);
+    return true;
+  } else {
+    // The wire type doesn't match the declaration.
+    return WireFormatLite::SkipField(input, tag);
+  }
+}
+
+bool ParseMessage(const Descriptor* descriptor, io::CodedInputStream* input,
+                  ParseVisitor* visitor) {
+  while (true) {
+    uint32 tag = input->ReadTag();
+    if (tag == 0) {
+      // End of input.  This is a valid place to end, so return true.
+      return true;
+    }
+
+    if (WireFormatLite::GetTagWireType(tag) ==
+        WireFormatLite::WIRETYPE_END_GROUP) {
+      // Must be the end of the message.
+      return true;
+    }
+
+    int field_number = WireFormatLite::GetTagFieldNumber(tag);
+    const FieldDescriptor* field = descriptor->FindFieldByNumber(field_number);
+
+    // If that failed, check if the field is an extension.
+    if (field == NULL && descriptor->IsExtensionNumber(field_number)) {
+      const DescriptorPool* pool = input->GetExtensionPool();
+      if (pool == NULL) pool = descriptor->file()->pool();
+      field = pool->FindExtensionByNumber(descriptor, field_number);
+    }
+
+    if (!ParseField(tag, field, input, visitor)) return false;
+  }
+}
+
+}  // namespace
+
+ParseVisitor::~ParseVisitor() {}
+
+bool StreamingParser::Parse(const Descriptor* descriptor,
+                            io::CodedInputStream* input,
+                            ParseVisitor* visitor) {
+  return ParseMessage(descriptor, input, visitor);
+}
+
+bool StreamingParser::ParseFromZeroCopyStream(const Descriptor* descriptor,
+                                              io::ZeroCopyInputStream* input,
+                                              ParseVisitor* visitor) {
+  io::CodedInputStream decoder(input);
+  return Parse(descriptor, &decoder, visitor) &&
+         decoder.ConsumedEntireMessage();
+}
+
+bool StreamingParser::ParseFromArray(const Descriptor* descriptor,
+                                     const void* data, int size,
+                                     ParseVisitor* visitor) {
+  io::CodedInputStream decoder(reinterpret_cast<const uint8*>(data), size);
+  return Parse(descriptor, &decoder, visitor) &&
+         decoder.ConsumedEntireMessage();
+}
+
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,149 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// ParseVisitor lets a program look at the contents of a serialized message
+// without building a Message object.  StreamingParser walks the wire format
+// with the help of the message's Descriptor and reports every field it
+// finds to a ParseVisitor: scalar values as they are decoded, strings as a
+// sequence of chunks pointing into the input buffers, and sub-messages as
+// matching BeginMessage()/EndMessage() calls.  Nothing is allocated, and a
+// visitor that is not interested in a sub-message can have it skipped
+// without decoding it.  This works equally for generated and dynamic types,
+// since only the Descriptor is consulted.
+
+#ifndef GOOGLE_PROTOBUF_PARSE_VISITOR_H__
+#define GOOGLE_PROTOBUF_PARSE_VISITOR_H__
+
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+  class Descriptor;
+  class FieldDescriptor;
+namespace io {
+  class CodedInputStream;
+  class ZeroCopyInputStream;
+}
+
+// Receives the fields found by StreamingParser.  Each method is called with
+// the FieldDescriptor of the field being reported, which belongs to the
+// message type being parsed or is an extension of it.  Repeated fields,
+// packed or not, produce one call per element.  The default implementations
+// ignore the value, so subclasses only override what they need.
+//
+// Enum values are reported as they appear on the wire, whether or not the
+// enum type defines them.  Fields that are not part of the message type, or
+// whose wire type does not match their declaration, are skipped silently.
+class LIBPROTOBUF_EXPORT ParseVisitor {
+ public:
+  ParseVisitor() {}
+  virtual ~ParseVisitor();
+
+  virtual void VisitInt32(const FieldDescriptor* field, int32 value) {}
+  virtual void VisitInt64(const FieldDescriptor* field, int64 value) {}
+  virtual void VisitUInt32(const FieldDescriptor* field, uint32 value) {}
+  virtual void VisitUInt64(const FieldDescriptor* field, uint64 value) {}
+  virtual void VisitFloat(const FieldDescriptor* field, float value) {}
+  virtual void VisitDouble(const FieldDescriptor* field, double value) {}
+  virtual void VisitBool(const FieldDescriptor* field, bool value) {}
+  virtual void VisitEnum(const FieldDescriptor* field, int value) {}
+
+  // Called when a string or bytes field of |size| bytes starts.  Returning
+  // false skips the value: no StringChunk() or EndString() calls follow.
+  virtual bool BeginString(const FieldDescriptor* field, int size) {
+    return false;
+  }
+  // Called with consecutive pieces of the value after BeginString() returned
+  // true.  |data| points into the input stream's buffer and is only valid
+  // during the call.  Strings are not checked for valid UTF-8.
+  virtual void StringChunk(const FieldDescriptor* field,
+                           const char* data, int size) {}
+  // Called after the last chunk of a string.
+  virtual void EndString(const FieldDescriptor* field) {}
+
+  // Called when a message or group field starts.  Returning false skips the
+  // whole sub-message without decoding it: no fields of it are reported and
+  // EndMessage() is not called.  Map fields are reported as repeated
+  // messages with "key" and "value" fields.
+  virtual bool BeginMessage(const FieldDescriptor* field) { return true; }
+  // Called after the last field of a sub-message.
+  virtual void EndMessage(const FieldDescriptor* field) {}
+
+ private:
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(ParseVisitor);
+};
+
+// Drives a ParseVisitor over serialized data.
+//
+// Example:
+//   class CountOrders : public ParseVisitor {
+//    public:
+//     CountOrders() : count(0) {}
+//     bool BeginMessage(const FieldDescriptor* field) {
+//       if (field->name() == "order") ++count;
+//       return false;  // Don't look inside.
+//     }
+//     int count;
+//   };
+//
+//   CountOrders visitor;
+//   StreamingParser::ParseFromZeroCopyStream(
+//       Customer::descriptor(), &input, &visitor);
+class LIBPROTOBUF_EXPORT StreamingParser {
+ public:
+  // Reads a message of the given type from |input| up to the end of the
+  // input or the current limit, as Message::MergePartialFromCodedStream()
+  // does, reporting its fields to |visitor|.  Returns false if the data is
+  // malformed; the visitor may have seen part of the message by then.
+  // Required fields are not checked.
+  //
+  // Extensions are looked up in input->GetExtensionPool() if set, and in the
+  // pool |descriptor| belongs to otherwise.  MessageSet items are skipped.
+  static bool Parse(const Descriptor* descriptor,
+                    io::CodedInputStream* input, ParseVisitor* visitor);
+
+  // Like Parse(), but reads the whole of |input| or |data| and fails if it
+  // does not hold exactly one message.
+  static bool ParseFromZeroCopyStream(const Descriptor* descriptor,
+                                      io::ZeroCopyInputStream* input,
+                                      ParseVisitor* visitor);
+  static bool ParseFromArray(const Descriptor* descriptor,
+                             const void* data, int size,
+                             ParseVisitor* visitor);
+
+ private:
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(StreamingParser);
+};
+
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_PARSE_VISITOR_H__
@@ -0,0 +1,348 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// https://developers.google.com/protocol-buffers/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <google/protobuf/parse_visitor.h>
+
+#include <string>
+#include <vector>
+
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/test_util.h>
+#include <google/protobuf/unittest.pb.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace {
+
+// Rebuilds the parsed message through reflection, so the result can be
+// compared with the original.
+class MessageBuilder : public ParseVisitor {
+ public:
+  explicit MessageBuilder(Message* message) : chunk_count_(0) {
+    stack_.push_back(message);
+  }
+
+  void VisitInt32(const FieldDescriptor* field, int32 value) {
+    if (field->is_repeated()) {
+      reflection()->AddInt32(top(), field, value);
+    } else {
+      reflection()->SetInt32(top(), field, value);
+    }
+  }
+  void VisitInt64(const FieldDescriptor* field, int64 value) {
+    if (field->is_repeated()) {
+      reflection()->AddInt64(top(), field, value);
+    } else {
+      reflection()->SetInt64(top(), field, value);
+    }
+  }
+  void VisitUInt32(const FieldDescriptor* field, uint32 value) {
+    if (field->is_repeated()) {
+      reflection()->AddUInt32(top(), field, value);
+    } else {
+      reflection()->SetUInt32(top(), field, value);
+    }
+  }
+  void VisitUInt64(const FieldDescriptor* field, uint64 value) {
+    if (field->is_repeated()) {
+      reflection()->AddUInt64(top(), field, value);
+    } else {
+      reflection()->SetUInt64(top(), field, value);
+    }
+  }
+  void VisitFloat(const FieldDescriptor* field, float value) {
+    if (field->is_repeated()) {
+      reflection()->AddFloat(top(), field, value);
+    } else {
+      reflection()->SetFloat(top(), field, value);
+    }
+  }
+  void VisitDouble(const FieldDescriptor* field, double value) {
+    if (field->is_repeated()) {
+      reflection()->AddDouble(top(), field, value);
+    } else {
+      reflection()->SetDouble(top(), field, value);
+    }
+  }
+  void VisitBool(const FieldDescriptor* field, bool value) {
+    if (field->is_repeated()) {
+      reflection()->AddBool(top(), field, value);
+    } else {
+      reflection()->SetBool(top(), field, value);
+    }
+  }
+  void VisitEnum(const FieldDescriptor* field, int value) {
+    const EnumValueDescriptor* enum_value =
+        field->enum_type()->FindValueByNumber(value);
+    ASSERT_TRUE(enum_value != NULL);
+    if (field->is_repeated()) {
+      reflection()->AddEnum(top(), field, enum_value);
+    } else {
+      reflection()->SetEnum(top(), field, enum_value);
+    }
+  }
+
+  bool BeginString(const FieldDescriptor* field, int size) {
+    string_.clear();
+    return true;
+  }
+  void StringChunk(const FieldDescriptor* field, const char* data, int size) {
+    string_.append(data, size);
+    ++chunk_count_;
+  }
+  void EndString(const FieldDescriptor* field) {
+    if (field->is_repeated()) {
+      reflection()->AddString(top(), field, string_);
+    } else {
+      reflection()->SetString(top(), field, string_);
+    }
+  }
+
+  bool BeginMessage(const FieldDescriptor* field) {
+    if (field->is_repeated()) {
+      stack_.push_back(reflection()->AddMessage(top(), field));
+    } else {
+      stack_.push_back(reflection()->MutableMessage(top(), field));
+    }
+    return true;
+  }
+  void EndMessage(const FieldDescriptor* field) {
+    stack_.pop_back();
+  }
+
+  int chunk_count_;
+
+ private:
+  Message* top() { return stack_.back(); }
+  const Reflection* reflection() { return top()->GetReflection(); }
+
+  vector<Message*> stack_;
+  string string_;
+};
+
+TEST(ParseVisitorTest, AllFields) {
+  unittest::TestAllTypes message;
+  TestUtil::SetAllFields(&message);
+  string data = message.SerializeAsString();
+
+  unittest::TestAllTypes result;
+  MessageBuilder builder(&result);
+  EXPECT_TRUE(StreamingParser::ParseFromArray(
+      result.GetDescriptor(), data.data(), data.size(), &builder));
+  TestUtil::ExpectAllFieldsSet(result);
+}
+
+TEST(ParseVisitorTest, PackedFields) {
+  unittest::TestPackedTypes message;
+  TestUtil::SetPackedFields(&message);
+  string data = message.SerializeAsString();
+
+  unittest::TestPackedTypes result;
+  MessageBuilder builder(&result);
+  EXPECT_TRUE(StreamingParser::ParseFromArray(
+      result.GetDescriptor(), data.data(), data.size(), &builder));
+  TestUtil::ExpectPackedFieldsSet(result);
+
+  // Packed data is also accepted for unpacked fields.
+  unittest::TestUnpackedTypes unpacked;
+  MessageBuilder unpacked_builder(&unpacked);
+  EXPECT_TRUE(StreamingParser::ParseFromArray(
+      unpacked.GetDescriptor(), data.data(), data.size(), &unpacked_builder));
+  TestUtil::ExpectUnpackedFieldsSet(unpacked);
+}
+
+TEST(ParseVisitorTest, Extensions) {
+  unittest::TestAllExtensions message;
+  TestUtil::SetAllExtensions(&message);
+  string data = message.SerializeAsString();
+
+  unittest::TestAllExtensions result;
+  MessageBuilder builder(&result);
+  EXPECT_TRUE(StreamingParser::ParseFromArray(
+      result.GetDescriptor(), data.data(), data.size(), &builder));
+  TestUtil::ExpectAllExtensionsSet(result);
+}
+
+TEST(ParseVisitorTest, DynamicMessage) {
+  // Only the descriptor is needed, so a type built at runtime works too.
+  DescriptorPool pool;
+  FileDescriptorProto file_proto;
+  unittest::TestAllTypes::descriptor()->file()->CopyTo(&file_proto);
+  FileDescriptorProto import_proto;
+  unittest_import::ImportMessage::descriptor()->file()->CopyTo(&import_proto);
+  FileDescriptorProto public_import_proto;
+  unittest_import::PublicImportMessage::descriptor()->file()->CopyTo(
+      &public_import_proto);
+  ASSERT_TRUE(pool.BuildFile(public_import_proto) != NULL);
+  ASSERT_TRUE(pool.BuildFile(import_proto) != NULL);
+  ASSERT_TRUE(pool.BuildFile(file_proto) != NULL);
+  const Descriptor* descriptor =
+      pool.FindMessageTypeByName("protobuf_unittest.TestAllTypes");
+  ASSERT_TRUE(descriptor != NULL);
+
+  unittest::TestAllTypes message;
+  TestUtil::SetAllFields(&message);
+  string data = message.SerializeAsString();
+
+  DynamicMessageFactory factory;
+  scoped_ptr<Message> result(factory.GetPrototype(descriptor)->New());
+  MessageBuilder builder(result.get());
+  EXPECT_TRUE(StreamingParser::ParseFromArray(
+      descriptor, data.data(), data.size(), &builder));
+  EXPECT_EQ(data, result->SerializeAsString());
+}
+
+TEST(ParseVisitorTest, StringChunks) {
+  // Strings are delivered as they lie in the input buffers, without being
+  // copied together.
+  unittest::TestAllTypes message;
+  message.set_optional_string(string(100, 'x'));
+  message.set_optional_bytes(string(50, 'y'));
+  string data = message.SerializeAsString();
+
+  io::ArrayInputStream input(data.data(), data.size(), 7);
+  unittest::TestAllTypes result;
+  MessageBuilder builder(&result);
+  EXPECT_TRUE(StreamingParser::ParseFromZeroCopyStream(
+      result.GetDescriptor(), &input, &builder));
+  EXPECT_EQ(message.optional_string(), result.optional_string());
+  EXPECT_EQ(message.optional_bytes(), result.optional_bytes());
+  EXPECT_GE(builder.chunk_count_, 150 / 7);
+}
+
+// Records which fields were reported, skipping sub-messages on request.
+class FieldRecorder : public ParseVisitor {
+ public:
+  explicit FieldRecorder(const string& skip) : skip_(skip) {}
+
+  void VisitInt32(const FieldDescriptor* field, int32 value) {
+    events_.push_back(field->name());
+  }
+  bool BeginMessage(const FieldDescriptor* field) {
+    if (field->name() == skip_) return false;
+    events_.push_back("begin " + field->name());
+    return true;
+  }
+  void EndMessage(const FieldDescriptor* field) {
+    events_.push_back("end " + field->name());
+  }
+
+  const string skip_;
+  vector<string> events_;
+};
+
+TEST(ParseVisitorTest, SkipSubMessages) {
+  unittest::TestAllTypes message;
+  message.set_optional_int32(1);
+  message.mutable_optionalgroup()->set_a(2);
+  message.mutable_optional_nested_message()->set_bb(3);
+  message.add_repeatedgroup()->set_a(4);
+  message.add_repeated_nested_message()->set_bb(5);
+  message.set_default_int32(6);
+  string data = message.SerializeAsString();
+
+  FieldRecorder all("");
+  EXPECT_TRUE(StreamingParser::ParseFromArray(
+      message.GetDescriptor(), data.data(), data.size(), &all));
+  const char* kAllEvents[] = {
+    "optional_int32",
+    "begin optionalgroup", "a", "end optionalgroup",
+    "begin optional_nested_message", "bb", "end optional_nested_message",
+    "begin repeatedgroup", "a", "end repeatedgroup",
+    "begin repeated_nested_message", "bb", "end repeated_nested_message",
+    "default_int32",
+  };
+  vector<string> expected(kAllEvents,
+                          kAllEvents + GOOGLE_ARRAYSIZE(kAllEvents));
+  EXPECT_TRUE(expected == all.events_);
+
+  // Skipping a group drops its events, but parsing carries on after it.
+  FieldRecorder skip_group("optionalgroup");
+  EXPECT_TRUE(StreamingParser::ParseFromArray(
+      message.GetDescriptor(), data.data(), data.size(), &skip_group));
+  vector<string> without_group(expected);
+  without_group.erase(without_group.begin() + 1, without_group.begin() + 4);
+  EXPECT_TRUE(without_group == skip_group.events_);
+
+  FieldRecorder skip_message("repeated_nested_message");
+  EXPECT_TRUE(StreamingParser::ParseFromArray(
+      message.GetDescriptor(), data.data(), data.size(), &skip_message));
+  vector<string> without_message(expected);
+  without_message.erase(without_message.begin() + 10,
+                        without_message.begin() + 13);
+  EXPECT_TRUE(without_message == skip_message.events_);
+}
+
+TEST(ParseVisitorTest, UnknownFieldsAreSkipped) {
+  unittest::TestAllTypes message;
+  TestUtil::SetAllFields(&message);
+  string data = message.SerializeAsString();
+
+  // TestEmptyMessage has no fields, so nothing is reported.
+  FieldRecorder recorder("");
+  EXPECT_TRUE(StreamingParser::ParseFromArray(
+      unittest::TestEmptyMessage::descriptor(), data.data(), data.size(),
+      &recorder));
+  EXPECT_TRUE(recorder.events_.empty());
+}
+
+TEST(ParseVisitorTest, MalformedInput) {
+  unittest::TestAllTypes message;
+  TestUtil::SetAllFields(&message);
+  string data = message.SerializeAsString();
+
+  // Truncated data is rejected exactly when the generated parser rejects it.
+  for (int size = 1; size < data.size(); size += 7) {
+    SCOPED_TRACE(size);
+    FieldRecorder recorder("");
+    unittest::TestAllTypes result;
+    EXPECT_EQ(result.ParsePartialFromArray(data.data(), size),
+              StreamingParser::ParseFromArray(message.GetDescriptor(),
+                                              data.data(), size, &recorder));
+  }
+
+  // An end-group tag at the top level is rejected.
+  const char kEndGroup[] = "\x0c";
+  FieldRecorder recorder("");
+  EXPECT_FALSE(StreamingParser::ParseFromArray(
+      message.GetDescriptor(), kEndGroup, 1, &recorder));
+}
+
+}  // namespace
+}  // namespace protobuf
+}  // namespace google
@@ -32,12 +32,14 @@
 //  Based on original Protocol Buffers design by
 //  Sanjay Ghemawat, Jeff Dean, and others.
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
 #include <google/protobuf/reflection_ops.h>
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/generated_message_util.h>
 #include <google/protobuf/unknown_field_set.h>
 #include <google/protobuf/stubs/strutil.h>
 
@@ -201,6 +203,324 @@ void ReflectionOps::DiscardUnknownFields(Message* message) {
   }
 }
 
+namespace {
+
+// Returns HashValue() of a singular field's value, or of element "index" of a
+// repeated field if index is not -1.  An unset singular field hashes as its
+// default value.
+uint64 HashFieldValue(const Message& message, const FieldDescriptor* field,
+                      int index) {
+  const Reflection* reflection = message.GetReflection();
+  switch (field->cpp_type()) {
+#define HANDLE_TYPE(CPPTYPE, METHOD)                                     \
+    case FieldDescriptor::CPPTYPE_##CPPTYPE:                             \
+      return HashValue(index == -1 ?                                     \
+          reflection->Get##METHOD(message, field) :                      \
+          reflection->GetRepeated##METHOD(message, field, index));
+
+    HANDLE_TYPE(INT32 , Int32    );
+    HANDLE_TYPE(INT64 , Int64    );
+    HANDLE_TYPE(UINT32, UInt32   );
+    HANDLE_TYPE(UINT64, UInt64   );
+    HANDLE_TYPE(FLOAT , Float    );
+    HANDLE_TYPE(DOUBLE, Double   );
+    HANDLE_TYPE(BOOL  , Bool     );
+    HANDLE_TYPE(ENUM  , EnumValue);
+#undef HANDLE_TYPE
+
+    case FieldDescriptor::CPPTYPE_STRING: {
+      string scratch;
+      return HashValue(index == -1 ?
+          reflection->GetStringReference(message, field, &scratch) :
+          reflection->GetRepeatedStringReference(message, field, index,
+                                                 &scratch));
+    }
+
+    case FieldDescriptor::CPPTYPE_MESSAGE:
+      return MessageHash(index == -1 ?
+          reflection->GetMessage(message, field) :
+          reflection->GetRepeatedMessage(message, field, index));
+  }
+  GOOGLE_LOG(FATAL) << "Can't get here.";
+  return 0;
+}
+
+// Like HashFieldValue(), but compares the values in two messages of the same
+// type.
+bool FieldValuesEqual(const Message& a, const Message& b,
+                      const FieldDescriptor* field, int index) {
+  const Reflection* a_reflection = a.GetReflection();
+  const Reflection* b_reflection = b.GetReflection();
+  switch (field->cpp_type()) {
+#define HANDLE_TYPE(CPPTYPE, METHOD)                                     \
+    case FieldDescriptor::CPPTYPE_##CPPTYPE:                             \
+      if (index == -1) {                                                 \
+        return ValuesEqual(a_reflection->Get##METHOD(a, field),          \
+                           b_reflection->Get##METHOD(b, field));         \
+      } else {                                                           \
+        return ValuesEqual(                                              \
+            a_reflection->GetRepeated##METHOD(a, field, index),          \
+            b_reflection->GetRepeated##METHOD(b, field, index));         \
+      }
+
+    HANDLE_TYPE(INT32 , Int32    );
+    HANDLE_TYPE(INT64 , Int64    );
+    HANDLE_TYPE(UINT32, UInt32   );
+    HANDLE_TYPE(UINT64, UInt64   );
+    HANDLE_TYPE(FLOAT , Float    );
+    HANDLE_TYPE(DOUBLE, Double   );
+    HANDLE_TYPE(BOOL  , Bool     );
+    HANDLE_TYPE(ENUM  , EnumValue);
+#undef HANDLE_TYPE
+
+    case FieldDescriptor::CPPTYPE_STRING: {
+      string a_scratch, b_scratch;
+      if (index == -1) {
+        return a_reflection->GetStringReference(a, field, &a_scratch) ==
+               b_reflection->GetStringReference(b, field, &b_scratch);
+      } else {
+        return a_reflection->GetRepeatedStringReference(a, field, index,
+                                                        &a_scratch) ==
+               b_reflection->GetRepeatedStringReference(b, field, index,
+                                                        &b_scratch);
+      }
+    }
+
+    case FieldDescriptor::CPPTYPE_MESSAGE:
+      if (index == -1) {
+        return MessageEquals(a_reflection->GetMessage(a, field),
+                             b_reflection->GetMessage(b, field));
+      } else {
+        return MessageEquals(a_reflection->GetRepeatedMessage(a, field, index),
+                             b_reflection->GetRepeatedMessage(b, field, index));
+      }
+  }
+  GOOGLE_LOG(FATAL) << "Can't get here.";
+  return false;
+}
+
+// Map entries are compared and hashed by their key and value only, so an
+// entry with an explicitly set default value matches one without it, as in
+// google::protobuf::Map.
+bool MapEntriesEqual(const Message& a, const Message& b) {
+  const Descriptor* descriptor = a.GetDescriptor();
+  return FieldValuesEqual(a, b, descriptor->field(0), -1) &&
+         FieldValuesEqual(a, b, descriptor->field(1), -1);
+}
+
+bool MapFieldsEqual(const Message& a, const Message& b,
+                    const FieldDescriptor* field, int size) {
+  const Reflection* a_reflection = a.GetReflection();
+  const Reflection* b_reflection = b.GetReflection();
+
+  // Maps that were filled in the same way list their entries in the same
+  // order, so try that first.
+  int start = 0;
+  while (start < size &&
+         MapEntriesEqual(a_reflection->GetRepeatedMessage(a, field, start),
+                         b_reflection->GetRepeatedMessage(b, field, start))) {
+    start++;
+  }
+  if (start == size) return true;
+
+  vector<const Message*> a_entries, b_entries;
+  a_entries.reserve(size - start);
+  b_entries.reserve(size - start);
+  for (int i = start; i < size; i++) {
+    a_entries.push_back(&a_reflection->GetRepeatedMessage(a, field, i));
+    b_entries.push_back(&b_reflection->GetRepeatedMessage(b, field, i));
+  }
+  MapEntryKeyLess less(field->message_type()->field(0));
+  std::sort(a_entries.begin(), a_entries.end(), less);
+  std::sort(b_entries.begin(), b_entries.end(), less);
+  for (int i = 0; i < a_entries.size(); i++) {
+    if (!MapEntriesEqual(*a_entries[i], *b_entries[i])) return false;
+  }
+  return true;
+}
+
+// Returns the term "field" adds to the hash of "message", or 0 if the field
+// is not set.
+uint64 HashField(const Message& message, const FieldDescriptor* field) {
+  const Reflection* reflection = message.GetReflection();
+  if (!field->is_repeated()) {
+    if (!reflection->HasField(message, field)) return 0;
+    return HashCombine(field->number(), HashFieldValue(message, field, -1));
+  }
+
+  const int size = reflection->FieldSize(message, field);
+  if (size == 0) return 0;
+  uint64 field_hash = 0;
+  if (field->is_map()) {
+    const Descriptor* entry_descriptor = field->message_type();
+    for (int i = 0; i < size; i++) {
+      const Message& entry = reflection->GetRepeatedMessage(message, field, i);
+      field_hash += HashCombine(
+          HashFieldValue(entry, entry_descriptor->field(0), -1),
+          HashFieldValue(entry, entry_descriptor->field(1), -1));
+    }
+  } else {
+    for (int i = 0; i < size; i++) {
+      field_hash = HashCombine(field_hash, HashFieldValue(message, field, i));
+    }
+  }
+  return HashCombine(field->number(), field_hash);
+}
+
+bool FieldsEqual(const Message& a, const Message& b,
+                 const FieldDescriptor* field) {
+  const Reflection* a_reflection = a.GetReflection();
+  const Reflection* b_reflection = b.GetReflection();
+  if (!field->is_repeated()) {
+    const bool has_field = a_reflection->HasField(a, field);
+    if (has_field != b_reflection->HasField(b, field)) return false;
+    return !has_field || FieldValuesEqual(a, b, field, -1);
+  }
+
+  const int size = a_reflection->FieldSize(a, field);
+  if (size != b_reflection->FieldSize(b, field)) return false;
+  if (field->is_map()) return MapFieldsEqual(a, b, field, size);
+  for (int i = 0; i < size; i++) {
+    if (!FieldValuesEqual(a, b, field, i)) return false;
+  }
+  return true;
+}
+
+// Appends the extensions set in "message" to "fields".
+void ListExtensions(const Message& message,
+                    vector<const FieldDescriptor*>* fields) {
+  vector<const FieldDescriptor*> all_fields;
+  message.GetReflection()->ListFields(message, &all_fields);
+  for (int i = 0; i < all_fields.size(); i++) {
+    if (all_fields[i]->is_extension()) fields->push_back(all_fields[i]);
+  }
+}
+
+bool UnknownFieldValuesEqual(const UnknownField& a, const UnknownField& b) {
+  if (a.type() != b.type()) return false;
+  switch (a.type()) {
+    case UnknownField::TYPE_VARINT:
+      return a.varint() == b.varint();
+    case UnknownField::TYPE_FIXED32:
+      return a.fixed32() == b.fixed32();
+    case UnknownField::TYPE_FIXED64:
+      return a.fixed64() == b.fixed64();
+    case UnknownField::TYPE_LENGTH_DELIMITED:
+      return a.length_delimited() == b.length_delimited();
+    case UnknownField::TYPE_GROUP:
+      return ReflectionOps::UnknownFieldsEqual(a.group(), b.group());
+  }
+  return false;
+}
+
+}  // namespace
+
+uint64 ReflectionOps::Hash(const Message& message) {
+  const Descriptor* descriptor = message.GetDescriptor();
+  const Reflection* reflection = message.GetReflection();
+
+  // Each term is already mixed, so they are simply added up; this keeps the
+  // result independent of the order in which fields are visited.
+  uint64 hash = 0;
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    hash += HashField(message, descriptor->field(i));
+  }
+  if (descriptor->extension_range_count() > 0) {
+    vector<const FieldDescriptor*> extensions;
+    ListExtensions(message, &extensions);
+    for (int i = 0; i < extensions.size(); i++) {
+      hash += HashField(message, extensions[i]);
+    }
+  }
+  hash += HashUnknownFields(reflection->GetUnknownFields(message));
+  return hash;
+}
+
+bool ReflectionOps::Equals(const Message& a, const Message& b) {
+  if (&a == &b) return true;
+  const Descriptor* descriptor = a.GetDescriptor();
+  if (b.GetDescriptor() != descriptor) return false;
+
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    if (!FieldsEqual(a, b, descriptor->field(i))) return false;
+  }
+  if (descriptor->extension_range_count() > 0) {
+    vector<const FieldDescriptor*> a_extensions, b_extensions;
+    ListExtensions(a, &a_extensions);
+    ListExtensions(b, &b_extensions);
+    // Both lists are sorted by field number.
+    if (a_extensions != b_extensions) return false;
+    for (int i = 0; i < a_extensions.size(); i++) {
+      if (!FieldsEqual(a, b, a_extensions[i])) return false;
+    }
+  }
+  return UnknownFieldsEqual(a.GetReflection()->GetUnknownFields(a),
+                            b.GetReflection()->GetUnknownFields(b));
+}
+
+uint64 ReflectionOps::HashUnknownFields(const UnknownFieldSet& unknown_fields) {
+  uint64 hash = 0;
+  for (int i = 0; i < unknown_fields.field_count(); i++) {
+    const UnknownField& field = unknown_fields.field(i);
+    uint64 value_hash = 0;
+    switch (field.type()) {
+      case UnknownField::TYPE_VARINT:
+        value_hash = HashValue(field.varint());
+        break;
+      case UnknownField::TYPE_FIXED32:
+        value_hash = HashValue(field.fixed32());
+        break;
+      case UnknownField::TYPE_FIXED64:
+        value_hash = HashValue(field.fixed64());
+        break;
+      case UnknownField::TYPE_LENGTH_DELIMITED:
+        value_hash = HashValue(field.length_delimited());
+        break;
+      case UnknownField::TYPE_GROUP:
+        value_hash = HashUnknownFields(field.group());
+        break;
+    }
+    // Like known fields, unknown fields are added up, so their order does
+    // not matter.
+    hash += HashCombine(field.number(), HashCombine(field.type(), value_hash));
+  }
+  return hash;
+}
+
+bool ReflectionOps::UnknownFieldsEqual(const UnknownFieldSet& a,
+                                       const UnknownFieldSet& b) {
+  const int count = a.field_count();
+  if (count != b.field_count()) return false;
+
+  // Usually both sets were parsed from the same layout.
+  int start = 0;
+  while (start < count && a.field(start).number() == b.field(start).number() &&
+         UnknownFieldValuesEqual(a.field(start), b.field(start))) {
+    start++;
+  }
+
+  // Otherwise match up the fields by number.  Fields with the same number
+  // keep their relative order, like the elements of a repeated field, so the
+  // n-th occurrence of a number in "a" must equal the n-th one in "b".  This
+  // is quadratic, but unknown fields are rare and few.
+  for (int i = start; i < count; i++) {
+    const UnknownField& field = a.field(i);
+    int occurrence = 0;
+    for (int j = start; j < i; j++) {
+      if (a.field(j).number() == field.number()) occurrence++;
+    }
+    const UnknownField* match = NULL;
+    for (int j = start; j < count; j++) {
+      if (b.field(j).number() == field.number() && occurrence-- == 0) {
+        match = &b.field(j);
+        break;
+      }
+    }
+    if (match == NULL || !UnknownFieldValuesEqual(field, *match)) return false;
+  }
+  return true;
+}
+
 static string SubMessagePrefix(const string& prefix,
                                const FieldDescriptor* field,
                                int index) {
@@ -264,6 +584,34 @@ void ReflectionOps::FindInitializationErrors(
   }
 }
 
+bool MapEntryKeyLess::operator()(const Message* a, const Message* b) const {
+  const Reflection* reflection = a->GetReflection();
+  switch (key_field_->cpp_type()) {
+#define HANDLE_TYPE(CPPTYPE, METHOD)                                     \
+    case FieldDescriptor::CPPTYPE_##CPPTYPE:                             \
+      return reflection->Get##METHOD(*a, key_field_) <                   \
+             reflection->Get##METHOD(*b, key_field_);
+
+    HANDLE_TYPE(INT32 , Int32 );
+    HANDLE_TYPE(INT64 , Int64 );
+    HANDLE_TYPE(UINT32, UInt32);
+    HANDLE_TYPE(UINT64, UInt64);
+    HANDLE_TYPE(BOOL  , Bool  );
+#undef HANDLE_TYPE
+
+    case FieldDescriptor::CPPTYPE_STRING: {
+      string a_scratch, b_scratch;
+      return reflection->GetStringReference(*a, key_field_, &a_scratch) <
+             reflection->GetStringReference(*b, key_field_, &b_scratch);
+    }
+
+    default:
+      GOOGLE_LOG(FATAL) << "Invalid map key type: "
+                 << key_field_->cpp_type_name();
+      return false;
+  }
+}
+
 }  // namespace internal
 }  // namespace protobuf
 }  // namespace google
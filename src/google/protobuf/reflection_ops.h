@@ -62,6 +62,16 @@ class LIBPROTOBUF_EXPORT ReflectionOps {
   static bool IsInitialized(const Message& message);
   static void DiscardUnknownFields(Message* message);
 
+  // Implement Message::StructuralHash() and Message::StructurallyEquals(),
+  // computing the same values as generated code does.
+  static uint64 Hash(const Message& message);
+  static bool Equals(const Message& a, const Message& b);
+
+  // The unknown-field parts of the above, which generated code calls too.
+  static uint64 HashUnknownFields(const UnknownFieldSet& unknown_fields);
+  static bool UnknownFieldsEqual(const UnknownFieldSet& a,
+                                 const UnknownFieldSet& b);
+
   // Finds all unset required fields in the message and adds their full
   // paths (e.g. "foo.bar[5].baz") to *names.  "prefix" will be attached to
   // the front of each name.
@@ -74,6 +84,20 @@ class LIBPROTOBUF_EXPORT ReflectionOps {
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(ReflectionOps);
 };
 
+// Orders map entries by key, comparing integers numerically and strings
+// bytewise like the generated code does.  Used for deterministic
+// serialization and to compare maps regardless of entry order.
+class LIBPROTOBUF_EXPORT MapEntryKeyLess {
+ public:
+  explicit MapEntryKeyLess(const FieldDescriptor* key_field)
+      : key_field_(key_field) {}
+
+  bool operator()(const Message* a, const Message* b) const;
+
+ private:
+  const FieldDescriptor* key_field_;
+};
+
 }  // namespace internal
 }  // namespace protobuf
 
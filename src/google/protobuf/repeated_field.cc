@@ -62,6 +62,7 @@ void** RepeatedPtrFieldBase::InternalExtend(int extend_amount) {
             kRepHeaderSize + sizeof(old_rep->elements[0])*new_size));
   }
   total_size_ = new_size;
+  rep_->is_inline = false;
   if (old_rep && old_rep->allocated_size > 0) {
     memcpy(rep_->elements, old_rep->elements,
            old_rep->allocated_size * sizeof(rep_->elements[0]));
@@ -69,7 +70,7 @@ void** RepeatedPtrFieldBase::InternalExtend(int extend_amount) {
   } else {
     rep_->allocated_size = 0;
   }
-  if (arena == NULL) {
+  if (arena == NULL && (old_rep == NULL || !old_rep->is_inline)) {
     delete [] reinterpret_cast<char*>(old_rep);
   }
   return &rep_->elements[current_size_];
@@ -90,6 +91,28 @@ void RepeatedPtrFieldBase::CloseGap(int start, int num) {
   rep_->allocated_size -= num;
 }
 
+void RepeatedPtrFieldBase::InitInlineRep(void* rep, int capacity) {
+  GOOGLE_DCHECK(rep_ == NULL);
+  rep_ = static_cast<Rep*>(rep);
+  rep_->allocated_size = 0;
+  rep_->is_inline = true;
+  total_size_ = capacity;
+}
+
+void RepeatedPtrFieldBase::SwapElementwise(RepeatedPtrFieldBase* other) {
+  int size = max(rep_ == NULL ? 0 : rep_->allocated_size,
+                 other->rep_ == NULL ? 0 : other->rep_->allocated_size);
+  if (size == 0) return;
+  if (total_size_ < size) InternalExtend(size - current_size_);
+  if (other->total_size_ < size) {
+    other->InternalExtend(size - other->current_size_);
+  }
+  std::swap_ranges(rep_->elements, rep_->elements + size,
+                   other->rep_->elements);
+  std::swap(rep_->allocated_size, other->rep_->allocated_size);
+  std::swap(current_size_, other->current_size_);
+}
+
 }  // namespace internal
 
 
@@ -95,6 +95,11 @@ inline int CalculateReserve(Iter begin, Iter end) {
   typedef typename std::iterator_traits<Iter>::iterator_category Category;
   return CalculateReserve(begin, end, Category());
 }
+
+template <typename Element, int kInlineCapacity>
+class InlinedRepeatedField;
+template <typename Element, int kInlineCapacity>
+class InlinedRepeatedPtrField;
 }  // namespace internal
 
 
@@ -114,6 +119,14 @@ class RepeatedField {
 
   RepeatedField& operator=(const RepeatedField& other);
 
+#if LANG_CXX11
+  // Moving steals the other field's storage when both fields are on the same
+  // arena (or both on the heap), and copies otherwise.  The moved-from field
+  // is left empty in the first case and unchanged in the second.
+  RepeatedField(RepeatedField&& other) noexcept;
+  RepeatedField& operator=(RepeatedField&& other) noexcept;
+#endif
+
   bool empty() const;
   int size() const;
 
@@ -206,6 +219,7 @@ class RepeatedField {
   // Returns the number of bytes used by the repeated field, excluding
   // sizeof(*this)
   int SpaceUsedExcludingSelf() const;
+  size_t SpaceUsedExcludingSelfLong() const;
 
   // Remove the element referenced by position.
   iterator erase(const_iterator position);
@@ -245,9 +259,32 @@ class RepeatedField {
   // if rep_ is NULL, then arena is NULL.
   Rep* rep_;
 
+  // A Rep may also live inside an enclosing InlinedRepeatedField instead of on
+  // the heap or an arena.  Such a Rep is marked by setting the low bit of its
+  // arena pointer; it is never freed, and its elements are constructed and
+  // destroyed by the enclosing object.
+  static const intptr_t kInlineRepTag = 1;
+
   friend class Arena;
   typedef void InternalArenaConstructable_;
 
+  template <typename E, int kInlineCapacity>
+  friend class internal::InlinedRepeatedField;
+
+  // Points this empty field at |rep|, which must have room for |capacity|
+  // elements and outlive the field's use of it.
+  void InitInlineRep(void* rep, int capacity, Arena* arena);
+
+  // True if the elements are stored in an enclosing InlinedRepeatedField.
+  inline bool HasInlineRep() const {
+    return rep_ != NULL &&
+        (reinterpret_cast<intptr_t>(rep_->arena) & kInlineRepTag) != 0;
+  }
+
+  // Swaps contents element by element, for fields whose storage cannot change
+  // hands.
+  void SwapElementwise(RepeatedField* other);
+
   // Move the contents of |from| into |to|, possibly clobbering |from| in the
   // process.  For primitive types this is just a memcpy(), but it could be
   // specialized for non-primitive types to, say, swap each element instead.
@@ -260,7 +297,8 @@ class RepeatedField {
 
   // Internal helper expected by Arena methods.
   inline Arena* GetArenaNoVirtual() const {
-    return (rep_ == NULL) ? NULL : rep_->arena;
+    return (rep_ == NULL) ? NULL : reinterpret_cast<Arena*>(
+        reinterpret_cast<intptr_t>(rep_->arena) & ~kInlineRepTag);
   }
 };
 
@@ -333,12 +371,18 @@ struct TypeImplementsMergeBehavior< ::std::string > {
 //    public:
 //     typedef MyType Type;
 //     static Type* New();
+//     // Creates n objects on the arena at once, or returns false if it
+//     // cannot; see ArenaOptions::slab_allocate_repeated_messages.
+//     static bool NewBatch(Arena*, int n, Type** elements);
 //     static void Delete(Type*);
 //     static void Clear(Type*);
 //     static void Merge(const Type& from, Type* to);
 //
 //     // Only needs to be implemented if SpaceUsedExcludingSelf() is called.
 //     static int SpaceUsed(const Type&);
+//     // Only needs to be implemented if SpaceUsedExcludingSelfLong() is
+//     // called.
+//     static size_t SpaceUsedLong(const Type&);
 //   };
 class LIBPROTOBUF_EXPORT RepeatedPtrFieldBase {
  protected:
@@ -414,6 +458,8 @@ class LIBPROTOBUF_EXPORT RepeatedPtrFieldBase {
 
   template <typename TypeHandler>
   int SpaceUsedExcludingSelf() const;
+  template <typename TypeHandler>
+  size_t SpaceUsedExcludingSelfLong() const;
 
 
   // Advanced memory management --------------------------------------
@@ -497,6 +543,10 @@ class LIBPROTOBUF_EXPORT RepeatedPtrFieldBase {
   int    total_size_;
   struct Rep {
     int    allocated_size;
+    // True if this Rep lives inside an enclosing InlinedRepeatedPtrField
+    // instead of on the heap or an arena.  Such a Rep is never freed.  On
+    // 64-bit platforms this fits in the padding before elements[].
+    bool   is_inline;
     void*  elements[1];
   };
   static const size_t kRepHeaderSize = sizeof(Rep) - sizeof(void*);
@@ -504,6 +554,23 @@ class LIBPROTOBUF_EXPORT RepeatedPtrFieldBase {
   // if rep_ is NULL, then arena is NULL.
   Rep* rep_;
 
+  template <typename E, int kInlineCapacity>
+  friend class InlinedRepeatedPtrField;
+
+  // Points this empty field at |rep|, which must have room for |capacity|
+  // elements and outlive the field's use of it.
+  void InitInlineRep(void* rep, int capacity);
+
+  // True if the element pointers are stored in an enclosing
+  // InlinedRepeatedPtrField.
+  inline bool HasInlineRep() const {
+    return rep_ != NULL && rep_->is_inline;
+  }
+
+  // Swaps contents pointer by pointer, for fields whose Rep cannot change
+  // hands.
+  void SwapElementwise(RepeatedPtrFieldBase* other);
+
   template <typename TypeHandler>
   static inline typename TypeHandler::Type* cast(void* element) {
     return reinterpret_cast<typename TypeHandler::Type*>(element);
@@ -550,6 +617,11 @@ class GenericTypeHandler {
     GOOGLE_ATTRIBUTE_NOINLINE {
     return New(arena);
   }
+  static inline bool NewBatch(Arena* arena, int n, GenericType** elements)
+    GOOGLE_ATTRIBUTE_NOINLINE {
+    return ::google::protobuf::Arena::CreateMaybeMessageArray<Type>(
+        arena, n, elements, static_cast<GenericType*>(0));
+  }
   static inline void Delete(GenericType* value, Arena* arena)
     GOOGLE_ATTRIBUTE_NOINLINE {
     if (arena == NULL) {
@@ -571,6 +643,9 @@ class GenericTypeHandler {
   static inline int SpaceUsed(const GenericType& value) {
     return value.SpaceUsed();
   }
+  static inline size_t SpaceUsedLong(const GenericType& value) {
+    return value.SpaceUsedLong();
+  }
   static inline const Type& default_instance() {
     return Type::default_instance();
   }
@@ -666,6 +741,9 @@ class LIBPROTOBUF_EXPORT StringTypeHandlerBase {
                                          ::google::protobuf::Arena* arena) {
     return New(arena);
   }
+  static inline bool NewBatch(Arena*, int, string**) {
+    return false;
+  }
   static inline ::google::protobuf::Arena* GetArena(string*) {
     return NULL;
   }
@@ -689,6 +767,9 @@ class StringTypeHandler : public StringTypeHandlerBase {
   static int SpaceUsed(const string& value)  {
     return sizeof(value) + StringSpaceUsedExcludingSelf(value);
   }
+  static size_t SpaceUsedLong(const string& value) {
+    return sizeof(value) + StringSpaceUsedExcludingSelf(value);
+  }
 };
 
 
@@ -709,6 +790,13 @@ class RepeatedPtrField : public internal::RepeatedPtrFieldBase {
 
   RepeatedPtrField& operator=(const RepeatedPtrField& other);
 
+#if LANG_CXX11
+  // See RepeatedField's move operations; the element pointers are stolen
+  // rather than the elements being copied one by one.
+  RepeatedPtrField(RepeatedPtrField&& other) noexcept;
+  RepeatedPtrField& operator=(RepeatedPtrField&& other) noexcept;
+#endif
+
   bool empty() const;
   int size() const;
 
@@ -800,8 +888,10 @@ class RepeatedPtrField : public internal::RepeatedPtrFieldBase {
   const_pointer_iterator pointer_end() const;
 
   // Returns (an estimate of) the number of bytes used by the repeated field,
-  // excluding sizeof(*this).
+  // excluding sizeof(*this).  The Long variant sizes message elements with
+  // their own SpaceUsedLong(), so it does not need reflection.
   int SpaceUsedExcludingSelf() const;
+  size_t SpaceUsedExcludingSelfLong() const;
 
   // Advanced memory management --------------------------------------
   // When hardcore memory management becomes necessary -- as it sometimes
@@ -1001,6 +1091,38 @@ RepeatedField<Element>::operator=(const RepeatedField& other) {
   return *this;
 }
 
+#if LANG_CXX11
+
+template <typename Element>
+inline RepeatedField<Element>::RepeatedField(RepeatedField&& other) noexcept
+  : current_size_(0),
+    total_size_(0),
+    rep_(NULL) {
+  // A newly constructed field is always on the heap, so only a heap-allocated
+  // source can give up its storage.  Swap() is not used because it would copy
+  // three times when the arenas differ.
+  if (other.GetArenaNoVirtual() != NULL) {
+    CopyFrom(other);
+  } else {
+    InternalSwap(&other);
+  }
+}
+
+template <typename Element>
+inline RepeatedField<Element>&
+RepeatedField<Element>::operator=(RepeatedField&& other) noexcept {
+  if (this != &other) {
+    if (GetArenaNoVirtual() != other.GetArenaNoVirtual()) {
+      CopyFrom(other);
+    } else {
+      InternalSwap(&other);
+    }
+  }
+  return *this;
+}
+
+#endif  // LANG_CXX11
+
 template <typename Element>
 inline bool RepeatedField<Element>::empty() const {
   return current_size_ == 0;
@@ -1149,11 +1271,37 @@ inline const Element* RepeatedField<Element>::data() const {
 
 template <typename Element>
 inline void RepeatedField<Element>::InternalSwap(RepeatedField* other) {
+  if (HasInlineRep() || other->HasInlineRep()) {
+    SwapElementwise(other);
+    return;
+  }
   std::swap(rep_, other->rep_);
   std::swap(current_size_, other->current_size_);
   std::swap(total_size_, other->total_size_);
 }
 
+template <typename Element>
+void RepeatedField<Element>::SwapElementwise(RepeatedField* other) {
+  int size = max(current_size_, other->current_size_);
+  if (size > 0) {
+    Reserve(size);
+    other->Reserve(size);
+    std::swap_ranges(rep_->elements, rep_->elements + size,
+                     other->rep_->elements);
+  }
+  std::swap(current_size_, other->current_size_);
+}
+
+template <typename Element>
+void RepeatedField<Element>::InitInlineRep(void* rep, int capacity,
+                                           Arena* arena) {
+  GOOGLE_DCHECK(rep_ == NULL);
+  rep_ = reinterpret_cast<Rep*>(rep);
+  rep_->arena = reinterpret_cast<Arena*>(
+      reinterpret_cast<intptr_t>(arena) | kInlineRepTag);
+  total_size_ = capacity;
+}
+
 template <typename Element>
 void RepeatedField<Element>::Swap(RepeatedField* other) {
   if (this == other) return;
@@ -1213,7 +1361,13 @@ RepeatedField<Element>::cend() const {
 
 template <typename Element>
 inline int RepeatedField<Element>::SpaceUsedExcludingSelf() const {
-  return rep_ ?
+  return rep_ && !HasInlineRep() ?
+      (total_size_ * sizeof(Element) + kRepHeaderSize) : 0;
+}
+
+template <typename Element>
+inline size_t RepeatedField<Element>::SpaceUsedExcludingSelfLong() const {
+  return rep_ && !HasInlineRep() ?
       (total_size_ * sizeof(Element) + kRepHeaderSize) : 0;
 }
 
@@ -1223,6 +1377,7 @@ template <typename Element>
 void RepeatedField<Element>::Reserve(int new_size) {
   if (total_size_ >= new_size) return;
   Rep* old_rep = rep_;
+  bool old_rep_is_inline = HasInlineRep();
   Arena* arena = GetArenaNoVirtual();
   new_size = max(google::protobuf::internal::kMinRepeatedFieldAllocationSize,
                  max(total_size_ * 2, new_size));
@@ -1253,6 +1408,9 @@ void RepeatedField<Element>::Reserve(int new_size) {
   if (current_size_ > 0) {
     MoveArray(rep_->elements, old_rep->elements, current_size_);
   }
+  // An inline array belongs to the enclosing InlinedRepeatedField, which
+  // destroys its elements itself.
+  if (old_rep_is_inline) return;
   // Likewise, we need to invoke destructors on the old array. If Element has no
   // destructor, this loop will disappear.
   e = &old_rep->elements[0];
@@ -1300,6 +1458,49 @@ struct ElementCopier<Element, true> {
   }
 };
 
+// A RepeatedField which keeps its first kInlineCapacity elements inside the
+// object itself, so that a short field needs no allocation at all.  Once it
+// grows past that, its elements move to the heap or arena just like those of
+// any other RepeatedField.  The C++ code generator uses this for repeated
+// primitive and enum fields when given the inline_repeated=N option; all
+// accessors still expose the field as a plain RepeatedField.
+template <typename Element, int kInlineCapacity>
+class InlinedRepeatedField : public RepeatedField<Element> {
+ public:
+  InlinedRepeatedField() {
+    this->InitInlineRep(&inline_rep_, kInlineCapacity, NULL);
+  }
+  explicit InlinedRepeatedField(Arena* arena) {
+    this->InitInlineRep(&inline_rep_, kInlineCapacity, arena);
+  }
+  InlinedRepeatedField(const InlinedRepeatedField& other)
+      : RepeatedField<Element>() {
+    this->InitInlineRep(&inline_rep_, kInlineCapacity, NULL);
+    this->CopyFrom(other);
+  }
+  ~InlinedRepeatedField() {
+    // The inline array is destroyed along with this object; keep the base
+    // class destructor from touching it.
+    if (this->HasInlineRep()) this->rep_ = NULL;
+  }
+
+  InlinedRepeatedField& operator=(const InlinedRepeatedField& other) {
+    this->CopyFrom(other);
+    return *this;
+  }
+
+  // True while the elements still fit in the inline array.
+  bool is_inlined() const { return this->HasInlineRep(); }
+
+ private:
+  // Laid out like RepeatedField<Element>::Rep.
+  struct InlineRep {
+    Arena* arena;
+    Element elements[kInlineCapacity];
+  };
+  InlineRep inline_rep_;
+};
+
 }  // namespace internal
 
 
@@ -1327,7 +1528,7 @@ void RepeatedPtrFieldBase::Destroy() {
     for (int i = 0; i < rep_->allocated_size; i++) {
       TypeHandler::Delete(cast<TypeHandler>(rep_->elements[i]), arena_);
     }
-    if (arena_ == NULL) {
+    if (arena_ == NULL && !rep_->is_inline) {
       delete [] reinterpret_cast<char*>(rep_);
     }
   }
@@ -1400,6 +1601,15 @@ inline typename TypeHandler::Type* RepeatedPtrFieldBase::Add(
   if (!rep_ || rep_->allocated_size == total_size_) {
     Reserve(total_size_ + 1);
   }
+  if (arena_ != NULL &&
+      TypeHandler::NewBatch(
+          arena_, total_size_ - rep_->allocated_size,
+          reinterpret_cast<typename TypeHandler::Type**>(
+              rep_->elements + rep_->allocated_size))) {
+    // The rest of the array now holds fresh elements, kept as cleared objects.
+    rep_->allocated_size = total_size_;
+    return cast<TypeHandler>(rep_->elements[current_size_++]);
+  }
   ++rep_->allocated_size;
   typename TypeHandler::Type* result =
       TypeHandler::NewFromPrototype(prototype, arena_);
@@ -1472,6 +1682,18 @@ void RepeatedPtrFieldBase::MergeFromInnerLoop(
     TypeHandler::Merge(*other_elem, new_elem);
   }
   Arena* arena = GetArenaNoVirtual();
+  if (arena != NULL && already_allocated < length &&
+      TypeHandler::NewBatch(
+          arena, length - already_allocated,
+          reinterpret_cast<typename TypeHandler::Type**>(
+              our_elems + already_allocated))) {
+    for (int i = already_allocated; i < length; i++) {
+      TypeHandler::Merge(
+          *reinterpret_cast<typename TypeHandler::Type*>(other_elems[i]),
+          reinterpret_cast<typename TypeHandler::Type*>(our_elems[i]));
+    }
+    return;
+  }
   for (int i = already_allocated; i < length; i++) {
     // Not allocated: alloc a new element first, then merge it.
     typename TypeHandler::Type* other_elem =
@@ -1524,13 +1746,33 @@ inline void RepeatedPtrFieldBase::SwapElements(int index1, int index2) {
 
 template <typename TypeHandler>
 inline int RepeatedPtrFieldBase::SpaceUsedExcludingSelf() const {
-  int allocated_bytes = total_size_ * sizeof(void*);
+  int allocated_bytes = 0;
   if (rep_ != NULL) {
     for (int i = 0; i < rep_->allocated_size; ++i) {
       allocated_bytes += TypeHandler::SpaceUsed(
           *cast<TypeHandler>(rep_->elements[i]));
     }
-    allocated_bytes += kRepHeaderSize;
+    // An inline Rep is part of the enclosing object.
+    if (!rep_->is_inline) {
+      allocated_bytes += total_size_ * sizeof(void*) + kRepHeaderSize;
+    }
+  }
+  return allocated_bytes;
+}
+
+template <typename TypeHandler>
+inline size_t RepeatedPtrFieldBase::SpaceUsedExcludingSelfLong() const {
+  size_t allocated_bytes = 0;
+  if (rep_ != NULL) {
+    for (int i = 0; i < rep_->allocated_size; ++i) {
+      allocated_bytes += TypeHandler::SpaceUsedLong(
+          *cast<TypeHandler>(rep_->elements[i]));
+    }
+    // An inline Rep is part of the enclosing object.
+    if (!rep_->is_inline) {
+      allocated_bytes += static_cast<size_t>(total_size_) * sizeof(void*) +
+                         kRepHeaderSize;
+    }
   }
   return allocated_bytes;
 }
@@ -1778,6 +2020,34 @@ inline RepeatedPtrField<Element>& RepeatedPtrField<Element>::operator=(
   return *this;
 }
 
+#if LANG_CXX11
+
+template <typename Element>
+inline RepeatedPtrField<Element>::RepeatedPtrField(
+    RepeatedPtrField&& other) noexcept
+  : RepeatedPtrFieldBase() {
+  if (other.GetArenaNoVirtual() != NULL) {
+    CopyFrom(other);
+  } else {
+    InternalSwap(&other);
+  }
+}
+
+template <typename Element>
+inline RepeatedPtrField<Element>& RepeatedPtrField<Element>::operator=(
+    RepeatedPtrField&& other) noexcept {
+  if (this != &other) {
+    if (GetArenaNoVirtual() != other.GetArenaNoVirtual()) {
+      CopyFrom(other);
+    } else {
+      InternalSwap(&other);
+    }
+  }
+  return *this;
+}
+
+#endif  // LANG_CXX11
+
 template <typename Element>
 inline bool RepeatedPtrField<Element>::empty() const {
   return RepeatedPtrFieldBase::empty();
@@ -1967,6 +2237,11 @@ inline int RepeatedPtrField<Element>::SpaceUsedExcludingSelf() const {
   return RepeatedPtrFieldBase::SpaceUsedExcludingSelf<TypeHandler>();
 }
 
+template <typename Element>
+inline size_t RepeatedPtrField<Element>::SpaceUsedExcludingSelfLong() const {
+  return RepeatedPtrFieldBase::SpaceUsedExcludingSelfLong<TypeHandler>();
+}
+
 template <typename Element>
 inline void RepeatedPtrField<Element>::AddAllocated(Element* value) {
   RepeatedPtrFieldBase::AddAllocated<TypeHandler>(value);
@@ -2201,11 +2476,55 @@ class RepeatedPtrOverPtrsIterator
 };
 
 void RepeatedPtrFieldBase::InternalSwap(RepeatedPtrFieldBase* other) {
+  if (HasInlineRep() || other->HasInlineRep()) {
+    SwapElementwise(other);
+    return;
+  }
   std::swap(rep_, other->rep_);
   std::swap(current_size_, other->current_size_);
   std::swap(total_size_, other->total_size_);
 }
 
+// A RepeatedPtrField which keeps its first kInlineCapacity element pointers
+// inside the object itself, so that a short field needs no pointer array.
+// The elements themselves are still allocated one by one, as usual.  The C++
+// code generator uses this for repeated string and message fields when given
+// the inline_repeated=N option; accessors still expose a plain
+// RepeatedPtrField.
+template <typename Element, int kInlineCapacity>
+class InlinedRepeatedPtrField : public RepeatedPtrField<Element> {
+ public:
+  InlinedRepeatedPtrField() {
+    this->InitInlineRep(&inline_rep_, kInlineCapacity);
+  }
+  explicit InlinedRepeatedPtrField(Arena* arena)
+      : RepeatedPtrField<Element>(arena) {
+    this->InitInlineRep(&inline_rep_, kInlineCapacity);
+  }
+  InlinedRepeatedPtrField(const InlinedRepeatedPtrField& other)
+      : RepeatedPtrField<Element>() {
+    this->InitInlineRep(&inline_rep_, kInlineCapacity);
+    this->CopyFrom(other);
+  }
+
+  InlinedRepeatedPtrField& operator=(const InlinedRepeatedPtrField& other) {
+    this->CopyFrom(other);
+    return *this;
+  }
+
+  // True while the element pointers still fit in the inline array.
+  bool is_inlined() const { return this->HasInlineRep(); }
+
+ private:
+  // Laid out like RepeatedPtrFieldBase::Rep.
+  struct InlineRep {
+    int allocated_size;
+    bool is_inline;
+    void* elements[kInlineCapacity];
+  };
+  InlineRep inline_rep_;
+};
+
 }  // namespace internal
 
 template <typename Element>
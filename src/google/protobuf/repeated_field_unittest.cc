@@ -38,10 +38,13 @@
 #include <algorithm>
 #include <limits>
 #include <list>
+#include <utility>
 #include <vector>
 
 #include <google/protobuf/repeated_field.h>
 
+#include <google/protobuf/arena.h>
+
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/unittest.pb.h>
 #include <google/protobuf/stubs/strutil.h>
@@ -386,6 +389,165 @@ TEST(RepeatedField, SelfAssign) {
   EXPECT_EQ(8, source.Get(1));
 }
 
+#if LANG_CXX11
+TEST(RepeatedField, MoveConstruct) {
+  RepeatedField<int> source;
+  source.Add(1);
+  source.Add(2);
+  const int* data = source.data();
+
+  RepeatedField<int> destination(std::move(source));
+
+  // The storage is taken over, not copied.
+  EXPECT_EQ(data, destination.data());
+  ASSERT_EQ(2, destination.size());
+  EXPECT_EQ(1, destination.Get(0));
+  EXPECT_EQ(2, destination.Get(1));
+  EXPECT_TRUE(source.empty());
+}
+
+TEST(RepeatedField, MoveConstructFromArena) {
+  Arena arena;
+  RepeatedField<int>* source =
+      Arena::CreateMessage<RepeatedField<int> >(&arena);
+  source->Add(1);
+  source->Add(2);
+
+  RepeatedField<int> destination(std::move(*source));
+
+  // The new field is on the heap, so the elements must be copied.
+  EXPECT_NE(source->data(), destination.data());
+  ASSERT_EQ(2, destination.size());
+  EXPECT_EQ(1, destination.Get(0));
+  EXPECT_EQ(2, destination.Get(1));
+  EXPECT_EQ(NULL, destination.GetArena());
+}
+
+TEST(RepeatedField, MoveAssign) {
+  RepeatedField<int> source, destination;
+  source.Add(4);
+  source.Add(5);
+  destination.Add(1);
+  destination.Add(2);
+  destination.Add(3);
+  const int* data = source.data();
+
+  destination = std::move(source);
+
+  EXPECT_EQ(data, destination.data());
+  ASSERT_EQ(2, destination.size());
+  EXPECT_EQ(4, destination.Get(0));
+  EXPECT_EQ(5, destination.Get(1));
+
+  // Self-move leaves the field intact.
+  RepeatedField<int>* p = &destination;
+  destination = std::move(*p);
+  ASSERT_EQ(2, destination.size());
+  EXPECT_EQ(4, destination.Get(0));
+}
+
+TEST(RepeatedField, MoveAssignAcrossArenas) {
+  Arena arena;
+  RepeatedField<int>* source =
+      Arena::CreateMessage<RepeatedField<int> >(&arena);
+  source->Add(4);
+  source->Add(5);
+  RepeatedField<int> destination;
+  destination.Add(1);
+
+  destination = std::move(*source);
+
+  EXPECT_NE(source->data(), destination.data());
+  ASSERT_EQ(2, destination.size());
+  EXPECT_EQ(4, destination.Get(0));
+  EXPECT_EQ(5, destination.Get(1));
+  EXPECT_EQ(NULL, destination.GetArena());
+}
+#endif  // LANG_CXX11
+
+TEST(RepeatedField, InlinedSmall) {
+  internal::InlinedRepeatedField<int, 3> field;
+  const RepeatedField<int>& base = field;
+  EXPECT_EQ(3, base.Capacity());
+  EXPECT_TRUE(field.is_inlined());
+
+  field.Add(1);
+  field.Add(2);
+  field.Add(3);
+  EXPECT_TRUE(field.is_inlined());
+  EXPECT_EQ(0, field.SpaceUsedExcludingSelf());
+  // The elements are stored inside the field object itself.
+  EXPECT_GE(reinterpret_cast<const char*>(field.data()),
+            reinterpret_cast<const char*>(&field));
+  EXPECT_LT(reinterpret_cast<const char*>(field.data()),
+            reinterpret_cast<const char*>(&field + 1));
+}
+
+TEST(RepeatedField, InlinedGrows) {
+  internal::InlinedRepeatedField<int, 2> field;
+  for (int i = 0; i < 10; i++) {
+    field.Add(i);
+  }
+  EXPECT_FALSE(field.is_inlined());
+  EXPECT_LT(0, field.SpaceUsedExcludingSelf());
+  ASSERT_EQ(10, field.size());
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(i, field.Get(i));
+  }
+}
+
+TEST(RepeatedField, InlinedSwap) {
+  internal::InlinedRepeatedField<int, 4> inlined;
+  inlined.Add(1);
+  inlined.Add(2);
+  RepeatedField<int> plain;
+  for (int i = 0; i < 6; i++) {
+    plain.Add(10 + i);
+  }
+
+  // The inline array cannot be handed over, so the elements are swapped.
+  inlined.Swap(&plain);
+  ASSERT_EQ(6, inlined.size());
+  EXPECT_EQ(10, inlined.Get(0));
+  EXPECT_EQ(15, inlined.Get(5));
+  ASSERT_EQ(2, plain.size());
+  EXPECT_EQ(1, plain.Get(0));
+  EXPECT_EQ(2, plain.Get(1));
+
+  plain.Swap(&inlined);
+  EXPECT_EQ(2, inlined.size());
+  EXPECT_EQ(6, plain.size());
+}
+
+TEST(RepeatedField, InlinedCopy) {
+  internal::InlinedRepeatedField<int, 2> source;
+  source.Add(5);
+  internal::InlinedRepeatedField<int, 2> copy(source);
+  EXPECT_TRUE(copy.is_inlined());
+  EXPECT_NE(source.data(), copy.data());
+  ASSERT_EQ(1, copy.size());
+  EXPECT_EQ(5, copy.Get(0));
+
+  source.Add(6);
+  source.Add(7);
+  copy = source;
+  ASSERT_EQ(3, copy.size());
+  EXPECT_EQ(7, copy.Get(2));
+}
+
+TEST(RepeatedField, InlinedOnArena) {
+  Arena arena;
+  internal::InlinedRepeatedField<int, 2> field(&arena);
+  EXPECT_EQ(&arena, field.GetArena());
+  field.Add(1);
+  field.Add(2);
+  field.Add(3);
+  EXPECT_FALSE(field.is_inlined());
+  EXPECT_EQ(&arena, field.GetArena());
+  ASSERT_EQ(3, field.size());
+  EXPECT_EQ(3, field.Get(2));
+}
+
 TEST(RepeatedField, MutableDataIsMutable) {
   RepeatedField<int> field;
   field.Add(1);
@@ -884,6 +1046,77 @@ TEST(RepeatedPtrField, SelfAssign) {
   EXPECT_EQ("8", source.Get(1));
 }
 
+#if LANG_CXX11
+TEST(RepeatedPtrField, MoveConstruct) {
+  RepeatedPtrField<string> source;
+  source.Add()->assign("1");
+  source.Add()->assign("2");
+  const string* first = &source.Get(0);
+
+  RepeatedPtrField<string> destination(std::move(source));
+
+  // The elements are taken over, not copied.
+  EXPECT_EQ(first, &destination.Get(0));
+  ASSERT_EQ(2, destination.size());
+  EXPECT_EQ("1", destination.Get(0));
+  EXPECT_EQ("2", destination.Get(1));
+  EXPECT_TRUE(source.empty());
+}
+
+TEST(RepeatedPtrField, MoveConstructFromArena) {
+  Arena arena;
+  RepeatedPtrField<TestAllTypes>* source =
+      Arena::CreateMessage<RepeatedPtrField<TestAllTypes> >(&arena);
+  source->Add()->set_optional_int32(1);
+
+  RepeatedPtrField<TestAllTypes> destination(std::move(*source));
+
+  EXPECT_NE(&source->Get(0), &destination.Get(0));
+  ASSERT_EQ(1, destination.size());
+  EXPECT_EQ(1, destination.Get(0).optional_int32());
+  EXPECT_EQ(NULL, destination.GetArena());
+  EXPECT_EQ(NULL, destination.Get(0).GetArena());
+}
+
+TEST(RepeatedPtrField, MoveAssign) {
+  RepeatedPtrField<string> source, destination;
+  source.Add()->assign("4");
+  source.Add()->assign("5");
+  destination.Add()->assign("1");
+  const string* first = &source.Get(0);
+
+  destination = std::move(source);
+
+  EXPECT_EQ(first, &destination.Get(0));
+  ASSERT_EQ(2, destination.size());
+  EXPECT_EQ("4", destination.Get(0));
+  EXPECT_EQ("5", destination.Get(1));
+
+  // Self-move leaves the field intact.
+  RepeatedPtrField<string>* p = &destination;
+  destination = std::move(*p);
+  ASSERT_EQ(2, destination.size());
+  EXPECT_EQ("4", destination.Get(0));
+}
+
+TEST(RepeatedPtrField, MoveAssignAcrossArenas) {
+  Arena arena;
+  RepeatedPtrField<TestAllTypes>* source =
+      Arena::CreateMessage<RepeatedPtrField<TestAllTypes> >(&arena);
+  source->Add()->set_optional_int32(4);
+  RepeatedPtrField<TestAllTypes> destination;
+  destination.Add()->set_optional_int32(1);
+  destination.Add()->set_optional_int32(2);
+
+  destination = std::move(*source);
+
+  EXPECT_NE(&source->Get(0), &destination.Get(0));
+  ASSERT_EQ(1, destination.size());
+  EXPECT_EQ(4, destination.Get(0).optional_int32());
+  EXPECT_EQ(NULL, destination.Get(0).GetArena());
+}
+#endif  // LANG_CXX11
+
 TEST(RepeatedPtrField, MutableDataIsMutable) {
   RepeatedPtrField<string> field;
   *field.Add() = "1";
@@ -966,6 +1199,97 @@ TEST(RepeatedPtrField, DeleteSubrange) {
   // DeleteSubrange is a trivial extension of ExtendSubrange.
 }
 
+TEST(RepeatedPtrField, InlinedSmall) {
+  internal::InlinedRepeatedPtrField<string, 2> field;
+  const RepeatedPtrField<string>& base = field;
+  EXPECT_EQ(2, base.Capacity());
+  EXPECT_TRUE(field.is_inlined());
+
+  field.Add()->assign("foo");
+  field.Add()->assign("bar");
+  EXPECT_TRUE(field.is_inlined());
+  // Only the strings themselves are counted; the pointers live in the field.
+  EXPECT_EQ(2 * sizeof(string), field.SpaceUsedExcludingSelf());
+  EXPECT_GE(reinterpret_cast<const char*>(field.data()),
+            reinterpret_cast<const char*>(&field));
+  EXPECT_LT(reinterpret_cast<const char*>(field.data()),
+            reinterpret_cast<const char*>(&field + 1));
+
+  // Cleared elements stay in the inline array for reuse.
+  field.Clear();
+  EXPECT_EQ(2, field.ClearedCount());
+  EXPECT_TRUE(field.is_inlined());
+}
+
+TEST(RepeatedPtrField, InlinedGrows) {
+  internal::InlinedRepeatedPtrField<string, 2> field;
+  for (int i = 0; i < 10; i++) {
+    field.Add()->assign(SimpleItoa(i));
+  }
+  EXPECT_FALSE(field.is_inlined());
+  EXPECT_LT(10 * sizeof(string), field.SpaceUsedExcludingSelf());
+  ASSERT_EQ(10, field.size());
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(SimpleItoa(i), field.Get(i));
+  }
+}
+
+TEST(RepeatedPtrField, InlinedSwap) {
+  internal::InlinedRepeatedPtrField<string, 4> inlined;
+  inlined.Add()->assign("a");
+  inlined.Add()->assign("b");
+  RepeatedPtrField<string> plain;
+  for (int i = 0; i < 6; i++) {
+    plain.Add()->assign(SimpleItoa(10 + i));
+  }
+  plain.RemoveLast();  // Leave a cleared element behind.
+
+  // The inline array cannot be handed over, so the pointers are swapped.
+  inlined.Swap(&plain);
+  ASSERT_EQ(5, inlined.size());
+  EXPECT_EQ(1, inlined.ClearedCount());
+  EXPECT_EQ("10", inlined.Get(0));
+  EXPECT_EQ("14", inlined.Get(4));
+  ASSERT_EQ(2, plain.size());
+  EXPECT_EQ(0, plain.ClearedCount());
+  EXPECT_EQ("a", plain.Get(0));
+  EXPECT_EQ("b", plain.Get(1));
+
+  plain.Swap(&inlined);
+  EXPECT_EQ(2, inlined.size());
+  EXPECT_EQ(5, plain.size());
+  EXPECT_EQ(1, plain.ClearedCount());
+}
+
+TEST(RepeatedPtrField, InlinedCopy) {
+  internal::InlinedRepeatedPtrField<string, 2> source;
+  source.Add()->assign("x");
+  internal::InlinedRepeatedPtrField<string, 2> copy(source);
+  EXPECT_TRUE(copy.is_inlined());
+  ASSERT_EQ(1, copy.size());
+  EXPECT_EQ("x", copy.Get(0));
+  EXPECT_NE(&source.Get(0), &copy.Get(0));
+
+  source.Add()->assign("y");
+  source.Add()->assign("z");
+  copy = source;
+  ASSERT_EQ(3, copy.size());
+  EXPECT_EQ("z", copy.Get(2));
+}
+
+TEST(RepeatedPtrField, InlinedOnArena) {
+  Arena arena;
+  internal::InlinedRepeatedPtrField<string, 2> field(&arena);
+  EXPECT_EQ(&arena, field.GetArena());
+  field.Add()->assign("1");
+  field.Add()->assign("2");
+  field.Add()->assign("3");
+  EXPECT_FALSE(field.is_inlined());
+  EXPECT_EQ(&arena, field.GetArena());
+  ASSERT_EQ(3, field.size());
+  EXPECT_EQ("3", field.Get(2));
+}
+
 // ===================================================================
 
 // Iterator tests stolen from net/proto/proto-array_unittest.
@@ -62,6 +62,17 @@
 #include <exception>
 #endif
 
+// Define LANG_CXX11 to 1 when compiling as C++11 or later; leave it undefined
+// otherwise.  Do NOT define it to 0, as that makes '#ifdef LANG_CXX11' and
+// '#if LANG_CXX11' disagree.  Generated code uses '#if LANG_CXX11' to guard
+// move constructors and move assignment.
+#ifndef LANG_CXX11
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L || \
+    (defined(_MSC_VER) && _MSC_VER >= 1900)
+#define LANG_CXX11 1
+#endif
+#endif
+
 #if defined(_WIN32) && defined(GetMessage)
 // Allow GetMessage to be used as a valid method name in protobuf classes.
 // windows.h defines GetMessage() as a macro.  Let's re-define it as an inline
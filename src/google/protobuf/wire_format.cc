@@ -32,6 +32,7 @@
 //  Based on original Protocol Buffers design by
 //  Sanjay Ghemawat, Jeff Dean, and others.
 
+#include <algorithm>
 #include <stack>
 #include <string>
 #include <vector>
@@ -43,6 +44,7 @@
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/wire_format_lite_inl.h>
 #include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/reflection_ops.h>
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
@@ -796,6 +798,19 @@ void WireFormat::SerializeFieldWithCachedSizes(
     count = 1;
   }
 
+  if (field->is_map() && count > 1 && output->IsSerializationDeterministic()) {
+    std::vector<const Message*> entries(count);
+    for (int j = 0; j < count; j++) {
+      entries[j] = &message_reflection->GetRepeatedMessage(message, field, j);
+    }
+    std::sort(entries.begin(), entries.end(),
+              MapEntryKeyLess(field->message_type()->FindFieldByName("key")));
+    for (int j = 0; j < count; j++) {
+      WireFormatLite::WriteMessage(field->number(), *entries[j], output);
+    }
+    return;
+  }
+
   const bool is_packed = field->options().packed();
   if (is_packed && count > 0) {
     WireFormatLite::WriteTag(field->number(),
@@ -431,7 +431,10 @@ void WireFormatLite::WriteGroupMaybeToArray(int field_number,
                                             io::CodedOutputStream* output) {
   WriteTag(field_number, WIRETYPE_START_GROUP, output);
   const int size = value.GetCachedSize();
-  uint8* target = output->GetDirectBufferForNBytesAndAdvance(size);
+  // SerializeWithCachedSizesToArray() has no way to order map entries, so
+  // deterministic output stays on the stream.
+  uint8* target = output->IsSerializationDeterministic() ?
+      NULL : output->GetDirectBufferForNBytesAndAdvance(size);
   if (target != NULL) {
     uint8* end = value.SerializeWithCachedSizesToArray(target);
     GOOGLE_DCHECK_EQ(end - target, size);
@@ -447,7 +450,8 @@ void WireFormatLite::WriteMessageMaybeToArray(int field_number,
   WriteTag(field_number, WIRETYPE_LENGTH_DELIMITED, output);
   const int size = value.GetCachedSize();
   output->WriteVarint32(size);
-  uint8* target = output->GetDirectBufferForNBytesAndAdvance(size);
+  uint8* target = output->IsSerializationDeterministic() ?
+      NULL : output->GetDirectBufferForNBytesAndAdvance(size);
   if (target != NULL) {
     uint8* end = value.SerializeWithCachedSizesToArray(target);
     GOOGLE_DCHECK_EQ(end - target, size);
@@ -456,6 +460,23 @@ void WireFormatLite::WriteMessageMaybeToArray(int field_number,
   }
 }
 
+void WireFormatLite::WriteGroupReverse(int field_number,
+                                       const MessageLite& value,
+                                       io::ReverseCodedBuffer* output) {
+  output->WriteTag(MakeTag(field_number, WIRETYPE_END_GROUP));
+  value.InternalSerializeReverse(output);
+  output->WriteTag(MakeTag(field_number, WIRETYPE_START_GROUP));
+}
+
+void WireFormatLite::WriteMessageReverse(int field_number,
+                                         const MessageLite& value,
+                                         io::ReverseCodedBuffer* output) {
+  const int end = output->ByteCount();
+  value.InternalSerializeReverse(output);
+  output->WriteVarint32(output->ByteCount() - end);
+  output->WriteTag(MakeTag(field_number, WIRETYPE_LENGTH_DELIMITED));
+}
+
 static inline bool ReadBytesToString(io::CodedInputStream* input,
                                      string* value) GOOGLE_ATTRIBUTE_ALWAYS_INLINE;
 static inline bool ReadBytesToString(io::CodedInputStream* input,
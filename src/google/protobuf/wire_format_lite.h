@@ -458,6 +458,25 @@ class LIBPROTOBUF_EXPORT WireFormatLite {
   static inline uint8* WriteMessageNoVirtualToArray(
     field_number, const MessageType& value, output) INL;
 
+#undef output
+#define output io::ReverseCodedBuffer* output_arg
+
+  // Prepend a sub-message field to a ReverseCodedBuffer.  The sub-message is
+  // written with InternalSerializeReverse() before its tag and length, so
+  // these neither require nor update cached sizes.
+  static void WriteGroupReverse(
+      field_number, const MessageLite& value, output);
+  static void WriteMessageReverse(
+      field_number, const MessageLite& value, output);
+
+  // Like above, but de-virtualize the call to InternalSerializeReverse().
+  template<typename MessageType>
+  static inline void WriteGroupNoVirtualReverse(
+    field_number, const MessageType& value, output) INL;
+  template<typename MessageType>
+  static inline void WriteMessageNoVirtualReverse(
+    field_number, const MessageType& value, output) INL;
+
 #undef output
 #undef input
 #undef INL
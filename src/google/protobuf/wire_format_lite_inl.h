@@ -790,6 +790,24 @@ inline uint8* WireFormatLite::WriteMessageNoVirtualToArray(
       ::SerializeWithCachedSizesToArray(target);
 }
 
+template<typename MessageType_WorkAroundCppLookupDefect>
+inline void WireFormatLite::WriteGroupNoVirtualReverse(
+    int field_number, const MessageType_WorkAroundCppLookupDefect& value,
+    io::ReverseCodedBuffer* output) {
+  output->WriteTag(MakeTag(field_number, WIRETYPE_END_GROUP));
+  value.MessageType_WorkAroundCppLookupDefect::InternalSerializeReverse(output);
+  output->WriteTag(MakeTag(field_number, WIRETYPE_START_GROUP));
+}
+template<typename MessageType_WorkAroundCppLookupDefect>
+inline void WireFormatLite::WriteMessageNoVirtualReverse(
+    int field_number, const MessageType_WorkAroundCppLookupDefect& value,
+    io::ReverseCodedBuffer* output) {
+  const int end = output->ByteCount();
+  value.MessageType_WorkAroundCppLookupDefect::InternalSerializeReverse(output);
+  output->WriteVarint32(output->ByteCount() - end);
+  output->WriteTag(MakeTag(field_number, WIRETYPE_LENGTH_DELIMITED));
+}
+
 // ===================================================================
 
 inline int WireFormatLite::Int32Size(int32 value) {
@@ -23,12 +23,18 @@ copy ..\src\google\protobuf\descriptor.h include\google\protobuf\descriptor.h
 copy ..\src\google\protobuf\descriptor.pb.h include\google\protobuf\descriptor.pb.h
 copy ..\src\google\protobuf\dynamic_message.h include\google\protobuf\dynamic_message.h
 copy ..\src\google\protobuf\extension_set.h include\google\protobuf\extension_set.h
+copy ..\src\google\protobuf\frozen_message.h include\google\protobuf\frozen_message.h
 copy ..\src\google\protobuf\generated_enum_reflection.h include\google\protobuf\generated_enum_reflection.h
 copy ..\src\google\protobuf\generated_message_reflection.h include\google\protobuf\generated_message_reflection.h
 copy ..\src\google\protobuf\generated_message_util.h include\google\protobuf\generated_message_util.h
+copy ..\src\google\protobuf\io\async_stream.h include\google\protobuf\io\async_stream.h
+copy ..\src\google\protobuf\io\buffer_chain.h include\google\protobuf\io\buffer_chain.h
 copy ..\src\google\protobuf\io\coded_stream.h include\google\protobuf\io\coded_stream.h
+copy ..\src\google\protobuf\io\delimited_message_stream.h include\google\protobuf\io\delimited_message_stream.h
+copy ..\src\google\protobuf\io\dictionary_trainer.h include\google\protobuf\io\dictionary_trainer.h
 copy ..\src\google\protobuf\io\gzip_stream.h include\google\protobuf\io\gzip_stream.h
 copy ..\src\google\protobuf\io\printer.h include\google\protobuf\io\printer.h
+copy ..\src\google\protobuf\io\record_file.h include\google\protobuf\io\record_file.h
 copy ..\src\google\protobuf\io\strtod.h include\google\protobuf\io\strtod.h
 copy ..\src\google\protobuf\io\tokenizer.h include\google\protobuf\io\tokenizer.h
 copy ..\src\google\protobuf\io\zero_copy_stream.h include\google\protobuf\io\zero_copy_stream.h
@@ -42,6 +48,7 @@ copy ..\src\google\protobuf\map_type_handler.h include\google\protobuf\map_type_
 copy ..\src\google\protobuf\message.h include\google\protobuf\message.h
 copy ..\src\google\protobuf\message_lite.h include\google\protobuf\message_lite.h
 copy ..\src\google\protobuf\metadata.h include\google\protobuf\metadata.h
+copy ..\src\google\protobuf\parse_visitor.h include\google\protobuf\parse_visitor.h
 copy ..\src\google\protobuf\reflection.h include\google\protobuf\reflection.h
 copy ..\src\google\protobuf\reflection_ops.h include\google\protobuf\reflection_ops.h
 copy ..\src\google\protobuf\repeated_field.h include\google\protobuf\repeated_field.h